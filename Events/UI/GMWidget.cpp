@@ -41,10 +41,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "GmAppConfig.h"
 #include "GmAppConfigWidget.h"
 #include "GmCommon.h"
-#include "GridNode.h"
 #include "Utils/ProgramOutputDialog.h"
 #include "MapViewSubWidget.h"
-#include "NGAW2Converter.h"
 #include "RecordSelectionWidget.h"
 #include "SimCenterPreferences.h"
 #include "SiteGridWidget.h"
@@ -57,7 +55,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "WorkflowAppR2D.h"
 #include "PeerNgaWest2Client.h"
 #include "PeerLoginDialog.h"
-#include "ZipUtils.h"
 #include "QGISSiteInputWidget.h"
 #include "SiteConfig.h"
 #include "SiteConfigWidget.h"
@@ -66,6 +63,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "IntensityMeasure.h"
 #include "ModularPython.h"
 #include "GroundFailureWidget.h"
+#include "StationMatrix.h"
+#include "ConcurrentTasks.h"
 
 
 #ifdef INCLUDE_USER_PASS
@@ -229,9 +228,17 @@ void GMWidget::setupConnections()
     connect(siteWidget->siteConfigWidget()->getSiteGridWidget(), &SiteGridWidget::selectGridOnMap, this, &GMWidget::showGISWindow);
 
 
-    connect(&peerClient, &PeerNgaWest2Client::recordsDownloaded, this, [this](QString zipFile)
+    // The pipeline takes the downloaded records from the client, converts them, and reports once all of them are in place
+    recordPipeline = new PeerRecordPipeline(&peerClient, this);
+
+    connect(recordPipeline, &PeerRecordPipeline::statusUpdated, this, [this](QString statusUpdate)
+            {
+                this->statusMessage(statusUpdate);
+            });
+
+    connect(recordPipeline, &PeerRecordPipeline::finished, this, [this](int result, QString errorMessage)
             {
-                this->parseDownloadedRecords(zipFile);
+                this->handleRecordsReady(result, errorMessage);
                 this->getProgressDialog()->hideProgressBar();
             });
 
@@ -542,19 +549,17 @@ QVector<QStringList> GMWidget::getUserGridData(void)
 
     gridData.push_back(headerRow);
 
-    auto gridNodeVec = userGrid->getGridNodeVec();
+    auto gridPoints = userGrid->getGridPoints();
     auto mapCanvas = mapViewSubWidget->getMapCanvasWidget()->mapCanvas();
 
-    for(int i = 0; i<gridNodeVec.size(); ++i)
+    for(int i = 0; i<gridPoints.size(); ++i)
     {
-        auto gridNode = gridNodeVec.at(i);
-
         QStringList stationRow;
 
         // The station id
         stationRow.push_back(QString::number(i));
 
-        auto screenPoint = gridNode->getPoint();
+        auto screenPoint = gridPoints.at(i);
 
         // The latitude and longitude
         auto longitude = theVisualizationWidget->getLongFromScreenPoint(screenPoint,mapCanvas);
@@ -979,9 +984,6 @@ void GMWidget::handleProcessFinished()
 
     QApplication::processEvents();
 
-    numDownloaded = 0;
-    downloadComplete = false;
-    recordsListToDownload.clear();
     NGA2Results = QJsonObject();
 
     auto res = this->downloadRecords();
@@ -1014,8 +1016,6 @@ int GMWidget::downloadRecords(void)
     QString pathToGMFilesDirectory = m_appConfig->getOutputDirectoryPath() + QDir::separator();
 
     // read file of selected record and create a list containing records to download
-    recordsListToDownload.clear();
-
     QStringList recordsToDownload;
 
     QString recordsListFilename = QString(pathToGMFilesDirectory + QString("RSN.csv"));
@@ -1043,66 +1043,20 @@ int GMWidget::downloadRecords(void)
 
     theRecordsListFile.close();
 
-    qDebug()<<QString::number(recordsListToDownload.empty());
-
-    // Check if any of the records exist, do not need to download them again
-    const QFileInfo existingFilesInfo(pathToGMFilesDirectory);
-
-    // Get the existing files in the folder to see if we already have the record
-    QStringList acceptableFileExtensions = {"*.json"};
-    QStringList existingFiles = existingFilesInfo.dir().entryList(acceptableFileExtensions, QDir::Files);
-
-    if(!existingFiles.empty())
-    {
-        for(auto&& it : recordsToDownload)
-        {
-            auto fileToCheck = "RSN" + it + ".json";
-            if(!existingFiles.contains(fileToCheck))
-                recordsListToDownload.append(it);
-        }
-    }
-    else
-    {
-        recordsListToDownload = recordsToDownload;
-    }
-
+    // The records that are already in the folder or in the local record cache are not downloaded again
+    QString errMsg;
+    auto res = recordPipeline->start(recordsToDownload, m_appConfig->getOutputDirectoryPath(), errMsg);
 
-    qDebug()<<QString::number(recordsListToDownload.isEmpty());
-    qDebug()<<QString::number(recordsListToDownload.empty());
-    if (!recordsListToDownload.isEmpty())
+    if(res != 0)
     {
-        this->downloadRecordBatch();
+        this->errorMessage(errMsg);
+        return -1;
     }
 
     return 0;
 }
 
 
-void GMWidget::downloadRecordBatch(void)
-{
-    if(recordsListToDownload.empty())
-        return;
-
-    auto maxBatchSize = 100;
-
-    if(recordsListToDownload.size() < maxBatchSize)
-    {
-        peerClient.selectRecords(recordsListToDownload);
-        numDownloaded = recordsListToDownload.size();
-
-        recordsListToDownload.clear();
-    }
-    else
-    {
-        auto recordsBatch = recordsListToDownload.mid(0,maxBatchSize-1);
-
-        numDownloaded += recordsBatch.size();
-
-        peerClient.selectRecords(recordsBatch);
-
-        recordsListToDownload = recordsListToDownload.mid(maxBatchSize-1,recordsListToDownload.size()-1);
-    }
-}
 int GMWidget::processDownloadedRecords(QString& errorMessage)
 {
 
@@ -1219,77 +1173,34 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
 
     auto motionDir = inputFile.dir().absolutePath() ;
 
-    QApplication::processEvents();
-
-    this->getProgressDialog()->setProgressBarRange(0,inputFiles.size());
-    this->getProgressDialog()->setProgressBarValue(0);
-
-    QApplication::processEvents();
-
-    // Get the headers in the first station file - assume that the rest will be the same
-    auto rowStr = data.at(1);
-    auto stationName = rowStr[0];
-
-    // Path to station files, e.g., site0.csv
-    auto stationFilePath = motionDir + QDir::separator() + stationName;
+    // Pop off the row that contains the header information
+    data.pop_front();
 
-    QString err2;
-    QVector<QStringList> sampleStationData = csvTool.parseCSVFile(stationFilePath,err);
+    const int numRows = data.size();
 
-    // Return if there is an error or the station data is empty
-    if(!err2.isEmpty())
+    if(numRows == 0)
     {
-        errorMessage = "Could not parse the first station with the following error: "+err2;
+        errorMessage = "The file " + pathToOutputEventGrid + " is empty";
         return -1;
     }
 
-    if(sampleStationData.size() < 2)
+    // The downsampling errors are given per station, in the order of the event grid
+    if((!RupSampledError.isEmpty() && RupSampledError.size() < numRows) || (!GMSampledError.isEmpty() && GMSampledError.size() < numRows))
     {
-        errorMessage = "The file " + stationFilePath + " is empty";
+        errorMessage = "The number of downsampling errors does not match the number of stations in the file " + pathToOutputEventGrid;
         return -1;
     }
 
-    // Get the header file
-    auto stationDataHeadings = sampleStationData.first();
-    if (!RupSampledError.isEmpty()){
-        qDebug() << "RupSampleMSE appended before." << stationDataHeadings.size();
-        stationDataHeadings.append("RupSampleMSE");
-        qDebug() << "RupSampleMSE appended after." << stationDataHeadings.size();
-    }
-    if (!GMSampledError.isEmpty()){
-        stationDataHeadings.append("GMSampleMSE");
-    }
-
-    // Create the fields
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
-    attribFields.push_back(QgsField("Station Name", QVariant::String));
-    attribFields.push_back(QgsField("Latitude", QVariant::Double));
-    attribFields.push_back(QgsField("Longitude", QVariant::Double));
-
-    // Pop off the row that contains the header information
-    data.pop_front();
-
-    auto numRows = data.size();
-
-    int count = 0;
-
-    auto maxToDisp = 20;
+    // Get the station locations first, they are quick to check
+    QVector<double> latitudes(numRows);
+    QVector<double> longitudes(numRows);
 
-    QgsFeatureList featureList;
-    // Get the data
     for(int i = 0; i<numRows; ++i)
     {
-        auto rowStr = data.at(i);
-
-        auto stationName = rowStr[0];
-
-        // Path to station files, e.g., site0.csv
-        auto stationPath = motionDir + QDir::separator() + stationName;
+        const auto& rowStr = data.at(i);
 
         bool ok;
-        auto lon = rowStr[1].toDouble(&ok);
+        longitudes[i] = rowStr.value(1).toDouble(&ok);
 
         if(!ok)
         {
@@ -1297,136 +1208,202 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
             return -1;
         }
 
-        auto lat = rowStr[2].toDouble(&ok);
+        latitudes[i] = rowStr.value(2).toDouble(&ok);
 
         if(!ok)
         {
             errorMessage = "Error latitude to a double, check the value";
             return -1;
         }
+    }
 
-        GroundMotionStation GMStation(stationPath,lat,lon);
+    const int maxToDisp = 20;
 
-        try
-        {
-            GMStation.importGroundMotions();
-        }
-        catch(QString msg)
+    // What is kept of a station once its matrix is reduced, the matrices themselves are not kept
+    struct StationSummary
+    {
+        QStringList headers;
+        QVector<bool> numericColumns;
+        QVector<double> means;
+        QVector<double> stdDevs;
+        QVector<double> medians;
+        QStringList previews;
+    };
+
+    QVector<StationSummary> stationSummaries(numRows);
+
+    // Each station writes only to its own slot
+    StationSummary* stationSummariesData = stationSummaries.data();
+
+    auto processStation = [&](const int i, QString& stationErr)
+    {
+        auto stationName = data.at(i).value(0);
+
+        // Path to station files, e.g., site0.csv
+        auto stationPath = motionDir + QDir::separator() + stationName;
+
+        StationMatrix stationMatrix;
+
+        // One row more than is shown, to know if the preview is cut off
+        QString err;
+        if(stationMatrix.parseFile(stationPath, maxToDisp + 1, err) != 0)
         {
-            errorMessage = "Error importing ground motion file: " + stationName+"\n"+msg;
-            return -1;
+            stationErr = "Error importing ground motion file: " + stationName + "\n" + err;
+            return;
         }
 
-        auto stationData = GMStation.getStationData();
-        qDebug() << "station data size before: "<<stationData.front().size();
-        if (!RupSampledError.isEmpty()){
-//            QString stationRupError = RupSampledError[i];
-//            qDebug() << "GMStation: "<< i<< " Rup Sample Error: " << stationRupError;
-            for (int rlz_i = 0; rlz_i < stationData.size(); ++rlz_i) {
-                stationData[rlz_i].append("0"); // place holder
-            }
-        }
-        if (!GMSampledError.isEmpty()){
-//            QString stationGMError = GMSampledError[i];
-//            qDebug() << "GMStation: "<< i<< " Rup GM Error: " << stationGMError;
-            for (int rlz_i = 0; rlz_i < stationData.size(); ++rlz_i) {
-                stationData[rlz_i].append("0"); // place holder
-            }
-        }
+        auto& summary = stationSummariesData[i];
 
-        // The number of headings in the file
-        auto numParams = stationData.front().size();
-
-        maxToDisp = (maxToDisp<stationData.size() ? maxToDisp : stationData.size());
-
-        QVector<QString> dataStrs(numParams);
-        QVector<double> dataDouble(numParams);
-        int num_rows = stationData.size();
-        for (int j = 0; j<numParams; j++){
-            double value = 0;
-            for(int row_i = 0; row_i<num_rows; row_i++){
-                auto stationParams = stationData[row_i];
-                QString valString = stationParams[j];
-                bool isNumber;
-                double valDouble = valString.toDouble(&isNumber);
-                if (isNumber && (stationDataHeadings[j].compare("factor")!=0)){
-                    value += valDouble;
-                } else {
-                    value = qQNaN();
-                }
-            }
-            value = value/num_rows;
-            if (stationDataHeadings[j].compare("RupSampleMSE")==0){
-                value = RupSampledError[i];
-            }
-            if (stationDataHeadings[j].compare("GMSampleMSE")==0){
-                value = GMSampledError[i];
-            }
-            dataDouble[j] = value;
-        }
+        summary.headers = stationMatrix.getHeaders();
 
-        for(int ii = 0; ii<maxToDisp-1; ++ii)
-        {
-            auto stationParams = stationData[ii];
+        const int numParams = stationMatrix.numColumns();
 
-            for(int j = 0; j<numParams; ++j)
-            {
-                if (qIsNaN(dataDouble[j])){
-                    dataStrs[j] += stationParams[j] + ", ";
-                } else {
-//                    dataStrs[j] = QString::number(dataDouble[j]);
-                    break;
-                }
+        summary.numericColumns.resize(numParams);
+        for(int j = 0; j<numParams; ++j)
+            summary.numericColumns[j] = stationMatrix.isNumericColumn(j) && summary.headers.at(j).compare("factor") != 0;
 
+        summary.means = stationMatrix.columnMeans();
+        summary.stdDevs = stationMatrix.columnStdDevs();
+
+        summary.medians.resize(numParams);
+        for(int j = 0; j<numParams; ++j)
+            summary.medians[j] = summary.numericColumns.at(j) ? stationMatrix.columnPercentile(j, 50.0) : qQNaN();
+
+        // The columns that are not averaged are shown as a list of their first values
+        const auto& textRows = stationMatrix.getTextRows();
+        const int numToDisp = std::min(maxToDisp, int(textRows.size()));
+
+        summary.previews.reserve(numParams);
+        for(int j = 0; j<numParams; ++j)
+        {
+            if(summary.numericColumns.at(j))
+            {
+                summary.previews.append(QString());
+                continue;
             }
+
+            QStringList values;
+            values.reserve(numToDisp);
+
+            for(int k = 0; k<numToDisp; ++k)
+                values.append(textRows.at(k).value(j));
+
+            auto str = values.join(", ");
+
+            if(numToDisp < stationMatrix.numRows())
+                str += "...";
+
+            summary.previews.append(str);
         }
-        // create the feature attributes
-        if (i==0){
-            for(int j = 0; j<numParams; ++j){
-                if (qIsNaN(dataDouble[j])){
-                    attribFields.push_back(QgsField(stationDataHeadings[j], QVariant::String));
-                } else {
-                    attribFields.push_back(QgsField(stationDataHeadings[j], QVariant::Double));
-                }
-            }
-        }
+    };
 
-        QgsAttributes featAttributes(attribFields.size());
+    this->getProgressDialog()->setProgressBarRange(0,numRows);
+    this->getProgressDialog()->setProgressBarValue(0);
+
+    // Report the first station that failed, in the order of the event file
+    auto processErr = ConcurrentTasks::map(numRows, processStation, [this](int value){
+        this->getProgressDialog()->setProgressBarValue(value);
+    });
+
+    if(!processErr.isEmpty())
+    {
+        errorMessage = processErr;
+        return -1;
+    }
+
+    // The fields are taken from the first station - assume that the rest will be the same
+    const auto& firstStation = stationSummaries.front();
+    const auto& stationDataHeadings = firstStation.headers;
+    const int numHeadings = stationDataHeadings.size();
+
+    // Create the fields
+    QList<QgsField> attribFields;
+    attribFields.push_back(QgsField("AssetType", QVariant::String));
+    attribFields.push_back(QgsField("TabName", QVariant::String));
+    attribFields.push_back(QgsField("Station Name", QVariant::String));
+    attribFields.push_back(QgsField("Latitude", QVariant::Double));
+    attribFields.push_back(QgsField("Longitude", QVariant::Double));
 
-        auto latitude = GMStation.getLatitude();
-        auto longitude = GMStation.getLongitude();
+    for(int j = 0; j<numHeadings; ++j)
+        attribFields.push_back(QgsField(stationDataHeadings[j], firstStation.numericColumns.at(j) ? QVariant::Double : QVariant::String));
+
+    // The downsampling errors are merged in as columns of their own
+    if(!RupSampledError.isEmpty())
+        attribFields.push_back(QgsField("RupSampleMSE", QVariant::Double));
+
+    if(!GMSampledError.isEmpty())
+        attribFields.push_back(QgsField("GMSampleMSE", QVariant::Double));
+
+    // The spread of the averaged columns across the realizations
+    QVector<int> statColumns;
+    for(int j = 0; j<numHeadings; ++j)
+    {
+        if(!firstStation.numericColumns.at(j))
+            continue;
+
+        statColumns.push_back(j);
+        attribFields.push_back(QgsField(stationDataHeadings[j] + " Std Dev", QVariant::Double));
+        attribFields.push_back(QgsField(stationDataHeadings[j] + " Median", QVariant::Double));
+    }
+
+    QgsFeatureList featureList;
+    featureList.reserve(numRows);
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        const auto& summary = stationSummaries.at(i);
+
+        auto stationName = data.at(i).value(0);
+
+        auto latitude = latitudes.at(i);
+        auto longitude = longitudes.at(i);
+
+        QgsAttributes featAttributes(attribFields.size());
 
         featAttributes[0] = "GroundMotionGridPoint";     // "AssetType"
         featAttributes[1] = "Ground Motion Grid Point";  // "TabName"
         featAttributes[2] = stationName;                 // "Station Name"
         featAttributes[3] = latitude;                    // "Latitude"
         featAttributes[4] = longitude;                   // "Longitude"
+
+        // The number of headings in the file
+        const int numParams = std::min(numHeadings, int(summary.headers.size()));
+
         for(int j = 0; j<numParams; ++j)
         {
-            if(qIsNaN(dataDouble[j])){
-                auto str = dataStrs[j] ;
-                str += stationData[maxToDisp-1][j];
-                if((qIsNaN(dataDouble[j]))&&(maxToDisp<stationData.size())){
-                    str += "...";
-                }
-                featAttributes[5+j] = str;
-            } else {
-                featAttributes[5+j] = dataDouble[j];
+            if(summary.numericColumns.at(j))
+                featAttributes[5+j] = summary.means.at(j);
+            else
+                featAttributes[5+j] = summary.previews.at(j);
+        }
+
+        int col = 5 + numHeadings;
+
+        if(!RupSampledError.isEmpty())
+            featAttributes[col++] = RupSampledError.at(i);
+
+        if(!GMSampledError.isEmpty())
+            featAttributes[col++] = GMSampledError.at(i);
+
+        for(auto&& j : statColumns)
+        {
+            if(j < numParams && summary.numericColumns.at(j))
+            {
+                featAttributes[col] = summary.stdDevs.at(j);
+                featAttributes[col+1] = summary.medians.at(j);
             }
 
+            col += 2;
         }
+
         // Create the feature
         QgsFeature feature;
         feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
         feature.setAttributes(featAttributes);
         featureList.append(feature);
-
-        ++count;
-        this->getProgressDialog()->setProgressBarValue(count);
-
-        QApplication::processEvents();
     }
 
+    stationSummaries.clear();
 
     auto vectorLayer = qgisVizWidget->addVectorLayer("Point", "Ground Motion Grid");
 
@@ -1448,7 +1425,7 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
 
     vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
 
-    dProvider->addFeatures(featureList);
+    dProvider->addFeatures(featureList, QgsFeatureSink::FastInsert);
     vectorLayer->updateExtents();
 
     qgisVizWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
@@ -1457,47 +1434,18 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
 }
 
 
-int GMWidget::parseDownloadedRecords(QString zipFile)
+int GMWidget::handleRecordsReady(int result, QString errMsg)
 {
-    QString pathToOutputDirectory = m_appConfig->getOutputDirectoryPath();
-    bool result =  ZipUtils::UnzipFile(zipFile, pathToOutputDirectory);
-    if (result == false)
+    if(result != 0)
     {
-        QString errMsg = "Error in unziping the downloaded ground motion files";
         this->errorMessage(errMsg);
-        return -1;
+        return result;
     }
 
-    NGAW2Converter tool;
-
-    // Import the search results overview file provided by the PEER Ground Motion Database for this batch - this file will get overwritten on the next batch
-    QString errMsg;
-    auto res1 = tool.parseNGAW2SearchResults(pathToOutputDirectory,NGA2Results,errMsg);
-    if(res1 != 0)
-    {
-        this->errorMessage(errMsg);
-        return -1;
-    }
+    // The search results of all of the downloaded batches
+    NGA2Results = recordPipeline->getSearchResults();
 
-    // if more records to download due to 100 record limit .. go download them
-    if (!recordsListToDownload.empty())
-    {
-        this->downloadRecordBatch();
-        return 0;
-    }
-
-    QJsonObject createdRecords;
-    auto res = tool.convertToSimCenterEvent(pathToOutputDirectory + QDir::separator(), NGA2Results, errMsg, &createdRecords);
-    if(res != 0)
-    {
-        if(res == -2)
-        {
-            errMsg.prepend("Error downloading ground motion files from PEER server.\n");
-        }
-
-        this->errorMessage(errMsg);
-        return res;
-    }
+    this->statusMessage(QString::number(recordPipeline->getNumDownloaded()) + " ground motion records were downloaded and " + QString::number(recordPipeline->getNumFromCache()) + " were taken from the local record cache");
 
     auto res2 = this->processDownloadedRecords(errMsg);
     if(res2 != 0)
@@ -41,6 +41,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "SimCenterAppWidget.h"
 #include "GroundMotionStation.h"
 #include "PeerNgaWest2Client.h"
+#include "PeerRecordPipeline.h"
 #include "EventGMDirWidget.h"
 
 #include <QProcess>
@@ -115,11 +116,8 @@ public slots:
     // Download records once selected
     int downloadRecords(void);
 
-    // Download records once selected
-    void downloadRecordBatch(void);
-
-    // Process the outfile files once the hazard simulation is complete
-    int parseDownloadedRecords(QString);
+    // Process the outfile files once all of the selected records are downloaded and converted
+    int handleRecordsReady(int result, QString errMsg);
 
     // Send event file and motion dir
     void sendEventFileMotionDir(const QString &eventFile, const QString &motionDir);
@@ -138,6 +136,8 @@ private:
 
     PeerNgaWest2Client peerClient;
 
+    PeerRecordPipeline* recordPipeline = nullptr;
+
     QProcess* process = nullptr;
 
     RecordSelectionConfig* m_selectionconfig = nullptr;
@@ -170,9 +170,6 @@ private:
 
     int processDownloadedRecords(QString& errorMessage);
 
-    int numDownloaded;
-    bool downloadComplete;
-    QStringList recordsListToDownload;
     QJsonObject NGA2Results;
 };
 
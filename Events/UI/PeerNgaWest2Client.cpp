@@ -50,10 +50,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QSslConfiguration>
 
 PeerNgaWest2Client::PeerNgaWest2Client(QObject *parent) : QObject(parent),
-    nRecords(3), isLoggedIn(false), retries(0)
+    nRecords(3), isLoggedIn(false), retries(0), serverUrl("https://ngawest2.berkeley.edu")
 {
     QNetworkCookie cookie("sourceDb_flag", "1");
-    cookie.setDomain("ngawest2.berkeley.edu");
+    cookie.setDomain(serverUrl.host());
     networkManager.cookieJar()->insertCookie(cookie);
 
     searchScaleFlag = -1;
@@ -75,7 +75,7 @@ void PeerNgaWest2Client::signIn(QString username, QString password)
     this->username = username;
     this->password = password;
     
-    QNetworkRequest peerSignInPageRequest(QUrl("https://ngawest2.berkeley.edu/users/sign_in"));
+    QNetworkRequest peerSignInPageRequest(serverPath("/users/sign_in"));
     signInPageReply = networkManager.get(peerSignInPageRequest);
 }
 
@@ -90,7 +90,7 @@ void PeerNgaWest2Client::selectRecords(QList<QPair<double, double>> spectrum, in
     this->distanceRange = distanceRange;
     this->vs30Range = vs30Range;
 
-    uploadFileRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/spectras/uploadFile"));
+    uploadFileRequest.setUrl(serverPath("/spectras/uploadFile"));
     QHttpMultiPart* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
 
     //Token part
@@ -134,10 +134,10 @@ void PeerNgaWest2Client::selectRecords(double sds, double sd1, double tl, int nR
     this->nRecords = nRecords;
 
     QNetworkCookie cookie("SpectrumModel_Dropdown", "99");
-    cookie.setDomain("ngawest2.berkeley.edu");
+    cookie.setDomain(serverUrl.host());
     networkManager.cookieJar()->insertCookie(cookie);
 
-    postSpectraRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/spectras"));
+    postSpectraRequest.setUrl(serverPath("/spectras"));
     postSpectraRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     postSpectraParameters.clear();
@@ -168,10 +168,10 @@ void PeerNgaWest2Client::selectRecords(QStringList records)
     emit statusUpdated("Performing Record Selection...");
 
     QNetworkCookie cookie("SpectrumModel_Dropdown", "88");
-    cookie.setDomain("ngawest2.berkeley.edu");
+    cookie.setDomain(serverUrl.host());
     networkManager.cookieJar()->insertCookie(cookie);
 
-    postSpectraRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/spectras"));
+    postSpectraRequest.setUrl(serverPath("/spectras"));
     postSpectraRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     postSpectraParameters.clear();
@@ -243,6 +243,13 @@ void PeerNgaWest2Client::processSignInPageReply()
     {
         emit statusUpdated("Failed to connect to PEER NGA West 2, Please check your internet connection");
         emit loginFinished(false);
+
+        // The sign in was a retry of a selection
+        if(retries > 0)
+        {
+            retries = 0;
+            failSelection("Failed to connect to PEER NGA West 2, Please check your internet connection");
+        }
         return;
     }
 
@@ -274,7 +281,7 @@ void PeerNgaWest2Client::processSignInPageReply()
     authenticityToken = match.captured(1);
 #endif
 
-    peerSignInRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/users/sign_in"));
+    peerSignInRequest.setUrl(serverPath("/users/sign_in"));
     peerSignInRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     signInParameters.clear();
@@ -329,17 +336,28 @@ void PeerNgaWest2Client::processSignInReply()
     emit loginFinished(false);
     isLoggedIn = false;
 
+    // The sign in was a retry of a selection
+    if(retries > 0)
+    {
+        retries = 0;
+        failSelection("Failed to sign in to PEER NGA West 2 again to submit the target spectrum");
+    }
 }
 
 
 void PeerNgaWest2Client::processUploadFileReply()
 {
+    if(uploadFileReply->error() != QNetworkReply::NoError)
+    {
+        failSelection("Failed to upload the target spectrum to PEER NGA West 2 Database");
+        return;
+    }
 
     QNetworkCookie cookie("SpectrumModel_Dropdown", "0");
-    cookie.setDomain("ngawest2.berkeley.edu");
+    cookie.setDomain(serverUrl.host());
     networkManager.cookieJar()->insertCookie(cookie);
 
-    postSpectraRequest.setUrl(QUrl("https://ngawest2.berkeley.edu/spectras"));
+    postSpectraRequest.setUrl(serverPath("/spectras"));
     postSpectraRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     postSpectraParameters.clear();
@@ -352,7 +370,7 @@ void PeerNgaWest2Client::processUploadFileReply()
     postSpectraParameters.addQueryItem("model[ID]", "0");
     postSpectraParameters.addQueryItem("spectra[menu_Mechanism]", "1");
 
-    for (auto& cookie: networkManager.cookieJar()->cookiesForUrl(QUrl("https://ngawest2.berkeley.edu")))
+    for (auto& cookie: networkManager.cookieJar()->cookiesForUrl(serverUrl))
         if (0 == cookie.name().compare("upload_file"))
             postSpectraParameters.addQueryItem("spectra[filename]", cookie.value());
 
@@ -386,7 +404,8 @@ void PeerNgaWest2Client::processPostSpectrumReply()
         }
 
         retries = 0;
-        auto url = postSpectraReply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+        // The redirection may be relative to the server
+        auto url = postSpectraReply->url().resolved(postSpectraReply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl());
         auto searchPost = url.toString().remove("/new").remove("/edit").remove("/searches").append("/searches");
 
         QNetworkRequest searchPostRequest(searchPost);
@@ -481,25 +500,38 @@ void PeerNgaWest2Client::processPostSpectrumReply()
 
 void PeerNgaWest2Client::processPostSearchReply()
 {
+    // The search redirects to its results
+    auto redirectUrl = postSearchReply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+    if(postSearchReply->error() != QNetworkReply::NoError || redirectUrl.isEmpty())
+    {
+        failSelection("Search of NGA West failed");
+        return;
+    }
+
     emit statusUpdated("Retrieving Record Selection Results from PEER NGA West 2 Database");
 
-    auto url = postSearchReply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+    auto url = postSearchReply->url().resolved(redirectUrl);
     auto getRecordsUrl = url.toString().replace("/edit", "/?getRecords=1");
 
     QNetworkRequest getRecordsRequest(getRecordsUrl);
-
-    if (getRecordsRequest.url().toString() == "") {
-        emit statusUpdated("Search of NGA West failed");
-    }
     getRecordsReply = networkManager.get(getRecordsRequest);
 }
 
 
 void PeerNgaWest2Client::processGetRecordsReply()
 {
-    emit statusUpdated("Downloading Ground Motions from PEER NGA West 2 Database");
     auto replyText = QString(getRecordsReply->readAll());
-    auto url = replyText.remove("window.location.href = \"").remove("\";").prepend("https://ngawest2.berkeley.edu");
+
+    // The reply is a script that sends the browser to the zip file of the records
+    if(getRecordsReply->error() != QNetworkReply::NoError || !replyText.contains("window.location.href"))
+    {
+        failSelection("Failed to retrieve the record selection results from PEER NGA West 2 Database");
+        return;
+    }
+
+    emit statusUpdated("Downloading Ground Motions from PEER NGA West 2 Database");
+    auto url = replyText.remove("window.location.href = \"").remove("\";").prepend(serverUrl.toString(QUrl::StripTrailingSlash));
 
     QNetworkRequest downloadRecordsRequest(url);
     downloadRecordsReply = networkManager.get(downloadRecordsRequest);
@@ -508,14 +540,20 @@ void PeerNgaWest2Client::processGetRecordsReply()
 
 void PeerNgaWest2Client::processDownloadRecordsReply()
 {
-    emit selectionFinished();
+    if(downloadRecordsReply->error() != QNetworkReply::NoError)
+    {
+        failSelection("Ground Motions Download Failed!");
+        return;
+    }
+
     auto tempLocation = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
 
     if(!QDir(tempLocation).exists())
     {
         if(!QDir(tempLocation).mkpath("."))
         {
-            emit statusUpdated("Ground Motions Download Failed!");
+            failSelection("Ground Motions Download Failed!");
+            return;
         }
     }
     //TODO: we might need to use temporary files
@@ -524,13 +562,14 @@ void PeerNgaWest2Client::processDownloadRecordsReply()
     QFile file(recordsPath);
     if(!file.open(QIODevice::WriteOnly))
     {
-        emit statusUpdated("Ground Motions Download Failed!");
+        failSelection("Ground Motions Download Failed!");
         return;
     }
 
     file.write(downloadRecordsReply->readAll());
     file.close();
 
+    emit selectionFinished();
     emit statusUpdated("Ground Motions Downloaded Successfully");
     emit recordsDownloaded(recordsPath);
 }
@@ -546,7 +585,7 @@ void PeerNgaWest2Client::retryPostSpectra()
 
 void PeerNgaWest2Client::retrySignIn()
 {
-    QNetworkRequest peerSignInPageRequest(QUrl("https://ngawest2.berkeley.edu/users/sign_in"));
+    QNetworkRequest peerSignInPageRequest(serverPath("/users/sign_in"));
     signInPageReply = networkManager.get(peerSignInPageRequest);
 }
 
@@ -561,14 +600,43 @@ void PeerNgaWest2Client::retry()
     }
     else
     {
-        emit statusUpdated("Failed to submit target spectrum to PEER NGA West 2 Database after 5 retries, Please try again shortly.");
         retries = 0;
-        emit selectionFinished();
+        failSelection("Failed to submit target spectrum to PEER NGA West 2 Database after 5 retries, Please try again shortly.");
         retrySignIn();
     }
 }
 
 
+void PeerNgaWest2Client::failSelection(const QString& message)
+{
+    emit statusUpdated(message);
+    emit selectionFinished();
+    emit selectionFailed(message);
+}
+
+
+void PeerNgaWest2Client::setServerUrl(const QUrl& url)
+{
+    serverUrl = url;
+
+    QNetworkCookie cookie("sourceDb_flag", "1");
+    cookie.setDomain(serverUrl.host());
+    networkManager.cookieJar()->insertCookie(cookie);
+}
+
+
+QUrl PeerNgaWest2Client::getServerUrl() const
+{
+    return serverUrl;
+}
+
+
+QUrl PeerNgaWest2Client::serverPath(const QString& path) const
+{
+    return serverUrl.resolved(QUrl(path));
+}
+
+
 void PeerNgaWest2Client::setScalingParameters(const int scaleFlag,
                                               const QString& periodPoints,
                                               const QString& weightPoints,
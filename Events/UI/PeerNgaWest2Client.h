@@ -63,6 +63,10 @@ public:
                               const QString& weightPoints,
                               const QString& scalingPeriod);
 
+    // The server that the requests go to, e.g., a local stand-in that replays recorded responses in the tests
+    void setServerUrl(const QUrl& url);
+    QUrl getServerUrl() const;
+
 signals:
     void loginFinished(bool result);
     void recordsDownloaded(QString recordsPath);
@@ -70,6 +74,9 @@ signals:
     void selectionStarted();
     void selectionFinished();
 
+    // A selection or download that was started did not complete, emitted after selectionFinished
+    void selectionFailed(QString errorMessage);
+
 public slots:
 
 private:
@@ -108,6 +115,11 @@ private:
     QNetworkRequest uploadFileRequest;
     QStringList recordsToDownload;
 
+    QUrl serverUrl;
+
+    // The URL of a path on the server, e.g., /users/sign_in
+    QUrl serverPath(const QString& path) const;
+
     void setupConnection();
     void processNetworkReply(QNetworkReply *reply);
 
@@ -122,6 +134,8 @@ private:
     void retrySignIn();
     void retry();
 
+    // Ends the selection that is in progress with the message
+    void failSelection(const QString& message);
 
 };
 
@@ -0,0 +1,437 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "PeerRecordPipeline.h"
+#include "PeerNgaWest2Client.h"
+#include "NGAW2Converter.h"
+#include "ZipUtils.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrent>
+
+namespace {
+
+// The PEER NGA West 2 database does not return more than 100 records per search
+const int maxBatchSize = 100;
+
+// Increase when the format of the converted records changes so that the old records are converted again
+const QString cacheVersion = "v1";
+
+}
+
+
+PeerRecordPipeline::PeerRecordPipeline(PeerNgaWest2Client* client, QObject* parent) : QObject(parent), peerClient(client)
+{
+    cacheDirectory = defaultCacheDirectory();
+
+    connect(peerClient, &PeerNgaWest2Client::recordsDownloaded, this, &PeerRecordPipeline::handleRecordsDownloaded);
+    connect(peerClient, &PeerNgaWest2Client::selectionFailed, this, &PeerRecordPipeline::handleSelectionFailed);
+}
+
+
+PeerRecordPipeline::~PeerRecordPipeline()
+{
+    // The staging directory is removed with the pipeline, so the conversions that use it have to be done first
+    for(auto&& it : conversions)
+        it->waitForFinished();
+}
+
+
+QString PeerRecordPipeline::defaultCacheDirectory(void)
+{
+    QString writableLocation = QStandardPaths::writableLocation(QStandardPaths::StandardLocation::AppLocalDataLocation);
+
+    return writableLocation + QDir::separator() + "PEERRecordCache" + QDir::separator() + cacheVersion;
+}
+
+
+void PeerRecordPipeline::setCacheDirectory(const QString& path)
+{
+    cacheDirectory = path;
+}
+
+
+QString PeerRecordPipeline::getCacheDirectory(void) const
+{
+    return cacheDirectory;
+}
+
+
+int PeerRecordPipeline::start(const QStringList& recordNumbers, const QString& outputDirectory, QString& err)
+{
+    if(running)
+    {
+        err = "The download of the ground motion records is already running";
+        return -1;
+    }
+
+    if(!QDir().mkpath(outputDirectory))
+    {
+        err = "Could not create the directory " + outputDirectory;
+        return -1;
+    }
+
+    stagingDirectory.reset(new QTemporaryDir());
+
+    if(!stagingDirectory->isValid())
+    {
+        err = "Could not create a temporary directory for the downloaded records: " + stagingDirectory->errorString();
+        stagingDirectory.reset();
+        return -1;
+    }
+
+    this->outputDirectory = outputDirectory;
+
+    pendingRecords.clear();
+    searchResults = QJsonObject();
+    errorMessage.clear();
+    downloadInFlight = false;
+    numBatches = 0;
+    numDownloaded = 0;
+    numFromCache = 0;
+
+    // A record that is listed more than once is downloaded once
+    QSet<QString> uniqueRecords;
+
+    for(auto&& it : recordNumbers)
+    {
+        auto RSN = it.trimmed();
+
+        if(RSN.isEmpty() || uniqueRecords.contains(RSN))
+            continue;
+
+        uniqueRecords.insert(RSN);
+
+        auto recordName = "RSN" + RSN;
+
+        if(QFileInfo::exists(outputDirectory + QDir::separator() + recordName + ".json"))
+            continue;
+
+        if(copyFromCache(recordName, cacheDirectory, outputDirectory))
+        {
+            ++numFromCache;
+            continue;
+        }
+
+        pendingRecords.append(RSN);
+    }
+
+    running = true;
+
+    if(numFromCache > 0)
+        emit statusUpdated(QString::number(numFromCache) + " ground motion records were taken from the local record cache");
+
+    if(pendingRecords.isEmpty())
+    {
+        // Nothing to download, still report the end from the event loop like a download would
+        QTimer::singleShot(0, this, [this](){ this->finishIfDone(); });
+        return 0;
+    }
+
+    this->requestNextBatch();
+
+    return 0;
+}
+
+
+bool PeerRecordPipeline::isRunning(void) const
+{
+    return running;
+}
+
+
+QJsonObject PeerRecordPipeline::getSearchResults(void) const
+{
+    return searchResults;
+}
+
+
+int PeerRecordPipeline::getNumDownloaded(void) const
+{
+    return numDownloaded;
+}
+
+
+int PeerRecordPipeline::getNumFromCache(void) const
+{
+    return numFromCache;
+}
+
+
+void PeerRecordPipeline::requestNextBatch(void)
+{
+    if(pendingRecords.isEmpty() || !errorMessage.isEmpty())
+        return;
+
+    auto recordsBatch = pendingRecords.mid(0, maxBatchSize);
+    pendingRecords = pendingRecords.mid(maxBatchSize);
+
+    numDownloaded += recordsBatch.size();
+    downloadInFlight = true;
+
+    emit statusUpdated("Downloading " + QString::number(recordsBatch.size()) + " ground motion records, " + QString::number(pendingRecords.size()) + " remaining after this batch");
+
+    peerClient->selectRecords(recordsBatch);
+}
+
+
+void PeerRecordPipeline::handleRecordsDownloaded(QString zipFile)
+{
+    // The client is shared, e.g., with a record selection that is not a part of the pipeline
+    if(!running || !downloadInFlight)
+        return;
+
+    downloadInFlight = false;
+
+    auto batchName = "batch" + QString::number(numBatches++);
+    auto batchZip = stagingDirectory->filePath(batchName + ".zip");
+    auto batchDirectory = stagingDirectory->filePath(batchName);
+
+    // The client writes every download to the same file, move it out of the way before the next download starts
+    if(!QFile::rename(zipFile, batchZip))
+    {
+        errorMessage = "Could not move the downloaded ground motion records " + zipFile;
+        pendingRecords.clear();
+        this->finishIfDone();
+        return;
+    }
+
+    // Start the next download first so that it overlaps with the conversion of this batch
+    this->requestNextBatch();
+
+    auto watcher = new QFutureWatcher<BatchResult>(this);
+    conversions.append(watcher);
+
+    connect(watcher, &QFutureWatcher<BatchResult>::finished, this, [this, watcher](){
+        this->handleBatchConverted(watcher);
+    });
+
+    watcher->setFuture(QtConcurrent::run(&PeerRecordPipeline::convertBatch, batchZip, batchDirectory, cacheDirectory, outputDirectory));
+}
+
+
+void PeerRecordPipeline::handleSelectionFailed(QString message)
+{
+    if(!running || !downloadInFlight)
+        return;
+
+    downloadInFlight = false;
+
+    // The batches that are already downloaded are still converted, but no more are requested
+    if(errorMessage.isEmpty())
+        errorMessage = "Error downloading ground motion files from PEER server.\n" + message;
+
+    pendingRecords.clear();
+
+    this->finishIfDone();
+}
+
+
+void PeerRecordPipeline::handleBatchConverted(QFutureWatcher<BatchResult>* watcher)
+{
+    conversions.removeOne(watcher);
+    watcher->deleteLater();
+
+    auto result = watcher->result();
+
+    if(!result.errorMessage.isEmpty())
+    {
+        // Keep the first error and do not download any more batches
+        if(errorMessage.isEmpty())
+            errorMessage = result.errorMessage;
+
+        pendingRecords.clear();
+    }
+    else
+    {
+        // The records of the batches go into the same objects, e.g., the metadata of the selected records
+        for(auto it = result.searchResults.constBegin(); it != result.searchResults.constEnd(); ++it)
+        {
+            auto existing = searchResults.value(it.key());
+
+            if(existing.isObject() && it.value().isObject())
+            {
+                auto merged = existing.toObject();
+                auto batchObj = it.value().toObject();
+
+                for(auto batchIt = batchObj.constBegin(); batchIt != batchObj.constEnd(); ++batchIt)
+                    merged.insert(batchIt.key(), batchIt.value());
+
+                searchResults.insert(it.key(), merged);
+            }
+            else
+            {
+                searchResults.insert(it.key(), it.value());
+            }
+        }
+    }
+
+    this->finishIfDone();
+}
+
+
+void PeerRecordPipeline::finishIfDone(void)
+{
+    if(!running || downloadInFlight || !conversions.isEmpty())
+        return;
+
+    if(!pendingRecords.isEmpty() && errorMessage.isEmpty())
+        return;
+
+    running = false;
+    pendingRecords.clear();
+    stagingDirectory.reset();
+
+    emit finished(errorMessage.isEmpty() ? 0 : -1, errorMessage);
+}
+
+
+PeerRecordPipeline::BatchResult PeerRecordPipeline::convertBatch(const QString& zipFile, const QString& batchDirectory, const QString& cacheDirectory, const QString& outputDirectory)
+{
+    BatchResult result;
+
+    if(!QDir().mkpath(batchDirectory) || !ZipUtils::UnzipFile(zipFile, batchDirectory))
+    {
+        result.errorMessage = "Error in unziping the downloaded ground motion files";
+        return result;
+    }
+
+    QFile::remove(zipFile);
+
+    NGAW2Converter tool;
+
+    // Import the search results overview file provided by the PEER Ground Motion Database for this batch
+    auto res = tool.parseNGAW2SearchResults(batchDirectory, result.searchResults, result.errorMessage);
+    if(res != 0)
+        return result;
+
+    tool.setWriteBinaryRecords(true);
+
+    res = tool.convertToSimCenterEvent(batchDirectory + QDir::separator(), result.searchResults, result.errorMessage, nullptr);
+    if(res != 0)
+    {
+        if(res == -2)
+            result.errorMessage.prepend("Error downloading ground motion files from PEER server.\n");
+
+        return result;
+    }
+
+    if(!QDir().mkpath(cacheDirectory))
+    {
+        result.errorMessage = "Could not create the record cache directory " + cacheDirectory;
+        return result;
+    }
+
+    QDir batchDir(batchDirectory);
+
+    // Put the records in the cache first, then hand them out from the cache like any other cached record
+    const auto recordFiles = batchDir.entryList(QStringList{"RSN*.json", "RSN*.bth"}, QDir::Files);
+
+    for(auto&& it : recordFiles)
+    {
+        auto cachedFile = cacheDirectory + QDir::separator() + it;
+
+        if(QFileInfo::exists(cachedFile))
+            continue;
+
+        // Another instance of the application may be filling the cache too, a record only appears under its name once it is complete
+        auto partialFile = cachedFile + ".part" + QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+
+        QFile::remove(partialFile);
+
+        if(!QFile::copy(batchDir.filePath(it), partialFile) || !QFile::rename(partialFile, cachedFile))
+        {
+            QFile::remove(partialFile);
+
+            if(!QFileInfo::exists(cachedFile))
+            {
+                result.errorMessage = "Could not add the record " + it + " to the record cache " + cacheDirectory;
+                return result;
+            }
+        }
+    }
+
+    for(auto&& it : recordFiles)
+    {
+        if(!it.endsWith(".json"))
+            continue;
+
+        auto recordName = QFileInfo(it).completeBaseName();
+
+        if(!copyFromCache(recordName, cacheDirectory, outputDirectory))
+        {
+            result.errorMessage = "Could not copy the record " + recordName + " to the directory " + outputDirectory;
+            return result;
+        }
+    }
+
+    batchDir.removeRecursively();
+
+    return result;
+}
+
+
+bool PeerRecordPipeline::copyFromCache(const QString& recordName, const QString& cacheDirectory, const QString& outputDirectory)
+{
+    const auto cachedRecord = cacheDirectory + QDir::separator() + recordName;
+
+    if(!QFileInfo::exists(cachedRecord + ".json"))
+        return false;
+
+    // The binary copy is optional
+    for(auto&& suffix : {".json", ".bth"})
+    {
+        const QString cachedFile = cachedRecord + suffix;
+
+        if(!QFileInfo::exists(cachedFile))
+            continue;
+
+        const QString outputFile = outputDirectory + QDir::separator() + recordName + suffix;
+
+        QFile::remove(outputFile);
+
+        if(!QFile::copy(cachedFile, outputFile))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,129 @@
+#ifndef PEERRECORDPIPELINE_H
+#define PEERRECORDPIPELINE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Downloads the PEER NGA West 2 records in batches, while the next batch downloads the previous one is unzipped and converted on a worker thread
+// The converted records are kept in a local cache keyed by their record sequence number (RSN), so a record is fetched and converted only once across scenarios
+
+#include <QFutureWatcher>
+#include <QJsonObject>
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <memory>
+
+class PeerNgaWest2Client;
+
+class PeerRecordPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    PeerRecordPipeline(PeerNgaWest2Client* client, QObject* parent = nullptr);
+    ~PeerRecordPipeline();
+
+    // The records are cached in the application data location unless another directory is given
+    static QString defaultCacheDirectory(void);
+    void setCacheDirectory(const QString& path);
+    QString getCacheDirectory(void) const;
+
+    // Makes RSN<number>.json of every record available in the output directory, the client has to be signed in
+    // The records that are already in the output directory or in the cache are not downloaded
+    // Returns -1 with the message in err if the pipeline could not start, otherwise finished is emitted once all of the records are in place
+    int start(const QStringList& recordNumbers, const QString& outputDirectory, QString& err);
+
+    bool isRunning(void) const;
+
+    // The search results of the downloaded batches, merged into one object as NGAW2Converter::parseNGAW2SearchResults gives them
+    QJsonObject getSearchResults(void) const;
+
+    int getNumDownloaded(void) const;
+    int getNumFromCache(void) const;
+
+signals:
+    void statusUpdated(QString status);
+
+    // Result is 0 on success and -1 on failure with the message
+    void finished(int result, QString errorMessage);
+
+private slots:
+    void handleRecordsDownloaded(QString zipFile);
+    void handleSelectionFailed(QString message);
+
+private:
+
+    struct BatchResult
+    {
+        QJsonObject searchResults;
+        QString errorMessage;
+    };
+
+    // Unzips and converts a batch, then moves its records into the cache and copies them to the output directory, runs on a worker thread
+    static BatchResult convertBatch(const QString& zipFile, const QString& batchDirectory, const QString& cacheDirectory, const QString& outputDirectory);
+
+    // Copies the record and its binary copy from the cache, returns false if the record is not in the cache
+    static bool copyFromCache(const QString& recordName, const QString& cacheDirectory, const QString& outputDirectory);
+
+    void requestNextBatch(void);
+    void handleBatchConverted(QFutureWatcher<BatchResult>* watcher);
+    void finishIfDone(void);
+
+    PeerNgaWest2Client* peerClient = nullptr;
+
+    QString cacheDirectory;
+    QString outputDirectory;
+
+    // Where the zip files of the batches are unzipped, removed when the pipeline is done
+    std::unique_ptr<QTemporaryDir> stagingDirectory;
+
+    QStringList pendingRecords;
+
+    bool running = false;
+    bool downloadInFlight = false;
+    int numBatches = 0;
+    int numDownloaded = 0;
+    int numFromCache = 0;
+
+    QList<QFutureWatcher<BatchResult>*> conversions;
+
+    QJsonObject searchResults;
+
+    QString errorMessage;
+};
+
+#endif // PEERRECORDPIPELINE_H
@@ -37,7 +37,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written: Stevan Gavrilovic
 
-#include "GridNode.h"
 #include "NodeHandle.h"
 #include "RectangleGrid.h"
 #include "SiteConfig.h"
@@ -57,8 +56,20 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QPainter>
 #include <QPixmap>
 #include <QRandomGenerator>
+#include <QStyleOptionGraphicsItem>
 #include <QWidget>
 
+#include <cmath>
+
+namespace
+{
+
+// Diameter of a grid point, and the closest that two painted grid points are allowed to get on the screen before points are left out
+const qreal gridPointDiameter = 5.0;
+const qreal minGridPointSpacing = 8.0;
+
+}
+
 RectangleGrid::RectangleGrid(QgsMapCanvas* parent) : QgsMapTool(parent), mapCanvas(parent)
 {
     gridSiteConfig = nullptr;
@@ -78,6 +89,7 @@ RectangleGrid::RectangleGrid(QgsMapCanvas* parent) : QgsMapTool(parent), mapCanv
     numDivisionsVertical = 5;
 
     color.setRgb(0,0,255,30);
+    gridPointColor.setRgb(0,0,255,100);
 
     auto width = 150;
     auto height = 150;
@@ -260,6 +272,53 @@ void RectangleGrid::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
     painter->setPen(Qt::NoPen);
     painter->setBrush(QBrush(color));
     painter->drawRect(rectangleGeometry);
+
+    if(gridPoints.isEmpty())
+        return;
+
+    const int numRows = static_cast<int>(numDivisionsHoriz) + 1;
+    const int numCols = static_cast<int>(numDivisionsVertical) + 1;
+
+    // Level of detail: when the grid is zoomed out so far that the points would overlap, only every n-th row and column is painted
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+
+    auto stride = [&](const QPointF& first, const QPointF& second, const int numPoints)
+    {
+        const QPointF diff = second - first;
+        const qreal spacing = std::sqrt(diff.x()*diff.x() + diff.y()*diff.y())*lod;
+
+        if(spacing <= 0.0)
+            return std::max(1, numPoints - 1);
+
+        return std::max(1, static_cast<int>(std::ceil(minGridPointSpacing/spacing)));
+    };
+
+    const int rowStride = numRows > 1 ? stride(gridPoints.at(0), gridPoints.at(numCols), numRows) : 1;
+    const int colStride = numCols > 1 ? stride(gridPoints.at(0), gridPoints.at(1), numCols) : 1;
+
+    // The last row and column are always painted so that the extent of the grid stays visible
+    QVector<int> rows;
+    for(int i = 0; i<numRows; i += rowStride)
+        rows.push_back(i);
+    if(rows.last() != numRows - 1)
+        rows.push_back(numRows - 1);
+
+    QVector<int> cols;
+    for(int j = 0; j<numCols; j += colStride)
+        cols.push_back(j);
+    if(cols.last() != numCols - 1)
+        cols.push_back(numCols - 1);
+
+    QVector<QPointF> paintedPoints;
+    paintedPoints.reserve(rows.size()*cols.size());
+
+    for(auto&& i : rows)
+        for(auto&& j : cols)
+            paintedPoints.push_back(gridPoints.at(i*numCols + j));
+
+    // A round pen as wide as a point draws all of the points in one call
+    painter->setPen(QPen(gridPointColor, gridPointDiameter, Qt::SolidLine, Qt::RoundCap));
+    painter->drawPoints(paintedPoints.constData(), paintedPoints.size());
 }
 
 
@@ -287,6 +346,8 @@ void RectangleGrid::updateGeometry(void)
         gridSiteConfig->siteGrid().longitude().set(lonMin, lonMax, numDivisionsVertical);
     }
 
+    this->updateGridPoints();
+
     // qDebug() << "RectangleRrid - emitting geometryChanged()";
     // qDebug() << mapCanvas->extent().toRectF();
     
@@ -294,9 +355,9 @@ void RectangleGrid::updateGeometry(void)
 }
 
 
-QVector<GridNode *> RectangleGrid::getGridNodeVec() const
+QVector<QPointF> RectangleGrid::getGridPoints() const
 {
-    return gridNodeVec;
+    return gridPoints;
 }
 
 
@@ -538,66 +599,52 @@ void RectangleGrid::handleCenterNodeChanged(const QPointF& pos)
 
 void RectangleGrid::clearGrid()
 {
-    qDeleteAll(gridNodeVec);
-    gridNodeVec.clear();
+    gridPoints.clear();
+    this->update();
 }
 
 
 void RectangleGrid::createGrid()
 {
-    auto ni = numDivisionsHoriz;
-    auto nj = numDivisionsVertical;
+    const int numPoints = static_cast<int>((numDivisionsHoriz + 1)*(numDivisionsVertical + 1));
 
-    gridNodeVec.reserve(ni*nj);
-
-    for (size_t i=0; i<=ni; ++i)
-    {
-        for (size_t j=0;j<=nj; ++j)
-        {
+    gridPoints.resize(numPoints);
 
-            // X COORDINATE
-            std::function<double(void)> xCoordinatelambda = [=]
-            {
-                auto divisor = static_cast<double>(ni*nj);
-
-                auto n1X = bottomLeftNode->pos().x();
-                auto n2X = bottomRightNode->pos().x();
-                auto n3X = topRightNode->pos().x();
-                auto n4X = topLeftNode->pos().x();
-
-                return static_cast<double>(i*j*n1X-i*j*n2X+i*j*n3X-i*j*n4X-i*n1X*nj+i*n2X*nj-j*n1X*ni+j*n4X*ni+n1X*ni*nj)/(divisor);
-            };
+    this->updateGridPoints();
+}
 
-            // Y COORDINATE
-            std::function<double(void)> yCoordinatelambda = [=]
-            {
-                auto divisor = static_cast<double>(ni*nj);
 
-                auto n1Y = bottomLeftNode->pos().y();
-                auto n2Y = bottomRightNode->pos().y();
-                auto n3Y = topRightNode->pos().y();
-                auto n4Y = topLeftNode->pos().y();
+void RectangleGrid::updateGridPoints(void)
+{
+    if(gridPoints.isEmpty())
+        return;
 
-                return static_cast<double>(i*j*n1Y-i*j*n2Y+i*j*n3Y-i*j*n4Y-i*n1Y*nj+i*n2Y*nj-j*n1Y*ni+j*n4Y*ni+n1Y*ni*nj)/(divisor);
-            };
+    const int ni = static_cast<int>(numDivisionsHoriz);
+    const int nj = static_cast<int>(numDivisionsVertical);
 
-            auto x = xCoordinatelambda();
-            auto y = yCoordinatelambda();
+    const QPointF n1 = bottomLeftNode->pos();
+    const QPointF n2 = bottomRightNode->pos();
+    const QPointF n3 = topRightNode->pos();
+    const QPointF n4 = topLeftNode->pos();
 
-            // Create the grid node
-            GridNode* newGridNode = new GridNode(this);
+    QPointF* points = gridPoints.data();
 
-            newGridNode->setX(x);
-            newGridNode->setY(y);
+    // Bilinear in the corners: the ends of each row are interpolated along the two sides of the grid, and then the points in between along the row
+    for(int i = 0; i<=ni; ++i)
+    {
+        const double u = ni == 0 ? 0.0 : static_cast<double>(i)/ni;
 
-            newGridNode->setXPos(xCoordinatelambda);
-            newGridNode->setYPos(yCoordinatelambda);
+        const QPointF rowStart = n1 + u*(n2 - n1);
+        const QPointF rowEnd = n4 + u*(n3 - n4);
+        const QPointF rowStep = nj == 0 ? QPointF() : (rowEnd - rowStart)/nj;
 
-            gridNodeVec.push_back(newGridNode);
+        QPointF* row = points + i*(nj + 1);
 
-            connect(this,&RectangleGrid::geometryChanged,newGridNode,&GridNode::updateGeometry);
-        }
+        for(int j = 0; j<=nj; ++j)
+            row[j] = rowStart + static_cast<double>(j)*rowStep;
     }
+
+    this->update();
 }
 
 
@@ -45,7 +45,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 class QgsMapCanvas;
 class NodeHandle;
-class GridNode;
 class SiteConfig;
 class VisualizationWidget;
 
@@ -59,7 +58,8 @@ class RectangleGrid : public QgsMapTool, public QGraphicsItem
     RectangleGrid(QgsMapCanvas* parent);
     ~RectangleGrid();
 
-    QVector<GridNode *> getGridNodeVec() const;
+    // The grid points in item coordinates, row by row from the bottom left corner, i.e., point (i,j) is at i*(numDivisionsVertical+1)+j
+    QVector<QPointF> getGridPoints() const;
     void setVisualizationWidget(VisualizationWidget *value);
     void clearGrid();
     void createGrid();
@@ -123,6 +123,9 @@ protected:
 
     void updateGeometry(void);
 
+    // Bilinear interpolation of all of the grid points from the four corners in one pass
+    void updateGridPoints(void);
+
 signals:
     void geometryChanged();
 
@@ -144,7 +147,9 @@ private:
     SiteConfig* gridSiteConfig;
     VisualizationWidget* theVisWidget;
 
-    QVector<GridNode*> gridNodeVec;
+    // The grid is stored as a flat array of points and painted by the rectangle itself, instead of as one graphics item per point
+    QVector<QPointF> gridPoints;
+    QColor gridPointColor;
 
     double latMin;
     double lonMin;
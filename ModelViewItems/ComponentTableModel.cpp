@@ -44,6 +44,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStringList>
 #include <QUuid>
 
+#include <utility>
+
 ComponentTableModel::ComponentTableModel(QObject *parent) : QAbstractTableModel(parent)
 {    
     numRows = 0;
@@ -60,7 +62,27 @@ ComponentTableModel::~ComponentTableModel()
 // Create a method to populate the model with data:
 void ComponentTableModel::populateData(const QVector<QStringList>& data, const QStringList& header)
 {
-    tableData = data;
+    tableStore.clear();
+
+    for(auto&& row : data)
+        tableStore.appendRow(row);
+
+    tableStore.finalize();
+
+    headerStringList = header;
+
+    numRows = rowCount();
+    numCols = columnCount();
+
+    emit layoutChanged();
+
+    return;
+}
+
+
+void ComponentTableModel::populateData(ComponentTableStore&& store, const QStringList& header)
+{
+    tableStore = std::move(store);
     headerStringList = header;
 
     numRows = rowCount();
@@ -77,7 +99,7 @@ void ComponentTableModel::clear(void)
     numRows = 0;
     numCols = 0;
 
-    tableData.clear();
+    tableStore.clear();
     headerStringList.clear();
 }
 
@@ -96,7 +118,7 @@ Qt::ItemFlags ComponentTableModel::flags(const QModelIndex &index) const
 int ComponentTableModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return tableData.size();
+    return tableStore.rowCount();
 }
 
 
@@ -104,10 +126,7 @@ int ComponentTableModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
 
-    if(tableData.isEmpty())
-        return 0;
-
-    return tableData.front().size();
+    return tableStore.columnCount();
 }
 
 
@@ -138,7 +157,7 @@ bool ComponentTableModel::setData(const QModelIndex &index, const QVariant &valu
 
     if(!strVal.isEmpty())
     {
-        tableData[row][col] = strVal;
+        tableStore.setText(row, col, strVal);
         emit handleCellChanged(row,col);
     }
 
@@ -163,16 +182,34 @@ QVariant ComponentTableModel::item(const int row, const int col) const
     if(col>= numCols || row>= numRows || row < 0 || col < 0)
         return QVariant();
 
-    return tableData[row][col];
+    return tableStore.text(row, col);
+}
+
+
+double ComponentTableModel::toDouble(const int row, const int col, bool* ok) const
+{
+    return tableStore.toDouble(row, col, ok);
 }
 
 
-QVector<QStringList>& ComponentTableModel::getTableData()
+QVector<QStringList> ComponentTableModel::getTableData() const
 {
+    QVector<QStringList> tableData;
+    tableData.reserve(numRows);
+
+    for(int i = 0; i<numRows; ++i)
+        tableData.push_back(tableStore.rowToStringList(i));
+
     return tableData;
 }
 
 
+const ComponentTableStore& ComponentTableModel::getTableStore() const
+{
+    return tableStore;
+}
+
+
 QStringList ComponentTableModel::getHeaderStringList() const
 {
     return headerStringList;
@@ -38,6 +38,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Dr. Stevan Gavrilovic, UC Berkeley
 
+#include "ComponentTableStore.h"
+
 #include <QAbstractTableModel>
 
 class ComponentTableModel : public QAbstractTableModel
@@ -57,6 +59,9 @@ public:
 
     void populateData(const QVector<QStringList>& data, const QStringList& header);
 
+    // Takes over a table that was already built, e.g., streamed straight from a file
+    void populateData(ComponentTableStore&& store, const QStringList& header);
+
     int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
 
     int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
@@ -65,7 +70,13 @@ public:
 
     QVariant item(const int row, const int col) const;
 
-    QVector<QStringList>& getTableData();
+    // Typed access that does not go through a string
+    double toDouble(const int row, const int col, bool* ok = nullptr) const;
+
+    // Makes a copy of the table as strings, use the table store to access the values directly
+    QVector<QStringList> getTableData() const;
+
+    const ComponentTableStore& getTableStore() const;
 
     QStringList getHeaderStringList() const;
 
@@ -75,7 +86,7 @@ signals:
 
 private:
 
-    QVector<QStringList> tableData;
+    ComponentTableStore tableStore;
     QStringList headerStringList;
 
     int numRows;
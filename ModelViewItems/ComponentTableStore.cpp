@@ -0,0 +1,541 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "ComponentTableStore.h"
+#include "CSVStreamReader.h"
+
+#include <QLocale>
+
+#include <limits>
+
+namespace {
+
+// The display text of a double, the shortest text that parses back to the same number
+QString doubleText(const double value)
+{
+    static const QLocale cLocale = QLocale::c();
+
+    return cLocale.toString(value, 'g', QLocale::FloatingPointShortest);
+}
+
+// True if the text is exactly what QString::number would give for the parsed integer, i.e., no sign, leading zeros, or "-0"
+bool isCanonicalInteger(const CSVField& field)
+{
+    const char* data = field.data();
+    const int size = field.size();
+
+    int i = (size > 0 && data[0] == '-') ? 1 : 0;
+
+    if(i >= size)
+        return false;
+
+    if(data[i] == '0')
+        return size == 1;
+
+    for(; i < size; ++i)
+    {
+        if(data[i] < '0' || data[i] > '9')
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+
+ComponentTableStore::ComponentTableStore()
+{
+    numRows = 0;
+}
+
+
+void ComponentTableStore::clear(void)
+{
+    columns.clear();
+    numRows = 0;
+}
+
+
+void ComponentTableStore::appendRow(const CSVRow& row)
+{
+    if(columns.isEmpty())
+    {
+        if(row.empty())
+            return;
+
+        columns.resize(row.size());
+    }
+
+    const auto numCols = columns.size();
+
+    for(int i = 0; i<numCols; ++i)
+        this->appendCell(columns[i], i < row.size() ? row[i] : CSVField());
+
+    ++numRows;
+}
+
+
+void ComponentTableStore::appendRow(const QStringList& row)
+{
+    if(columns.isEmpty())
+    {
+        if(row.empty())
+            return;
+
+        columns.resize(row.size());
+    }
+
+    const auto numCols = columns.size();
+
+    for(int i = 0; i<numCols; ++i)
+    {
+        const QByteArray bytes = i < row.size() ? row.at(i).toUtf8() : QByteArray();
+
+        this->appendCell(columns[i], CSVField(bytes.constData(), bytes.size()));
+    }
+
+    ++numRows;
+}
+
+
+void ComponentTableStore::finalize(void)
+{
+    for(auto&& column : columns)
+    {
+        // Fall back to a string column if most of the numbers in a column had to keep their text anyways
+        if(column.type != ColumnType::String && column.textOverrides.size() > numRows/4)
+            this->promoteToString(column);
+
+        // The lookup is rebuilt if a cell is edited later on
+        column.dictionaryLookup.clear();
+        column.dictionaryLookup.squeeze();
+
+        column.intValues.squeeze();
+        column.doubleValues.squeeze();
+        column.stringCodes.squeeze();
+        column.dictionary.squeeze();
+    }
+}
+
+
+int ComponentTableStore::rowCount(void) const
+{
+    return numRows;
+}
+
+
+int ComponentTableStore::columnCount(void) const
+{
+    return columns.size();
+}
+
+
+ComponentTableStore::ColumnType ComponentTableStore::columnType(const int col) const
+{
+    if(col < 0 || col >= columns.size())
+        return ColumnType::String;
+
+    return columns.at(col).type;
+}
+
+
+QString ComponentTableStore::text(const int row, const int col) const
+{
+    if(col < 0 || col >= columns.size() || row < 0 || row >= numRows)
+        return QString();
+
+    return this->columnText(columns.at(col), row);
+}
+
+
+double ComponentTableStore::toDouble(const int row, const int col, bool* ok) const
+{
+    if(col < 0 || col >= columns.size() || row < 0 || row >= numRows)
+    {
+        if(ok)
+            *ok = false;
+
+        return 0.0;
+    }
+
+    const auto& column = columns.at(col);
+
+    if(column.type == ColumnType::String)
+        return column.dictionary.at(column.stringCodes.at(row)).toDouble(ok);
+
+    if(!column.textOverrides.isEmpty())
+    {
+        auto it = column.textOverrides.constFind(row);
+
+        if(it != column.textOverrides.constEnd())
+            return it.value().toDouble(ok);
+    }
+
+    if(ok)
+        *ok = true;
+
+    if(column.type == ColumnType::Integer)
+        return static_cast<double>(column.intValues.at(row));
+
+    return column.doubleValues.at(row);
+}
+
+
+qint64 ComponentTableStore::toLongLong(const int row, const int col, bool* ok) const
+{
+    if(col < 0 || col >= columns.size() || row < 0 || row >= numRows)
+    {
+        if(ok)
+            *ok = false;
+
+        return 0;
+    }
+
+    const auto& column = columns.at(col);
+
+    if(column.type != ColumnType::Integer || column.textOverrides.contains(row))
+        return this->columnText(column, row).toLongLong(ok);
+
+    if(ok)
+        *ok = true;
+
+    return column.intValues.at(row);
+}
+
+
+void ComponentTableStore::setText(const int row, const int col, const QString& value)
+{
+    if(col < 0 || col >= columns.size() || row < 0 || row >= numRows)
+        return;
+
+    auto& column = columns[col];
+
+    bool ok = false;
+
+    if(column.type == ColumnType::Integer)
+    {
+        auto intVal = value.toLongLong(&ok);
+
+        column.intValues[row] = ok ? intVal : 0;
+
+        if(ok && QString::number(intVal) == value)
+            column.textOverrides.remove(row);
+        else
+            column.textOverrides.insert(row, value);
+    }
+    else if(column.type == ColumnType::Double)
+    {
+        auto doubleVal = value.toDouble(&ok);
+
+        column.doubleValues[row] = ok ? doubleVal : std::numeric_limits<double>::quiet_NaN();
+
+        if(ok && doubleText(doubleVal) == value)
+            column.textOverrides.remove(row);
+        else
+            column.textOverrides.insert(row, value);
+    }
+    else
+    {
+        column.stringCodes[row] = this->dictionaryCode(column, value);
+    }
+}
+
+
+QVector<double> ComponentTableStore::columnToDoubles(const int col, const double missingValue) const
+{
+    QVector<double> values;
+
+    if(col < 0 || col >= columns.size())
+        return values;
+
+    const auto& column = columns.at(col);
+
+    if(column.type == ColumnType::String)
+    {
+        // Parse each distinct string only once
+        QVector<double> dictionaryValues(column.dictionary.size());
+
+        for(int i = 0; i<column.dictionary.size(); ++i)
+        {
+            bool ok;
+            auto val = column.dictionary.at(i).toDouble(&ok);
+            dictionaryValues[i] = ok ? val : missingValue;
+        }
+
+        values.resize(numRows);
+
+        for(int i = 0; i<numRows; ++i)
+            values[i] = dictionaryValues.at(column.stringCodes.at(i));
+
+        return values;
+    }
+
+    if(column.type == ColumnType::Integer)
+    {
+        values.resize(numRows);
+
+        for(int i = 0; i<numRows; ++i)
+            values[i] = static_cast<double>(column.intValues.at(i));
+    }
+    else
+    {
+        values = column.doubleValues;
+    }
+
+    for(auto it = column.textOverrides.constBegin(); it != column.textOverrides.constEnd(); ++it)
+    {
+        bool ok;
+        auto val = it.value().toDouble(&ok);
+        values[it.key()] = ok ? val : missingValue;
+    }
+
+    return values;
+}
+
+
+QStringList ComponentTableStore::rowToStringList(const int row) const
+{
+    QStringList rowList;
+
+    if(row < 0 || row >= numRows)
+        return rowList;
+
+    rowList.reserve(columns.size());
+
+    for(auto&& column : columns)
+        rowList.append(this->columnText(column, row));
+
+    return rowList;
+}
+
+
+qint64 ComponentTableStore::memoryUsage(void) const
+{
+    qint64 numBytes = 0;
+
+    for(auto&& column : columns)
+    {
+        numBytes += column.intValues.capacity()*sizeof(qint64);
+        numBytes += column.doubleValues.capacity()*sizeof(double);
+        numBytes += column.stringCodes.capacity()*sizeof(qint32);
+
+        for(auto&& it : column.dictionary)
+            numBytes += sizeof(QString) + it.capacity()*sizeof(QChar);
+
+        for(auto&& it : column.textOverrides)
+            numBytes += sizeof(int) + sizeof(QString) + it.capacity()*sizeof(QChar);
+    }
+
+    return numBytes;
+}
+
+
+void ComponentTableStore::appendCell(Column& column, const CSVField& field)
+{
+    const int row = numRows;
+
+    bool ok = false;
+
+    if(column.type == ColumnType::Integer)
+    {
+        // Keep empty cells in a numeric column, they are common for missing values
+        if(field.isEmpty())
+        {
+            column.intValues.append(0);
+            column.textOverrides.insert(row, QString(""));
+            return;
+        }
+
+        auto intVal = field.toLongLong(&ok);
+
+        if(ok)
+        {
+            column.intValues.append(intVal);
+
+            if(!isCanonicalInteger(field))
+                column.textOverrides.insert(row, field.toString());
+
+            return;
+        }
+
+        field.toDouble(&ok);
+
+        if(ok)
+        {
+            this->promoteToDouble(column);
+        }
+        else
+        {
+            this->promoteToString(column);
+            this->appendString(column, field.toString());
+            return;
+        }
+    }
+
+    if(column.type == ColumnType::Double)
+    {
+        if(field.isEmpty())
+        {
+            column.doubleValues.append(std::numeric_limits<double>::quiet_NaN());
+            column.textOverrides.insert(row, QString(""));
+            return;
+        }
+
+        auto doubleVal = field.toDouble(&ok);
+
+        if(!ok)
+        {
+            this->promoteToString(column);
+            this->appendString(column, field.toString());
+            return;
+        }
+
+        column.doubleValues.append(doubleVal);
+
+        if(doubleText(doubleVal) != QLatin1String(field.data(), field.size()))
+            column.textOverrides.insert(row, field.toString());
+
+        return;
+    }
+
+    this->appendString(column, field.toString());
+}
+
+
+void ComponentTableStore::appendString(Column& column, const QString& value)
+{
+    column.stringCodes.append(this->dictionaryCode(column, value));
+}
+
+
+qint32 ComponentTableStore::dictionaryCode(Column& column, const QString& value)
+{
+    // The lookup is released in finalize, rebuild it on the first edit after that
+    if(column.dictionaryLookup.isEmpty() && !column.dictionary.isEmpty())
+    {
+        for(int i = 0; i<column.dictionary.size(); ++i)
+            column.dictionaryLookup.insert(column.dictionary.at(i), i);
+    }
+
+    auto it = column.dictionaryLookup.constFind(value);
+
+    if(it != column.dictionaryLookup.constEnd())
+        return it.value();
+
+    const qint32 code = column.dictionary.size();
+
+    column.dictionary.append(value);
+    column.dictionaryLookup.insert(value, code);
+
+    return code;
+}
+
+
+void ComponentTableStore::promoteToDouble(Column& column)
+{
+    const auto numValues = column.intValues.size();
+
+    column.doubleValues.reserve(column.intValues.capacity());
+
+    for(int i = 0; i<numValues; ++i)
+    {
+        const auto intVal = column.intValues.at(i);
+        const auto doubleVal = static_cast<double>(intVal);
+
+        column.doubleValues.append(doubleVal);
+
+        // Keep the integer text if the double would be displayed differently
+        if(!column.textOverrides.contains(i))
+        {
+            const auto intText = QString::number(intVal);
+
+            if(doubleText(doubleVal) != intText)
+                column.textOverrides.insert(i, intText);
+        }
+    }
+
+    column.intValues.clear();
+    column.intValues.squeeze();
+
+    column.type = ColumnType::Double;
+}
+
+
+void ComponentTableStore::promoteToString(Column& column)
+{
+    if(column.type == ColumnType::String)
+        return;
+
+    const auto numValues = column.type == ColumnType::Integer ? column.intValues.size() : column.doubleValues.size();
+
+    QVector<qint32> codes;
+    codes.reserve(column.type == ColumnType::Integer ? column.intValues.capacity() : column.doubleValues.capacity());
+
+    for(int i = 0; i<numValues; ++i)
+        codes.append(this->dictionaryCode(column, this->columnText(column, i)));
+
+    column.stringCodes = codes;
+
+    column.intValues.clear();
+    column.intValues.squeeze();
+    column.doubleValues.clear();
+    column.doubleValues.squeeze();
+    column.textOverrides.clear();
+    column.textOverrides.squeeze();
+
+    column.type = ColumnType::String;
+}
+
+
+QString ComponentTableStore::columnText(const Column& column, const int row) const
+{
+    if(column.type == ColumnType::String)
+        return column.dictionary.at(column.stringCodes.at(row));
+
+    if(!column.textOverrides.isEmpty())
+    {
+        auto it = column.textOverrides.constFind(row);
+
+        if(it != column.textOverrides.constEnd())
+            return it.value();
+    }
+
+    if(column.type == ColumnType::Integer)
+        return QString::number(column.intValues.at(row));
+
+    return doubleText(column.doubleValues.at(row));
+}
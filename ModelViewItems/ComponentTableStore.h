@@ -0,0 +1,123 @@
+#ifndef ComponentTableStore_H
+#define ComponentTableStore_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Column oriented, typed storage for the asset tables
+// Each column is inferred as an integer, double, or string column while the rows are appended. Numbers live in contiguous arrays and strings are dictionary encoded, which keeps repeated categorical values such as the occupancy class as a single string
+// A number whose text is not in the canonical form, e.g., "1.50" or an empty cell in a numeric column, keeps its original text so that the table always displays exactly what was in the file
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <limits>
+
+class CSVField;
+class CSVRow;
+
+class ComponentTableStore
+{
+public:
+
+    enum class ColumnType { Integer, Double, String };
+
+    ComponentTableStore();
+
+    void clear(void);
+
+    // The number of columns is set by the first row that is appended, extra cells in the following rows are ignored and missing cells are left empty
+    void appendRow(const CSVRow& row);
+    void appendRow(const QStringList& row);
+
+    // Call once all of the rows are appended, releases the memory that was only needed while building the columns
+    void finalize(void);
+
+    int rowCount(void) const;
+    int columnCount(void) const;
+
+    ColumnType columnType(const int col) const;
+
+    // The text of a cell as it would be displayed
+    QString text(const int row, const int col) const;
+
+    double toDouble(const int row, const int col, bool* ok = nullptr) const;
+    qint64 toLongLong(const int row, const int col, bool* ok = nullptr) const;
+
+    void setText(const int row, const int col, const QString& value);
+
+    // Returns the column as a contiguous array of doubles, cells that are not numbers are set to the missing value
+    QVector<double> columnToDoubles(const int col, const double missingValue = std::numeric_limits<double>::quiet_NaN()) const;
+
+    QStringList rowToStringList(const int row) const;
+
+    // The approximate number of bytes held by the table
+    qint64 memoryUsage(void) const;
+
+private:
+
+    struct Column
+    {
+        ColumnType type = ColumnType::Integer;
+
+        QVector<qint64> intValues;
+        QVector<double> doubleValues;
+
+        QVector<qint32> stringCodes;
+        QVector<QString> dictionary;
+        QHash<QString, qint32> dictionaryLookup;
+
+        // Cells whose text is not the canonical text of the stored number, keyed by row
+        QHash<int, QString> textOverrides;
+    };
+
+    void appendCell(Column& column, const CSVField& field);
+    void appendString(Column& column, const QString& value);
+
+    qint32 dictionaryCode(Column& column, const QString& value);
+
+    void promoteToDouble(Column& column);
+    void promoteToString(Column& column);
+
+    QString columnText(const Column& column, const int row) const;
+
+    QVector<Column> columns;
+
+    int numRows;
+};
+
+#endif // ComponentTableStore_H
@@ -0,0 +1,370 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+#include "ResultsTableModel.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+// Below this many rows the sort is not worth splitting across threads
+const int minParallelSortSize = 50000;
+
+}
+
+
+ResultsTableModel::ResultsTableModel(QObject *parent) : QAbstractTableModel(parent)
+{
+
+}
+
+
+ResultsTableModel::~ResultsTableModel()
+{
+
+}
+
+
+QVariant ResultsTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    if(index.row() >= rowOrder.size() || index.column() >= columns.size())
+        return QVariant();
+
+    const auto row = rowOrder.at(index.row());
+    const auto& column = columns.at(index.column());
+
+    if(column.text)
+        return column.text(row);
+
+    const auto value = this->columnValues(column)[row];
+
+    // A missing value shows as an empty cell
+    if(std::isnan(value))
+        return QVariant();
+
+    return value;
+}
+
+
+QVariant ResultsTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role == Qt::DisplayRole && orientation == Qt::Horizontal && section >= 0 && section < columns.size())
+        return columns.at(section).heading;
+
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+
+int ResultsTableModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+
+    return rowOrder.size();
+}
+
+
+int ResultsTableModel::columnCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+
+    return columns.size();
+}
+
+
+void ResultsTableModel::sort(int column, Qt::SortOrder order)
+{
+    if(column < 0 || column >= columns.size())
+        return;
+
+    sortColumn = column;
+    sortOrder = order;
+
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+
+    // Remember which data rows the persistent indexes, e.g., the selection, point to
+    const auto oldPersistent = this->persistentIndexList();
+
+    QVector<int> oldSourceRows;
+    oldSourceRows.reserve(oldPersistent.size());
+
+    for(auto&& it : oldPersistent)
+        oldSourceRows.append(rowOrder.at(it.row()));
+
+    this->sortRows(rowOrder, this->columnValues(columns.at(column)), order);
+
+    if(!oldPersistent.isEmpty())
+    {
+        QVector<int> newPosition(numRows, -1);
+
+        for(int i = 0; i < rowOrder.size(); ++i)
+            newPosition[rowOrder.at(i)] = i;
+
+        QModelIndexList newPersistent;
+        newPersistent.reserve(oldPersistent.size());
+
+        for(int i = 0; i < oldPersistent.size(); ++i)
+            newPersistent.append(this->index(newPosition.at(oldSourceRows.at(i)), oldPersistent.at(i).column()));
+
+        this->changePersistentIndexList(oldPersistent, newPersistent);
+    }
+
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+}
+
+
+void ResultsTableModel::setNumberOfRows(const int nRows)
+{
+    this->beginResetModel();
+
+    columns.clear();
+
+    numRows = nRows;
+
+    rowOrder.resize(numRows);
+    std::iota(rowOrder.begin(), rowOrder.end(), 0);
+
+    sortColumn = -1;
+
+    this->endResetModel();
+}
+
+
+void ResultsTableModel::addColumn(const QString& heading, QVector<double> values)
+{
+    // Rows without a value are missing
+    values.resize(numRows);
+
+    Column column;
+    column.heading = heading;
+    column.ownedValues = std::move(values);
+
+    this->appendColumn(std::move(column));
+}
+
+
+void ResultsTableModel::addColumn(const QString& heading, const double* values)
+{
+    Column column;
+    column.heading = heading;
+    column.externalValues = values;
+
+    this->appendColumn(std::move(column));
+}
+
+
+void ResultsTableModel::addTextColumn(const QString& heading, const QStringList& text)
+{
+    QVector<double> sortValues(numRows, std::numeric_limits<double>::quiet_NaN());
+
+    for(int i = 0; i < numRows && i < text.size(); ++i)
+    {
+        bool OK;
+        auto value = text.at(i).toDouble(&OK);
+
+        if(OK)
+            sortValues[i] = value;
+    }
+
+    auto textSize = text.size();
+
+    this->addTextColumn(heading, [text, textSize](int row)
+    {
+        return row < textSize ? text.at(row) : QString();
+    }, std::move(sortValues));
+}
+
+
+void ResultsTableModel::addTextColumn(const QString& heading, const std::function<QString(int row)>& text, QVector<double> sortValues)
+{
+    sortValues.resize(numRows);
+
+    Column column;
+    column.heading = heading;
+    column.ownedValues = std::move(sortValues);
+    column.text = text;
+
+    this->appendColumn(std::move(column));
+}
+
+
+void ResultsTableModel::setRowFilter(const std::function<bool(int row)>& accept)
+{
+    this->beginResetModel();
+
+    rowOrder.clear();
+
+    for(int i = 0; i < numRows; ++i)
+    {
+        if(accept(i))
+            rowOrder.append(i);
+    }
+
+    if(sortColumn != -1)
+        this->sortRows(rowOrder, this->columnValues(columns.at(sortColumn)), sortOrder);
+
+    this->endResetModel();
+}
+
+
+void ResultsTableModel::clearRowFilter(void)
+{
+    this->setRowFilter([](int){ return true; });
+}
+
+
+int ResultsTableModel::sourceRow(const int row) const
+{
+    if(row < 0 || row >= rowOrder.size())
+        return -1;
+
+    return rowOrder.at(row);
+}
+
+
+double ResultsTableModel::value(const int row, const int col) const
+{
+    if(row < 0 || row >= rowOrder.size() || col < 0 || col >= columns.size())
+        return std::numeric_limits<double>::quiet_NaN();
+
+    return this->columnValues(columns.at(col))[rowOrder.at(row)];
+}
+
+
+void ResultsTableModel::clear(void)
+{
+    this->beginResetModel();
+
+    columns.clear();
+    rowOrder.clear();
+
+    numRows = 0;
+    sortColumn = -1;
+
+    this->endResetModel();
+}
+
+
+void ResultsTableModel::appendColumn(Column&& column)
+{
+    const int col = columns.size();
+
+    this->beginInsertColumns(QModelIndex(), col, col);
+
+    columns.append(std::move(column));
+
+    this->endInsertColumns();
+}
+
+
+const double* ResultsTableModel::columnValues(const Column& column) const
+{
+    if(column.externalValues != nullptr)
+        return column.externalValues;
+
+    return column.ownedValues.constData();
+}
+
+
+void ResultsTableModel::sortRows(QVector<int>& rows, const double* values, const Qt::SortOrder order) const
+{
+    // Ties are broken by the row so that the order is the same no matter how the rows were split up
+    auto lessThan = [values, order](const int a, const int b)
+    {
+        const auto valueA = values[a];
+        const auto valueB = values[b];
+
+        const bool missingA = std::isnan(valueA);
+        const bool missingB = std::isnan(valueB);
+
+        if(missingA || missingB)
+        {
+            if(missingA != missingB)
+                return missingB;
+
+            return a < b;
+        }
+
+        if(valueA != valueB)
+            return order == Qt::AscendingOrder ? valueA < valueB : valueA > valueB;
+
+        return a < b;
+    };
+
+    const int n = rows.size();
+
+    const int numChunks = n < minParallelSortSize ? 1 : std::max(1, QThread::idealThreadCount());
+
+    QVector<int> bounds(numChunks + 1);
+    for(int i = 0; i <= numChunks; ++i)
+        bounds[i] = static_cast<int>(static_cast<qint64>(n)*i/numChunks);
+
+    QVector<int> chunks(numChunks);
+    std::iota(chunks.begin(), chunks.end(), 0);
+
+    int* rowData = rows.data();
+
+    // Sort the chunks on their own, then merge neighbouring runs until only one is left
+    QtConcurrent::blockingMap(chunks, [&](const int chunk)
+    {
+        std::sort(rowData + bounds.at(chunk), rowData + bounds.at(chunk + 1), lessThan);
+    });
+
+    for(int width = 1; width < numChunks; width *= 2)
+    {
+        QVector<int> merges;
+        for(int chunk = 0; chunk + width < numChunks; chunk += 2*width)
+            merges.append(chunk);
+
+        QtConcurrent::blockingMap(merges, [&](const int chunk)
+        {
+            const auto last = std::min(chunk + 2*width, numChunks);
+            std::inplace_merge(rowData + bounds.at(chunk), rowData + bounds.at(chunk + width), rowData + bounds.at(last), lessThan);
+        });
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef ResultsTableModel_H
+#define ResultsTableModel_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Read-only table model for the results tables
+// The values live in contiguous numeric columns and are only formatted when a cell is painted, so a table with millions of rows costs one double per cell instead of one item per cell
+// Sorting and filtering only rearrange a vector of row indices, the columns themselves are never copied or moved
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+class ResultsTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ResultsTableModel(QObject *parent = nullptr);
+    ~ResultsTableModel();
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+
+    // Sorts the visible rows by the values of a column, missing values (NaN) always go last
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) Q_DECL_OVERRIDE;
+
+    // Clears the table and sets the number of rows of the columns that are added next
+    void setNumberOfRows(const int numRows);
+
+    // Adds a numeric column, the model keeps the values
+    void addColumn(const QString& heading, QVector<double> values);
+
+    // Adds a numeric column that points into memory owned by someone else, e.g., a memory-mapped results cache; the memory has to outlive the table or the next call to clear
+    void addColumn(const QString& heading, const double* values);
+
+    // Adds a column of text, e.g., the asset ids; the column is sorted by the number in the text, like TableNumberItem does
+    void addTextColumn(const QString& heading, const QStringList& text);
+
+    // Same as above for text that is made on demand from the row number
+    void addTextColumn(const QString& heading, const std::function<QString(int row)>& text, QVector<double> sortValues);
+
+    // Shows only the rows that are accepted by the filter, in their current sort order
+    void setRowFilter(const std::function<bool(int row)>& accept);
+    void clearRowFilter(void);
+
+    // The row of the data that is shown at a row of the table
+    int sourceRow(const int row) const;
+
+    double value(const int row, const int col) const;
+
+    void clear(void);
+
+private:
+
+    struct Column
+    {
+        QString heading;
+
+        // Either owned or external values, used for the display of numeric columns and for the sorting of all columns
+        QVector<double> ownedValues;
+        const double* externalValues = nullptr;
+
+        // Set for the text columns
+        std::function<QString(int row)> text;
+    };
+
+    void appendColumn(Column&& column);
+
+    const double* columnValues(const Column& column) const;
+
+    // Parallel sort of the row indices by the values of a column
+    void sortRows(QVector<int>& rows, const double* values, const Qt::SortOrder order) const;
+
+    int numRows = 0;
+
+    QVector<Column> columns;
+
+    // The rows of the data in the order they are shown
+    QVector<int> rowOrder;
+
+    int sortColumn = -1;
+    Qt::SortOrder sortOrder = Qt::AscendingOrder;
+};
+
+#endif // ResultsTableModel_H
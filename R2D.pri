@@ -94,6 +94,7 @@ SOURCES +=  $$PWD/Events/UI/BedrockDepth.cpp \
             $$PWD/Events/UI/OpenQuakeUserSpecifiedWidget.cpp \
             $$PWD/Events/UI/PeerLoginDialog.cpp \
             $$PWD/Events/UI/PeerNGAWest2Client.cpp \
+            $$PWD/Events/UI/PeerRecordPipeline.cpp \
             $$PWD/Events/UI/PointSourceRupture.cpp \
             $$PWD/Events/UI/PointSourceRuptureWidget.cpp \
             $$PWD/Events/UI/QGISSiteInputWidget.cpp \
@@ -122,6 +123,8 @@ SOURCES +=  $$PWD/Events/UI/BedrockDepth.cpp \
             $$PWD/Events/UI/zDepthWidget.cpp \
             $$PWD/Events/UI/zDepthUserInputWidget.cpp \
             $$PWD/ModelViewItems/ComponentTableModel.cpp \
+            $$PWD/ModelViewItems/ComponentTableStore.cpp \
+            $$PWD/ModelViewItems/ResultsTableModel.cpp \
             $$PWD/ModelViewItems/ComponentTableView.cpp \
             $$PWD/ModelViewItems/ListTreeModel.cpp \
             $$PWD/ModelViewItems/CustomListWidget.cpp \
@@ -129,10 +132,19 @@ SOURCES +=  $$PWD/Events/UI/BedrockDepth.cpp \
             $$PWD/Tools/AssetFilterDelegate.cpp \
             $$PWD/Tools/ComponentDatabase.cpp \
             $$PWD/Tools/CSVReaderWriter.cpp \
+            $$PWD/Tools/CSVStreamReader.cpp \
+            $$PWD/Tools/GeoJSONFeatureSplitter.cpp \
             $$PWD/Tools/GeoJSONReaderWriter.cpp \
             $$PWD/Tools/ComponentDatabaseManager.cpp \
             $$PWD/Tools/NGAW2Converter.cpp \
+            $$PWD/Tools/NearestNeighbourEventMapper.cpp \
             $$PWD/Tools/Pelicun3PostProcessor.cpp \
+            $$PWD/Tools/ResultsColumnCache.cpp \
+            $$PWD/Tools/ComponentIDSet.cpp \
+            $$PWD/Tools/HydraulicScreening.cpp \
+            $$PWD/Tools/HurricaneTrackIndex.cpp \
+            $$PWD/Tools/StationMatrix.cpp \
+            $$PWD/Tools/ConcurrentTasks.cpp \
             $$PWD/Tools/PelicunPostProcessor.cpp \
             $$PWD/Tools/CBCitiesPostProcessor.cpp \
             $$PWD/Tools/REmpiricalProbabilityDistribution.cpp \
@@ -281,6 +293,7 @@ HEADERS +=  $$PWD/Events/UI/BedrockDepth.h \
             $$PWD/Events/UI/OpenQuakeUserSpecifiedWidget.h \
             $$PWD/Events/UI/PeerLoginDialog.h \
             $$PWD/Events/UI/PeerNGAWest2Client.h \
+            $$PWD/Events/UI/PeerRecordPipeline.h \
             $$PWD/Events/UI/PointSourceRupture.h \
             $$PWD/Events/UI/PointSourceRuptureWidget.h \
             $$PWD/Events/UI/QGISSiteInputWidget.h \
@@ -312,10 +325,19 @@ HEADERS +=  $$PWD/Events/UI/BedrockDepth.h \
             $$PWD/Tools/AssetFilterDelegate.h \
             $$PWD/Tools/ComponentDatabase.h \
             $$PWD/Tools/CSVReaderWriter.h \
+            $$PWD/Tools/CSVStreamReader.h \
+            $$PWD/Tools/GeoJSONFeatureSplitter.h \
             $$PWD/Tools/GeoJSONReaderWriter.h \
             $$PWD/Tools/ComponentDatabaseManager.h \
             $$PWD/Tools/NGAW2Converter.h \
+            $$PWD/Tools/NearestNeighbourEventMapper.h \
             $$PWD/Tools/Pelicun3PostProcessor.h \
+            $$PWD/Tools/ResultsColumnCache.h \
+            $$PWD/Tools/ComponentIDSet.h \
+            $$PWD/Tools/HydraulicScreening.h \
+            $$PWD/Tools/HurricaneTrackIndex.h \
+            $$PWD/Tools/StationMatrix.h \
+            $$PWD/Tools/ConcurrentTasks.h \
             $$PWD/Tools/PelicunPostProcessor.h \
             $$PWD/Tools/CBCitiesPostProcessor.h \
             $$PWD/Tools/REmpiricalProbabilityDistribution.h \
@@ -390,6 +412,8 @@ HEADERS +=  $$PWD/Events/UI/BedrockDepth.h \
             $$PWD/UIWidgets/HurricaneObject.h \
             $$PWD/ModelViewItems/CustomListWidget.h \
             $$PWD/ModelViewItems/ComponentTableModel.h \
+            $$PWD/ModelViewItems/ComponentTableStore.h \
+            $$PWD/ModelViewItems/ResultsTableModel.h \
             $$PWD/ModelViewItems/ComponentTableView.h \
             $$PWD/ModelViewItems/ListTreeModel.h \
             $$PWD/GraphicElements/GridNode.h \
@@ -468,6 +492,8 @@ HEADERS +=  $$PWD/Events/UI/BedrockDepth.h \
 # Add QGIS sources and headers
 
 SOURCES +=  $$PWD/Tools/QGISHurricanePreprocessor.cpp \
+            $$PWD/Tools/PolygonSpatialIndex.cpp \
+            $$PWD/Tools/RasterBlockSampler.cpp \
             $$PWD/UIWidgets/LineAssetInputWidget.cpp \
             $$PWD/UIWidgets/PointAssetInputWidget.cpp \
             $$PWD/UIWidgets/CSVWaterNetworkInputWidget.cpp \
@@ -483,6 +509,8 @@ SOURCES +=  $$PWD/Tools/QGISHurricanePreprocessor.cpp \
 #            $$PWD/ModelViewItems/LayerTreeView.cpp \
 
 HEADERS +=  $$PWD/Tools/QGISHurricanePreprocessor.h \
+            $$PWD/Tools/PolygonSpatialIndex.h \
+            $$PWD/Tools/RasterBlockSampler.h \
             $$PWD/UIWidgets/LineAssetInputWidget.h \
             $$PWD/UIWidgets/PointAssetInputWidget.h \
             $$PWD/UIWidgets/CSVWaterNetworkInputWidget.h \
@@ -0,0 +1,241 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Microbenchmark of the two linear solvers of the EPANET 2.2 hydraulics that is compiled into R2D
+// The networks are synthetic square grids of junctions fed by a reservoir at one corner, the grid is the worst case for the fill-in of the factorization
+// Build it on its own with qmake Tests/EpanetSolverBenchmark.pri and run it with -iterations or -median to get stable timings
+
+#include "epanet2_2.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtTest/QtTest>
+
+#include <cmath>
+
+class EpanetSolverBenchmark: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testSolversAgree_data();
+    void testSolversAgree();
+
+    void benchmarkSolve_data();
+    void benchmarkSolve();
+
+private:
+
+    // Writes a grid network with side x side junctions, returns the path of the .inp file
+    QString writeGridNetwork(const int side);
+
+    // Opens the network and its hydraulics with a linear solver, returns the EPANET error code
+    int openNetwork(const QString& pathToInp, const int solver, EN_Project& ph);
+
+    // Solves the steady state of the network with a linear solver, the heads of all nodes are returned in heads
+    void solveNetwork(const QString& pathToInp, const int solver, QVector<double>& heads);
+
+    QTemporaryDir networkDir;
+
+    QMap<int, QString> networkFiles;
+};
+
+
+void EpanetSolverBenchmark::initTestCase()
+{
+    QVERIFY(networkDir.isValid());
+
+    for(auto side : {50, 100, 150})
+        networkFiles.insert(side, this->writeGridNetwork(side));
+}
+
+
+QString EpanetSolverBenchmark::writeGridNetwork(const int side)
+{
+    const auto path = networkDir.filePath("Grid" + QString::number(side) + ".inp");
+
+    QFile file(path);
+    if(!file.open(QFile::WriteOnly | QFile::Text))
+        return QString();
+
+    QTextStream out(&file);
+
+    // The elevations, demands, lengths and diameters vary over the grid so that the flows are not symmetric
+    out << "[JUNCTIONS]\n";
+    for(int r = 0; r<side; ++r)
+        for(int c = 0; c<side; ++c)
+            out << "J" << r << "_" << c << " " << 10 + (r*7 + c*3) % 11 << " " << 1 + (r + c) % 5 << "\n";
+
+    out << "[RESERVOIRS]\nR1 150\n";
+
+    out << "[PIPES]\n";
+    int pipe = 0;
+    for(int r = 0; r<side; ++r)
+    {
+        for(int c = 0; c<side; ++c)
+        {
+            if(c + 1 < side)
+                out << "P" << pipe++ << " J" << r << "_" << c << " J" << r << "_" << c + 1 << " " << 100 + (r % 7)*10 << " " << 8 + (c % 3)*2 << " 100 0\n";
+            if(r + 1 < side)
+                out << "P" << pipe++ << " J" << r << "_" << c << " J" << r + 1 << "_" << c << " " << 100 + (c % 5)*10 << " " << 8 + (r % 3)*2 << " 100 0\n";
+        }
+    }
+    out << "P" << pipe++ << " R1 J0_0 100 36 100 0\n";
+
+    out << "[OPTIONS]\nUnits GPM\nHeadloss H-W\n[TIMES]\nDuration 0\n[END]\n";
+
+    return path;
+}
+
+
+int EpanetSolverBenchmark::openNetwork(const QString& pathToInp, const int solver, EN_Project& ph)
+{
+    EN_createproject(&ph);
+
+    const auto pathToReport = networkDir.filePath("report.rpt");
+
+    int errcode = EN_open(ph, QFile::encodeName(pathToInp).constData(), QFile::encodeName(pathToReport).constData(), "");
+
+    if(errcode < 100)
+        errcode = EN_setoption(ph, EN_LINEARSOLVER, solver);
+
+    // The reordering and the symbolic factorization are done here, once per network
+    if(errcode < 100)
+        errcode = EN_openH(ph);
+
+    if(errcode >= 100)
+        EN_deleteproject(ph);
+
+    return errcode;
+}
+
+
+void EpanetSolverBenchmark::solveNetwork(const QString& pathToInp, const int solver, QVector<double>& heads)
+{
+    EN_Project ph;
+    QVERIFY(this->openNetwork(pathToInp, solver, ph) < 100);
+
+    long currentTime = 0;
+
+    EN_initH(ph, EN_INITFLOW);
+    const auto errcode = EN_runH(ph, &currentTime);
+
+    int numNodes = 0;
+    EN_getcount(ph, EN_NODECOUNT, &numNodes);
+
+    heads.resize(numNodes);
+    for(int i = 0; i<numNodes; ++i)
+        EN_getnodevalue(ph, i + 1, EN_HEAD, &heads[i]);
+
+    EN_closeH(ph);
+    EN_deleteproject(ph);
+
+    QVERIFY(errcode < 100);
+}
+
+
+void EpanetSolverBenchmark::testSolversAgree_data()
+{
+    QTest::addColumn<int>("side");
+
+    QTest::newRow("50x50") << 50;
+    QTest::newRow("100x100") << 100;
+}
+
+
+void EpanetSolverBenchmark::testSolversAgree()
+{
+    QFETCH(int, side);
+
+    QVector<double> choleskyHeads;
+    QVector<double> supernodalHeads;
+
+    this->solveNetwork(networkFiles.value(side), EN_CHOLESKY, choleskyHeads);
+    this->solveNetwork(networkFiles.value(side), EN_SUPERNODAL, supernodalHeads);
+
+    QCOMPARE(choleskyHeads.size(), supernodalHeads.size());
+
+    // The sums are done in a different order, so the heads agree to round-off rather than bit for bit
+    for(int i = 0; i<choleskyHeads.size(); ++i)
+        QVERIFY2(std::fabs(choleskyHeads.at(i) - supernodalHeads.at(i)) < 1.0e-4, qPrintable("Heads differ at node " + QString::number(i + 1)));
+}
+
+
+void EpanetSolverBenchmark::benchmarkSolve_data()
+{
+    QTest::addColumn<int>("side");
+    QTest::addColumn<int>("solver");
+
+    for(auto side : networkFiles.keys())
+    {
+        QTest::newRow(qPrintable(QString("Cholesky %1x%1").arg(side))) << side << static_cast<int>(EN_CHOLESKY);
+        QTest::newRow(qPrintable(QString("Supernodal %1x%1").arg(side))) << side << static_cast<int>(EN_SUPERNODAL);
+    }
+}
+
+
+void EpanetSolverBenchmark::benchmarkSolve()
+{
+    QFETCH(int, side);
+    QFETCH(int, solver);
+
+    EN_Project ph;
+    QVERIFY(this->openNetwork(networkFiles.value(side), solver, ph) < 100);
+
+    long currentTime = 0;
+    int errcode = 0;
+
+    // Only the numerical solve is timed, i.e., the trials with a factorization of the network matrix in each
+    // The flows are initialized again in every iteration so that each one runs the same trials
+    QBENCHMARK
+    {
+        EN_initH(ph, EN_INITFLOW);
+        errcode = EN_runH(ph, &currentTime);
+    }
+
+    EN_closeH(ph);
+    EN_deleteproject(ph);
+
+    QVERIFY(errcode < 100);
+}
+
+
+QTEST_APPLESS_MAIN(EpanetSolverBenchmark)
+#include "EpanetSolverBenchmark.moc"
@@ -0,0 +1,37 @@
+QT       -= gui
+QT       += testlib
+TARGET    = EpanetSolverBenchmark
+CONFIG   += console
+CONFIG   -= app_bundle
+
+# C++17 support
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD/../assetWidgets/EPANET2.2/include \
+               $$PWD/../assetWidgets/EPANET2.2/src \
+
+SOURCES += \
+        $$PWD/../assetWidgets/EPANET2.2/geoJSON.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/inpfile.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/qualreact.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/genmmd.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/hydcoeffs.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/input1.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/output.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/qualroute.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/epanet.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/epanet2.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/hydraul.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/input2.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/outputJSON.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/report.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/hydsolver.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/input3.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/project.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/rules.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/hash.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/hydstatus.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/mempool.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/quality.c \
+        $$PWD/../assetWidgets/EPANET2.2/src/smatrix.c \
+        $$PWD/EpanetSolverBenchmark.cpp \
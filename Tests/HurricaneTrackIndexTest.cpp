@@ -0,0 +1,295 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Checks the hurricane track index against a small IBTrACS database: the storm records, the season and region filters, and opening a storm by its SID
+// Build it on its own with qmake Tests/HurricaneTrackIndexTest.pri
+
+#include "HurricaneTrackIndex.h"
+#include "HurricaneObject.h"
+
+#include <QFile>
+#include <QRectF>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+class HurricaneTrackIndexTest: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testStorms();
+    void testFindStormsBySeason_data();
+    void testFindStormsBySeason();
+    void testFindStormsByRegion_data();
+    void testFindStormsByRegion();
+    void testReadStorm();
+    void testReopen();
+
+private:
+
+    static bool writeDatabase(const QString& path, const QString& rows);
+
+    QTemporaryDir databaseDir;
+    QString databasePath;
+
+    HurricaneTrackIndex trackIndex;
+};
+
+
+namespace {
+
+// The columns of IBTrACS that the index uses, in the order of the database, and the units row that follows the names
+const char databaseHeader[] =
+        "SID,SEASON,NUMBER,BASIN,SUBBASIN,NAME,ISO_TIME,NATURE,LAT,LON,WMO_WIND,WMO_PRES,DIST2LAND,USA_WIND,USA_PRES\n"
+        " ,Year, , , , , , ,degrees_north,degrees_east,kts,mb,km,kts,mb\n";
+
+// Four storms in three basins and three seasons, XAVIER and ZEB have no USA values and never make landfall
+const char databaseRows[] =
+        "2004223N11301,2004,45,NA,CS,CHARLEY,2004-08-09 12:00:00,TS,18.0,-80.0,60,990,100,65,985\n"
+        "2004223N11301,2004,45,NA,GM,CHARLEY,2004-08-13 18:00:00,TS,26.0,-82.0,120,945,0,125,941\n"
+        "2004223N11301,2004,45,NA,GM,CHARLEY,2004-08-14 00:00:00,TS,28.0,-81.0,70,980,50,75,978\n"
+        "2004250N15250,2004,50,EP,MM,XAVIER,2004-09-06 00:00:00,TS,15.0,-120.0,40,1000,800,,\n"
+        "2004250N15250,2004,50,EP,MM,XAVIER,2004-09-06 06:00:00,TS,16.0,-121.0,45,998,850,,\n"
+        "2017242N16333,2017,70,NA,MM,IRMA,2017-08-30 00:00:00,TS,16.0,-30.0,50,1000,2000,55,997\n"
+        "2017242N16333,2017,70,NA,MM,IRMA,2017-09-08 00:00:00,TS,25.0,-75.0,140,920,30,150,914\n"
+        "2017242N16333,2017,70,NA,GM,IRMA,2017-09-10 12:00:00,TS,26.0,-81.0,100,950,0,110,945\n"
+        "1998280N10150,1998,60,WP,MM,ZEB,1998-10-07 00:00:00,TS,10.0,150.0,50,990,500,,\n"
+        "1998280N10150,1998,60,WP,MM,ZEB,1998-10-08 00:00:00,TS,12.0,145.0,60,985,400,,\n";
+
+}
+
+
+bool HurricaneTrackIndexTest::writeDatabase(const QString& path, const QString& rows)
+{
+    QFile file(path);
+
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(databaseHeader);
+    file.write(rows.toUtf8());
+
+    return true;
+}
+
+
+void HurricaneTrackIndexTest::initTestCase()
+{
+    // Keep the index out of the application data folder of the user
+    QStandardPaths::setTestModeEnabled(true);
+
+    QVERIFY(databaseDir.isValid());
+
+    databasePath = databaseDir.filePath("IBTrACS.test.csv");
+    QVERIFY(writeDatabase(databasePath, databaseRows));
+
+    // Start from no index so that the first open builds it
+    QFile::remove(HurricaneTrackIndex::indexFilePath(databasePath));
+
+    QString err;
+    QVERIFY2(trackIndex.open(databasePath, err) == 0, qPrintable(err));
+    QVERIFY(QFile::exists(HurricaneTrackIndex::indexFilePath(databasePath)));
+}
+
+
+void HurricaneTrackIndexTest::cleanupTestCase()
+{
+    trackIndex.close();
+
+    QFile::remove(HurricaneTrackIndex::indexFilePath(databasePath));
+}
+
+
+void HurricaneTrackIndexTest::testStorms()
+{
+    QCOMPARE(trackIndex.numStorms(), 4);
+    QCOMPARE(trackIndex.numPoints(), qint64(10));
+
+    QCOMPARE(trackIndex.getSID(0), QString("2004223N11301"));
+    QCOMPARE(trackIndex.getName(2), QString("IRMA"));
+    QCOMPARE(trackIndex.getBasin(1), QString("EP"));
+    QCOMPARE(trackIndex.getSeason(3), 1998);
+
+    QCOMPARE(trackIndex.getFirstPoint(2), qint64(5));
+    QCOMPARE(trackIndex.getNumPoints(2), 3);
+
+    QCOMPARE(trackIndex.getIndexLandfall(0), 1);
+    QCOMPARE(trackIndex.getIndexLandfall(1), -1);
+    QCOMPARE(trackIndex.getIndexLandfall(2), 2);
+    QCOMPARE(trackIndex.getIndexLandfall(3), -1);
+
+    QCOMPARE(trackIndex.getBoundingBox(0), QRectF(QPointF(-82.0, 18.0), QPointF(-80.0, 28.0)));
+    QCOMPARE(trackIndex.getBoundingBox(3), QRectF(QPointF(145.0, 10.0), QPointF(150.0, 12.0)));
+
+    QCOMPARE(trackIndex.getLatitudes()[6], 25.0);
+    QCOMPARE(trackIndex.getLongitudes()[6], -75.0);
+
+    // The USA values are used if there are any, otherwise the WMO values
+    QCOMPARE(trackIndex.getWinds()[1], 125.0f);
+    QCOMPARE(trackIndex.getPressures()[1], 941.0f);
+    QCOMPARE(trackIndex.getWinds()[3], 40.0f);
+    QCOMPARE(trackIndex.getPressures()[4], 998.0f);
+
+    QCOMPARE(trackIndex.findStorm("2017242N16333"), 2);
+    QCOMPARE(trackIndex.findStorm("1998280N10150"), 3);
+    QCOMPARE(trackIndex.findStorm("2005236N23285"), -1);
+}
+
+
+void HurricaneTrackIndexTest::testFindStormsBySeason_data()
+{
+    QTest::addColumn<int>("firstSeason");
+    QTest::addColumn<int>("lastSeason");
+    QTest::addColumn<QString>("basin");
+    QTest::addColumn<QVector<int>>("expected");
+
+    QTest::newRow("one season") << 2004 << 2004 << QString() << QVector<int>{0, 1};
+    QTest::newRow("one season in a basin") << 2004 << 2004 << QString("NA") << QVector<int>{0};
+    QTest::newRow("range in a basin") << 2000 << 2020 << QString("NA") << QVector<int>{0, 2};
+    QTest::newRow("range") << 1990 << 1999 << QString() << QVector<int>{3};
+    QTest::newRow("all") << 0 << 3000 << QString() << QVector<int>{0, 1, 2, 3};
+    QTest::newRow("basin without storms") << 0 << 3000 << QString("SI") << QVector<int>();
+    QTest::newRow("season without storms") << 2005 << 2016 << QString() << QVector<int>();
+}
+
+
+void HurricaneTrackIndexTest::testFindStormsBySeason()
+{
+    QFETCH(int, firstSeason);
+    QFETCH(int, lastSeason);
+    QFETCH(QString, basin);
+    QFETCH(QVector<int>, expected);
+
+    QCOMPARE(trackIndex.findStorms(firstSeason, lastSeason, basin), expected);
+}
+
+
+void HurricaneTrackIndexTest::testFindStormsByRegion_data()
+{
+    QTest::addColumn<QRectF>("region");
+    QTest::addColumn<QVector<int>>("expected");
+
+    QTest::newRow("Florida") << QRectF(QPointF(-85.0, 20.0), QPointF(-78.0, 30.0)) << QVector<int>{0, 2};
+    QTest::newRow("Florida with flipped corners") << QRectF(QPointF(-78.0, 30.0), QPointF(-85.0, 20.0)) << QVector<int>{0, 2};
+    QTest::newRow("Western Pacific") << QRectF(QPointF(140.0, 5.0), QPointF(155.0, 15.0)) << QVector<int>{3};
+    QTest::newRow("touching the edge of a track") << QRectF(QPointF(-130.0, 0.0), QPointF(-121.0, 15.0)) << QVector<int>{1};
+    QTest::newRow("open ocean") << QRectF(QPointF(0.0, -50.0), QPointF(10.0, -40.0)) << QVector<int>();
+}
+
+
+void HurricaneTrackIndexTest::testFindStormsByRegion()
+{
+    QFETCH(QRectF, region);
+    QFETCH(QVector<int>, expected);
+
+    QCOMPARE(trackIndex.findStorms(region), expected);
+}
+
+
+void HurricaneTrackIndexTest::testReadStorm()
+{
+    // The same lookup as opening a hurricane that is selected on the map
+    auto storm = trackIndex.findStorm("2004223N11301");
+    QCOMPARE(storm, 0);
+
+    HurricaneObject hurricane;
+    QString err;
+    QVERIFY2(trackIndex.readStorm(storm, hurricane, err) == 0, qPrintable(err));
+
+    QCOMPARE(hurricane.SID, QString("2004223N11301"));
+    QCOMPARE(hurricane.name, QString("CHARLEY"));
+    QCOMPARE(hurricane.season, QString("2004"));
+    QCOMPARE(hurricane.size(), 3);
+    QCOMPARE(hurricane.parameterLabels, trackIndex.getParameterLabels());
+
+    const auto indexLat = hurricane.parameterLabels.indexOf("LAT");
+    const auto indexLon = hurricane.parameterLabels.indexOf("LON");
+    QVERIFY(indexLat != -1 && indexLon != -1);
+
+    QCOMPARE(hurricane.indexLandfall, 1);
+    QCOMPARE(hurricane.landfallData.at(indexLat), QString("26.0"));
+    QCOMPARE(hurricane.landfallData.at(indexLon), QString("-82.0"));
+
+    // The last storm ends at the end of the database
+    HurricaneObject lastHurricane;
+    QVERIFY2(trackIndex.readStorm(3, lastHurricane, err) == 0, qPrintable(err));
+    QCOMPARE(lastHurricane.size(), 2);
+    QCOMPARE(lastHurricane[1].at(indexLat), QString("12.0"));
+    QVERIFY(lastHurricane.landfallData.isEmpty());
+
+    err.clear();
+    QCOMPARE(trackIndex.readStorm(trackIndex.numStorms(), hurricane, err), -1);
+    QVERIFY(!err.isEmpty());
+}
+
+
+void HurricaneTrackIndexTest::testReopen()
+{
+    // A database that changes after its index was built gets a new index
+    const auto changedPath = databaseDir.filePath("IBTrACS.changed.csv");
+    QVERIFY(writeDatabase(changedPath, databaseRows));
+
+    HurricaneTrackIndex changedIndex;
+    QString err;
+    QVERIFY2(changedIndex.open(changedPath, err) == 0, qPrintable(err));
+    QCOMPARE(changedIndex.numStorms(), 4);
+    changedIndex.close();
+
+    QVERIFY(writeDatabase(changedPath, QString(databaseRows) + "2005236N23285,2005,12,NA,GM,KATRINA,2005-08-29 12:00:00,TS,29.5,-89.6,110,920,0,110,920\n"));
+
+    QVERIFY2(changedIndex.open(changedPath, err) == 0, qPrintable(err));
+    QCOMPARE(changedIndex.numStorms(), 5);
+    QCOMPARE(changedIndex.findStorm("2005236N23285"), 4);
+    QCOMPARE(changedIndex.findStorms(2005, 2005), QVector<int>{4});
+    QCOMPARE(changedIndex.getIndexLandfall(4), 0);
+
+    changedIndex.close();
+    QFile::remove(HurricaneTrackIndex::indexFilePath(changedPath));
+
+    // The index that was built in initTestCase is mapped again without parsing the database
+    HurricaneTrackIndex reopenedIndex;
+    QVERIFY2(reopenedIndex.open(databasePath, err) == 0, qPrintable(err));
+    QCOMPARE(reopenedIndex.numStorms(), trackIndex.numStorms());
+    QCOMPARE(reopenedIndex.findStorms(2000, 2020, "NA"), (QVector<int>{0, 2}));
+}
+
+
+QTEST_GUILESS_MAIN(HurricaneTrackIndexTest)
+#include "HurricaneTrackIndexTest.moc"
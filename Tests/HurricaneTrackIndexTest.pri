@@ -0,0 +1,21 @@
+QT       += testlib
+QT       -= gui
+TARGET    = HurricaneTrackIndexTest
+CONFIG   += console
+CONFIG   -= app_bundle
+
+# C++17 support
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD/../Tools \
+               $$PWD/../UIWidgets
+
+SOURCES += \
+        $$PWD/../Tools/CSVStreamReader.cpp \
+        $$PWD/../Tools/HurricaneTrackIndex.cpp \
+        $$PWD/HurricaneTrackIndexTest.cpp \
+
+HEADERS += \
+        $$PWD/../Tools/CSVStreamReader.h \
+        $$PWD/../Tools/HurricaneTrackIndex.h \
+        $$PWD/../UIWidgets/HurricaneObject.h \
@@ -0,0 +1,216 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Benchmark of the nearest neighbour event mapper against a brute-force search over the grid points
+// Build it on its own with qmake Tests/NearestNeighbourBenchmark.pri and run it with -iterations or -median to get stable timings
+
+#include "NearestNeighbourEventMapper.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <random>
+
+class NearestNeighbourBenchmark: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testMatchesBruteForce();
+    void benchmarkTree();
+    void benchmarkBruteForce();
+    void benchmarkMapAssets();
+
+private:
+
+    // The k closest grid points by checking every one of them, ties go to the grid point that comes first in the file like in the mapper
+    QVector<int> bruteForceNearest(const double longitude, const double latitude, const int k) const;
+
+    QTemporaryDir gridDir;
+
+    NearestNeighbourEventMapper mapper;
+
+    QVector<QPointF> gridPoints;
+    QVector<QPointF> queries;
+
+    const int numGridPoints = 20000;
+    const int numQueries = 20000;
+    const int numNeighbours = 4;
+};
+
+
+void NearestNeighbourBenchmark::initTestCase()
+{
+    QVERIFY(gridDir.isValid());
+
+    // Grid points scattered over a region the size of a large ShakeMap, every tenth one is a copy of an earlier point so that there are ties
+    std::mt19937_64 generator(12345);
+    std::uniform_real_distribution<double> lon(-123.0, -121.0);
+    std::uniform_real_distribution<double> lat(37.0, 39.0);
+
+    for(int i = 0; i<numGridPoints; ++i)
+    {
+        if(i > 0 && i % 10 == 0)
+            gridPoints.push_back(gridPoints.at(static_cast<int>(generator() % i)));
+        else
+            gridPoints.push_back(QPointF(lon(generator), lat(generator)));
+    }
+
+    // Half of the queries sit on grid points, where the inverse distance weights are the most sensitive
+    for(int i = 0; i<numQueries; ++i)
+    {
+        if(i % 2 == 0)
+            queries.push_back(gridPoints.at(static_cast<int>(generator() % numGridPoints)));
+        else
+            queries.push_back(QPointF(lon(generator), lat(generator)));
+    }
+
+    QFile gridFile(gridDir.filePath("EventGrid.csv"));
+    QVERIFY(gridFile.open(QFile::WriteOnly | QFile::Text));
+
+    QTextStream gridStream(&gridFile);
+    gridStream.setRealNumberPrecision(17);
+    gridStream << "GP_file,Longitude,Latitude\n";
+
+    for(int i = 0; i<numGridPoints; ++i)
+        gridStream << "Site_" << i << ".csv," << gridPoints.at(i).x() << ',' << gridPoints.at(i).y() << '\n';
+
+    gridFile.close();
+
+    // The mapper only reads the first grid point file up front, to find the type and number of events
+    QFile siteFile(gridDir.filePath("Site_0.csv"));
+    QVERIFY(siteFile.open(QFile::WriteOnly | QFile::Text));
+    siteFile.write("PGA\n0.1\n0.2\n0.3\n");
+    siteFile.close();
+
+    QString err;
+    QVERIFY2(mapper.loadEventGrid(gridFile.fileName(), err) == 0, err.toLocal8Bit());
+    QCOMPARE(mapper.numGridPoints(), numGridPoints);
+}
+
+
+QVector<int> NearestNeighbourBenchmark::bruteForceNearest(const double longitude, const double latitude, const int k) const
+{
+    QVector<QPair<double,int>> candidates;
+    candidates.reserve(gridPoints.size());
+
+    for(int i = 0; i<gridPoints.size(); ++i)
+    {
+        const double dx = gridPoints.at(i).x() - longitude;
+        const double dy = gridPoints.at(i).y() - latitude;
+        candidates.push_back(qMakePair(dx*dx + dy*dy, i));
+    }
+
+    std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end());
+
+    QVector<int> indices;
+    for(int i = 0; i<k; ++i)
+        indices.push_back(candidates.at(i).second);
+
+    return indices;
+}
+
+
+void NearestNeighbourBenchmark::testMatchesBruteForce()
+{
+    QVector<int> indices;
+    QVector<double> distances;
+
+    for(auto&& query : queries)
+    {
+        mapper.nearestGridPoints(query.x(), query.y(), numNeighbours, indices, distances);
+
+        QCOMPARE(indices, this->bruteForceNearest(query.x(), query.y(), numNeighbours));
+    }
+}
+
+
+void NearestNeighbourBenchmark::benchmarkTree()
+{
+    QVector<int> indices;
+    QVector<double> distances;
+
+    QBENCHMARK
+    {
+        for(auto&& query : queries)
+            mapper.nearestGridPoints(query.x(), query.y(), numNeighbours, indices, distances);
+    }
+}
+
+
+void NearestNeighbourBenchmark::benchmarkBruteForce()
+{
+    QBENCHMARK
+    {
+        for(auto&& query : queries)
+            this->bruteForceNearest(query.x(), query.y(), numNeighbours);
+    }
+}
+
+
+void NearestNeighbourBenchmark::benchmarkMapAssets()
+{
+    QVector<NearestNeighbourEventMapper::Asset> assets;
+    assets.reserve(queries.size());
+
+    for(int i = 0; i<queries.size(); ++i)
+    {
+        NearestNeighbourEventMapper::Asset asset;
+        asset.id = QString::number(i);
+        asset.longitude = queries.at(i).x();
+        asset.latitude = queries.at(i).y();
+        assets.push_back(asset);
+    }
+
+    QString err;
+
+    QBENCHMARK
+    {
+        QVERIFY2(mapper.mapAssets(assets, numNeighbours, 5, 42, err) == 0, err.toLocal8Bit());
+    }
+
+    QCOMPARE(mapper.getAssetEvents().size(), assets.size());
+}
+
+
+QTEST_APPLESS_MAIN(NearestNeighbourBenchmark)
+#include "NearestNeighbourBenchmark.moc"
@@ -0,0 +1,19 @@
+QT       -= gui
+QT       += testlib concurrent
+TARGET    = NearestNeighbourBenchmark
+CONFIG   += console
+CONFIG   -= app_bundle
+
+# C++17 support
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD/../Tools
+
+SOURCES += \
+        $$PWD/../Tools/CSVStreamReader.cpp \
+        $$PWD/../Tools/NearestNeighbourEventMapper.cpp \
+        $$PWD/NearestNeighbourBenchmark.cpp \
+
+HEADERS += \
+        $$PWD/../Tools/CSVStreamReader.h \
+        $$PWD/../Tools/NearestNeighbourEventMapper.h \
@@ -0,0 +1,345 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Tests of the PEER record pipeline against a local stand-in for the PEER NGA West 2 server, the stand-in replays the responses recorded in PeerReplay
+// Build it on its own with qmake Tests/PeerRecordPipelineReplayTest.pri, it does not need a connection to the PEER server
+
+#include "PeerNgaWest2Client.h"
+#include "PeerRecordPipeline.h"
+
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+// Answers every request with the recorded response of its method and path, the requests are kept in the order that they came in
+class ReplayServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    ReplayServer(const QString& recordingsDirectory, QObject* parent = nullptr) : QTcpServer(parent), recordings(recordingsDirectory)
+    {
+        connect(this, &QTcpServer::newConnection, this, &ReplayServer::handleNewConnection);
+    }
+
+    // The recording is a file in the recordings directory, a .http file holds the status line, the headers and the body, any other file is sent as the body of a 200 response
+    void setResponse(const QByteArray& method, const QByteArray& path, const QString& recording)
+    {
+        routes.insert(method + ' ' + path, recording);
+    }
+
+    QUrl url(void) const
+    {
+        return QUrl("http://127.0.0.1:" + QString::number(this->serverPort()));
+    }
+
+    QList<QByteArray> requests;
+
+private slots:
+    void handleNewConnection(void)
+    {
+        while(auto socket = this->nextPendingConnection())
+        {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket](){ this->handleReadyRead(socket); });
+        }
+    }
+
+private:
+
+    void handleReadyRead(QTcpSocket* socket)
+    {
+        auto& buffer = buffers[socket];
+        buffer.append(socket->readAll());
+
+        // Wait for the whole request, the body follows the headers
+        auto headerEnd = buffer.indexOf("\r\n\r\n");
+        if(headerEnd == -1)
+            return;
+
+        const auto headerLines = buffer.left(headerEnd).split('\n');
+
+        int contentLength = 0;
+        for(auto&& line : headerLines)
+        {
+            if(line.toLower().startsWith("content-length:"))
+                contentLength = line.mid(15).trimmed().toInt();
+        }
+
+        if(buffer.size() < headerEnd + 4 + contentLength)
+            return;
+
+        // The request line, e.g., GET /users/sign_in HTTP/1.1
+        const auto requestLine = headerLines.first().trimmed().split(' ');
+        const auto request = requestLine.value(0) + ' ' + requestLine.value(1);
+
+        buffers.remove(socket);
+        requests.append(request);
+
+        socket->write(this->response(request));
+        socket->disconnectFromHost();
+    }
+
+    QByteArray response(const QByteArray& request) const
+    {
+        QByteArray statusAndHeaders = "HTTP/1.1 404 Not Found\r\n";
+        QByteArray body;
+
+        if(routes.contains(request))
+        {
+            QFile file(recordings.filePath(routes.value(request)));
+
+            if(file.open(QFile::ReadOnly))
+            {
+                body = file.readAll();
+
+                if(file.fileName().endsWith(".http"))
+                {
+                    // The recordings are stored with plain line feeds
+                    auto headerEnd = body.indexOf("\n\n");
+                    statusAndHeaders = body.left(headerEnd).replace("\n", "\r\n") + "\r\n";
+                    body = body.mid(headerEnd + 2);
+                }
+                else
+                {
+                    statusAndHeaders = "HTTP/1.1 200 OK\r\nContent-Type: application/zip\r\n";
+                }
+            }
+        }
+
+        return statusAndHeaders + "Content-Length: " + QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    }
+
+    QDir recordings;
+    QMap<QByteArray, QString> routes;
+    QMap<QTcpSocket*, QByteArray> buffers;
+};
+
+
+class PeerRecordPipelineReplayTest: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void testDownload();
+    void testDownloadFailed();
+    void testSearchFailed();
+    void testRetriesExhausted();
+
+private:
+
+    // Signs the client in to the replay server
+    void signIn(void);
+
+    // Starts the pipeline and waits for it to finish, returns the arguments of the finished signal
+    QList<QVariant> runPipeline(const QStringList& recordNumbers);
+
+    std::unique_ptr<ReplayServer> server;
+    std::unique_ptr<PeerNgaWest2Client> client;
+    std::unique_ptr<PeerRecordPipeline> pipeline;
+
+    std::unique_ptr<QTemporaryDir> workDir;
+};
+
+
+void PeerRecordPipelineReplayTest::init()
+{
+    const auto recordings = QFINDTESTDATA("PeerReplay");
+    QVERIFY2(!recordings.isEmpty(), "No recorded responses found");
+
+    server.reset(new ReplayServer(recordings));
+    QVERIFY(server->listen(QHostAddress::LocalHost));
+
+    server->setResponse("GET", "/users/sign_in", "signInPage.http");
+    server->setResponse("POST", "/users/sign_in", "signIn.http");
+    server->setResponse("POST", "/spectras", "postSpectra.http");
+    server->setResponse("POST", "/spectras/17/searches", "postSearch.http");
+    server->setResponse("GET", "/spectras/17/searches/23/?getRecords=1", "getRecords.http");
+    server->setResponse("GET", "/spectras/17/searches/23/download_zip", "PeerRecords.zip");
+
+    workDir.reset(new QTemporaryDir());
+    QVERIFY(workDir->isValid());
+
+    client.reset(new PeerNgaWest2Client());
+    client->setServerUrl(server->url());
+
+    pipeline.reset(new PeerRecordPipeline(client.get()));
+    pipeline->setCacheDirectory(workDir->filePath("cache"));
+}
+
+
+void PeerRecordPipelineReplayTest::cleanup()
+{
+    pipeline.reset();
+    client.reset();
+    server.reset();
+    workDir.reset();
+}
+
+
+void PeerRecordPipelineReplayTest::signIn(void)
+{
+    QSignalSpy loginSpy(client.get(), &PeerNgaWest2Client::loginFinished);
+
+    client->signIn("replay@example.com", "replay");
+
+    QVERIFY(loginSpy.wait(10000));
+    QCOMPARE(loginSpy.first().first().toBool(), true);
+}
+
+
+QList<QVariant> PeerRecordPipelineReplayTest::runPipeline(const QStringList& recordNumbers)
+{
+    QSignalSpy finishedSpy(pipeline.get(), &PeerRecordPipeline::finished);
+
+    QString err;
+    if(pipeline->start(recordNumbers, workDir->filePath("output"), err) != 0)
+        return QList<QVariant>{-1, err};
+
+    // The pipeline has to finish, a failed download must not leave it waiting
+    if(!finishedSpy.wait(10000))
+        return QList<QVariant>();
+
+    return finishedSpy.first();
+}
+
+
+void PeerRecordPipelineReplayTest::testDownload()
+{
+    this->signIn();
+
+    auto result = this->runPipeline(QStringList{"1"});
+
+    QCOMPARE(result.size(), 2);
+    QVERIFY2(result.at(0).toInt() == 0, result.at(1).toString().toLocal8Bit());
+    QVERIFY(!pipeline->isRunning());
+    QCOMPARE(pipeline->getNumDownloaded(), 1);
+
+    QVERIFY(QFileInfo::exists(workDir->filePath("output/RSN1.json")));
+    QVERIFY(QFileInfo::exists(workDir->filePath("cache/RSN1.json")));
+
+    const auto metadata = pipeline->getSearchResults().value("-- Summary of Metadata of Selected Records --").toObject();
+    QCOMPARE(metadata.size(), 1);
+
+    // The second time the record comes from the cache, without a request to the server
+    QVERIFY(QFile::remove(workDir->filePath("output/RSN1.json")));
+
+    const auto numRequests = server->requests.size();
+
+    result = this->runPipeline(QStringList{"1"});
+
+    QCOMPARE(result.size(), 2);
+    QCOMPARE(result.at(0).toInt(), 0);
+    QCOMPARE(pipeline->getNumFromCache(), 1);
+    QCOMPARE(pipeline->getNumDownloaded(), 0);
+    QCOMPARE(server->requests.size(), numRequests);
+    QVERIFY(QFileInfo::exists(workDir->filePath("output/RSN1.json")));
+}
+
+
+void PeerRecordPipelineReplayTest::testDownloadFailed()
+{
+    server->setResponse("GET", "/spectras/17/searches/23/download_zip", "downloadFailed.http");
+
+    this->signIn();
+
+    auto result = this->runPipeline(QStringList{"1"});
+
+    QCOMPARE(result.size(), 2);
+    QCOMPARE(result.at(0).toInt(), -1);
+    QVERIFY(result.at(1).toString().contains("Ground Motions Download Failed!"));
+    QVERIFY(!pipeline->isRunning());
+    QVERIFY(!QFileInfo::exists(workDir->filePath("output/RSN1.json")));
+
+    // The pipeline can be started again once the server is back
+    server->setResponse("GET", "/spectras/17/searches/23/download_zip", "PeerRecords.zip");
+
+    result = this->runPipeline(QStringList{"1"});
+
+    QCOMPARE(result.size(), 2);
+    QVERIFY2(result.at(0).toInt() == 0, result.at(1).toString().toLocal8Bit());
+    QVERIFY(QFileInfo::exists(workDir->filePath("output/RSN1.json")));
+}
+
+
+void PeerRecordPipelineReplayTest::testSearchFailed()
+{
+    server->setResponse("POST", "/spectras/17/searches", "postSearchFailed.http");
+
+    this->signIn();
+
+    auto result = this->runPipeline(QStringList{"1"});
+
+    QCOMPARE(result.size(), 2);
+    QCOMPARE(result.at(0).toInt(), -1);
+    QVERIFY(result.at(1).toString().contains("Search of NGA West failed"));
+    QVERIFY(!pipeline->isRunning());
+
+    // Nothing is requested after the failed search
+    QCOMPARE(server->requests.last(), QByteArray("POST /spectras/17/searches"));
+}
+
+
+void PeerRecordPipelineReplayTest::testRetriesExhausted()
+{
+    // The server keeps asking to sign in again
+    server->setResponse("POST", "/spectras", "postSpectraUnauthenticated.http");
+
+    this->signIn();
+
+    auto result = this->runPipeline(QStringList{"1"});
+
+    QCOMPARE(result.size(), 2);
+    QCOMPARE(result.at(0).toInt(), -1);
+    QVERIFY(result.at(1).toString().contains("after 5 retries"));
+    QVERIFY(!pipeline->isRunning());
+
+    // The first submission and the five retries
+    QCOMPARE(server->requests.count("POST /spectras"), 6);
+}
+
+
+QTEST_GUILESS_MAIN(PeerRecordPipelineReplayTest)
+#include "PeerRecordPipelineReplayTest.moc"
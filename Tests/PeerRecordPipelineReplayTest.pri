@@ -0,0 +1,33 @@
+QT       += widgets testlib network concurrent
+TARGET    = PeerRecordPipelineReplayTest
+CONFIG   += console
+CONFIG   -= app_bundle
+
+# C++17 support
+CONFIG += c++17
+
+PATH_TO_COMMON=../../SimCenterCommon
+
+# For the unzipping of the downloaded records
+include($$PATH_TO_COMMON/Common/Common.pri)
+
+INCLUDEPATH += $$PWD/../Events/UI \
+               $$PWD/../Tools \
+               $$PWD/../UIWidgets \
+
+SOURCES += \
+        $$PWD/../Events/UI/PeerNgaWest2Client.cpp \
+        $$PWD/../Events/UI/PeerRecordPipeline.cpp \
+        $$PWD/../Tools/NGAW2Converter.cpp \
+        $$PWD/../Tools/CSVReaderWriter.cpp \
+        $$PWD/../Tools/CSVStreamReader.cpp \
+        $$PWD/../UIWidgets/GroundMotionTimeHistory.cpp \
+        $$PWD/PeerRecordPipelineReplayTest.cpp \
+
+HEADERS += \
+        $$PWD/../Events/UI/PeerNgaWest2Client.h \
+        $$PWD/../Events/UI/PeerRecordPipeline.h \
+        $$PWD/../Tools/NGAW2Converter.h \
+        $$PWD/../Tools/CSVReaderWriter.h \
+        $$PWD/../Tools/CSVStreamReader.h \
+        $$PWD/../UIWidgets/GroundMotionTimeHistory.h \
@@ -0,0 +1,314 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+// Checks the batched raster sampler against sampling the data provider one point at a time
+// Build it on its own with qmake Tests/RasterBlockSamplerTest.pri
+
+#include "RasterBlockSampler.h"
+
+#include <qgsapplication.h>
+#include <qgspointxy.h>
+#include <qgsrasterdataprovider.h>
+#include <qgsrasterlayer.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtTest/QtTest>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+
+class RasterBlockSamplerTest: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testNearest_data();
+    void testNearest();
+    void testBilinear_data();
+    void testBilinear();
+    void testBadBand();
+
+private:
+
+    // The value of the pixel that contains the point as the data provider gives it, NaN if it has none
+    double providerSample(const double x, const double y) const;
+
+    QTemporaryDir rasterDir;
+
+    std::unique_ptr<QgsRasterLayer> rasterLayer;
+    QgsRasterDataProvider* dataProvider = nullptr;
+
+    // Points inside of the raster, on no data pixels, and outside of the raster
+    QVector<double> xs;
+    QVector<double> ys;
+
+    const int numCols = 613;
+    const int numRows = 421;
+    const double cellSize = 0.001;
+    const double xllCorner = -95.2;
+    const double yllCorner = 29.1;
+};
+
+
+void RasterBlockSamplerTest::initTestCase()
+{
+    QgsApplication::init();
+    QgsApplication::initQgis();
+
+    QVERIFY(rasterDir.isValid());
+
+    // An ESRI ASCII grid that GDAL reads as a single band raster, with a block and a scatter of no data pixels
+    const auto rasterPath = rasterDir.filePath("depth.asc");
+
+    QFile rasterFile(rasterPath);
+    QVERIFY(rasterFile.open(QFile::WriteOnly | QFile::Text));
+
+    QTextStream stream(&rasterFile);
+    stream.setRealNumberPrecision(10);
+    stream << "ncols " << numCols << "\n";
+    stream << "nrows " << numRows << "\n";
+    stream << "xllcorner " << xllCorner << "\n";
+    stream << "yllcorner " << yllCorner << "\n";
+    stream << "cellsize " << cellSize << "\n";
+    stream << "NODATA_value -9999\n";
+
+    for(int row = 0; row<numRows; ++row)
+    {
+        for(int col = 0; col<numCols; ++col)
+        {
+            const bool noData = (row > 100 && row < 140 && col > 250 && col < 300) || (row*numCols + col) % 97 == 0;
+
+            if(noData)
+                stream << "-9999";
+            else
+                stream << 0.25*std::sin(0.05*col) + 0.001*row + 0.5;
+
+            stream << (col + 1 == numCols ? "\n" : " ");
+        }
+    }
+
+    rasterFile.close();
+
+    rasterLayer = std::make_unique<QgsRasterLayer>(rasterPath, "depth", "gdal");
+    QVERIFY2(rasterLayer->isValid(), "Failed to open the test raster");
+
+    dataProvider = rasterLayer->dataProvider();
+    QCOMPARE(dataProvider->xSize(), numCols);
+    QCOMPARE(dataProvider->ySize(), numRows);
+
+    std::mt19937_64 generator(2024);
+    std::uniform_real_distribution<double> x(xllCorner - 0.05, xllCorner + numCols*cellSize + 0.05);
+    std::uniform_real_distribution<double> y(yllCorner - 0.05, yllCorner + numRows*cellSize + 0.05);
+
+    for(int i = 0; i<50000; ++i)
+    {
+        xs.push_back(x(generator));
+        ys.push_back(y(generator));
+    }
+
+    // The corners and the edges of the raster, where the bilinear lookup is clamped
+    const double xMax = xllCorner + numCols*cellSize;
+    const double yMax = yllCorner + numRows*cellSize;
+    const double inset = 0.1*cellSize;
+
+    xs << xllCorner + inset << xMax - inset << xllCorner + inset << xMax - inset << 0.5*(xllCorner + xMax);
+    ys << yllCorner + inset << yllCorner + inset << yMax - inset << yMax - inset << yMax - inset;
+}
+
+
+void RasterBlockSamplerTest::cleanupTestCase()
+{
+    rasterLayer.reset();
+    QgsApplication::exitQgis();
+}
+
+
+double RasterBlockSamplerTest::providerSample(const double x, const double y) const
+{
+    bool ok = false;
+    const auto value = dataProvider->sample(QgsPointXY(x, y), 1, &ok);
+
+    return ok ? value : std::numeric_limits<double>::quiet_NaN();
+}
+
+
+void RasterBlockSamplerTest::testNearest_data()
+{
+    QTest::addColumn<int>("tileSize");
+
+    QTest::newRow("default tiles") << 256;
+    QTest::newRow("small tiles") << 7;
+    QTest::newRow("one tile") << 1024;
+}
+
+
+void RasterBlockSamplerTest::testNearest()
+{
+    QFETCH(int, tileSize);
+
+    RasterBlockSampler sampler(dataProvider, tileSize, 4);
+
+    QVector<double> values;
+    QBitArray missed;
+    QString err;
+
+    // The same band twice, to check the layout of the values
+    QVERIFY2(sampler.sample(xs, ys, {1, 1}, RasterBlockSampler::Interpolation::Nearest, values, missed, err) == 0, err.toLocal8Bit());
+
+    QCOMPARE(values.size(), 2*xs.size());
+    QCOMPARE(missed.size(), xs.size());
+
+    int numMissed = 0;
+
+    for(int i = 0; i<xs.size(); ++i)
+    {
+        const auto expected = this->providerSample(xs.at(i), ys.at(i));
+
+        if(std::isnan(expected))
+        {
+            QVERIFY2(missed.testBit(i), QString("Point %1 should be a miss").arg(i).toLocal8Bit());
+            QVERIFY(std::isnan(values.at(2*i)) && std::isnan(values.at(2*i + 1)));
+            ++numMissed;
+            continue;
+        }
+
+        QVERIFY2(!missed.testBit(i), QString("Point %1 should not be a miss").arg(i).toLocal8Bit());
+        QCOMPARE(values.at(2*i), expected);
+        QCOMPARE(values.at(2*i + 1), expected);
+    }
+
+    // The points have to cover both the misses and the hits
+    QVERIFY(numMissed > 0 && numMissed < xs.size());
+}
+
+
+void RasterBlockSamplerTest::testBilinear_data()
+{
+    this->testNearest_data();
+}
+
+
+void RasterBlockSamplerTest::testBilinear()
+{
+    QFETCH(int, tileSize);
+
+    RasterBlockSampler sampler(dataProvider, tileSize, 4);
+
+    QVector<double> values;
+    QBitArray missed;
+    QString err;
+
+    QVERIFY2(sampler.sample(xs, ys, {1}, RasterBlockSampler::Interpolation::Bilinear, values, missed, err) == 0, err.toLocal8Bit());
+
+    int numInterpolated = 0;
+
+    for(int i = 0; i<xs.size(); ++i)
+    {
+        const double col = (xs.at(i) - xllCorner)/cellSize;
+        const double row = (yllCorner + numRows*cellSize - ys.at(i))/cellSize;
+
+        if(!(col >= 0.0 && col < numCols && row >= 0.0 && row < numRows))
+        {
+            QVERIFY(missed.testBit(i));
+            continue;
+        }
+
+        // The four pixel centres around the point, clamped to the edge of the raster like in the sampler
+        const int left = std::max(0, std::min(static_cast<int>(std::floor(col - 0.5)), numCols - 2));
+        const int top = std::max(0, std::min(static_cast<int>(std::floor(row - 0.5)), numRows - 2));
+
+        const double wx = std::max(0.0, std::min(1.0, col - 0.5 - left));
+        const double wy = std::max(0.0, std::min(1.0, row - 0.5 - top));
+
+        auto centre = [&](const int c, const int r)
+        {
+            return this->providerSample(xllCorner + (c + 0.5)*cellSize, yllCorner + numRows*cellSize - (r + 0.5)*cellSize);
+        };
+
+        const double p00 = centre(left, top);
+        const double p10 = centre(left + 1, top);
+        const double p01 = centre(left, top + 1);
+        const double p11 = centre(left + 1, top + 1);
+
+        if(std::isnan(p00) || std::isnan(p10) || std::isnan(p01) || std::isnan(p11))
+        {
+            // Next to no data the sampler falls back to one of the four pixels
+            if(!missed.testBit(i))
+            {
+                const double val = values.at(i);
+                QVERIFY2(val == p00 || val == p10 || val == p01 || val == p11, QString("Point %1 next to no data").arg(i).toLocal8Bit());
+            }
+
+            continue;
+        }
+
+        const double upper = p00 + wx*(p10 - p00);
+        const double lower = p01 + wx*(p11 - p01);
+        const double expected = upper + wy*(lower - upper);
+
+        QVERIFY2(!missed.testBit(i), QString("Point %1 should not be a miss").arg(i).toLocal8Bit());
+        QVERIFY2(std::fabs(values.at(i) - expected) <= 1.0e-9, QString("Point %1: %2 instead of %3").arg(i).arg(values.at(i), 0, 'g', 17).arg(expected, 0, 'g', 17).toLocal8Bit());
+
+        ++numInterpolated;
+    }
+
+    QVERIFY(numInterpolated > 0);
+}
+
+
+void RasterBlockSamplerTest::testBadBand()
+{
+    RasterBlockSampler sampler(dataProvider);
+
+    QVector<double> values;
+    QBitArray missed;
+    QString err;
+
+    QCOMPARE(sampler.sample(xs, ys, {2}, RasterBlockSampler::Interpolation::Nearest, values, missed, err), -1);
+    QVERIFY(!err.isEmpty());
+}
+
+
+QTEST_GUILESS_MAIN(RasterBlockSamplerTest)
+#include "RasterBlockSamplerTest.moc"
@@ -0,0 +1,22 @@
+QT       += testlib
+TARGET    = RasterBlockSamplerTest
+CONFIG   += console
+CONFIG   -= app_bundle
+
+# C++17 support
+CONFIG += c++17
+
+DEFINES +=  Q_GIS
+
+PATH_TO_QGIS_PLUGIN=../../QGISPlugin
+
+include($$PATH_TO_QGIS_PLUGIN/QGIS.pri)
+
+INCLUDEPATH += $$PWD/../Tools
+
+SOURCES += \
+        $$PWD/../Tools/RasterBlockSampler.cpp \
+        $$PWD/RasterBlockSamplerTest.cpp \
+
+HEADERS += \
+        $$PWD/../Tools/RasterBlockSampler.h \
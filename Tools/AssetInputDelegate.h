@@ -38,9 +38,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
-#include <QLineEdit>
+#include "ComponentIDSet.h"
 
-#include <set>
+#include <QLineEdit>
 
 class AssetInputDelegate : public QLineEdit
 {
@@ -49,15 +49,17 @@ class AssetInputDelegate : public QLineEdit
 public:
     AssetInputDelegate();
 
-    std::set<int> getSelectedComponentIDs() const;
+    const ComponentIDSet& getSelectedComponentIDs() const;
 
     void insertSelectedComponent(const int id);
 
     void insertSelectedComponents(const QVector<int>& ids);
 
+    void insertSelectedComponents(const ComponentIDSet& ids);
+
     void clear();
 
-    int size();
+    qint64 size();
 
     // Returns the list of components in a string in the form 1,3,5-6,10,12,...
     QString getComponentAnalysisList();
@@ -70,7 +72,7 @@ signals:
 
 private:
 
-    std::set<int> selectedComponentIDs;
+    ComponentIDSet selectedComponentIDs;
 
     QString prevText;
 };
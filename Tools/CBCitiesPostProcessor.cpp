@@ -44,6 +44,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "REmpiricalProbabilityDistribution.h"
 #include "TablePrinter.h"
 #include "TableNumberItem.h"
+#include "ResultsTableModel.h"
 #include "VisualizationWidget.h"
 #include "WorkflowAppR2D.h"
 #include "Utils/ProgramOutputDialog.h"
@@ -70,6 +71,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStackedBarSeries>
 #include <QStringList>
 #include <QTabWidget>
+#include <QTableView>
 #include <QTableWidget>
 #include <QTextCursor>
 #include <QTextTable>
@@ -132,7 +134,9 @@ CBCitiesPostProcessor::CBCitiesPostProcessor(QWidget *parent, VisualizationWidge
 
     auto tableWidgetLayout = new QVBoxLayout(tableWidget);
 
-    resultsTableWidget = new QTableWidget(this);
+    resultsTableWidget = new QTableView(this);
+    resultsTableModel = new ResultsTableModel(resultsTableWidget);
+    resultsTableWidget->setModel(resultsTableModel);
     resultsTableWidget->verticalHeader()->setVisible(false);
     resultsTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
@@ -300,9 +304,11 @@ int CBCitiesPostProcessor::processDVResults(const QVector<QStringList>& DVResult
 
     QStringList tableHeadings = {"Asset ID","RepairRate"};
 
-    resultsTableWidget->setColumnCount(tableHeadings.size());
-    resultsTableWidget->setHorizontalHeaderLabels(tableHeadings);
-    resultsTableWidget->setRowCount(DVResults.size()-numHeaderRows);
+    // The table columns are gathered here and handed to the model in one go
+    const int numTableRows = DVResults.size()-numHeaderRows;
+    QStringList assetIDColumn;
+    assetIDColumn.reserve(numTableRows);
+    QVector<double> repairRateColumn(numTableRows);
 
     REmpiricalProbabilityDistribution theProbDist;
 
@@ -342,11 +348,8 @@ int CBCitiesPostProcessor::processDVResults(const QVector<QStringList>& DVResult
 
         theProbDist.addSample(repairRate);
 
-        auto IDItem = new TableNumberItem(IDStr);
-        auto failureProbItem = new TableNumberItem(meanRR);
-
-        resultsTableWidget->setItem(count,0, IDItem);
-        resultsTableWidget->setItem(count,1, failureProbItem);
+        assetIDColumn.append(IDStr);
+        repairRateColumn[count] = repairRate;
 
         auto& rowData = fieldAttributes[count];
 
@@ -360,6 +363,10 @@ int CBCitiesPostProcessor::processDVResults(const QVector<QStringList>& DVResult
         }
     }
 
+    resultsTableModel->setNumberOfRows(numTableRows);
+    resultsTableModel->addTextColumn(tableHeadings.at(0), assetIDColumn);
+    resultsTableModel->addColumn(tableHeadings.at(1), repairRateColumn);
+
     // Test to remove start
     // auto start = high_resolution_clock::now();
     // Test to remove end
@@ -485,10 +492,10 @@ int CBCitiesPostProcessor::createHistogramChart(REmpiricalProbabilityDistributio
 
 
 
-void CBCitiesPostProcessor::processResultsSubset(const std::set<int>& selectedComponentIDs)
+void CBCitiesPostProcessor::processResultsSubset(const ComponentIDSet& selectedComponentIDs)
 {
 
-    if(selectedComponentIDs.empty())
+    if(selectedComponentIDs.isEmpty())
         return;
 
     if(DVdata.size() < numHeaderRows)
@@ -575,7 +582,7 @@ void CBCitiesPostProcessor::clear(void)
 
     outputFilePath.clear();
 
-    resultsTableWidget->clear();
+    resultsTableModel->clear();
 
     sortComboBox->setCurrentIndex(0);
 
@@ -47,13 +47,14 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QMainWindow>
 
 #include <memory>
-#include <set>
 
 class REmpiricalProbabilityDistribution;
 class VisualizationWidget;
 
 class QDockWidget;
 class QTableWidget;
+class QTableView;
+class ResultsTableModel;
 class QGridLayout;
 class QLabel;
 class QComboBox;
@@ -112,7 +113,7 @@ public:
         return val;
     }
 
-    void processResultsSubset(const std::set<int>& selectedComponentIDs);
+    void processResultsSubset(const ComponentIDSet& selectedComponentIDs);
 
     void setCurrentlyViewable(bool status);
 
@@ -143,7 +144,8 @@ private:
 
     QWidget *tableWidget;
 
-    QTableWidget* resultsTableWidget;
+    QTableView* resultsTableWidget;
+    ResultsTableModel* resultsTableModel;
 
     QDockWidget* chartsDock3;
 
@@ -37,6 +37,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "CSVReaderWriter.h"
+#include "CSVStreamReader.h"
 
 #include <QVector>
 #include <QTextStream>
@@ -206,117 +207,16 @@ QVector<QStringList> CSVReaderWriter::parseCSVFile(const QString &pathToFile, QS
 {
     QVector<QStringList> returnVec;
 
-    QFile geomFile(pathToFile);
+    CSVStreamReader csvReader;
 
-    if (!geomFile.open(QIODevice::ReadOnly))
+    auto res = csvReader.parseFile(pathToFile, [&](const CSVRow& row, int)
     {
-        err = "Cannot find the file: " + pathToFile + "\nCheck your directory and try again.";
-        return returnVec;
-    }
-
-    QStringList rowLines;
-    while (!geomFile.atEnd())
-    {
-        QString line = geomFile.readLine();
-
-        rowLines << line;
-    }
+        returnVec.push_back(row.toStringList());
+        return true;
+    }, err);
 
-    auto numRows = rowLines.size();
-    if(numRows == 0)
-    {
+    if(res == 0 && returnVec.empty())
         err = "Error in parsing the .csv file " + pathToFile + " in CVSReaderWriter::parseCSVFile";
-        return returnVec;
-    }
-
-    returnVec.reserve(numRows);
-
-    for(auto&& it: rowLines)
-    {
-        auto lineStr = this->parseLineCSV(it);
-
-        returnVec.push_back(lineStr);
-    }
 
     return returnVec;
 }
-
-
-QStringList CSVReaderWriter::parseLineCSV(const QString &csvString)
-{
-    QStringList fields;
-    QString value;
-
-    bool hasQuote = false;
-
-    for (int i = 0; i < csvString.size(); ++i)
-    {
-        const QChar current = csvString.at(i);
-
-        // Normal state
-        if (hasQuote == false)
-        {
-            // Comma
-            if (current == ',')
-            {
-                // Save field
-                fields.append(value.trimmed());
-                value.clear();
-            }
-
-            // Double-quote
-            else if (current == '"')
-            {
-                hasQuote = true;
-                value += current;
-            }
-
-            // Other character
-            else
-                value += current;
-        }
-        else if (hasQuote)
-        {
-            // Check for another double-quote
-            if (current == '"')
-            {
-                if (i < csvString.size())
-                {
-                    // A double double-quote?
-                    if (i+1 < csvString.size() && csvString.at(i+1) == '"')
-                    {
-                        value += '"';
-
-                        // Skip a second quote character in a row
-                        i++;
-                    }
-                    else
-                    {
-                        hasQuote = false;
-                        value += '"';
-                    }
-                }
-            }
-
-            // Other character
-            else
-                value += current;
-        }
-    }
-
-    if (!value.isEmpty())
-        fields.append(value.trimmed());
-
-
-    // Remove quotes and whitespace around quotes
-    for (int i=0; i<fields.size(); ++i)
-        if (fields[i].length()>=1 && fields[i].left(1)=='"')
-        {
-            fields[i]=fields[i].mid(1);
-            if (fields[i].length()>=1 && fields[i].right(1)=='"')
-                fields[i]=fields[i].left(fields[i].length()-1);
-        }
-
-    return fields;
-}
-
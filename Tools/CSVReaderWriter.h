@@ -56,12 +56,9 @@ public:
     // Parses a CSV file and returns the file as a vector of string lists
     // Each item in the vector (string list) corresponds to a row of the csv file that is parsed
     // The string list corresponds to the items within a row, i.e., the values in the cells. There are as many items in the string list as there are in the row of the CSV file
+    // Use CSVStreamReader directly to avoid holding the whole file in memory as strings
     QVector<QStringList> parseCSVFile(const QString &pathToFile, QString& err);
 
-private:
-
-    QStringList parseLineCSV(const QString &csvString);
-
 };
 
 #endif // CSVREADERWRITER_H
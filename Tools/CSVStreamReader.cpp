@@ -0,0 +1,353 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "CSVStreamReader.h"
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#include <cstring>
+
+namespace {
+
+// Word-at-a-time test for a byte in a 64-bit word, see "Determine if a word has a byte equal to n" in Bit Twiddling Hacks
+inline quint64 broadcastByte(const char c)
+{
+    return 0x0101010101010101ULL * static_cast<unsigned char>(c);
+}
+
+inline bool hasByte(const quint64 word, const quint64 pattern)
+{
+    const quint64 x = word ^ pattern;
+    return ((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) != 0;
+}
+
+// Same set of characters as QString::trimmed
+inline bool isSpace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+}
+
+
+double CSVField::toDouble(bool* ok) const
+{
+    return rawData().toDouble(ok);
+}
+
+
+int CSVField::toInt(bool* ok) const
+{
+    return rawData().toInt(ok);
+}
+
+
+qint64 CSVField::toLongLong(bool* ok) const
+{
+    return rawData().toLongLong(ok);
+}
+
+
+QString CSVField::toString() const
+{
+    return QString::fromUtf8(fieldData, fieldSize);
+}
+
+
+QByteArray CSVField::toByteArray() const
+{
+    return QByteArray(fieldData, fieldSize);
+}
+
+
+bool CSVField::equals(const char* str) const
+{
+    const auto len = std::strlen(str);
+
+    if(len != static_cast<size_t>(fieldSize))
+        return false;
+
+    return len == 0 || std::memcmp(fieldData, str, len) == 0;
+}
+
+
+QStringList CSVRow::toStringList() const
+{
+    QStringList list;
+    list.reserve(rowFields.size());
+
+    for(auto&& it : rowFields)
+        list.append(it.toString());
+
+    return list;
+}
+
+
+CSVStreamReader::CSVStreamReader(char delimiter) : delimiter(delimiter)
+{
+
+}
+
+
+int CSVStreamReader::parseFile(const QString& pathToFile, const RowCallback& callback, QString& err)
+{
+    numRows = 0;
+    numBytes = 0;
+
+    QFile file(pathToFile);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        err = "Cannot find the file: " + pathToFile + "\nCheck your directory and try again.";
+        return -1;
+    }
+
+    const auto fileSize = file.size();
+
+    if(fileSize == 0)
+        return 0;
+
+    // Map the file so that the fields can point straight into the file bytes
+    uchar* mappedData = file.map(0, fileSize);
+
+    if(mappedData != nullptr)
+    {
+        auto res = this->parseBuffer(reinterpret_cast<const char*>(mappedData), fileSize, callback, err);
+
+        file.unmap(mappedData);
+
+        return res;
+    }
+
+    // Some file systems do not support mapping, read the file into memory instead
+    const QByteArray fileData = file.readAll();
+
+    return this->parseBuffer(fileData.constData(), fileData.size(), callback, err);
+}
+
+
+int CSVStreamReader::parseBuffer(const char* data, qint64 size, const RowCallback& callback, QString& err)
+{
+    numRows = 0;
+    numBytes = 0;
+
+    if(data == nullptr || size <= 0)
+        return 0;
+
+    qint64 pos = 0;
+
+    // Skip the UTF-8 byte order mark
+    if(size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+        pos = 3;
+
+    while(pos < size)
+    {
+        fields.clear();
+        scratch.clear();
+        scratchFields.clear();
+
+        qint64 fieldStart = pos;
+        bool inQuote = false;
+        bool hasQuote = false;
+        bool endOfLine = false;
+
+        while(!endOfLine)
+        {
+            pos = this->scanToSpecial(data, pos, size);
+
+            if(pos == size)
+            {
+                // The last line of the file does not end in a line feed, an empty trailing field is dropped here
+                if(fieldStart < size)
+                    this->addField(data, fieldStart, size, hasQuote);
+
+                break;
+            }
+
+            const char current = data[pos];
+
+            if(current == '"')
+            {
+                inQuote = !inQuote;
+                hasQuote = true;
+                ++pos;
+            }
+            else if(current == '\n')
+            {
+                // A line always ends a row, even inside of a quote
+                this->addField(data, fieldStart, pos, hasQuote);
+                ++pos;
+                endOfLine = true;
+            }
+            else if(inQuote)
+            {
+                // A delimiter inside of a quote is a part of the field
+                ++pos;
+            }
+            else
+            {
+                this->addField(data, fieldStart, pos, hasQuote);
+                ++pos;
+                fieldStart = pos;
+                hasQuote = false;
+            }
+        }
+
+        if(fields.isEmpty())
+            continue;
+
+        // Now that the scratch buffer will not grow anymore, point the un-escaped fields into it
+        for(auto&& it : scratchFields)
+            fields[it.first] = CSVField(scratch.constData() + it.second, fields[it.first].size());
+
+        CSVRow row(fields);
+
+        const auto rowIndex = numRows;
+        ++numRows;
+        numBytes = pos;
+
+        if(!callback(row, rowIndex))
+            break;
+    }
+
+    return 0;
+}
+
+
+int CSVStreamReader::numRowsParsed(void) const
+{
+    return numRows;
+}
+
+
+qint64 CSVStreamReader::bytesParsed(void) const
+{
+    return numBytes;
+}
+
+
+qint64 CSVStreamReader::scanToSpecial(const char* data, qint64 pos, qint64 end) const
+{
+    const quint64 delimiterPattern = broadcastByte(delimiter);
+    const quint64 quotePattern = broadcastByte('"');
+    const quint64 lineFeedPattern = broadcastByte('\n');
+
+    // Skip over eight bytes at a time as long as none of them is a special character
+    while(pos + 8 <= end)
+    {
+        quint64 word;
+        std::memcpy(&word, data + pos, 8);
+
+        if(hasByte(word, delimiterPattern) || hasByte(word, quotePattern) || hasByte(word, lineFeedPattern))
+            break;
+
+        pos += 8;
+    }
+
+    for(; pos < end; ++pos)
+    {
+        const char current = data[pos];
+
+        if(current == delimiter || current == '"' || current == '\n')
+            return pos;
+    }
+
+    return end;
+}
+
+
+void CSVStreamReader::addField(const char* data, qint64 start, qint64 end, bool hasQuote)
+{
+    while(start < end && isSpace(data[start]))
+        ++start;
+
+    while(end > start && isSpace(data[end-1]))
+        --end;
+
+    // Fast path, the field is a view into the data
+    if(!hasQuote)
+    {
+        fields.append(CSVField(data + start, static_cast<int>(end - start)));
+        return;
+    }
+
+    // Un-escape the doubled quotes, the quote characters are kept at this stage
+    const int offset = scratch.size();
+
+    bool inQuote = false;
+    for(qint64 i = start; i < end; ++i)
+    {
+        const char current = data[i];
+
+        if(current != '"')
+        {
+            scratch.append(current);
+        }
+        else if(!inQuote)
+        {
+            inQuote = true;
+            scratch.append(current);
+        }
+        else if(i + 1 < end && data[i+1] == '"')
+        {
+            scratch.append('"');
+            ++i;
+        }
+        else
+        {
+            inQuote = false;
+            scratch.append(current);
+        }
+    }
+
+    int fieldOffset = offset;
+    int fieldSize = scratch.size() - offset;
+
+    // Remove the enclosing quotes
+    if(fieldSize >= 1 && scratch.at(fieldOffset) == '"')
+    {
+        ++fieldOffset;
+        --fieldSize;
+
+        if(fieldSize >= 1 && scratch.at(fieldOffset + fieldSize - 1) == '"')
+            --fieldSize;
+    }
+
+    scratchFields.append(qMakePair(fields.size(), fieldOffset));
+    fields.append(CSVField(nullptr, fieldSize));
+}
@@ -0,0 +1,149 @@
+#ifndef CSVSTREAMREADER_H
+#define CSVSTREAMREADER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Streaming CSV reader that works directly on the bytes of a memory-mapped file
+// Rows are handed to a callback one at a time and every field is a view into the mapped bytes, i.e., nothing is copied until a field is converted
+// The quote and line semantics are the same as in CSVReaderWriter::parseCSVFile: a quote protects delimiters up to the end of the line, doubled quotes are un-escaped, and the enclosing quotes and whitespace around a field are removed
+
+#include <QByteArray>
+#include <QPair>
+#include <QVector>
+
+#include <functional>
+
+class QString;
+class QStringList;
+
+class CSVField
+{
+public:
+    CSVField() = default;
+    CSVField(const char* data, int size) : fieldData(data), fieldSize(size) {}
+
+    const char* data() const { return fieldData; }
+    int size() const { return fieldSize; }
+    bool isEmpty() const { return fieldSize == 0; }
+
+    // The numbers are only parsed when they are asked for
+    double toDouble(bool* ok = nullptr) const;
+    int toInt(bool* ok = nullptr) const;
+    qint64 toLongLong(bool* ok = nullptr) const;
+
+    QString toString() const;
+
+    // Deep copy of the field bytes
+    QByteArray toByteArray() const;
+
+    // Compares the field to a null-terminated string without converting to a QString
+    bool equals(const char* str) const;
+
+private:
+
+    // Wraps the view without copying; Qt makes a null-terminated copy internally only when a number is parsed
+    QByteArray rawData() const { return QByteArray::fromRawData(fieldData, fieldSize); }
+
+    const char* fieldData = nullptr;
+    int fieldSize = 0;
+};
+
+
+class CSVRow
+{
+public:
+    explicit CSVRow(const QVector<CSVField>& fields) : rowFields(fields) {}
+
+    int size() const { return rowFields.size(); }
+    bool empty() const { return rowFields.isEmpty(); }
+
+    const CSVField& at(int i) const { return rowFields.at(i); }
+    const CSVField& operator[](int i) const { return rowFields.at(i); }
+
+    QVector<CSVField>::const_iterator begin() const { return rowFields.cbegin(); }
+    QVector<CSVField>::const_iterator end() const { return rowFields.cend(); }
+
+    // Converts the row into the string list that CSVReaderWriter::parseCSVFile returns
+    QStringList toStringList() const;
+
+private:
+    const QVector<CSVField>& rowFields;
+};
+
+
+class CSVStreamReader
+{
+public:
+
+    // Called once per row with the zero-based row index (the header is row 0)
+    // The row and its fields are only valid for the duration of the call, return false to stop reading
+    using RowCallback = std::function<bool(const CSVRow& row, int rowIndex)>;
+
+    explicit CSVStreamReader(char delimiter = ',');
+
+    // Maps the file into memory and streams it row by row; returns 0 on success and -1 on failure with the message in err
+    int parseFile(const QString& pathToFile, const RowCallback& callback, QString& err);
+
+    // Streams the rows of a buffer that is already in memory
+    int parseBuffer(const char* data, qint64 size, const RowCallback& callback, QString& err);
+
+    // The number of rows that were handed to the callback in the last parse
+    int numRowsParsed(void) const;
+
+    // The number of bytes read up to the end of the current row, e.g., to report the progress from within the callback
+    qint64 bytesParsed(void) const;
+
+private:
+
+    // Returns the position of the next delimiter, quote, or line feed at or after pos, or end if there is none
+    qint64 scanToSpecial(const char* data, qint64 pos, qint64 end) const;
+
+    void addField(const char* data, qint64 start, qint64 end, bool hasQuote);
+
+    char delimiter;
+
+    int numRows = 0;
+    qint64 numBytes = 0;
+
+    QVector<CSVField> fields;
+
+    // Fields that contain quotes are un-escaped into this buffer
+    // Pairs of (field index, offset into the buffer) that are resolved into views once the row is complete, since the buffer may reallocate while the row grows
+    QByteArray scratch;
+    QVector<QPair<int, int>> scratchFields;
+};
+
+#endif // CSVSTREAMREADER_H
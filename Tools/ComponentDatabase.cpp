@@ -42,6 +42,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <qgsfeature.h>
 #include <qgsfeaturerequest.h>
 
+#include <algorithm>
+
 ComponentDatabase::ComponentDatabase(QString type) : offset(0), componentType(type)
 {
     messageHandler = ProgramOutputDialog::getInstance();
@@ -63,7 +65,8 @@ bool ComponentDatabase::isEmpty(void)
 void ComponentDatabase::clear(void)
 {
     mainLayer = nullptr;
-    selectedFeaturesSet.clear();
+    selectedIDs.clear();
+    selectedLayerFids.clear();
     offset = 0;
     selectedLayer = nullptr;
 }
@@ -120,36 +123,59 @@ void ComponentDatabase::setSelectedLayer(QgsVectorLayer *value)
 }
 
 
-bool ComponentDatabase::addFeaturesToSelectedLayer(const std::set<int> ids)
+bool ComponentDatabase::addFeaturesToSelectedLayer(const ComponentIDSet& ids)
 {
-    if(!selectedFeaturesSet.isEmpty())
-    {
-        selectedFeaturesSet.clear();
+    if(!selectedIDs.isEmpty())
         this->clearSelectedLayer();
-    }
-
-    selectedFeaturesSet.reserve(ids.size());
-
-    for(auto&& id : ids)
-        selectedFeaturesSet.insert(id+offset);
-
-    auto featIt = mainLayer->getFeatures(selectedFeaturesSet);
 
     QgsFeatureList featList;
     featList.reserve(ids.size());
 
     QgsFeature feat;
-    while (featIt.nextFeature(feat))
+
+    // Scan the main layer once when the selection covers a large part of it, e.g., a whole region, otherwise request only the selected features
+    if(ids.size()*4 >= mainLayer->featureCount())
+    {
+        auto featIt = mainLayer->getFeatures();
+
+        while (featIt.nextFeature(feat))
+        {
+            if(ids.contains(feat.id()-offset))
+                featList.push_back(feat);
+        }
+    }
+    else
     {
-        auto id = feat.id();
-        featList.push_back(feat);
+        QgsFeatureIds fids;
+        fids.reserve(ids.size());
+
+        for(auto&& id : ids)
+            fids.insert(id+offset);
+
+        auto featIt = mainLayer->getFeatures(fids);
+
+        while (featIt.nextFeature(feat))
+            featList.push_back(feat);
     }
 
     if(featList.size() != ids.size())
         return false;
 
+    // Keep the selected layer in the order of the component IDs
+    std::sort(featList.begin(), featList.end(), [](const QgsFeature& a, const QgsFeature& b){ return a.id() < b.id(); });
+
     auto res = selectedLayer->dataProvider()->addFeatures(featList, QgsFeatureSink::FastInsert);
 
+    if(!res)
+        return false;
+
+    // The provider sets the ids that the features were given in the selected layer
+    selectedLayerFids.clear();
+    for(auto&& it : featList)
+        this->appendSelectedLayerFid(it.id());
+
+    selectedIDs = ids;
+
     selectedLayer->updateExtents();
 
     return res;
@@ -158,26 +184,22 @@ bool ComponentDatabase::addFeaturesToSelectedLayer(const std::set<int> ids)
 
 bool ComponentDatabase::addFeatureToSelectedLayer(const int id)
 {
-    auto fid = id+offset;
-
-    if(selectedFeaturesSet.contains(fid))
+    if(selectedIDs.contains(id))
         return true;
 
-    auto feature = this->getFeature(fid);
+    auto feature = this->getFeature(id);
     if(feature.isValid() == false)
     {
         messageHandler->appendErrorMessage("Error getting the feature from the database");
         return false;
     }
 
-    return this->addFeatureToSelectedLayer(feature);
+    return this->addFeatureToSelectedLayer(id, feature);
 }
 
 
-bool ComponentDatabase::addFeatureToSelectedLayer(QgsFeature& feature)
+bool ComponentDatabase::addFeatureToSelectedLayer(const int id, QgsFeature& feature)
 {
-    auto fid = feature.id();
-
     auto res = selectedLayer->dataProvider()->addFeature(feature, QgsFeatureSink::FastInsert);
 
     // auto res = selectedLayer->addFeature(feature/*, QgsFeatureSink::FastInsert*/);
@@ -188,7 +210,28 @@ bool ComponentDatabase::addFeatureToSelectedLayer(QgsFeature& feature)
         return false;
     }
 
-    selectedFeaturesSet.insert(fid);
+    selectedIDs.insert(id);
+
+    // Rebuild the runs with the new feature id at the position of its component, a single feature is only added interactively
+    const auto insertIndex = selectedIDs.indexOf(id);
+    const auto oldRuns = selectedLayerFids;
+
+    selectedLayerFids.clear();
+
+    qint64 index = 0;
+    for(auto&& run : oldRuns)
+    {
+        for(qint64 i = 0; i<run.count; ++i, ++index)
+        {
+            if(index == insertIndex)
+                this->appendSelectedLayerFid(feature.id());
+
+            this->appendSelectedLayerFid(run.firstFid + i);
+        }
+    }
+
+    if(index == insertIndex)
+        this->appendSelectedLayerFid(feature.id());
 
     return true;
 }
@@ -200,22 +243,71 @@ void ComponentDatabase::setOffset(int value)
 }
 
 
+const ComponentIDSet& ComponentDatabase::getSelectedIDs() const
+{
+    return selectedIDs;
+}
+
+
 bool ComponentDatabase::removeFeaturesFromSelectedLayer(QgsFeatureIds& featureIds)
 {
     auto res = selectedLayer->dataProvider()->deleteFeatures(featureIds);
 
+    if(!res)
+        return res;
+
+    QVector<int> keptIDs;
+
+    const auto oldRuns = selectedLayerFids;
+    selectedLayerFids.clear();
+
+    auto idIt = selectedIDs.begin();
+    for(auto&& run : oldRuns)
+    {
+        for(qint64 i = 0; i<run.count; ++i, ++idIt)
+        {
+            auto fid = run.firstFid + i;
+
+            if(!featureIds.contains(fid))
+            {
+                keptIDs.push_back(*idIt);
+                this->appendSelectedLayerFid(fid);
+            }
+        }
+    }
+
+    selectedIDs.clear();
+    selectedIDs.insert(keptIDs);
+
     return res;
 }
 
 
 bool ComponentDatabase::clearSelectedLayer(void)
 {
+    selectedIDs.clear();
+    selectedLayerFids.clear();
+
     auto res = selectedLayer->dataProvider()->truncate();
 
     return res;
 }
 
 
+bool ComponentDatabase::changeSelectedAttributeValues(const QVector<QgsAttributeMap>& rows)
+{
+    QgsChangedAttributesMap changedAttributes;
+
+    for(auto&& run : selectedLayerFids)
+    {
+        for(qint64 i = 0; i<run.count && run.firstIndex + i < rows.size(); ++i)
+            changedAttributes.insert(run.firstFid + i, rows.at(static_cast<int>(run.firstIndex + i)));
+    }
+
+    return selectedLayer->dataProvider()->changeAttributeValues(changedAttributes);
+}
+
+
 bool ComponentDatabase::addNewComponentAttributes(const QStringList& fieldNames, const QVector<QgsAttributes>& values, QString& error)
 {
     if(selectedLayer == nullptr)
@@ -224,11 +316,11 @@ bool ComponentDatabase::addNewComponentAttributes(const QStringList& fieldNames,
         return false;
     }
 
-    auto numSelectedFeatures = selectedFeaturesSet.size();
+    auto numSelectedFeatures = selectedIDs.size();
 
     auto numFeatSelLayer = selectedLayer->featureCount();
 
-    if(values.size() != numSelectedFeatures || numSelectedFeatures != numFeatSelLayer)
+    if(values.size() != numSelectedFeatures || numSelectedFeatures != numFeatSelLayer || this->numSelectedLayerFids() != numSelectedFeatures)
     {
         error = "Error, the number of assets in the imported data ("+QString::number(values.size())+ ") should be equal to the number of assets in the 'selected assets layer' (" + QString::number(numSelectedFeatures)+ "). /n Failed to batch add new attributes. Please ensure all assets are loaded and added to the selected features layer in the input file stage.";
         return false;
@@ -251,80 +343,65 @@ bool ComponentDatabase::addNewComponentAttributes(const QStringList& fieldNames,
         return false;
     }
 
+    auto provider = selectedLayer->dataProvider();
 
-    QgsFields existingFields = selectedLayer->dataProvider()->fields();
-
+    // Only add the fields that are not already in the layer, e.g., from a previous import of the results
+    QList<QgsField> newFields;
     for(int i = 0; i <numNewFields; ++i)
-        existingFields.append(QgsField(fieldNames[i], firstRow.at(i).type()));
-
-
-    QgsFeatureRequest featRequest (selectedFeaturesSet);
-
-    // All this just to get the feature request to return everything with ascending ids
-    QgsFeatureRequest::OrderByClause orderByClause(QString("id"),true);
-    QList<QgsFeatureRequest::OrderByClause> obcList = {orderByClause};
-    QgsFeatureRequest::OrderBy orderBy(obcList);
-    featRequest.setOrderBy(orderBy);
-
-    auto featIt = mainLayer->getFeatures(featRequest);
-
-    QgsFeatureList featList;
-    featList.reserve(values.size());
-
-    int count = 0;
-    QgsFeature feat;
-    while (featIt.nextFeature(feat))
     {
-        auto existingAtrb = feat.attributes();
-
-        // auto id = feat.id();
-        feat.setFields(existingFields, true);
-
-        auto newAtrb = values[count];
+        if(provider->fieldNameIndex(fieldNames[i]) == -1)
+            newFields.append(QgsField(fieldNames[i], firstRow.at(i).type()));
+    }
 
-        existingAtrb.append(newAtrb);
+    if(!newFields.isEmpty())
+    {
+        auto res = provider->addAttributes(newFields);
 
-        // The number of provided attributes need to exactly match the number of the feature's fields.
-        feat.setAttributes(existingAtrb);
+        if(!res)
+        {
+            error = "Error adding attributes to the layer" + selectedLayer->name();
+            return false;
+        }
 
-        featList.push_back(feat);
-        ++count;
+        selectedLayer->updateFields(); // tell the vector layer to fetch changes from the provider
     }
 
-    if(values.size() != featList.size())
+    QVector<int> fieldIndices(numNewFields);
+    for(int i = 0; i <numNewFields; ++i)
     {
-        error = "Error, inconsist sizes of values to update and number of updated features. Please contact developers. Could not add fields to "+selectedLayer->name();
-        return false;
-    }
+        fieldIndices[i] = provider->fieldNameIndex(fieldNames[i]);
 
-    auto res = selectedLayer->dataProvider()->truncate();
+        if(fieldIndices[i] == -1)
+        {
+            error = "Error, failed to find the field "+fieldNames[i]+" after adding it to "+selectedLayer->name();
+            return false;
+        }
+    }
 
-    if(!res)
+    // The values are given in the ascending order of the component IDs, which is the order of the features in the selected layer
+    QVector<QgsAttributeMap> rows(values.size());
+    for(int row = 0; row<values.size(); ++row)
     {
-        error = "Error, failed to remove existing features in the 'Selected Asset Layer' data provider. Please contact developers. Could not add fields to "+selectedLayer->name();
-        return false;
-    }
+        auto&& rowValues = values.at(row);
 
-    res = selectedLayer->dataProvider()->addAttributes(existingFields.toList());
+        if(rowValues.size() != numNewFields)
+        {
+            error = "Error, the number of values must match the number of fields";
+            return false;
+        }
 
-    if(!res)
-    {
-         error = "Error adding attributes to the layer" + selectedLayer->name();
-         return false;
+        for(int i = 0; i <numNewFields; ++i)
+            rows[row].insert(fieldIndices.at(i), rowValues.at(i));
     }
 
-    selectedLayer->updateFields(); // tell the vector layer to fetch changes from the provider
-
-    res = selectedLayer->dataProvider()->addFeatures(featList);
+    auto res = this->changeSelectedAttributeValues(rows);
 
     if(!res)
     {
-        error = "Error, failed to add features to the 'Selected Asset Layer' data provider. Please contact developers. Could not add fields to "+selectedLayer->name();
+        error = "Error, failed to change the attribute values in the 'Selected Asset Layer' data provider. Please contact developers. Could not add fields to "+selectedLayer->name();
         return false;
     }
 
-    selectedLayer->updateExtents();
-
     return res;
 }
 
@@ -338,11 +415,11 @@ bool ComponentDatabase::updateComponentAttributes(const QString& fieldName, cons
         return false;
     }
 
-    auto numSelectedFeatures = selectedFeaturesSet.size();
+    auto numSelectedFeatures = selectedIDs.size();
 
     auto numFeatSelLayer = selectedLayer->featureCount();
 
-    if(values.size() != numSelectedFeatures || numSelectedFeatures != numFeatSelLayer)
+    if(values.size() != numSelectedFeatures || numSelectedFeatures != numFeatSelLayer || this->numSelectedLayerFids() != numSelectedFeatures)
     {
         error = "Error, the number of assets in the imported data ("+QString::number(values.size())+ ") should be equal to the number of assets in the 'selected assets layer' (" + QString::number(numSelectedFeatures)+ "). /n Failed to batch update attribute: "+fieldName+". Please ensure all assets are loaded and added to the selected features layer in the input file stage.";
         return false;
@@ -356,56 +433,19 @@ bool ComponentDatabase::updateComponentAttributes(const QString& fieldName, cons
         return false;
     }
 
-    QgsFeatureRequest featRequest (selectedFeaturesSet);
-
-    // All this just to get the feature request to return everything with ascending ids
-    QgsFeatureRequest::OrderByClause orderByClause(QString("id"),true);
-    QList<QgsFeatureRequest::OrderByClause> obcList = {orderByClause};
-    QgsFeatureRequest::OrderBy orderBy(obcList);
-    featRequest.setOrderBy(orderBy);
+    // The values are given in the ascending order of the component IDs, which is the order of the features in the selected layer
+    QVector<QgsAttributeMap> rows(values.size());
+    for(int row = 0; row<values.size(); ++row)
+        rows[row].insert(field, values.at(row));
 
-    auto featIt = mainLayer->getFeatures(featRequest);
-
-    QgsFeatureList featList;
-    featList.reserve(values.size());
-
-    int count = 0;
-    QgsFeature feat;
-    while (featIt.nextFeature(feat))
-    {
-        // auto id = feat.id();
-        auto attrb = values[count];
-
-        feat.setAttribute(field,attrb);
-
-        featList.push_back(feat);
-        ++count;
-    }
-
-    if(values.size() != featList.size())
-    {
-        error = "Error, inconsist sizes of values to update and number of updated features. Please contact developers. Could not batch update field: "+fieldName;
-        return false;
-    }
-
-    auto res = selectedLayer->dataProvider()->truncate();
+    auto res = this->changeSelectedAttributeValues(rows);
 
     if(!res)
     {
-        error = "Error, failed to remove existing features in the 'Selected Asset Layer' data provider. Please contact developers. Could not batch update field: "+fieldName;
+        error = "Error, failed to change the attribute values in the 'Selected Asset Layer' data provider. Please contact developers. Could not batch update field: "+fieldName;
         return false;
     }
 
-    res = selectedLayer->dataProvider()->addFeatures(featList);
-
-    if(!res)
-    {
-        error = "Error, failed to add features to the 'Selected Asset Layer' data provider. Please contact developers. Could not batch update field: "+fieldName;
-        return false;
-    }
-
-    selectedLayer->updateExtents();
-
     return res;
 }
 
@@ -432,13 +472,19 @@ bool ComponentDatabase::updateComponentAttribute(const qint64 id, const QString&
     // Update the selected layer if there is one...
     if(selectedLayer != nullptr)
     {
-        auto fidSel = selectedFeaturesSet.values().indexOf(id);
+        auto index = selectedIDs.indexOf(id);
 
         // Still return true if feature is not in the set
-        if(fidSel == -1)
+        if(index == -1)
             return true;
 
-        auto res2 = selectedLayer->changeAttributeValue(fidSel,field,value);
+        QgsAttributeMap attributeMap;
+        attributeMap.insert(field, value);
+
+        QgsChangedAttributesMap changedAttributes;
+        changedAttributes.insert(this->selectedLayerFid(index), attributeMap);
+
+        auto res2 = selectedLayer->dataProvider()->changeAttributeValues(changedAttributes);
 
         if(!res2)
             return res2;
@@ -466,3 +512,45 @@ QVariant ComponentDatabase::getAttributeValue(const qint64 id, const QString& at
 
     return val;
 }
+
+
+QgsFeatureId ComponentDatabase::selectedLayerFid(const qint64 index) const
+{
+    auto run = std::upper_bound(selectedLayerFids.begin(), selectedLayerFids.end(), index, [](const qint64 value, const FidRun& run){ return value < run.firstIndex; });
+
+    if(run == selectedLayerFids.begin())
+        return FID_NULL;
+
+    --run;
+
+    if(index >= run->firstIndex + run->count)
+        return FID_NULL;
+
+    return run->firstFid + (index - run->firstIndex);
+}
+
+
+qint64 ComponentDatabase::numSelectedLayerFids(void) const
+{
+    if(selectedLayerFids.isEmpty())
+        return 0;
+
+    return selectedLayerFids.last().firstIndex + selectedLayerFids.last().count;
+}
+
+
+void ComponentDatabase::appendSelectedLayerFid(const QgsFeatureId fid)
+{
+    if(!selectedLayerFids.isEmpty())
+    {
+        auto& last = selectedLayerFids.last();
+
+        if(last.firstFid + last.count == fid)
+        {
+            ++last.count;
+            return;
+        }
+    }
+
+    selectedLayerFids.push_back(FidRun{this->numSelectedLayerFids(), fid, 1});
+}
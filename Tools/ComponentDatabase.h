@@ -38,6 +38,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "ComponentIDSet.h"
+
 #include <QMap>
 #include <QVariant>
 
@@ -45,8 +47,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <qgsattributes.h>
 #include <qgsvectorlayer.h>
 
-#include <set>
-
 class ProgramOutputDialog;
 
 class QgsFeature;
@@ -63,7 +63,7 @@ public:
     void startEditing(void);
 
     // Fast, use for batch feature addition
-    bool addFeaturesToSelectedLayer(const std::set<int> ids);
+    bool addFeaturesToSelectedLayer(const ComponentIDSet& ids);
 
     // Slow, only use for adding indvidual features when needed
     bool addFeatureToSelectedLayer(const int id);
@@ -97,13 +97,40 @@ public:
 
     void setOffset(int value);
 
+    const ComponentIDSet& getSelectedIDs() const;
+
 private:
     ProgramOutputDialog* messageHandler;
 
-    bool addFeatureToSelectedLayer(QgsFeature& feature);
+    bool addFeatureToSelectedLayer(const int id, QgsFeature& feature);
+
+    // Batch change of attribute values in the selected layer, the rows of the map are in the ascending order of the selected IDs
+    bool changeSelectedAttributeValues(const QVector<QgsAttributeMap>& rows);
+
+    // IDs of the components in the selected layer
+    ComponentIDSet selectedIDs;
+
+    // Run of selected components, consecutive in the ascending order of the component IDs, whose features have consecutive ids in the selected layer
+    struct FidRun
+    {
+        qint64 firstIndex;
+        QgsFeatureId firstFid;
+        qint64 count;
+    };
+
+    // The feature id in the selected layer of the selected component at a position in the ascending order of the IDs
+    QgsFeatureId selectedLayerFid(const qint64 index) const;
+
+    // The number of selected components that have a feature id
+    qint64 numSelectedLayerFids(void) const;
+
+    // Adds the feature id of the next selected component, extending the last run if the id follows on from it
+    void appendSelectedLayerFid(const QgsFeatureId fid);
 
-    // Selected feature set
-    QSet<long long> selectedFeaturesSet;
+    // The feature ids in the selected layer of the selected components, in the ascending order of the component IDs
+    // The provider numbers a batch of added features consecutively, so a selection that was added in one go is a single run
+    // Lets attribute updates change the selected features in place instead of rebuilding the layer
+    QVector<FidRun> selectedLayerFids;
 
     // Set of layers that this component may have features in
     QgsVectorLayer* mainLayer = nullptr;
@@ -0,0 +1,374 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "ComponentIDSet.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+ComponentIDSet::ComponentIDSet()
+{
+    counts.push_back(0);
+}
+
+
+int ComponentIDSet::parse(const QString& list, QString& err)
+{
+    auto text = list;
+
+    // Remove any white space from the string
+    text.remove(" ");
+
+    QVector<Range> parsedRuns;
+
+    // Split the incoming text into the parts delimited by commas
+    auto parts = text.split(",", QString::SkipEmptyParts);
+
+    parsedRuns.reserve(parts.size());
+
+    for(auto&& part : parts)
+    {
+        bool okStart = false;
+        bool okEnd = false;
+
+        int IDStart = 0;
+        int IDEnd = 0;
+
+        // Handle the case where there is a range of IDs separated by a '-'
+        auto pos = part.indexOf('-');
+        if(pos != -1)
+        {
+            IDStart = part.leftRef(pos).toInt(&okStart);
+            IDEnd = part.midRef(pos + 1).toInt(&okEnd);
+        }
+        else // ID is given individually
+        {
+            IDStart = part.toInt(&okStart);
+            IDEnd = IDStart;
+            okEnd = okStart;
+        }
+
+        if(!okStart || !okEnd)
+        {
+            err = "Error, could not convert '" + part + "' into an asset ID or a range of asset IDs";
+            return -1;
+        }
+
+        // Make sure that the end integer is greater than the first
+        if(IDStart > IDEnd)
+        {
+            err = "Error in the range of asset IDs provided in the Component asset selection box";
+            return -1;
+        }
+
+        parsedRuns.push_back({IDStart, IDEnd});
+    }
+
+    std::sort(parsedRuns.begin(), parsedRuns.end(), [](const Range& a, const Range& b){ return a.first < b.first; });
+
+    runs = merge(parsedRuns, QVector<Range>());
+
+    this->updateCounts();
+
+    return 0;
+}
+
+
+QString ComponentIDSet::toString(void) const
+{
+    QStringList parts;
+    parts.reserve(runs.size());
+
+    for(auto&& run : runs)
+    {
+        if(run.first == run.last)
+            parts.append(QString::number(run.first));
+        else
+            parts.append(QString::number(run.first) + "-" + QString::number(run.last));
+    }
+
+    return parts.join(",");
+}
+
+
+void ComponentIDSet::insert(const int id)
+{
+    this->insertRange(id, id);
+}
+
+
+void ComponentIDSet::insertRange(const int first, const int last)
+{
+    if(first > last)
+        return;
+
+    QVector<Range> newRun = {{first, last}};
+
+    runs = merge(runs, newRun);
+
+    this->updateCounts();
+}
+
+
+void ComponentIDSet::insert(const QVector<int>& ids)
+{
+    if(ids.isEmpty())
+        return;
+
+    auto sortedIds = ids;
+    std::sort(sortedIds.begin(), sortedIds.end());
+
+    // Collapse the sorted IDs into runs before merging them in
+    QVector<Range> newRuns;
+
+    Range run = {sortedIds.first(), sortedIds.first()};
+    for(auto&& id : sortedIds)
+    {
+        if(static_cast<qint64>(id) <= static_cast<qint64>(run.last) + 1)
+        {
+            run.last = std::max(run.last, id);
+        }
+        else
+        {
+            newRuns.push_back(run);
+            run = {id, id};
+        }
+    }
+    newRuns.push_back(run);
+
+    runs = merge(runs, newRuns);
+
+    this->updateCounts();
+}
+
+
+void ComponentIDSet::unite(const ComponentIDSet& other)
+{
+    runs = merge(runs, other.runs);
+
+    this->updateCounts();
+}
+
+
+void ComponentIDSet::intersect(const ComponentIDSet& other)
+{
+    QVector<Range> result;
+
+    int i = 0;
+    int j = 0;
+    while(i < runs.size() && j < other.runs.size())
+    {
+        auto&& a = runs.at(i);
+        auto&& b = other.runs.at(j);
+
+        auto first = std::max(a.first, b.first);
+        auto last = std::min(a.last, b.last);
+
+        if(first <= last)
+            result.push_back({first, last});
+
+        // Advance the run that ends first, the other one may still overlap the next run
+        if(a.last < b.last)
+            ++i;
+        else
+            ++j;
+    }
+
+    runs = result;
+
+    this->updateCounts();
+}
+
+
+ComponentIDSet ComponentIDSet::united(const ComponentIDSet& a, const ComponentIDSet& b)
+{
+    auto result = a;
+    result.unite(b);
+    return result;
+}
+
+
+ComponentIDSet ComponentIDSet::intersected(const ComponentIDSet& a, const ComponentIDSet& b)
+{
+    auto result = a;
+    result.intersect(b);
+    return result;
+}
+
+
+bool ComponentIDSet::contains(const int id) const
+{
+    return this->indexOf(id) != -1;
+}
+
+
+qint64 ComponentIDSet::indexOf(const int id) const
+{
+    // Find the first run that ends at or after the ID
+    auto it = std::lower_bound(runs.cbegin(), runs.cend(), id, [](const Range& run, const int val){ return run.last < val; });
+
+    if(it == runs.cend() || it->first > id)
+        return -1;
+
+    auto runIndex = std::distance(runs.cbegin(), it);
+
+    return counts.at(runIndex) + (id - it->first);
+}
+
+
+int ComponentIDSet::at(const qint64 index) const
+{
+    // Find the run that holds the position, i.e., the last run with fewer IDs in front of it than the index
+    auto it = std::upper_bound(counts.cbegin(), counts.cend() - 1, index);
+
+    auto runIndex = std::distance(counts.cbegin(), it) - 1;
+
+    return static_cast<int>(runs.at(runIndex).first + (index - counts.at(runIndex)));
+}
+
+
+void ComponentIDSet::clear(void)
+{
+    runs.clear();
+
+    this->updateCounts();
+}
+
+
+bool ComponentIDSet::isEmpty(void) const
+{
+    return runs.isEmpty();
+}
+
+
+qint64 ComponentIDSet::size(void) const
+{
+    return counts.last();
+}
+
+
+int ComponentIDSet::first(void) const
+{
+    return runs.first().first;
+}
+
+
+int ComponentIDSet::last(void) const
+{
+    return runs.last().last;
+}
+
+
+const QVector<ComponentIDSet::Range>& ComponentIDSet::ranges(void) const
+{
+    return runs;
+}
+
+
+ComponentIDSet::const_iterator ComponentIDSet::begin(void) const
+{
+    return const_iterator(runs.constData(), runs.constData() + runs.size());
+}
+
+
+ComponentIDSet::const_iterator ComponentIDSet::end(void) const
+{
+    return const_iterator(runs.constData() + runs.size(), runs.constData() + runs.size());
+}
+
+
+bool ComponentIDSet::operator==(const ComponentIDSet& other) const
+{
+    if(runs.size() != other.runs.size())
+        return false;
+
+    for(int i = 0; i < runs.size(); ++i)
+    {
+        if(runs.at(i).first != other.runs.at(i).first || runs.at(i).last != other.runs.at(i).last)
+            return false;
+    }
+
+    return true;
+}
+
+
+bool ComponentIDSet::operator!=(const ComponentIDSet& other) const
+{
+    return !(*this == other);
+}
+
+
+void ComponentIDSet::updateCounts(void)
+{
+    counts.resize(runs.size() + 1);
+
+    qint64 count = 0;
+    for(int i = 0; i < runs.size(); ++i)
+    {
+        counts[i] = count;
+        count += static_cast<qint64>(runs.at(i).last) - runs.at(i).first + 1;
+    }
+
+    counts[runs.size()] = count;
+}
+
+
+QVector<ComponentIDSet::Range> ComponentIDSet::merge(const QVector<Range>& a, const QVector<Range>& b)
+{
+    QVector<Range> result;
+    result.reserve(a.size() + b.size());
+
+    int i = 0;
+    int j = 0;
+    while(i < a.size() || j < b.size())
+    {
+        // Take the run that starts first
+        Range next;
+        if(j == b.size() || (i < a.size() && a.at(i).first <= b.at(j).first))
+            next = a.at(i++);
+        else
+            next = b.at(j++);
+
+        // Extend the last run if the next one overlaps it or is adjacent to it
+        if(!result.isEmpty() && static_cast<qint64>(next.first) <= static_cast<qint64>(result.last().last) + 1)
+            result.last().last = std::max(result.last().last, next.last);
+        else
+            result.push_back(next);
+    }
+
+    return result;
+}
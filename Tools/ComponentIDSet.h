@@ -0,0 +1,161 @@
+#ifndef COMPONENTIDSET_H
+#define COMPONENTIDSET_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Set of component IDs stored as sorted, non-overlapping and non-adjacent runs of consecutive IDs
+// A selection such as "1-2000000" is a single run, so the memory and the cost of the set operations scale with the number of runs rather than the number of IDs
+
+#include <QString>
+#include <QVector>
+
+#include <iterator>
+
+class ComponentIDSet
+{
+public:
+
+    // Inclusive range of IDs [first, last]
+    struct Range
+    {
+        int first;
+        int last;
+    };
+
+    // Forward iterator over the individual IDs, in ascending order
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const_iterator(const Range* range, const Range* end) : range(range), end(end), id(range != end ? range->first : 0) {}
+
+        const int& operator*() const { return id; }
+
+        const_iterator& operator++()
+        {
+            if(id == range->last)
+            {
+                ++range;
+                id = range != end ? range->first : 0;
+            }
+            else
+                ++id;
+
+            return *this;
+        }
+
+        const_iterator operator++(int) { auto it = *this; ++(*this); return it; }
+
+        bool operator==(const const_iterator& other) const { return range == other.range && id == other.id; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        const Range* range;
+        const Range* end;
+        int id;
+    };
+
+    ComponentIDSet();
+
+    // Parses a list in the form 1,3,5-6,10,12,... where the entries may be in any order and may overlap
+    // Returns 0 on success and -1 on failure with the message in err, the set is left unchanged on failure
+    int parse(const QString& list, QString& err);
+
+    // Returns the set as a list in the form 1,3,5-6,10,12,...
+    QString toString(void) const;
+
+    void insert(const int id);
+
+    void insertRange(const int first, const int last);
+
+    void insert(const QVector<int>& ids);
+
+    // Union and intersection, both linear in the number of runs
+    void unite(const ComponentIDSet& other);
+
+    void intersect(const ComponentIDSet& other);
+
+    static ComponentIDSet united(const ComponentIDSet& a, const ComponentIDSet& b);
+
+    static ComponentIDSet intersected(const ComponentIDSet& a, const ComponentIDSet& b);
+
+    bool contains(const int id) const;
+
+    // Position of the ID in the ascending order of the set, or -1 if the ID is not in the set
+    qint64 indexOf(const int id) const;
+
+    // The ID at a position in the ascending order of the set
+    int at(const qint64 index) const;
+
+    void clear(void);
+
+    bool isEmpty(void) const;
+
+    // The number of IDs in the set
+    qint64 size(void) const;
+
+    // The smallest and the largest ID, the set must not be empty
+    int first(void) const;
+    int last(void) const;
+
+    const QVector<Range>& ranges(void) const;
+
+    const_iterator begin(void) const;
+    const_iterator end(void) const;
+
+    bool operator==(const ComponentIDSet& other) const;
+    bool operator!=(const ComponentIDSet& other) const;
+
+private:
+
+    // Rebuilds the running count of IDs in front of each run, called after every change to the runs
+    void updateCounts(void);
+
+    // Merges two sorted run lists
+    static QVector<Range> merge(const QVector<Range>& a, const QVector<Range>& b);
+
+    QVector<Range> runs;
+
+    // Number of IDs in all of the runs before run i, with the total at the end
+    QVector<qint64> counts;
+};
+
+#endif // COMPONENTIDSET_H
@@ -0,0 +1,102 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "ConcurrentTasks.h"
+
+#include <QFutureWatcher>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <exception>
+#include <numeric>
+
+void ConcurrentTasks::waitFor(const QFuture<void>& future, const std::function<void(int)>& progress, QEventLoop::ProcessEventsFlags flags)
+{
+    QFutureWatcher<void> watcher;
+    QEventLoop loop;
+
+    if(progress)
+        QObject::connect(&watcher, &QFutureWatcher<void>::progressValueChanged, &loop, progress);
+
+    QObject::connect(&watcher, &QFutureWatcher<void>::finished, &loop, &QEventLoop::quit);
+
+    watcher.setFuture(future);
+
+    if(!watcher.isFinished())
+        loop.exec(flags);
+
+    watcher.waitForFinished();
+}
+
+
+QString ConcurrentTasks::map(const int count, const std::function<void(int, QString&)>& task, const std::function<void(int)>& progress)
+{
+    QVector<int> indices(count);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    QVector<QString> errors(count);
+    QString* errorsData = errors.data();
+
+    auto runTask = [&task, errorsData](const int& i)
+    {
+        try
+        {
+            task(i, errorsData[i]);
+        }
+        catch(const QString& msg)
+        {
+            errorsData[i] = msg;
+        }
+        catch(const std::exception& e)
+        {
+            errorsData[i] = QString("Error: ") + e.what();
+        }
+        catch(...)
+        {
+            errorsData[i] = "Unknown error";
+        }
+    };
+
+    ConcurrentTasks::waitFor(QtConcurrent::map(indices, runTask), progress);
+
+    for(auto&& err : errors)
+    {
+        if(!err.isEmpty())
+            return err;
+    }
+
+    return QString();
+}
@@ -0,0 +1,60 @@
+#ifndef CONCURRENTTASKS_H
+#define CONCURRENTTASKS_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Runs work on the global thread pool from the GUI thread while the event loop keeps running, so that the interface repaints and shows the progress
+
+#include <QEventLoop>
+#include <QFuture>
+#include <QString>
+
+#include <functional>
+
+class ConcurrentTasks
+{
+public:
+
+    // Waits for the future with a nested event loop, progress is called in the calling thread with the progress value of the future
+    // By default the user input is held back until the future has finished, so that the action that started the work cannot be triggered again in the meantime
+    static void waitFor(const QFuture<void>& future, const std::function<void(int)>& progress = nullptr, QEventLoop::ProcessEventsFlags flags = QEventLoop::ExcludeUserInputEvents);
+
+    // Runs task(i, err) for every i in [0, count) in parallel and waits for it with waitFor, progress gets the number of finished tasks
+    // Every task has its own error slot and exceptions thrown by a task are stored in its slot; returns the first error in the order of the tasks, or an empty string
+    static QString map(const int count, const std::function<void(int, QString&)>& task, const std::function<void(int)>& progress = nullptr);
+};
+
+#endif // CONCURRENTTASKS_H
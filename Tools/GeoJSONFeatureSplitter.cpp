@@ -0,0 +1,764 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+#include "GeoJSONFeatureSplitter.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <cstring>
+
+namespace {
+
+inline bool isJsonSpace(const char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// The non-finite tokens and the strings that they are replaced with, the same strings that the results widget used to substitute before parsing
+struct NonFiniteToken
+{
+    const char* token;
+    qint64 length;
+    const char* replacement;
+};
+
+const NonFiniteToken nonFiniteTokens[] = {{"NaN", 3, "\"NaN\""},
+                                          {"Infinity", 8, "\"inf\""},
+                                          {"-Infinity", 9, "\"-inf\""}};
+
+const char featureCollectionHeader[] = "{\"type\": \"FeatureCollection\", \"features\": [\n";
+
+// The outputs are compared in blocks of this many bytes
+const qint64 compareBlockSize = 1 << 20;
+
+// True if the two files hold the same bytes
+bool sameContents(const QString& pathA, const QString& pathB)
+{
+    QFile fileA(pathA);
+    QFile fileB(pathB);
+
+    if(!fileA.open(QIODevice::ReadOnly) || !fileB.open(QIODevice::ReadOnly) || fileA.size() != fileB.size())
+        return false;
+
+    while(!fileA.atEnd())
+    {
+        const auto blockA = fileA.read(compareBlockSize);
+
+        if(blockA.isEmpty() || blockA != fileB.read(compareBlockSize))
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+
+GeoJSONFeatureSplitter::GeoJSONFeatureSplitter()
+{
+
+}
+
+
+GeoJSONFeatureSplitter::~GeoJSONFeatureSplitter()
+{
+    for(auto&& writer : writers)
+        delete writer.file;
+}
+
+
+int GeoJSONFeatureSplitter::splitFile(const QString& pathToFile, const QString& outputDirectory, QString& err)
+{
+    QFile file(pathToFile);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        err = "Cannot open the file: " + pathToFile;
+        return -1;
+    }
+
+    const auto fileSize = file.size();
+
+    // Map the file so that the features can be copied straight from the file bytes
+    uchar* mappedData = file.map(0, fileSize);
+
+    if(mappedData != nullptr)
+    {
+        auto res = this->splitBuffer(reinterpret_cast<const char*>(mappedData), fileSize, outputDirectory, err);
+
+        file.unmap(mappedData);
+
+        if(res != 0)
+            err += "\nFile: " + pathToFile;
+
+        return res;
+    }
+
+    // Some file systems do not support mapping, read the file into memory instead
+    const QByteArray fileData = file.readAll();
+
+    auto res = this->splitBuffer(fileData.constData(), fileData.size(), outputDirectory, err);
+
+    if(res != 0)
+        err += "\nFile: " + pathToFile;
+
+    return res;
+}
+
+
+int GeoJSONFeatureSplitter::splitBuffer(const char* buffer, qint64 size, const QString& outputDirectory, QString& err)
+{
+    data = buffer;
+    dataSize = size;
+    pos = 0;
+
+    outputDir = outputDirectory;
+    errorMessage.clear();
+    replacements.clear();
+    outputFiles.clear();
+    assetTypeToType.clear();
+    crsData.clear();
+    numFeatures = 0;
+
+    if(data == nullptr || dataSize <= 0)
+    {
+        err = "The GeoJSON file is empty";
+        return -1;
+    }
+
+    // Skip a UTF-8 byte order mark
+    if(dataSize >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+        pos = 3;
+
+    auto ok = this->parseCollection();
+
+    if(ok)
+        ok = this->closeWriters();
+
+    data = nullptr;
+    dataSize = 0;
+
+    if(!ok)
+    {
+        this->discardWriters();
+        err = errorMessage;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+QStringList GeoJSONFeatureSplitter::getFeatureTypes(void) const
+{
+    return outputFiles.keys();
+}
+
+
+QString GeoJSONFeatureSplitter::getOutputFile(const QString& type) const
+{
+    return outputFiles.value(type);
+}
+
+
+QMap<QString, QList<QString>> GeoJSONFeatureSplitter::getAssetTypeToType(void) const
+{
+    return assetTypeToType;
+}
+
+
+QJsonObject GeoJSONFeatureSplitter::getCRS(void) const
+{
+    if(crsData.isEmpty())
+        return QJsonObject();
+
+    return QJsonDocument::fromJson(crsData).object();
+}
+
+
+int GeoJSONFeatureSplitter::getNumFeatures(void) const
+{
+    return numFeatures;
+}
+
+
+bool GeoJSONFeatureSplitter::fail(const QString& msg)
+{
+    if(errorMessage.isEmpty())
+        errorMessage = "Error parsing GeoJSON: " + msg;
+
+    return false;
+}
+
+
+void GeoJSONFeatureSplitter::skipWhitespace(void)
+{
+    while(pos < dataSize && isJsonSpace(data[pos]))
+        ++pos;
+}
+
+
+bool GeoJSONFeatureSplitter::expect(const char c)
+{
+    this->skipWhitespace();
+
+    if(pos >= dataSize)
+        return this->fail("Unexpected end of the file, expected '" + QString(c) + "'");
+
+    if(data[pos] != c)
+        return this->fail("Expected '" + QString(c) + "' at offset " + QString::number(pos));
+
+    ++pos;
+
+    return true;
+}
+
+
+bool GeoJSONFeatureSplitter::parseString(QByteArray* value)
+{
+    if(pos >= dataSize || data[pos] != '"')
+        return this->fail("Expected a string at offset " + QString::number(pos));
+
+    const qint64 start = ++pos;
+
+    for(;;)
+    {
+        auto quote = static_cast<const char*>(std::memchr(data + pos, '"', static_cast<size_t>(dataSize - pos)));
+
+        if(quote == nullptr)
+            return this->fail("Unterminated string starting at offset " + QString::number(start - 1));
+
+        const qint64 quotePos = quote - data;
+
+        pos = quotePos + 1;
+
+        // The quote is escaped if it follows an odd number of backslashes
+        qint64 firstBackslash = quotePos;
+        while(firstBackslash > start && data[firstBackslash - 1] == '\\')
+            --firstBackslash;
+
+        if((quotePos - firstBackslash) % 2 == 0)
+            break;
+    }
+
+    if(value != nullptr)
+        *value = QByteArray(data + start, static_cast<int>(pos - 1 - start));
+
+    return true;
+}
+
+
+bool GeoJSONFeatureSplitter::skipNonFinite(void)
+{
+    for(auto&& it : nonFiniteTokens)
+    {
+        if(dataSize - pos >= it.length && std::memcmp(data + pos, it.token, static_cast<size_t>(it.length)) == 0)
+        {
+            replacements.append(Replacement{pos, pos + it.length, it.replacement});
+            pos += it.length;
+            return true;
+        }
+    }
+
+    return this->fail("Unexpected token at offset " + QString::number(pos));
+}
+
+
+bool GeoJSONFeatureSplitter::skipValue(void)
+{
+    if(pos >= dataSize)
+        return this->fail("Unexpected end of the file");
+
+    auto isNonFinite = [this](const qint64 i)
+    {
+        return data[i] == 'N' || data[i] == 'I' || (data[i] == '-' && i + 1 < dataSize && data[i + 1] == 'I');
+    };
+
+    const char c = data[pos];
+
+    if(c == '"')
+        return this->parseString(nullptr);
+
+    // Objects and arrays are skipped by counting the brackets, only the strings and the non-finite tokens need a closer look
+    if(c == '{' || c == '[')
+    {
+        int depth = 0;
+
+        while(pos < dataSize)
+        {
+            const char b = data[pos];
+
+            if(b == '"')
+            {
+                if(!this->parseString(nullptr))
+                    return false;
+
+                continue;
+            }
+
+            if(b == '{' || b == '[')
+            {
+                ++depth;
+            }
+            else if(b == '}' || b == ']')
+            {
+                --depth;
+
+                if(depth == 0)
+                {
+                    ++pos;
+                    return true;
+                }
+            }
+            else if(isNonFinite(pos))
+            {
+                if(!this->skipNonFinite())
+                    return false;
+
+                continue;
+            }
+
+            ++pos;
+        }
+
+        return this->fail("Unexpected end of the file");
+    }
+
+    if(isNonFinite(pos))
+        return this->skipNonFinite();
+
+    // Numbers and literals run up to the next structural character
+    const qint64 start = pos;
+
+    while(pos < dataSize && !isJsonSpace(data[pos]) && data[pos] != ',' && data[pos] != '}' && data[pos] != ']')
+        ++pos;
+
+    if(pos == start)
+        return this->fail("Unexpected character at offset " + QString::number(pos));
+
+    return true;
+}
+
+
+bool GeoJSONFeatureSplitter::parseCollection(void)
+{
+    if(!this->expect('{'))
+        return false;
+
+    bool hasType = false;
+
+    this->skipWhitespace();
+
+    if(pos < dataSize && data[pos] == '}')
+        return this->fail("The Json object is missing the 'type' key that defines the asset type");
+
+    for(;;)
+    {
+        this->skipWhitespace();
+
+        QByteArray key;
+        if(!this->parseString(&key) || !this->expect(':'))
+            return false;
+
+        this->skipWhitespace();
+
+        if(key == "features")
+        {
+            if(!this->expect('['))
+                return false;
+
+            this->skipWhitespace();
+
+            if(pos < dataSize && data[pos] == ']')
+            {
+                ++pos;
+            }
+            else
+            {
+                for(;;)
+                {
+                    if(!this->parseFeature())
+                        return false;
+
+                    this->skipWhitespace();
+
+                    if(pos >= dataSize)
+                        return this->fail("Unexpected end of the file in the features array");
+
+                    const char c = data[pos++];
+
+                    if(c == ']')
+                        break;
+
+                    if(c != ',')
+                        return this->fail("Expected ',' or ']' at offset " + QString::number(pos - 1));
+                }
+            }
+        }
+        else if(key == "crs")
+        {
+            const qint64 start = pos;
+
+            if(!this->skipValue())
+                return false;
+
+            this->appendSpan(crsData, start, pos);
+        }
+        else
+        {
+            if(key == "type")
+                hasType = true;
+
+            if(!this->skipValue())
+                return false;
+        }
+
+        replacements.clear();
+
+        this->skipWhitespace();
+
+        if(pos >= dataSize)
+            return this->fail("Unexpected end of the file");
+
+        const char c = data[pos++];
+
+        if(c == '}')
+            break;
+
+        if(c != ',')
+            return this->fail("Expected ',' or '}' at offset " + QString::number(pos - 1));
+    }
+
+    if(!hasType)
+        return this->fail("The Json object is missing the 'type' key that defines the asset type");
+
+    return true;
+}
+
+
+bool GeoJSONFeatureSplitter::parseFeature(void)
+{
+    this->skipWhitespace();
+
+    if(pos >= dataSize || data[pos] != '{')
+        return this->fail("Expected a feature object at offset " + QString::number(pos));
+
+    const qint64 start = pos++;
+
+    QString type;
+    QString assetType;
+
+    this->skipWhitespace();
+
+    if(pos < dataSize && data[pos] == '}')
+    {
+        ++pos;
+    }
+    else
+    {
+        for(;;)
+        {
+            this->skipWhitespace();
+
+            QByteArray key;
+            if(!this->parseString(&key) || !this->expect(':'))
+                return false;
+
+            this->skipWhitespace();
+
+            if(key == "properties" && pos < dataSize && data[pos] == '{')
+            {
+                if(!this->parseProperties(type, assetType))
+                    return false;
+            }
+            else if(!this->skipValue())
+            {
+                return false;
+            }
+
+            this->skipWhitespace();
+
+            if(pos >= dataSize)
+                return this->fail("Unexpected end of the file in a feature");
+
+            const char c = data[pos++];
+
+            if(c == '}')
+                break;
+
+            if(c != ',')
+                return this->fail("Expected ',' or '}' at offset " + QString::number(pos - 1));
+        }
+    }
+
+    // type is Bridge/Tunnel/Road
+    if(type.isEmpty())
+        type = "Building";
+
+    // assetType is Transportation Network
+    auto& typesList = assetTypeToType[assetType];
+    if(!typesList.contains(type))
+        typesList.append(type);
+
+    if(!this->writeFeature(type, start, pos))
+        return false;
+
+    replacements.clear();
+
+    ++numFeatures;
+
+    return true;
+}
+
+
+bool GeoJSONFeatureSplitter::parseProperties(QString& type, QString& assetType)
+{
+    // Step over the opening bracket
+    ++pos;
+
+    this->skipWhitespace();
+
+    if(pos < dataSize && data[pos] == '}')
+    {
+        ++pos;
+        return true;
+    }
+
+    for(;;)
+    {
+        this->skipWhitespace();
+
+        QByteArray key;
+        if(!this->parseString(&key) || !this->expect(':'))
+            return false;
+
+        this->skipWhitespace();
+
+        const bool isType = key == "type";
+
+        if((isType || key == "assetType") && pos < dataSize && data[pos] == '"')
+        {
+            QByteArray value;
+            if(!this->parseString(&value))
+                return false;
+
+            if(isType)
+                type = this->decodeString(value);
+            else
+                assetType = this->decodeString(value);
+        }
+        else if(!this->skipValue())
+        {
+            return false;
+        }
+
+        this->skipWhitespace();
+
+        if(pos >= dataSize)
+            return this->fail("Unexpected end of the file in the feature properties");
+
+        const char c = data[pos++];
+
+        if(c == '}')
+            return true;
+
+        if(c != ',')
+            return this->fail("Expected ',' or '}' at offset " + QString::number(pos - 1));
+    }
+}
+
+
+QString GeoJSONFeatureSplitter::decodeString(const QByteArray& raw) const
+{
+    if(!raw.contains('\\'))
+        return QString::fromUtf8(raw);
+
+    // Let Qt deal with the escape sequences, this is rare enough that the small document does not matter
+    auto doc = QJsonDocument::fromJson("[\"" + raw + "\"]");
+
+    return doc.array().at(0).toString();
+}
+
+
+void GeoJSONFeatureSplitter::appendSpan(QByteArray& out, const qint64 start, const qint64 end) const
+{
+    qint64 from = start;
+
+    for(auto&& it : replacements)
+    {
+        if(it.start < start || it.end > end)
+            continue;
+
+        out.append(data + from, static_cast<int>(it.start - from));
+        out.append(it.text);
+        from = it.end;
+    }
+
+    out.append(data + from, static_cast<int>(end - from));
+}
+
+
+bool GeoJSONFeatureSplitter::writeSpan(QFile* file, const qint64 start, const qint64 end)
+{
+    qint64 from = start;
+
+    bool ok = true;
+
+    for(auto&& it : replacements)
+    {
+        if(it.start < start || it.end > end)
+            continue;
+
+        ok = ok && file->write(data + from, it.start - from) != -1;
+        ok = ok && file->write(it.text) != -1;
+        from = it.end;
+    }
+
+    ok = ok && file->write(data + from, end - from) != -1;
+
+    if(!ok)
+        return this->fail("Error writing to the file " + file->fileName());
+
+    return true;
+}
+
+
+bool GeoJSONFeatureSplitter::writeFeature(const QString& type, const qint64 start, const qint64 end)
+{
+    auto it = writers.find(type);
+
+    if(it == writers.end())
+    {
+        auto outputFile = QDir(outputDir).filePath(type + ".geojson");
+
+        // Written next to the output first, the output is only replaced once the collection is complete and has changed
+        auto file = new QFile(outputFile + ".part");
+
+        if(!file->open(QFile::WriteOnly | QFile::Truncate))
+        {
+            delete file;
+            return this->fail("Error creating the output file " + outputFile);
+        }
+
+        outputFiles.insert(type, outputFile);
+
+        TypeWriter writer;
+        writer.file = file;
+        writer.outputFile = outputFile;
+
+        it = writers.insert(type, writer);
+
+        file->write(featureCollectionHeader);
+    }
+
+    auto& writer = it.value();
+
+    if(writer.numFeatures > 0)
+        writer.file->write(",\n");
+
+    if(!this->writeSpan(writer.file, start, end))
+        return false;
+
+    ++writer.numFeatures;
+
+    return true;
+}
+
+
+bool GeoJSONFeatureSplitter::closeWriters(void)
+{
+    // The crs may come after the features in the input, so it is written at the end of each collection
+    QByteArray footer = "\n]";
+
+    if(!crsData.isEmpty())
+        footer += ", \"crs\": " + crsData;
+
+    footer += "}\n";
+
+    bool ok = true;
+
+    for(auto&& writer : writers)
+    {
+        const auto partFile = writer.file->fileName();
+
+        ok = ok && writer.file->write(footer) == footer.size();
+        writer.file->close();
+
+        delete writer.file;
+
+        // An unchanged output keeps its modification time, which is what the results cache checks before it reuses its columns
+        if(ok && sameContents(partFile, writer.outputFile))
+        {
+            QFile::remove(partFile);
+        }
+        else if(ok)
+        {
+            QFile::remove(writer.outputFile);
+            ok = QFile::rename(partFile, writer.outputFile);
+        }
+        else
+        {
+            QFile::remove(partFile);
+        }
+    }
+
+    writers.clear();
+
+    if(!ok)
+        return this->fail("Error writing the output files");
+
+    return true;
+}
+
+
+void GeoJSONFeatureSplitter::discardWriters(void)
+{
+    for(auto&& writer : writers)
+        delete writer.file;
+
+    writers.clear();
+
+    for(auto&& it : outputFiles)
+        QFile::remove(it + ".part");
+
+    outputFiles.clear();
+    assetTypeToType.clear();
+    numFeatures = 0;
+}
@@ -0,0 +1,142 @@
+#ifndef GEOJSONFEATURESPLITTER_H
+#define GEOJSONFEATURESPLITTER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Splits a GeoJSON FeatureCollection into one FeatureCollection file per feature type in a single streaming pass
+// The input file is memory-mapped and scanned byte by byte; the features are never parsed into a document, the bytes of each feature are copied straight to the file of its type
+// The non-standard NaN, Infinity, and -Infinity tokens that Python writes are accepted and written out as the strings "NaN", "inf", and "-inf"
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QFile;
+
+class GeoJSONFeatureSplitter
+{
+public:
+    GeoJSONFeatureSplitter();
+    ~GeoJSONFeatureSplitter();
+
+    // Writes the features of the collection in pathToFile to outputDirectory/<type>.geojson, where the type is the "type" member of the feature properties ("Building" if it is empty)
+    // A file whose contents would not change is left as it is
+    // Returns 0 on success and -1 on failure with the message in err, in which case the partially written files are removed
+    int splitFile(const QString& pathToFile, const QString& outputDirectory, QString& err);
+
+    // Splits a collection that is already in memory
+    int splitBuffer(const char* buffer, qint64 size, const QString& outputDirectory, QString& err);
+
+    // The feature types that were found, in alphabetical order
+    QStringList getFeatureTypes(void) const;
+
+    // The path to the file that holds the features of the given type
+    QString getOutputFile(const QString& type) const;
+
+    // The feature types under each asset type, i.e., the "assetType" member of the feature properties, in the order they were first found
+    QMap<QString, QList<QString>> getAssetTypeToType(void) const;
+
+    // The crs of the collection, empty if there is none
+    QJsonObject getCRS(void) const;
+
+    int getNumFeatures(void) const;
+
+private:
+
+    struct Replacement
+    {
+        qint64 start;
+        qint64 end;
+        const char* text;
+    };
+
+    struct TypeWriter
+    {
+        QFile* file = nullptr;
+        QString outputFile;
+        int numFeatures = 0;
+    };
+
+    bool fail(const QString& msg);
+
+    void skipWhitespace(void);
+    bool expect(const char c);
+
+    // Reads the string at the current position; the raw, still escaped, contents are returned in value if it is not null
+    bool parseString(QByteArray* value);
+
+    // Skips over the value at the current position without checking its contents, the non-finite number tokens are recorded as replacements
+    bool skipValue(void);
+    bool skipNonFinite(void);
+
+    bool parseCollection(void);
+    bool parseFeature(void);
+    bool parseProperties(QString& type, QString& assetType);
+
+    QString decodeString(const QByteArray& raw) const;
+
+    // Copies the bytes between start and end with the non-finite tokens replaced
+    void appendSpan(QByteArray& out, const qint64 start, const qint64 end) const;
+
+    bool writeFeature(const QString& type, const qint64 start, const qint64 end);
+    bool writeSpan(QFile* file, const qint64 start, const qint64 end);
+    bool closeWriters(void);
+    void discardWriters(void);
+
+    const char* data = nullptr;
+    qint64 dataSize = 0;
+    qint64 pos = 0;
+
+    QString outputDir;
+    QString errorMessage;
+
+    // Non-finite tokens in the value that is currently being copied
+    QVector<Replacement> replacements;
+
+    QHash<QString, TypeWriter> writers;
+    QMap<QString, QString> outputFiles;
+    QMap<QString, QList<QString>> assetTypeToType;
+
+    QByteArray crsData;
+
+    int numFeatures = 0;
+};
+
+#endif // GEOJSONFEATURESPLITTER_H
@@ -0,0 +1,934 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "HurricaneTrackIndex.h"
+#include "HurricaneObject.h"
+#include "CSVStreamReader.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// Increase when the layout of the index changes so that old indexes are rebuilt
+const quint32 indexVersion = 1;
+
+const char indexMagic[8] = {'R','2','D','H','T','R','K','\0'};
+
+// Written in the native byte order, an index from a machine with a different byte order is rebuilt
+const quint32 byteOrderMark = 0x01020304;
+
+const double noValue = std::numeric_limits<double>::quiet_NaN();
+
+// Returns NaN if the column does not exist or the field is empty or not a number
+double parseValue(const CSVRow& row, int index)
+{
+    if(index == -1 || row[index].isEmpty())
+        return noValue;
+
+    bool ok = false;
+    auto val = row[index].toDouble(&ok);
+
+    return ok ? val : noValue;
+}
+
+// The sections of the index start on 8 byte boundaries so that the columns can be used straight from the mapping
+qint64 alignedSize(qint64 size)
+{
+    return (size + 7) & ~qint64(7);
+}
+
+}
+
+struct HurricaneTrackIndex::IndexHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+
+    // Size and modification time of the database when the index was built
+    qint64 databaseSize;
+    qint64 databaseModified;
+
+    qint64 numStorms;
+    qint64 numPoints;
+
+    // The column names of the database separated by line feeds
+    qint64 labelsOffset;
+    qint64 labelsSize;
+
+    qint64 stringsOffset;
+    qint64 stringsSize;
+
+    qint64 stormsOffset;
+    qint64 sidOrderOffset;
+
+    qint64 latitudesOffset;
+    qint64 longitudesOffset;
+    qint64 windsOffset;
+    qint64 pressuresOffset;
+};
+
+struct HurricaneTrackIndex::StormRecord
+{
+    // Bytes of the rows of the storm in the database
+    qint64 rowsOffset;
+    qint64 rowsSize;
+
+    qint64 firstPoint;
+    qint32 numPoints;
+    qint32 indexLandfall;
+    qint32 season;
+
+    // Offsets and sizes in the string section
+    quint32 sidOffset;
+    quint32 sidSize;
+    quint32 nameOffset;
+    quint32 nameSize;
+    quint32 basinOffset;
+    quint32 basinSize;
+    quint32 padding;
+
+    double minLon;
+    double minLat;
+    double maxLon;
+    double maxLat;
+};
+
+HurricaneTrackIndex::HurricaneTrackIndex()
+{
+    static_assert(sizeof(IndexHeader) == 128, "The index header must not be padded");
+    static_assert(sizeof(StormRecord) == 96, "The storm record must not be padded");
+}
+
+
+HurricaneTrackIndex::~HurricaneTrackIndex()
+{
+    this->close();
+}
+
+
+int HurricaneTrackIndex::open(const QString& pathToDatabase, QString& err, const ProgressCallback& progress)
+{
+    this->close();
+
+    QFileInfo databaseInfo(pathToDatabase);
+
+    if(!databaseInfo.exists())
+    {
+        err = "Cannot find the file: " + pathToDatabase + "\nCheck your directory and try again.";
+        return -1;
+    }
+
+    auto pathToIndex = indexFilePath(pathToDatabase);
+
+    // Use the existing index if it is valid for the database, otherwise build it again
+    QString mapErr;
+    if(!QFile::exists(pathToIndex) || this->mapIndex(pathToDatabase, pathToIndex, mapErr) != 0)
+    {
+        this->close();
+
+        if(this->buildIndex(pathToDatabase, pathToIndex, err, progress) != 0)
+            return -1;
+
+        if(this->mapIndex(pathToDatabase, pathToIndex, err) != 0)
+        {
+            this->close();
+            return -1;
+        }
+    }
+
+    // The storms are read from the database when they are opened
+    databasePath = databaseInfo.absoluteFilePath();
+    databaseFile.setFileName(databasePath);
+
+    if(databaseFile.open(QIODevice::ReadOnly))
+        databaseData = databaseFile.map(0, databaseFile.size());
+
+    return 0;
+}
+
+
+void HurricaneTrackIndex::close(void)
+{
+    if(indexData != nullptr)
+        indexFile.unmap(indexData);
+
+    if(indexFile.isOpen())
+        indexFile.close();
+
+    if(databaseData != nullptr)
+        databaseFile.unmap(databaseData);
+
+    if(databaseFile.isOpen())
+        databaseFile.close();
+
+    indexData = nullptr;
+    databaseData = nullptr;
+    indexBuffer.clear();
+    databasePath.clear();
+    parameterLabels.clear();
+
+    header = nullptr;
+    storms = nullptr;
+    sidOrder = nullptr;
+    strings = nullptr;
+    latitudes = nullptr;
+    longitudes = nullptr;
+    winds = nullptr;
+    pressures = nullptr;
+}
+
+
+bool HurricaneTrackIndex::isOpen(void) const
+{
+    return header != nullptr;
+}
+
+
+QString HurricaneTrackIndex::indexFilePath(const QString& pathToDatabase)
+{
+    QString writableLocation = QStandardPaths::writableLocation(QStandardPaths::StandardLocation::AppLocalDataLocation);
+    QDir indexDir(writableLocation + QDir::separator() + "HurricaneTrackIndex");
+    if(!indexDir.exists())
+        indexDir.mkpath(".");
+
+    // One index per database, named after its path
+    auto pathHash = QCryptographicHash::hash(QFileInfo(pathToDatabase).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    return indexDir.filePath(QString::fromLatin1(pathHash) + ".idx");
+}
+
+
+const QStringList& HurricaneTrackIndex::getParameterLabels(void) const
+{
+    return parameterLabels;
+}
+
+
+int HurricaneTrackIndex::numStorms(void) const
+{
+    return header ? static_cast<int>(header->numStorms) : 0;
+}
+
+
+qint64 HurricaneTrackIndex::numPoints(void) const
+{
+    return header ? header->numPoints : 0;
+}
+
+
+QString HurricaneTrackIndex::getSID(int storm) const
+{
+    return this->getString(storms[storm].sidOffset, storms[storm].sidSize);
+}
+
+
+QString HurricaneTrackIndex::getName(int storm) const
+{
+    return this->getString(storms[storm].nameOffset, storms[storm].nameSize);
+}
+
+
+QString HurricaneTrackIndex::getBasin(int storm) const
+{
+    return this->getString(storms[storm].basinOffset, storms[storm].basinSize);
+}
+
+
+int HurricaneTrackIndex::getSeason(int storm) const
+{
+    return storms[storm].season;
+}
+
+
+QRectF HurricaneTrackIndex::getBoundingBox(int storm) const
+{
+    const auto& rec = storms[storm];
+
+    if(rec.minLon > rec.maxLon || rec.minLat > rec.maxLat)
+        return QRectF();
+
+    return QRectF(QPointF(rec.minLon, rec.minLat), QPointF(rec.maxLon, rec.maxLat));
+}
+
+
+qint64 HurricaneTrackIndex::getFirstPoint(int storm) const
+{
+    return storms[storm].firstPoint;
+}
+
+
+int HurricaneTrackIndex::getNumPoints(int storm) const
+{
+    return storms[storm].numPoints;
+}
+
+
+int HurricaneTrackIndex::getIndexLandfall(int storm) const
+{
+    return storms[storm].indexLandfall;
+}
+
+
+const double* HurricaneTrackIndex::getLatitudes(void) const
+{
+    return latitudes;
+}
+
+
+const double* HurricaneTrackIndex::getLongitudes(void) const
+{
+    return longitudes;
+}
+
+
+const float* HurricaneTrackIndex::getWinds(void) const
+{
+    return winds;
+}
+
+
+const float* HurricaneTrackIndex::getPressures(void) const
+{
+    return pressures;
+}
+
+
+int HurricaneTrackIndex::findStorm(const QString& SID) const
+{
+    if(header == nullptr)
+        return -1;
+
+    const auto sid = SID.toUtf8();
+
+    auto compareSID = [this](int storm, const QByteArray& val)
+    {
+        const auto& rec = storms[storm];
+        const auto len = std::min<int>(rec.sidSize, val.size());
+
+        auto res = std::memcmp(strings + rec.sidOffset, val.constData(), len);
+
+        return res < 0 || (res == 0 && static_cast<int>(rec.sidSize) < val.size());
+    };
+
+    // The storms are sorted by SID in file order, so a SID that occurs more than once finds its first storm like a linear search would
+    auto end = sidOrder + header->numStorms;
+    auto it = std::lower_bound(sidOrder, end, sid, compareSID);
+
+    if(it == end || this->getSID(*it) != SID)
+        return -1;
+
+    return *it;
+}
+
+
+QVector<int> HurricaneTrackIndex::findStorms(int firstSeason, int lastSeason, const QString& basin) const
+{
+    QVector<int> found;
+
+    const auto basinData = basin.toUtf8();
+
+    for(int i = 0; i < this->numStorms(); ++i)
+    {
+        const auto& rec = storms[i];
+
+        if(rec.season < firstSeason || rec.season > lastSeason)
+            continue;
+
+        if(!basinData.isEmpty() && (static_cast<int>(rec.basinSize) != basinData.size() || std::memcmp(strings + rec.basinOffset, basinData.constData(), rec.basinSize) != 0))
+            continue;
+
+        found.push_back(i);
+    }
+
+    return found;
+}
+
+
+QVector<int> HurricaneTrackIndex::findStorms(const QRectF& region) const
+{
+    QVector<int> found;
+
+    const auto bounds = region.normalized();
+
+    for(int i = 0; i < this->numStorms(); ++i)
+    {
+        const auto& rec = storms[i];
+
+        // Compare the bounds directly, a track along a meridian or parallel has an empty rectangle that QRectF does not intersect
+        if(rec.maxLon < bounds.left() || rec.minLon > bounds.right() || rec.maxLat < bounds.top() || rec.minLat > bounds.bottom())
+            continue;
+
+        found.push_back(i);
+    }
+
+    return found;
+}
+
+
+int HurricaneTrackIndex::readStorm(int storm, HurricaneObject& hurricane, QString& err) const
+{
+    if(header == nullptr || storm < 0 || storm >= this->numStorms())
+    {
+        err = "The hurricane is not in the database";
+        return -1;
+    }
+
+    const auto& rec = storms[storm];
+
+    const char* rowData = nullptr;
+    QByteArray rowBuffer;
+
+    if(databaseData != nullptr)
+    {
+        rowData = reinterpret_cast<const char*>(databaseData) + rec.rowsOffset;
+    }
+    else
+    {
+        // Some file systems do not support mapping, read the rows of the storm instead
+        QFile file(databasePath);
+
+        if(!file.open(QIODevice::ReadOnly) || !file.seek(rec.rowsOffset))
+        {
+            err = "Cannot read the hurricane database: " + databasePath;
+            return -1;
+        }
+
+        rowBuffer = file.read(rec.rowsSize);
+
+        if(rowBuffer.size() != rec.rowsSize)
+        {
+            err = "Cannot read the hurricane database: " + databasePath;
+            return -1;
+        }
+
+        rowData = rowBuffer.constData();
+    }
+
+    hurricane.clear();
+    hurricane.parameterLabels = parameterLabels;
+
+    const auto numCol = parameterLabels.size();
+
+    QString rowErr;
+    CSVStreamReader csvReader;
+
+    auto res = csvReader.parseBuffer(rowData, rec.rowsSize, [&](const CSVRow& csvRow, int)
+    {
+        if(csvRow.size() != numCol)
+        {
+            rowErr = "Error, inconsistency in the data in the row and number of columns";
+            return false;
+        }
+
+        hurricane.push_back(csvRow.toStringList());
+
+        return true;
+    }, err);
+
+    if(res != 0)
+        return -1;
+
+    if(!rowErr.isEmpty())
+    {
+        err = rowErr;
+        return -1;
+    }
+
+    if(hurricane.size() != rec.numPoints)
+    {
+        err = "The hurricane database changed since its index was built, load the database again";
+        return -1;
+    }
+
+    if(rec.indexLandfall != -1)
+    {
+        hurricane.landfallData = hurricane[rec.indexLandfall];
+        hurricane.indexLandfall = rec.indexLandfall;
+    }
+
+    hurricane.SID = this->getSID(storm);
+    hurricane.name = this->getName(storm);
+
+    auto indexSeason = parameterLabels.indexOf("SEASON");
+    if(indexSeason != -1)
+        hurricane.season = hurricane.front().at(indexSeason);
+
+    return 0;
+}
+
+
+int HurricaneTrackIndex::buildIndex(const QString& pathToDatabase, const QString& pathToIndex, QString& err, const ProgressCallback& progress)
+{
+    QFileInfo databaseInfo(pathToDatabase);
+
+    const auto databaseSize = databaseInfo.size();
+
+    // Split the hurricanes up as the rows stream in, they come in one long list
+    CSVStreamReader csvReader;
+
+    QStringList headerData;
+    int numCol = 0;
+    int indexLandfall = -1;
+    int indexSID = -1;
+    int indexName = -1;
+    int indexSeason = -1;
+    int indexBasin = -1;
+    int indexLat = -1;
+    int indexLon = -1;
+    int indexUSAWind = -1;
+    int indexWMOWind = -1;
+    int indexUSAPress = -1;
+    int indexWMOPress = -1;
+
+    QVector<StormRecord> stormRecords;
+    QByteArray stringData;
+    QVector<double> latData;
+    QVector<double> lonData;
+    QVector<float> windData;
+    QVector<float> pressData;
+
+    QByteArray SID;
+
+    // Start of the current row in the database
+    qint64 rowStart = 0;
+
+    int lastPercent = -1;
+
+    auto addString = [&stringData](const CSVField& field, quint32& offset, quint32& size)
+    {
+        offset = static_cast<quint32>(stringData.size());
+        size = static_cast<quint32>(field.size());
+        stringData.append(field.data(), field.size());
+    };
+
+    QString rowErr;
+
+    auto res = csvReader.parseFile(pathToDatabase, [&](const CSVRow& csvRow, int rowIndex)
+    {
+        const auto rowEnd = csvReader.bytesParsed();
+
+        // Get the header information to populate the fields
+        if(rowIndex == 0)
+        {
+            headerData = csvRow.toStringList();
+            numCol = headerData.size();
+
+            indexLandfall = headerData.indexOf("DIST2LAND");
+            indexSID = headerData.indexOf("SID");
+            indexName = headerData.indexOf("NAME");
+            indexSeason = headerData.indexOf("SEASON");
+            indexBasin = headerData.indexOf("BASIN");
+            indexLat = headerData.indexOf("LAT");
+            indexLon = headerData.indexOf("LON");
+            indexUSAWind = headerData.indexOf("USA_WIND");
+            indexWMOWind = headerData.indexOf("WMO_WIND");
+            indexUSAPress = headerData.indexOf("USA_PRES");
+            indexWMOPress = headerData.indexOf("WMO_PRES");
+
+            if(indexLandfall == -1 || indexSID == -1 || indexName == -1 || indexSeason == -1 || indexLat == -1 || indexLon == -1)
+            {
+                rowErr = "Could not find the required column indexes in the data file";
+                return false;
+            }
+
+            rowStart = rowEnd;
+            return true;
+        }
+
+        // Skip the second row that contains the units information
+        if(rowIndex == 1)
+        {
+            rowStart = rowEnd;
+            return true;
+        }
+
+        if(csvRow.size() != numCol)
+        {
+            rowErr = "Error, inconsistency in the data in the row and number of columns";
+            return false;
+        }
+
+        const auto& currSID = csvRow[indexSID];
+
+        if(stormRecords.isEmpty() || currSID.size() != SID.size() || std::memcmp(currSID.data(), SID.constData(), SID.size()) != 0)
+        {
+            SID = currSID.toByteArray();
+
+            StormRecord rec;
+            std::memset(&rec, 0, sizeof(rec));
+
+            rec.rowsOffset = rowStart;
+            rec.firstPoint = latData.size();
+            rec.indexLandfall = -1;
+            rec.season = csvRow[indexSeason].toInt();
+            rec.minLon = std::numeric_limits<double>::max();
+            rec.minLat = std::numeric_limits<double>::max();
+            rec.maxLon = std::numeric_limits<double>::lowest();
+            rec.maxLat = std::numeric_limits<double>::lowest();
+
+            addString(currSID, rec.sidOffset, rec.sidSize);
+            addString(csvRow[indexName], rec.nameOffset, rec.nameSize);
+
+            if(indexBasin != -1)
+                addString(csvRow[indexBasin], rec.basinOffset, rec.basinSize);
+
+            stormRecords.push_back(rec);
+        }
+
+        auto& rec = stormRecords.last();
+
+        auto latitude = parseValue(csvRow, indexLat);
+        auto longitude = parseValue(csvRow, indexLon);
+
+        // Default to the USA values and then the WMO values if there are no USA values
+        auto wind = parseValue(csvRow, indexUSAWind);
+        if(std::isnan(wind))
+            wind = parseValue(csvRow, indexWMOWind);
+
+        auto pressure = parseValue(csvRow, indexUSAPress);
+        if(std::isnan(pressure))
+            pressure = parseValue(csvRow, indexWMOPress);
+
+        // Not all hurricanes will make landfall
+        // If the distance to land is 0, then this is the first landfall
+        if(rec.indexLandfall == -1 && csvRow[indexLandfall].equals("0"))
+            rec.indexLandfall = rec.numPoints;
+
+        if(!std::isnan(latitude) && !std::isnan(longitude))
+        {
+            rec.minLon = std::min(rec.minLon, longitude);
+            rec.maxLon = std::max(rec.maxLon, longitude);
+            rec.minLat = std::min(rec.minLat, latitude);
+            rec.maxLat = std::max(rec.maxLat, latitude);
+        }
+
+        latData.push_back(latitude);
+        lonData.push_back(longitude);
+        windData.push_back(static_cast<float>(wind));
+        pressData.push_back(static_cast<float>(pressure));
+
+        ++rec.numPoints;
+        rec.rowsSize = rowEnd - rec.rowsOffset;
+
+        rowStart = rowEnd;
+
+        if(progress && databaseSize > 0)
+        {
+            int percent = static_cast<int>(100*rowEnd/databaseSize);
+            if(percent != lastPercent)
+            {
+                lastPercent = percent;
+                progress(percent);
+            }
+        }
+
+        return true;
+    }, err);
+
+    if(res != 0)
+        return -1;
+
+    if(!rowErr.isEmpty())
+    {
+        err = rowErr;
+        return -1;
+    }
+
+    if(csvReader.numRowsParsed() == 0 || stormRecords.isEmpty())
+    {
+        err = "Hurricane data is empty";
+        return -1;
+    }
+
+    const auto numStorms = stormRecords.size();
+    const auto numPoints = latData.size();
+
+    // Storms in order of their SID, storms with the same SID stay in file order
+    QVector<qint32> order(numStorms);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](qint32 a, qint32 b)
+    {
+        const auto& recA = stormRecords.at(a);
+        const auto& recB = stormRecords.at(b);
+        const auto len = std::min(recA.sidSize, recB.sidSize);
+
+        auto res = std::memcmp(stringData.constData() + recA.sidOffset, stringData.constData() + recB.sidOffset, len);
+
+        return res < 0 || (res == 0 && recA.sidSize < recB.sidSize);
+    });
+
+    const auto labelData = headerData.join('\n').toUtf8();
+
+    IndexHeader indexHeader;
+    std::memset(&indexHeader, 0, sizeof(indexHeader));
+    std::memcpy(indexHeader.magic, indexMagic, sizeof(indexMagic));
+    indexHeader.version = indexVersion;
+    indexHeader.byteOrder = byteOrderMark;
+    indexHeader.databaseSize = databaseSize;
+    indexHeader.databaseModified = databaseInfo.lastModified().toMSecsSinceEpoch();
+    indexHeader.numStorms = numStorms;
+    indexHeader.numPoints = numPoints;
+
+    qint64 offset = sizeof(IndexHeader);
+
+    indexHeader.labelsOffset = offset;
+    indexHeader.labelsSize = labelData.size();
+    offset += alignedSize(labelData.size());
+
+    indexHeader.stringsOffset = offset;
+    indexHeader.stringsSize = stringData.size();
+    offset += alignedSize(stringData.size());
+
+    indexHeader.stormsOffset = offset;
+    offset += alignedSize(numStorms*sizeof(StormRecord));
+
+    indexHeader.sidOrderOffset = offset;
+    offset += alignedSize(numStorms*sizeof(qint32));
+
+    indexHeader.latitudesOffset = offset;
+    offset += alignedSize(numPoints*sizeof(double));
+
+    indexHeader.longitudesOffset = offset;
+    offset += alignedSize(numPoints*sizeof(double));
+
+    indexHeader.windsOffset = offset;
+    offset += alignedSize(numPoints*sizeof(float));
+
+    indexHeader.pressuresOffset = offset;
+
+    // Write the index to a temporary file first so that an interrupted build never leaves a partial index behind
+    QSaveFile file(pathToIndex);
+
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        err = "Could not create the hurricane database index " + pathToIndex + ": " + file.errorString();
+        return -1;
+    }
+
+    auto writeSection = [&file](const void* data, qint64 size)
+    {
+        static const char zeros[8] = {};
+
+        file.write(static_cast<const char*>(data), size);
+        file.write(zeros, alignedSize(size) - size);
+    };
+
+    writeSection(&indexHeader, sizeof(indexHeader));
+    writeSection(labelData.constData(), labelData.size());
+    writeSection(stringData.constData(), stringData.size());
+    writeSection(stormRecords.constData(), numStorms*sizeof(StormRecord));
+    writeSection(order.constData(), numStorms*sizeof(qint32));
+    writeSection(latData.constData(), numPoints*sizeof(double));
+    writeSection(lonData.constData(), numPoints*sizeof(double));
+    writeSection(windData.constData(), numPoints*sizeof(float));
+    writeSection(pressData.constData(), numPoints*sizeof(float));
+
+    if(!file.commit())
+    {
+        err = "Could not write the hurricane database index " + pathToIndex + ": " + file.errorString();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int HurricaneTrackIndex::mapIndex(const QString& pathToDatabase, const QString& pathToIndex, QString& err)
+{
+    indexFile.setFileName(pathToIndex);
+
+    if(!indexFile.open(QIODevice::ReadOnly))
+    {
+        err = "Could not open the hurricane database index " + pathToIndex;
+        return -1;
+    }
+
+    const auto indexSize = indexFile.size();
+
+    if(indexSize < static_cast<qint64>(sizeof(IndexHeader)))
+    {
+        err = "The hurricane database index " + pathToIndex + " is not valid";
+        return -1;
+    }
+
+    const char* data = nullptr;
+
+    indexData = indexFile.map(0, indexSize);
+
+    if(indexData != nullptr)
+    {
+        data = reinterpret_cast<const char*>(indexData);
+    }
+    else
+    {
+        // Some file systems do not support mapping, read the index into memory instead
+        indexBuffer = indexFile.readAll();
+        data = indexBuffer.constData();
+
+        if(indexBuffer.size() != indexSize)
+        {
+            err = "Could not read the hurricane database index " + pathToIndex;
+            return -1;
+        }
+    }
+
+    auto indexHeader = reinterpret_cast<const IndexHeader*>(data);
+
+    QFileInfo databaseInfo(pathToDatabase);
+
+    if(std::memcmp(indexHeader->magic, indexMagic, sizeof(indexMagic)) != 0 ||
+            indexHeader->version != indexVersion ||
+            indexHeader->byteOrder != byteOrderMark)
+    {
+        err = "The hurricane database index " + pathToIndex + " is not valid";
+        return -1;
+    }
+
+    if(indexHeader->databaseSize != databaseInfo.size() ||
+            indexHeader->databaseModified != databaseInfo.lastModified().toMSecsSinceEpoch())
+    {
+        err = "The hurricane database changed since its index was built";
+        return -1;
+    }
+
+    const auto numStorms = indexHeader->numStorms;
+    const auto numPoints = indexHeader->numPoints;
+
+    // Whether a section of count elements at offset lies within the index, written so that a corrupt count or offset cannot overflow
+    // The sections are aligned so that the columns can be read in place
+    auto sectionFits = [indexSize](qint64 offset, qint64 count, qint64 elementSize)
+    {
+        return offset >= 0 && offset <= indexSize && offset % 8 == 0 && count >= 0 && count <= (indexSize - offset)/elementSize;
+    };
+
+    if(numStorms < 0 || numPoints < 0 || numStorms > std::numeric_limits<qint32>::max() ||
+            !sectionFits(indexHeader->labelsOffset, indexHeader->labelsSize, 1) ||
+            indexHeader->labelsSize > std::numeric_limits<int>::max() ||
+            !sectionFits(indexHeader->stringsOffset, indexHeader->stringsSize, 1) ||
+            !sectionFits(indexHeader->stormsOffset, numStorms, sizeof(StormRecord)) ||
+            !sectionFits(indexHeader->sidOrderOffset, numStorms, sizeof(qint32)) ||
+            !sectionFits(indexHeader->latitudesOffset, numPoints, sizeof(double)) ||
+            !sectionFits(indexHeader->longitudesOffset, numPoints, sizeof(double)) ||
+            !sectionFits(indexHeader->windsOffset, numPoints, sizeof(float)) ||
+            !sectionFits(indexHeader->pressuresOffset, numPoints, sizeof(float)))
+    {
+        err = "The hurricane database index " + pathToIndex + " is not valid";
+        return -1;
+    }
+
+    // Check every storm record once here, so that the accessors can use the offsets in the records without checking them on every call
+    const auto indexStorms = reinterpret_cast<const StormRecord*>(data + indexHeader->stormsOffset);
+    const auto indexSidOrder = reinterpret_cast<const qint32*>(data + indexHeader->sidOrderOffset);
+    const auto stringsSize = indexHeader->stringsSize;
+    const auto databaseSize = indexHeader->databaseSize;
+
+    auto stringFits = [stringsSize](quint32 offset, quint32 size)
+    {
+        return static_cast<qint64>(offset) + static_cast<qint64>(size) <= stringsSize;
+    };
+
+    for(qint64 i = 0; i < numStorms; ++i)
+    {
+        const auto& rec = indexStorms[i];
+
+        if(!stringFits(rec.sidOffset, rec.sidSize) || !stringFits(rec.nameOffset, rec.nameSize) || !stringFits(rec.basinOffset, rec.basinSize) ||
+                rec.firstPoint < 0 || rec.numPoints < 0 || rec.firstPoint > numPoints - rec.numPoints ||
+                rec.indexLandfall < -1 || rec.indexLandfall >= rec.numPoints ||
+                rec.rowsOffset < 0 || rec.rowsSize < 0 || rec.rowsOffset > databaseSize - rec.rowsSize)
+        {
+            err = "The hurricane database index " + pathToIndex + " is not valid";
+            return -1;
+        }
+    }
+
+    // The SID order has to be a list of storms sorted by SID for the binary search in findStorm
+    for(qint64 i = 0; i < numStorms; ++i)
+    {
+        const auto storm = indexSidOrder[i];
+
+        if(storm < 0 || storm >= numStorms)
+        {
+            err = "The hurricane database index " + pathToIndex + " is not valid";
+            return -1;
+        }
+
+        if(i == 0)
+            continue;
+
+        const auto& prev = indexStorms[indexSidOrder[i - 1]];
+        const auto& rec = indexStorms[storm];
+
+        const auto stringData = data + indexHeader->stringsOffset;
+        const auto res = std::memcmp(stringData + prev.sidOffset, stringData + rec.sidOffset, std::min(prev.sidSize, rec.sidSize));
+
+        if(res > 0 || (res == 0 && prev.sidSize > rec.sidSize))
+        {
+            err = "The hurricane database index " + pathToIndex + " is not valid";
+            return -1;
+        }
+    }
+
+    header = indexHeader;
+    strings = data + header->stringsOffset;
+    storms = reinterpret_cast<const StormRecord*>(data + header->stormsOffset);
+    sidOrder = reinterpret_cast<const qint32*>(data + header->sidOrderOffset);
+    latitudes = reinterpret_cast<const double*>(data + header->latitudesOffset);
+    longitudes = reinterpret_cast<const double*>(data + header->longitudesOffset);
+    winds = reinterpret_cast<const float*>(data + header->windsOffset);
+    pressures = reinterpret_cast<const float*>(data + header->pressuresOffset);
+
+    parameterLabels = QString::fromUtf8(data + header->labelsOffset, header->labelsSize).split('\n');
+
+    return 0;
+}
+
+
+QString HurricaneTrackIndex::getString(quint32 offset, quint32 size) const
+{
+    return QString::fromUtf8(strings + offset, size);
+}
@@ -0,0 +1,149 @@
+#ifndef HURRICANETRACKINDEX_H
+#define HURRICANETRACKINDEX_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Compact binary index of an IBTrACS hurricane database in CSV format
+// The first time a database is opened the CSV file is parsed once and the index is written to the application data folder, later sessions memory-map the index instead of parsing the database again
+// The index holds one record per storm (SID, name, season, basin, bounding box and the bytes of its rows in the database) and the latitude, longitude, wind and pressure of every track point as columns
+// A single storm is opened by parsing only its rows from the memory-mapped database
+
+#include <QByteArray>
+#include <QFile>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+struct HurricaneObject;
+
+class HurricaneTrackIndex
+{
+public:
+    HurricaneTrackIndex();
+    ~HurricaneTrackIndex();
+
+    // Called with the percentage of the database that is parsed while the index is built
+    using ProgressCallback = std::function<void(int percent)>;
+
+    // Opens the index of the database, the index is built first if there is none or if the database changed since it was built
+    // Returns 0 on success and -1 on failure with the message in err
+    int open(const QString& pathToDatabase, QString& err, const ProgressCallback& progress = nullptr);
+
+    void close(void);
+
+    bool isOpen(void) const;
+
+    // The file where the index of the database is kept
+    static QString indexFilePath(const QString& pathToDatabase);
+
+    // The column names of the database
+    const QStringList& getParameterLabels(void) const;
+
+    int numStorms(void) const;
+    qint64 numPoints(void) const;
+
+    QString getSID(int storm) const;
+    QString getName(int storm) const;
+    QString getBasin(int storm) const;
+    int getSeason(int storm) const;
+
+    // Longitude and latitude bounds of the track, as x and y
+    QRectF getBoundingBox(int storm) const;
+
+    // The track points of a storm are numPoints consecutive entries in the point columns starting at firstPoint
+    qint64 getFirstPoint(int storm) const;
+    int getNumPoints(int storm) const;
+
+    // Index of the first point with a distance to land of 0, or -1 if the storm does not make landfall
+    int getIndexLandfall(int storm) const;
+
+    // Point columns, NaN where the database has no value
+    // The wind and pressure are the USA agency values if available, otherwise the WMO values
+    const double* getLatitudes(void) const;
+    const double* getLongitudes(void) const;
+    const float* getWinds(void) const;
+    const float* getPressures(void) const;
+
+    // Returns the storm with the SID or -1 if it is not in the database
+    int findStorm(const QString& SID) const;
+
+    // Storms with a season in [firstSeason, lastSeason] and, if given, in the basin
+    QVector<int> findStorms(int firstSeason, int lastSeason, const QString& basin = QString()) const;
+
+    // Storms whose track bounding box intersects the region given as longitude and latitude bounds
+    QVector<int> findStorms(const QRectF& region) const;
+
+    // Parses the rows of one storm from the database into the hurricane
+    // Returns 0 on success and -1 on failure with the message in err
+    int readStorm(int storm, HurricaneObject& hurricane, QString& err) const;
+
+private:
+
+    struct IndexHeader;
+    struct StormRecord;
+
+    int buildIndex(const QString& pathToDatabase, const QString& pathToIndex, QString& err, const ProgressCallback& progress);
+
+    int mapIndex(const QString& pathToDatabase, const QString& pathToIndex, QString& err);
+
+    QString getString(quint32 offset, quint32 size) const;
+
+    const IndexHeader* header = nullptr;
+    const StormRecord* storms = nullptr;
+    const qint32* sidOrder = nullptr;
+    const char* strings = nullptr;
+    const double* latitudes = nullptr;
+    const double* longitudes = nullptr;
+    const float* winds = nullptr;
+    const float* pressures = nullptr;
+
+    QStringList parameterLabels;
+
+    QFile indexFile;
+    uchar* indexData = nullptr;
+
+    // Used instead of the mapping if the file system does not support mapping
+    QByteArray indexBuffer;
+
+    QString databasePath;
+    QFile databaseFile;
+    uchar* databaseData = nullptr;
+};
+
+#endif // HURRICANETRACKINDEX_H
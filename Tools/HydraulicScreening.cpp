@@ -0,0 +1,477 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "HydraulicScreening.h"
+#include "GeoJSONFeatureSplitter.h"
+
+#include "epanet2_2.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// Meters of water to psi, used when the network is in US customary units
+const double psiPerMeter = 1.4219702;
+
+// Reading the .inp file uses strtok and ctime, which are not reentrant, so the workers open and close their projects one at a time
+QMutex epanetFileMutex;
+
+}
+
+
+HydraulicScreening::HydraulicScreening(QObject* parent) : QObject(parent), linearSolver(EN_CHOLESKY), nextScenario(0), cancelled(false)
+{
+    connect(&runWatcher, &QFutureWatcher<void>::finished, this, &HydraulicScreening::finished);
+}
+
+
+HydraulicScreening::~HydraulicScreening()
+{
+    // The workers write into the results, so they have to stop before the results are freed
+    cancelled = true;
+    runWatcher.waitForFinished();
+}
+
+
+int HydraulicScreening::readScenarios(const QString& pathToResults, double leakEmitterCoefficient, QVector<HydraulicScenario>& scenarios, QString& err)
+{
+    // The results file of the workflow can have NaN values and all asset types in it, the splitter cleans up the values and writes the pipes to their own file
+    QTemporaryDir splitDir;
+    if(!splitDir.isValid())
+    {
+        err = "Could not create a temporary directory for the pipes in the results file " + pathToResults;
+        return -1;
+    }
+
+    GeoJSONFeatureSplitter splitter;
+    if(splitter.splitFile(pathToResults, splitDir.path(), err) != 0)
+        return -1;
+
+    auto pathToPipes = splitter.getOutputFile("Pipe");
+
+    if(pathToPipes.isEmpty())
+    {
+        err = "Could not find any pipes in the results file " + pathToResults;
+        return -1;
+    }
+
+    QFile file(pathToPipes);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        err = "Could not open the pipes of the results file " + pathToResults;
+        return -1;
+    }
+
+    QJsonParseError parseError;
+    auto features = QJsonDocument::fromJson(file.readAll(), &parseError).object().value("features").toArray();
+
+    if(parseError.error != QJsonParseError::NoError)
+    {
+        err = "Could not parse the results file " + pathToResults + ": " + parseError.errorString();
+        return -1;
+    }
+
+    HydraulicScenario scenario;
+    scenario.name = QFileInfo(pathToResults).fileName();
+
+    int numWithDamageState = 0;
+
+    for(auto&& featureValue : features)
+    {
+        auto properties = featureValue.toObject().value("properties").toObject();
+
+        auto id = properties.value("InpID").toVariant().toString();
+
+        if(id.isEmpty())
+        {
+            err = "The pipes in the results file " + pathToResults + " have no 'InpID', the network has to be loaded from an .inp file to be screened";
+            return -1;
+        }
+
+        // The missing values are written as the string "NaN", which is not a damage state
+        auto damageState = properties.value("R2Dres_MostLikelyCriticalDamageState");
+
+        if(!damageState.isDouble())
+            continue;
+
+        ++numWithDamageState;
+
+        auto state = qRound(damageState.toDouble());
+
+        if(state >= 2)
+        {
+            scenario.brokenPipes.append(id);
+        }
+        else if(state == 1)
+        {
+            scenario.leaks.append(qMakePair(properties.value("startNode").toVariant().toString(), 0.5*leakEmitterCoefficient));
+            scenario.leaks.append(qMakePair(properties.value("endNode").toVariant().toString(), 0.5*leakEmitterCoefficient));
+        }
+    }
+
+    if(numWithDamageState == 0)
+    {
+        err = "None of the pipes in the results file " + pathToResults + " has a 'R2Dres_MostLikelyCriticalDamageState'";
+        return -1;
+    }
+
+    scenarios.clear();
+    scenarios.append(scenario);
+
+    return 0;
+}
+
+
+int HydraulicScreening::run(const QString& pathToInpFile, const QVector<HydraulicScenario>& scenarios, double minimumPressure, double requiredPressure, QString& err)
+{
+    if(runWatcher.isRunning())
+    {
+        err = "The screening is already running";
+        return -1;
+    }
+
+    if(scenarios.isEmpty())
+    {
+        err = "There are no realizations to screen";
+        return -1;
+    }
+
+    if(minimumPressure < 0.0)
+        minimumPressure = 0.0;
+
+    if(requiredPressure < 0.0)
+        requiredPressure = 20.0;
+
+    if(requiredPressure <= minimumPressure)
+    {
+        err = "The required pressure must be larger than the minimum pressure";
+        return -1;
+    }
+
+    // The reports of the workers are not needed, they are only written because EPANET writes to stdout otherwise
+    reportDir.reset(new QTemporaryDir());
+    if(!reportDir->isValid())
+    {
+        err = "Could not create a temporary directory for the EPANET reports";
+        return -1;
+    }
+
+    runScenarios = scenarios;
+    results.fill(HydraulicScreeningResult(), scenarios.size());
+    resultData = results.data();
+    nextScenario = 0;
+    cancelled = false;
+    workerError.clear();
+
+    auto numWorkers = std::min(QThread::idealThreadCount(), scenarios.size());
+
+    workers.resize(std::max(numWorkers, 1));
+    std::iota(workers.begin(), workers.end(), 0);
+
+    auto solveRealizations = [this, pathToInpFile, minimumPressure, requiredPressure](const int worker)
+    {
+        auto pathToReport = reportDir->filePath("screening_" + QString::number(worker) + ".rpt");
+
+        this->runWorker(pathToInpFile, pathToReport, runScenarios, minimumPressure, requiredPressure);
+    };
+
+    // The analysis runs in the background, the watcher emits finished in the thread of this object when the workers are done
+    runWatcher.setFuture(QtConcurrent::map(workers, solveRealizations));
+
+    return 0;
+}
+
+
+bool HydraulicScreening::isRunning(void) const
+{
+    return runWatcher.isRunning();
+}
+
+
+QString HydraulicScreening::getError(void)
+{
+    QMutexLocker locker(&errorMutex);
+    return workerError;
+}
+
+
+void HydraulicScreening::setLinearSolver(const int solver)
+{
+    linearSolver = solver;
+}
+
+
+void HydraulicScreening::cancel(void)
+{
+    cancelled = true;
+}
+
+
+bool HydraulicScreening::isCancelled(void) const
+{
+    return cancelled;
+}
+
+
+const QVector<HydraulicScreeningResult>& HydraulicScreening::getResults(void) const
+{
+    return results;
+}
+
+
+void HydraulicScreening::runWorker(const QString& pathToInpFile, const QString& pathToReport, const QVector<HydraulicScenario>& scenarios, double minimumPressure, double requiredPressure)
+{
+    auto setError = [&](const QString& msg)
+    {
+        QMutexLocker locker(&errorMutex);
+        if(workerError.isEmpty())
+            workerError = msg;
+    };
+
+    EN_Project ph = nullptr;
+    if(EN_createproject(&ph) != 0)
+    {
+        setError("Could not allocate an EPANET project");
+        return;
+    }
+
+    auto closeProject = [&]()
+    {
+        QMutexLocker locker(&epanetFileMutex);
+        EN_deleteproject(ph);
+    };
+
+    char errMsg[256] = "";
+
+    int errcode = 0;
+    {
+        QMutexLocker locker(&epanetFileMutex);
+        errcode = EN_open(ph, QFile::encodeName(pathToInpFile).constData(), QFile::encodeName(pathToReport).constData(), "");
+    }
+
+    if(errcode >= 100)
+    {
+        EN_geterror(errcode, errMsg, sizeof(errMsg) - 1);
+        setError("Could not read the network in " + pathToInpFile + ": " + QString::fromUtf8(errMsg));
+        closeProject();
+        return;
+    }
+
+    // The pressures of the pressure driven analysis are in the pressure units of the network
+    int flowUnits = EN_LPS;
+    EN_getflowunits(ph, &flowUnits);
+
+    if(flowUnits < EN_LPS)
+    {
+        minimumPressure *= psiPerMeter;
+        requiredPressure *= psiPerMeter;
+    }
+
+    // A single steady state analysis per realization
+    errcode = EN_setdemandmodel(ph, EN_PDA, minimumPressure, requiredPressure, 0.5);
+
+    if(errcode == 0)
+        errcode = EN_settimeparam(ph, EN_DURATION, 0);
+
+    // The linear solver can only be chosen while the hydraulics are closed
+    if(errcode == 0)
+        errcode = EN_setoption(ph, EN_LINEARSOLVER, linearSolver);
+
+    // Opening the hydraulics reorders the nodes and does the symbolic factorization of the network matrix once for all of the realizations
+    if(errcode == 0)
+        errcode = EN_openH(ph);
+
+    if(errcode >= 100)
+    {
+        EN_geterror(errcode, errMsg, sizeof(errMsg) - 1);
+        setError("Could not set up the hydraulic analysis: " + QString::fromUtf8(errMsg));
+        closeProject();
+        return;
+    }
+
+    int numNodes = 0;
+    EN_getcount(ph, EN_NODECOUNT, &numNodes);
+
+    double emitterExponent = 0.5;
+    EN_getoption(ph, EN_EMITEXPON, &emitterExponent);
+
+    QVector<int> junctions;
+    for(int i = 1; i <= numNodes; ++i)
+    {
+        int type = -1;
+        EN_getnodetype(ph, i, &type);
+
+        if(type == EN_JUNCTION)
+            junctions.push_back(i);
+    }
+
+    // The original values of the links and nodes that a realization changes, so that they can be restored for the next one
+    QVector<QPair<int, double>> changedLinks;
+    QVector<QPair<int, double>> changedNodes;
+
+    while(!cancelled)
+    {
+        auto index = nextScenario++;
+
+        if(index >= scenarios.size())
+            break;
+
+        auto&& scenario = scenarios.at(index);
+
+        HydraulicScreeningResult result;
+
+        for(auto&& pipe : scenario.brokenPipes)
+        {
+            auto id = pipe.toUtf8();
+
+            int linkIndex = 0;
+            if(EN_getlinkindex(ph, id.data(), &linkIndex) != 0)
+            {
+                ++result.numUnknownIds;
+                continue;
+            }
+
+            double status = EN_OPEN;
+            EN_getlinkvalue(ph, linkIndex, EN_INITSTATUS, &status);
+            changedLinks.push_back(qMakePair(linkIndex, status));
+
+            EN_setlinkvalue(ph, linkIndex, EN_INITSTATUS, EN_CLOSED);
+        }
+
+        for(auto&& leak : scenario.leaks)
+        {
+            auto id = leak.first.toUtf8();
+
+            int nodeIndex = 0;
+            if(EN_getnodeindex(ph, id.data(), &nodeIndex) != 0)
+            {
+                ++result.numUnknownIds;
+                continue;
+            }
+
+            double emitter = 0.0;
+            EN_getnodevalue(ph, nodeIndex, EN_EMITTER, &emitter);
+            changedNodes.push_back(qMakePair(nodeIndex, emitter));
+
+            // Leaks at the same node add up
+            EN_setnodevalue(ph, nodeIndex, EN_EMITTER, emitter + leak.second);
+        }
+
+        long t = 0;
+        errcode = EN_initH(ph, EN_NOSAVE);
+
+        if(errcode < 100)
+            errcode = std::max(errcode, EN_runH(ph, &t));
+
+        result.errorCode = errcode;
+
+        if(errcode < 100)
+        {
+            double fullDemand = 0.0;
+            double deliveredDemand = 0.0;
+            int numDemandNodes = 0;
+            int numBelowRequired = 0;
+            double minPressure = std::numeric_limits<double>::max();
+
+            for(auto&& node : junctions)
+            {
+                double demand = 0.0;
+                double deficit = 0.0;
+                double pressure = 0.0;
+                double emitterCoeff = 0.0;
+
+                EN_getnodevalue(ph, node, EN_DEMAND, &demand);
+                EN_getnodevalue(ph, node, EN_DEMANDDEFICIT, &deficit);
+                EN_getnodevalue(ph, node, EN_PRESSURE, &pressure);
+                EN_getnodevalue(ph, node, EN_EMITTER, &emitterCoeff);
+
+                minPressure = std::min(minPressure, pressure);
+
+                // EN_DEMAND is the delivered demand plus the outflow of the emitter, i.e., the leak, which is not a served demand
+                // This EPANET has no EN_EMITTERFLOW, the flow is C*p^exponent, with the sign of the pressure like in the solver
+                if(emitterCoeff > 0.0)
+                    demand = std::max(0.0, demand - std::copysign(emitterCoeff*std::pow(std::abs(pressure), emitterExponent), pressure));
+
+                if(demand + deficit <= 0.0)
+                    continue;
+
+                fullDemand += demand + deficit;
+                deliveredDemand += demand;
+                ++numDemandNodes;
+
+                if(pressure < requiredPressure)
+                    ++numBelowRequired;
+            }
+
+            result.demandSatisfaction = fullDemand > 0.0 ? deliveredDemand / fullDemand : 1.0;
+            result.fractionBelowRequired = numDemandNodes > 0 ? static_cast<double>(numBelowRequired) / numDemandNodes : 0.0;
+            result.minimumPressure = junctions.isEmpty() ? 0.0 : minPressure;
+        }
+
+        // Restore the network in reverse order, so that a node with several leaks gets its original value back
+        for(int i = changedNodes.size() - 1; i >= 0; --i)
+            EN_setnodevalue(ph, changedNodes.at(i).first, EN_EMITTER, changedNodes.at(i).second);
+
+        for(int i = changedLinks.size() - 1; i >= 0; --i)
+            EN_setlinkvalue(ph, changedLinks.at(i).first, EN_INITSTATUS, changedLinks.at(i).second);
+
+        changedNodes.clear();
+        changedLinks.clear();
+
+        // Each index is written by one worker only
+        resultData[index] = result;
+
+        emit scenarioFinished(index);
+    }
+
+    EN_closeH(ph);
+    closeProject();
+}
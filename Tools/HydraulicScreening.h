@@ -0,0 +1,158 @@
+#ifndef HYDRAULICSCREENING_H
+#define HYDRAULICSCREENING_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Fast screening of water network damage realizations with the EPANET 2.2 solver that is compiled into R2D
+// Every realization is a single steady state pressure driven analysis of the network with the broken pipes closed and the leaks modelled as emitters
+// The realizations are solved in parallel, each worker opens its own copy of the network once and solves its realizations one after the other
+// The node reordering and the symbolic factorization are done when a worker opens the hydraulics, the damage does not change the sparsity pattern so they are reused by all of its realizations
+
+#include <QFutureWatcher>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+class QTemporaryDir;
+
+// One damage realization of the network
+struct HydraulicScenario
+{
+    QString name;
+
+    // Ids of the pipes in the .inp file that are broken, the pipes are closed
+    QStringList brokenPipes;
+
+    // Ids of the nodes in the .inp file that leak and their emitter coefficient, in the flow units of the .inp file
+    QVector<QPair<QString, double>> leaks;
+};
+
+// Serviceability of the network in one realization
+struct HydraulicScreeningResult
+{
+    // EPANET error code of the analysis, -1 until the realization is solved, warnings are < 100
+    int errorCode = -1;
+
+    // Delivered demand over the full demand of the junctions that have a demand, the outflow of the leaks is not counted as delivered
+    double demandSatisfaction = 0.0;
+
+    // Fraction of the junctions with a demand where the pressure is below the required pressure
+    double fractionBelowRequired = 0.0;
+
+    // Lowest pressure of all junctions, in the pressure units of the .inp file
+    double minimumPressure = 0.0;
+
+    // Number of broken pipes and leaks in the realization that are not in the network
+    int numUnknownIds = 0;
+};
+
+class HydraulicScreening : public QObject
+{
+    Q_OBJECT
+
+public:
+    HydraulicScreening(QObject* parent = nullptr);
+    ~HydraulicScreening();
+
+    // Reads the damage of the pipes from a results GeoJSON file of the workflow, i.e., R2D_results.geojson or the Pipe.geojson that the results widget splits off
+    // The results hold the most likely critical damage state of each pipe (R2Dres_MostLikelyCriticalDamageState), so the file is read as a single realization
+    // A pipe in damage state 1 leaks, the leak is split over the emitters of its start and end nodes, and a pipe in a higher damage state is broken
+    // The pipes are matched to the network by their InpID, the emitter coefficient of a leak is in the flow units of the .inp file
+    // Returns 0 on success and -1 on failure with the message in err
+    static int readScenarios(const QString& pathToResults, double leakEmitterCoefficient, QVector<HydraulicScenario>& scenarios, QString& err);
+
+    // Starts solving the realizations in the background and returns, the results are available as they finish through the scenarioFinished signal and finished is emitted at the end
+    // The minimum and required pressures of the pressure driven analysis are in meters, negative values use 0 m and 20 m
+    // Returns 0 if the analysis was started and -1 with the message in err otherwise
+    int run(const QString& pathToInpFile, const QVector<HydraulicScenario>& scenarios, double minimumPressure, double requiredPressure, QString& err);
+
+    bool isRunning(void) const;
+
+    // The error of a worker that could not open the network, empty if all of them could
+    QString getError(void);
+
+    // The solver of the linear equations in each hydraulic trial, one of EN_CHOLESKY (the default) or EN_SUPERNODAL, set before run
+    void setLinearSolver(const int solver);
+
+    // Stops the analysis after the realizations that are being solved
+    void cancel(void);
+
+    // Whether the last run was cancelled, the realizations that were not solved have an error code of -1
+    bool isCancelled(void) const;
+
+    const QVector<HydraulicScreeningResult>& getResults(void) const;
+
+signals:
+    // Emitted from the worker threads, connections to objects in other threads are queued
+    void scenarioFinished(int index);
+
+    // Emitted in the thread of the object when all of the workers are done
+    void finished(void);
+
+private:
+
+    // Opens the network in a new project and solves realizations until there are none left
+    void runWorker(const QString& pathToInpFile, const QString& pathToReport, const QVector<HydraulicScenario>& scenarios, double minimumPressure, double requiredPressure);
+
+    QVector<HydraulicScreeningResult> results;
+
+    // Inputs of the run that is in progress, they have to outlive the workers
+    QVector<HydraulicScenario> runScenarios;
+    QVector<int> workers;
+    std::unique_ptr<QTemporaryDir> reportDir;
+
+    QFutureWatcher<void> runWatcher;
+
+    int linearSolver;
+
+    // Written by the workers, one realization per index
+    HydraulicScreeningResult* resultData = nullptr;
+
+    std::atomic<int> nextScenario;
+    std::atomic<bool> cancelled;
+
+    // The first error of a worker that could not open the network
+    QString workerError;
+    QMutex errorMutex;
+};
+
+#endif // HYDRAULICSCREENING_H
@@ -38,6 +38,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "NGAW2Converter.h"
 #include "CSVReaderWriter.h"
+#include "GroundMotionTimeHistory.h"
 
 #include <QDir>
 #include <QJsonDocument>
@@ -45,14 +46,186 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QFile>
 #include <QFileInfo>
 #include <QVariant>
+#include <QtConcurrent/QtConcurrent>
 
 #include <math.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+// The powers of ten that are exact in a double
+const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool isSpace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+const char* skipSpaces(const char* pos, const char* end)
+{
+    while(pos != end && isSpace(*pos))
+        ++pos;
+
+    return pos;
+}
+
+// Parses the number at pos and moves pos past it, the number has to end at white space or at the end of the data
+// The short decimals of the PEER files are converted without a copy or a locale, the rest are left to Qt
+bool parseNumber(const char*& pos, const char* end, double& value)
+{
+    const char* p = pos;
+
+    bool negative = false;
+    if(p != end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        ++p;
+    }
+
+    const char* numberStart = p;
+
+    quint64 mantissa = 0;
+    int numDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool exact = true;
+
+    auto addDigit = [&](const int digit, const bool fractional)
+    {
+        hasDigits = true;
+
+        // Leading zeros are not significant
+        if(mantissa == 0 && digit == 0)
+        {
+            exponent -= fractional;
+            return;
+        }
+
+        if(numDigits < 19)
+        {
+            mantissa = mantissa*10 + digit;
+            ++numDigits;
+            exponent -= fractional;
+        }
+        else
+        {
+            exact = false;
+            exponent += !fractional;
+        }
+    };
+
+    for(; p != end && *p >= '0' && *p <= '9'; ++p)
+        addDigit(*p - '0', false);
+
+    if(p != end && *p == '.')
+        for(++p; p != end && *p >= '0' && *p <= '9'; ++p)
+            addDigit(*p - '0', true);
+
+    if(!hasDigits)
+        return false;
+
+    if(p != end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+
+        bool negativeExponent = false;
+        if(p != end && (*p == '-' || *p == '+'))
+        {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+
+        if(p == end || *p < '0' || *p > '9')
+            return false;
+
+        int exp = 0;
+        for(; p != end && *p >= '0' && *p <= '9'; ++p)
+            if(exp < 10000)
+                exp = exp*10 + (*p - '0');
+
+        exponent += negativeExponent ? -exp : exp;
+    }
+
+    if(p != end && !isSpace(*p))
+        return false;
+
+    double magnitude = 0.0;
+
+    if(exact && numDigits <= 15 && exponent >= -22 && exponent <= 22)
+    {
+        // Both the mantissa and the power of ten are exact, so the single rounding of the product or quotient gives the correctly rounded value
+        magnitude = static_cast<double>(mantissa);
+        magnitude = exponent < 0 ? magnitude/powersOfTen[-exponent] : magnitude*powersOfTen[exponent];
+    }
+    else
+    {
+        bool ok = false;
+        magnitude = QByteArray::fromRawData(numberStart, p - numberStart).toDouble(&ok);
+
+        if(!ok)
+            return false;
+    }
+
+    value = negative ? -magnitude : magnitude;
+    pos = p;
+
+    return true;
+}
+
+// Returns the line at pos without its line ending and moves pos to the start of the next line
+QByteArray readLine(const char*& pos, const char* end)
+{
+    const char* lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+
+    if(lineEnd == nullptr)
+        lineEnd = end;
+
+    QByteArray line(pos, lineEnd - pos);
+
+    pos = lineEnd != end ? lineEnd + 1 : end;
+
+    return line.trimmed();
+}
+
+// Finds the key in the line and parses the number that follows it
+bool parseKeyValue(const QByteArray& line, const char* key, double& value)
+{
+    auto index = line.indexOf(key);
+
+    if(index == -1)
+        return false;
+
+    const char* end = line.constData() + line.size();
+    const char* pos = skipSpaces(line.constData() + index + qstrlen(key), end);
+
+    // The value ends at a comma or a unit, e.g., NPTS=  5000, DT=   .0050 SEC
+    const char* valueEnd = pos;
+    while(valueEnd != end && !isSpace(*valueEnd) && *valueEnd != ',')
+        ++valueEnd;
+
+    return parseNumber(pos, valueEnd, value) && pos == valueEnd;
+}
+
+}
+
 
 NGAW2Converter::NGAW2Converter()
 {
     directionH1 = true;
     directionH2 = true;
     directionVert = false;
+
+    writeBinaryRecords = false;
+}
+
+
+void NGAW2Converter::setWriteBinaryRecords(bool value)
+{
+    writeBinaryRecords = value;
 }
 
 
@@ -90,6 +263,12 @@ int NGAW2Converter::convertToSimCenterEvent(const QString& pathToOutputDirectory
 
     auto records = metaData.keys();
 
+    // The names of the records and the paths to the files of their directions, empty if the direction is not wanted
+    const bool useDirection[3] = {directionH1, directionH2, directionVert};
+
+    QStringList recordNames;
+    QVector<std::array<QString, 3>> recordFiles;
+
     for(auto&& it : records)
     {
         auto recordObj = metaData[it].toObject();
@@ -102,8 +281,6 @@ int NGAW2Converter::convertToSimCenterEvent(const QString& pathToOutputDirectory
             return -1;
         }
 
-        auto name = "RSN"+RSNNumber;
-
         auto H1FileName = recordObj.value("Horizontal-1 Acc. Filename").toString();
         auto H2FileName = recordObj.value("Horizontal-2 Acc. Filename").toString();
         auto VFileName = recordObj.value("Vertical Acc. Filename").toString();
@@ -114,105 +291,101 @@ int NGAW2Converter::convertToSimCenterEvent(const QString& pathToOutputDirectory
             return -1;
         }
 
-        QJsonObject recordJsonObj;
+        const QString fileNames[3] = {H1FileName, H2FileName, VFileName};
 
-        recordJsonObj.insert("name",name);
+        std::array<QString, 3> files;
+        for(int i = 0; i<3; ++i)
+        {
+            if(useDirection[i])
+                files[i] = pathToOutputDirectory + fileNames[i];
+        }
 
-        auto dT = -1.0;
+        recordNames.append("RSN"+RSNNumber);
+        recordFiles.append(files);
+    }
 
-        if(directionH1)
-        {
-            auto filePathH1 = pathToOutputDirectory + H1FileName;
-            QJsonObject H1Obj;
-            auto res1 = this->convertRecordToJson(filePathH1,H1Obj,errorMsg);
-            if(res1 != 0)
-            {
-                errorMsg = "Error importing file " + filePathH1;
-                return -1;
-            }
+    const int numRecords = recordNames.size();
 
-            // Get the time step
-            auto dTTs = H1Obj.value("dT").toDouble();
-            dT = dTTs;
+    // Each record writes only to its own slots
+    QVector<QString> recordErrors(numRecords);
+    QVector<QJsonObject> recordObjects(createdRecords != nullptr ? numRecords : 0);
 
-            // Get the time history data points
-            auto TH = H1Obj.value("TimeHistoryData").toArray();
-            recordJsonObj.insert("data_x",TH);
+    QString* recordErrorsData = recordErrors.data();
+    QJsonObject* recordObjectsData = recordObjects.data();
 
-            auto PGA = this->getPGA(&TH);
-            recordJsonObj.insert("PGA_x",PGA);
-        }
+    const bool writeBinary = writeBinaryRecords;
 
-        if(directionH2)
+    auto convertRecord = [&](const int i)
+    {
+        static const char* dataKeys[3] = {"data_x", "data_y", "data_z"};
+        static const char* PGAKeys[3] = {"PGA_x", "PGA_y", "PGA_z"};
+
+        const auto& name = recordNames.at(i);
+        const auto& files = recordFiles.at(i);
+
+        QJsonObject recordJsonObj;
+
+        recordJsonObj.insert("name",name);
+
+        GroundMotionTimeHistory binaryRecord(name);
+
+        auto dT = -1.0;
+
+        for(int j = 0; j<3; ++j)
         {
-            auto filePathH2 = pathToOutputDirectory + H2FileName;
-            QJsonObject H2Obj;
-            auto res2 = this->convertRecordToJson(filePathH2,H2Obj,errorMsg);
-            if(res2 != 0)
+            if(files[j].isEmpty())
+                continue;
+
+            RecordComponent component;
+            QString err;
+            if(parseRecordFile(files[j], component, err) != 0)
             {
-                errorMsg = "Error importing file " + filePathH2;
-                return -1;
+                recordErrorsData[i] = "Error importing file " + files[j] + "\n" + err;
+                return;
             }
 
             // Set the time step if not already set
-            auto dTTs = H2Obj.value("dT").toDouble();
             if(dT < 0.0)
-                dT = dTTs;
-            else
+                dT = component.dT;
+            else if(fabs(component.dT-dT) > 1.0e-6)
             {
                 // Check if the time step is the same for all time history files
-                if(fabs(dTTs-dT) > 1.0e-6)
-                {
-                    errorMsg = "Error, inconsistent time step size in the time history files.";
-                    return -1;
-                }
+                recordErrorsData[i] = "Error, inconsistent time step size in the time history files.";
+                return;
             }
 
             // Get the time history data points
-            auto TH = H2Obj.value("TimeHistoryData").toArray();
-            recordJsonObj.insert("data_y",TH);
+            QJsonArray TH;
+            for(auto&& val : component.timeHistory)
+                TH.append(val);
 
-            auto PGA = this->getPGA(&TH);
-            recordJsonObj.insert("PGA_y",PGA);
-        }
+            recordJsonObj.insert(dataKeys[j],TH);
+            recordJsonObj.insert(PGAKeys[j],component.peakValue);
 
-        if(directionVert)
-        {
-            auto filePathV = pathToOutputDirectory + VFileName;
-            QJsonObject VObj;
-            auto res3 = this->convertRecordToJson(filePathV,VObj,errorMsg);
-            if(res3 != 0)
+            if(!writeBinary)
+                continue;
+
+            if(j == 0)
             {
-                errorMsg = "Error importing file " + filePathV;
-                return -1;
+                binaryRecord.setX(component.timeHistory);
+                binaryRecord.setPeakIntensityMeasureX(component.peakValue);
+            }
+            else if(j == 1)
+            {
+                binaryRecord.setY(component.timeHistory);
+                binaryRecord.setPeakIntensityMeasureY(component.peakValue);
             }
-
-            auto dTTs = VObj.value("dT").toDouble();
-
-            if(dT < 0.0)
-                dT = dTTs;
             else
             {
-                // Check if the time step is the same for all time history files
-                if(fabs(dTTs-dT) > 1.0e-6)
-                {
-                    errorMsg = "Error, inconsistent time step size in the time history files.";
-                    return -1;
-                }
+                binaryRecord.setZ(component.timeHistory);
+                binaryRecord.setPeakIntensityMeasureZ(component.peakValue);
             }
-
-            // Get the time history data points
-            auto TH = VObj.value("TimeHistoryData").toArray();
-            recordJsonObj.insert("data_z",TH);
-
-            auto PGA = this->getPGA(&TH);
-            recordJsonObj.insert("PGA_z",PGA);
         }
 
         if(dT <= 0.0)
         {
-            errorMsg = "Error getting the time step from the time history files";
-            return -1;
+            recordErrorsData[i] = "Error getting the time step from the time history files";
+            return;
         }
 
         recordJsonObj.insert("dT",dT);
@@ -222,19 +395,50 @@ int NGAW2Converter::convertToSimCenterEvent(const QString& pathToOutputDirectory
         QFile file(outputFile);
         if (!file.open(QFile::WriteOnly | QFile::Text))
         {
-            errorMsg = "Error creating the output json file";
-            return -1;
+            recordErrorsData[i] = "Error creating the output json file";
+            return;
         }
 
-        // Write the file to the folder
+        // Write the file to the folder, without the indentation that would double its size
         QJsonDocument doc(recordJsonObj);
-        file.write(doc.toJson());
+        file.write(doc.toJson(QJsonDocument::Compact));
         file.close();
 
-        if(createdRecords)
+        if(writeBinary)
         {
-            createdRecords->insert("name",recordJsonObj);
+            binaryRecord.setDT(dT);
+
+            QString err;
+            if(binaryRecord.writeBinary(GroundMotionTimeHistory::binaryFilePath(outputFile), err) != 0)
+            {
+                recordErrorsData[i] = err;
+                return;
+            }
         }
+
+        if(recordObjectsData != nullptr)
+            recordObjectsData[i] = recordJsonObj;
+    };
+
+    QVector<int> recordIndices(numRecords);
+    std::iota(recordIndices.begin(), recordIndices.end(), 0);
+
+    QtConcurrent::blockingMap(recordIndices, convertRecord);
+
+    // Report the first record that failed, in the order of the metadata
+    for(auto&& recordErr : recordErrors)
+    {
+        if(!recordErr.isEmpty())
+        {
+            errorMsg = recordErr;
+            return -1;
+        }
+    }
+
+    if(createdRecords)
+    {
+        for(int i = 0; i<numRecords; ++i)
+            createdRecords->insert(recordNames.at(i),recordObjects.at(i));
     }
 
     // Remove the raw files
@@ -333,10 +537,10 @@ int NGAW2Converter::parseNGAW2SearchResults(const QString& filesDirectoryPath, Q
 }
 
 
-int NGAW2Converter::convertRecordToJson(const QString& inputFile, QJsonObject& recordJson, QString& errorMsg)
+int NGAW2Converter::parseRecordFile(const QString& inputFile, RecordComponent& component, QString& errorMsg)
 {
     // Open the raw file
-    QFile theRecordFile = QFile(inputFile);
+    QFile theRecordFile(inputFile);
 
     if (!theRecordFile.exists())
     {
@@ -344,131 +548,90 @@ int NGAW2Converter::convertRecordToJson(const QString& inputFile, QJsonObject& r
         return -1;
     }
 
-    if (theRecordFile.open(QIODevice::ReadOnly))
+    if (!theRecordFile.open(QIODevice::ReadOnly))
     {
-        auto firstLine = theRecordFile.readLine();
-
-        if(firstLine.compare("PEER NGA STRONG MOTION DATABASE RECORD\r\n") != 0)
-        {
-            errorMsg = "Only PEER NGA files supported";
-            return -1;
-        }
-
-        // Get the second line -> event name, event date, station ID, direction
-        auto secondLine = theRecordFile.readLine();
-
-        auto secondLineValues = secondLine.split(',');
+        errorMsg = "Could not open the file " + inputFile;
+        return -1;
+    }
 
-        if(secondLineValues.size() != 4)
-        {
-            errorMsg = "Error importing the time series raw data";
-            return -1;
-        }
+    // The records are small, read them at once and tokenize the bytes in place
+    const auto fileData = theRecordFile.readAll();
+    theRecordFile.close();
 
-        auto eventName = QString::fromLocal8Bit(secondLineValues.at(0)).trimmed();
+    const char* pos = fileData.constData();
+    const char* end = pos + fileData.size();
 
-        auto eventDate = QString::fromLocal8Bit(secondLineValues.at(1)).trimmed();
+    auto firstLine = readLine(pos, end);
 
-        auto stationID = QString::fromLocal8Bit(secondLineValues.at(2)).trimmed();
+    if(firstLine != "PEER NGA STRONG MOTION DATABASE RECORD")
+    {
+        errorMsg = "Only PEER NGA files supported";
+        return -1;
+    }
 
-        auto direction = QString::fromLocal8Bit(secondLineValues.at(3)).trimmed();
+    // Get the second line -> event name, event date, station ID, direction
+    auto secondLineValues = readLine(pos, end).split(',');
 
-        // Get the third line - type of time history, acceleration, velocity, displacement, etc.
-        auto timeHistoryType = QString::fromLocal8Bit(theRecordFile.readLine()).trimmed();
+    if(secondLineValues.size() != 4)
+    {
+        errorMsg = "Error importing the time series raw data";
+        return -1;
+    }
 
-        // Get the fourth line - number of points and time step (Dt)
-        auto fourthLine = QString::fromLocal8Bit(theRecordFile.readLine()).trimmed();
+    component.eventName = QString::fromLocal8Bit(secondLineValues.at(0)).trimmed();
+    component.eventDate = QString::fromLocal8Bit(secondLineValues.at(1)).trimmed();
+    component.stationID = QString::fromLocal8Bit(secondLineValues.at(2)).trimmed();
+    component.direction = QString::fromLocal8Bit(secondLineValues.at(3)).trimmed();
 
-        QRegExp rx = QRegExp("NPTS=\\s*([1-9][0-9]*)\\s*,\\s*DT=\\s*(\\d*\\.\\d+)\\s*SEC");
+    // Get the third line - type of time history, acceleration, velocity, displacement, etc.
+    component.timeHistoryType = QString::fromLocal8Bit(readLine(pos, end));
 
-        rx.indexIn(fourthLine);
+    // Get the fourth line - number of points and time step (Dt)
+    auto fourthLine = readLine(pos, end);
 
-        QStringList qsl = rx.capturedTexts();
+    double numPntsValue = 0.0;
+    if(!parseKeyValue(fourthLine, "NPTS=", numPntsValue) || numPntsValue < 1.0 || numPntsValue != floor(numPntsValue) || numPntsValue > std::numeric_limits<int>::max())
+    {
+        errorMsg = "Error converting string to integer";
+        return -1;
+    }
 
-        if(qsl.size() != 3)
-            return -1;
+    const int numPnts = static_cast<int>(numPntsValue);
 
-        bool OK = true;
+    if(!parseKeyValue(fourthLine, "DT=", component.dT) || component.dT <= 0.0)
+    {
+        errorMsg = "Error converting string to double";
+        return -1;
+    }
 
-        auto numPtnsStr = qsl[1];
-        auto numPnts = numPtnsStr.toInt(&OK);
+    auto& timeHistory = component.timeHistory;
+    timeHistory.clear();
+    timeHistory.reserve(numPnts);
 
-        if(!OK)
-        {
-            errorMsg = "Error converting string to integer";
-            return -1;
-        }
+    double peakValue = 0.0;
 
-        auto dTStr = qsl[2];
-        auto dT = dTStr.toDouble(&OK);
+    for(pos = skipSpaces(pos, end); pos != end; pos = skipSpaces(pos, end))
+    {
+        double dataPointValue = 0.0;
 
-        if(!OK)
+        if(!parseNumber(pos, end, dataPointValue))
         {
-            errorMsg = "Error converting string to double";
+            errorMsg = "Error converting to double ";
             return -1;
         }
 
-        QJsonArray timeHistoryArray;
-
-        QRegExp delim("\\s+");
-
-        // File opened successfully, parse csv file for records
-        while (!theRecordFile.atEnd())
-        {
-            auto line =  QString::fromLocal8Bit(theRecordFile.readLine()).trimmed();
-
-            foreach (const QString &item, line.split(delim, QString::SkipEmptyParts))
-            {
-                bool OK = true;
-                auto dataPointValue = item.toDouble(&OK);
-
-                if(!OK)
-                {
-                    errorMsg = "Error converting to double ";
-                    return -1;
-                }
+        peakValue = std::max(peakValue, fabs(dataPointValue));
 
-                timeHistoryArray.append(dataPointValue);
-
-            }
-        }
-
-        if(timeHistoryArray.size() != numPnts)
-        {
-            errorMsg = "Error, the number of imported points should match the number of points in the time-history input file";
-            return -1;
-        }
-
-        recordJson.insert("NumberPoints", numPnts);
-        recordJson.insert("EventName", eventName);
-        recordJson.insert("EventDate", eventDate);
-        recordJson.insert("StationID", stationID);
-        recordJson.insert("Direction", direction);
-        recordJson.insert("TimeHistoryType", timeHistoryType);
-        recordJson.insert("dT", dT);
-        recordJson.insert("TimeHistoryData",timeHistoryArray);
+        timeHistory.append(dataPointValue);
     }
 
-
-    return 0;
-}
-
-
-double NGAW2Converter::getPGA(const QJsonArray* timeHistory)
-{
-
-    auto variantList = timeHistory->toVariantList();
-
-    auto PGAmax = 0.0;
-
-    for(auto&& it : variantList)
+    if(timeHistory.size() != numPnts)
     {
-        auto val = it.toDouble();
-
-        if(fabs(val) > PGAmax)
-           PGAmax = val;
+        errorMsg = "Error, the number of imported points should match the number of points in the time-history input file";
+        return -1;
     }
 
-    return PGAmax;
-}
+    component.peakValue = peakValue;
 
+    return 0;
+}
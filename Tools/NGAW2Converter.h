@@ -41,25 +41,49 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include <QJsonObject>
+#include <QString>
+#include <QVector>
 
 class NGAW2Converter
 {
 public:
     NGAW2Converter();
 
+    // The records are converted in parallel, one record with all of its directions per task
     int convertToSimCenterEvent(const QString& pathToOutputDirectory, const QJsonObject& NGA2Results, QString& errorMsg, QJsonObject* createdRecords);
 
     int parseNGAW2SearchResults(const QString& filesDirectoryPath, QJsonObject& resultsJson, QString& errorMsg);
 
+    // Also write a compact binary copy of every record next to its JSON file, see GroundMotionTimeHistory::writeBinary
+    void setWriteBinaryRecords(bool value);
+
 private:
-    int convertRecordToJson(const QString& inputFile, QJsonObject& recordJson, QString& errorMsg);
 
-    double getPGA(const QJsonArray* timeHistory);
+    // One direction of a record as it is read from a PEER .AT2 file
+    struct RecordComponent
+    {
+        QString eventName;
+        QString eventDate;
+        QString stationID;
+        QString direction;
+        QString timeHistoryType;
+
+        double dT = 0.0;
+
+        QVector<double> timeHistory;
+
+        // The largest absolute value of the time history, found while parsing
+        double peakValue = 0.0;
+    };
+
+    // Thread-safe, returns 0 on success and -1 on failure with the message in errorMsg
+    static int parseRecordFile(const QString& inputFile, RecordComponent& component, QString& errorMsg);
 
     bool directionH1;
     bool directionH2;
     bool directionVert;
 
+    bool writeBinaryRecords;
 };
 
 #endif // NGAW2CONVERTER_H
@@ -0,0 +1,571 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "NearestNeighbourEventMapper.h"
+#include "CSVStreamReader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QVarLengthArray>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+// Mixes the seed and the position of an asset into the seed of the asset's own generator
+quint64 splitMix64(quint64 x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+
+// Uniform number in [0,1) from the top 53 bits, unlike std::uniform_real_distribution this is the same with every standard library
+double uniform01(std::mt19937_64& generator)
+{
+    return static_cast<double>(generator() >> 11)*(1.0/9007199254740992.0);
+}
+
+
+// Runs fn(begin,end) over contiguous ranges of [0,n) on the thread pool
+template <typename Function>
+void parallelRanges(const int n, Function fn)
+{
+    const int numPartitions = std::max(1, std::min(n, 4*QThread::idealThreadCount()));
+
+    QVector<int> partitions(numPartitions);
+    std::iota(partitions.begin(), partitions.end(), 0);
+
+    QtConcurrent::blockingMap(partitions, [&](const int partition)
+    {
+        fn(static_cast<int>(static_cast<qint64>(n)*partition/numPartitions), static_cast<int>(static_cast<qint64>(n)*(partition+1)/numPartitions));
+    });
+}
+
+}
+
+
+NearestNeighbourEventMapper::NearestNeighbourEventMapper()
+{
+
+}
+
+
+int NearestNeighbourEventMapper::loadEventGrid(const QString& pathToEventGrid, QString& err)
+{
+    gridPointFiles.clear();
+    tree.clear();
+    eventType.clear();
+    eventCount = 0;
+    assetEvents.clear();
+
+    eventDir = QFileInfo(pathToEventGrid).absolutePath();
+
+    int indexFile = -1;
+    int indexLon = -1;
+    int indexLat = -1;
+
+    QString rowErr;
+
+    CSVStreamReader csvReader;
+    auto res = csvReader.parseFile(pathToEventGrid, [&](const CSVRow& row, int rowIndex)
+    {
+        if(rowIndex == 0)
+        {
+            for(int i = 0; i<row.size(); ++i)
+            {
+                if(row[i].equals("GP_file"))
+                    indexFile = i;
+                else if(row[i].equals("Longitude"))
+                    indexLon = i;
+                else if(row[i].equals("Latitude"))
+                    indexLat = i;
+            }
+
+            if(indexFile == -1 || indexLon == -1 || indexLat == -1)
+            {
+                rowErr = "The event grid file needs the columns GP_file, Longitude, and Latitude";
+                return false;
+            }
+
+            return true;
+        }
+
+        if(row.size() <= std::max(indexFile, std::max(indexLon, indexLat)))
+        {
+            rowErr = "Missing values in the row " + QString::number(rowIndex) + " of the event grid file";
+            return false;
+        }
+
+        bool okLon = false, okLat = false;
+        auto lon = row[indexLon].toDouble(&okLon);
+        auto lat = row[indexLat].toDouble(&okLat);
+
+        if(!okLon || !okLat)
+        {
+            rowErr = "Error converting the location in the row " + QString::number(rowIndex) + " of the event grid file to a double";
+            return false;
+        }
+
+        tree.push_back(GridPoint{lon, lat, gridPointFiles.size()});
+        gridPointFiles.append(row[indexFile].toString());
+
+        return true;
+    }, err);
+
+    if(res != 0)
+        return -1;
+
+    if(!rowErr.isEmpty())
+    {
+        err = rowErr;
+        return -1;
+    }
+
+    if(tree.isEmpty())
+    {
+        err = "The event grid file " + pathToEventGrid + " has no grid points";
+        return -1;
+    }
+
+    if(!gridPointFiles.first().endsWith(".csv", Qt::CaseInsensitive))
+    {
+        err = "Only grid points with .csv files are supported, found " + gridPointFiles.first();
+        return -1;
+    }
+
+    // Every grid point is assumed to have the same type and number of events as the first one, like in the NearestNeighborEvents application
+    QStringList firstHeadings;
+
+    CSVStreamReader firstReader;
+    res = firstReader.parseFile(eventDir + QDir::separator() + gridPointFiles.first(), [&](const CSVRow& row, int rowIndex)
+    {
+        if(rowIndex == 0)
+            firstHeadings = row.toStringList();
+
+        return true;
+    }, err);
+
+    if(res != 0)
+        return -1;
+
+    eventCount = firstReader.numRowsParsed() - 1;
+
+    if(firstHeadings.isEmpty() || eventCount < 1)
+    {
+        err = "The grid point file " + gridPointFiles.first() + " has no events";
+        return -1;
+    }
+
+    eventType = (firstHeadings.first() == "TH_file" || firstHeadings.first() == "GM_file") ? "timeHistory" : "intensityMeasure";
+
+    this->buildTree(0, tree.size(), 0);
+
+    return 0;
+}
+
+
+void NearestNeighbourEventMapper::buildTree(const int begin, const int end, const int depth)
+{
+    if(end - begin < 2)
+        return;
+
+    const int mid = begin + (end - begin)/2;
+
+    if(depth % 2 == 0)
+        std::nth_element(tree.begin() + begin, tree.begin() + mid, tree.begin() + end, [](const GridPoint& a, const GridPoint& b) { return a.x < b.x; });
+    else
+        std::nth_element(tree.begin() + begin, tree.begin() + mid, tree.begin() + end, [](const GridPoint& a, const GridPoint& b) { return a.y < b.y; });
+
+    this->buildTree(begin, mid, depth + 1);
+    this->buildTree(mid + 1, end, depth + 1);
+}
+
+
+int NearestNeighbourEventMapper::numGridPoints(void) const
+{
+    return tree.size();
+}
+
+
+void NearestNeighbourEventMapper::nearestGridPoints(const double longitude, const double latitude, const int k, QVector<int>& indices, QVector<double>& distances) const
+{
+    indices.clear();
+    distances.clear();
+
+    const int numNeighbours = std::min(k, tree.size());
+
+    if(numNeighbours <= 0)
+        return;
+
+    // The best candidates so far as (squared distance, grid point) pairs, kept sorted
+    QVarLengthArray<QPair<double,int>, 16> best;
+
+    auto consider = [&](const GridPoint& point)
+    {
+        const double dx = point.x - longitude;
+        const double dy = point.y - latitude;
+        const auto candidate = qMakePair(dx*dx + dy*dy, point.index);
+
+        if(best.size() == numNeighbours && !(candidate < best.last()))
+            return;
+
+        if(best.size() == numNeighbours)
+            best.removeLast();
+
+        best.insert(std::upper_bound(best.begin(), best.end(), candidate), candidate);
+    };
+
+    // Depth-first search that visits the side of a split containing the location first and the other side only if it can hold a closer point
+    std::function<void(int,int,int)> search = [&](const int begin, const int end, const int depth)
+    {
+        if(begin >= end)
+            return;
+
+        const int mid = begin + (end - begin)/2;
+        const auto& node = tree.at(mid);
+
+        consider(node);
+
+        const double diff = depth % 2 == 0 ? longitude - node.x : latitude - node.y;
+
+        const int nearBegin = diff < 0.0 ? begin : mid + 1;
+        const int nearEnd = diff < 0.0 ? mid : end;
+        const int farBegin = diff < 0.0 ? mid + 1 : begin;
+        const int farEnd = diff < 0.0 ? end : mid;
+
+        search(nearBegin, nearEnd, depth + 1);
+
+        if(best.size() < numNeighbours || diff*diff <= best.last().first)
+            search(farBegin, farEnd, depth + 1);
+    };
+
+    search(0, tree.size(), 0);
+
+    indices.reserve(best.size());
+    distances.reserve(best.size());
+
+    for(auto&& it : best)
+    {
+        indices.push_back(it.second);
+        distances.push_back(std::sqrt(it.first));
+    }
+}
+
+
+int NearestNeighbourEventMapper::readGridPointEvents(const int gridPoint, QVector<Event>& events, QString& err) const
+{
+    const auto path = eventDir + QDir::separator() + gridPointFiles.at(gridPoint);
+
+    QString rowErr;
+
+    CSVStreamReader csvReader;
+    auto res = csvReader.parseFile(path, [&](const CSVRow& row, int rowIndex)
+    {
+        if(rowIndex == 0 || row.empty())
+            return true;
+
+        Event event;
+        event.name = row[0].toString();
+
+        // A record without a scaling factor is not scaled
+        if(row.size() > 1 && !row[1].isEmpty())
+        {
+            bool ok = false;
+            event.scaleFactor = row[1].toDouble(&ok);
+
+            if(!ok)
+            {
+                rowErr = "Error converting the scaling factor in the row " + QString::number(rowIndex) + " of the file " + path + " to a double";
+                return false;
+            }
+        }
+
+        events.push_back(event);
+
+        return true;
+    }, err);
+
+    if(res != 0)
+        return -1;
+
+    if(!rowErr.isEmpty())
+    {
+        err = rowErr;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int NearestNeighbourEventMapper::mapAssets(const QVector<Asset>& assets, const int numNeighbours, const int numSamples, const int seed, QString& err)
+{
+    assetEvents.clear();
+    numMapped = 0;
+
+    if(tree.isEmpty())
+    {
+        err = "Load an event grid before mapping the assets";
+        return -1;
+    }
+
+    if(numNeighbours < 1 || numSamples < 1)
+    {
+        err = "The number of neighbors and the number of samples have to be at least one";
+        return -1;
+    }
+
+    const int numAssets = assets.size();
+
+    // The grid point of every sample of every asset, the number of assets times the number of samples can be more than an int holds
+    const qint64 numSampled = static_cast<qint64>(numAssets)*numSamples;
+
+    if(static_cast<quint64>(numSampled) > static_cast<quint64>(std::vector<int>().max_size()))
+    {
+        err = "The number of assets times the number of samples is too large to map in memory";
+        return -1;
+    }
+
+    std::vector<int> sampledGridPoints(static_cast<size_t>(numSampled), -1);
+    int* sampledData = sampledGridPoints.data();
+
+    parallelRanges(numAssets, [&](const int begin, const int end)
+    {
+        QVector<int> indices;
+        QVector<double> distances;
+        QVector<double> cumulativeWeights;
+
+        for(int i = begin; i<end; ++i)
+        {
+            // Count the progress in steps so that the threads do not all write to the counter for every asset
+            if((i - begin) % 1024 == 1023)
+            {
+                numMapped += 1024;
+
+                if(cancelled)
+                    return;
+            }
+
+            const auto& asset = assets.at(i);
+
+            this->nearestGridPoints(asset.longitude, asset.latitude, numNeighbours, indices, distances);
+
+            // Inverse squared distance weights, a grid point on top of the asset takes all of the weight
+            const bool onGridPoint = distances.first() == 0.0;
+
+            cumulativeWeights.resize(distances.size());
+
+            double sumWeights = 0.0;
+            for(int j = 0; j<distances.size(); ++j)
+            {
+                if(onGridPoint)
+                    sumWeights += distances.at(j) == 0.0 ? 1.0 : 0.0;
+                else
+                    sumWeights += 1.0/(distances.at(j)*distances.at(j));
+
+                cumulativeWeights[j] = sumWeights;
+            }
+
+            std::mt19937_64 generator(splitMix64(static_cast<quint64>(static_cast<quint32>(seed)) ^ splitMix64(static_cast<quint64>(i))));
+
+            for(int s = 0; s<numSamples; ++s)
+            {
+                const double u = uniform01(generator)*sumWeights;
+
+                auto pick = std::upper_bound(cumulativeWeights.begin(), cumulativeWeights.end(), u) - cumulativeWeights.begin();
+                pick = std::min<qint64>(pick, cumulativeWeights.size() - 1);
+
+                sampledData[static_cast<size_t>(i)*numSamples + s] = indices.at(pick);
+            }
+        }
+
+        numMapped += (end - begin) % 1024;
+    });
+
+    if(cancelled)
+    {
+        err = "The mapping of the events was cancelled";
+        return -1;
+    }
+
+    // Read the records of only the grid points that were sampled, for intensity measures the file and row are the event
+    QVector<QVector<Event>> gridEvents(tree.size());
+
+    if(eventType == "timeHistory")
+    {
+        QSet<int> usedSet;
+        for(auto&& it : sampledGridPoints)
+            usedSet.insert(it);
+
+        QVector<int> usedGridPoints(usedSet.begin(), usedSet.end());
+        std::sort(usedGridPoints.begin(), usedGridPoints.end());
+
+        QVector<QString> readErrors(usedGridPoints.size());
+        QVector<Event>* gridEventsData = gridEvents.data();
+        QString* readErrorsData = readErrors.data();
+
+        parallelRanges(usedGridPoints.size(), [&](const int begin, const int end)
+        {
+            for(int i = begin; i<end; ++i)
+                this->readGridPointEvents(usedGridPoints.at(i), gridEventsData[usedGridPoints.at(i)], readErrorsData[i]);
+        });
+
+        for(auto&& it : readErrors)
+        {
+            if(!it.isEmpty())
+            {
+                err = it;
+                return -1;
+            }
+        }
+    }
+
+    assetEvents.resize(numAssets);
+
+    for(int i = 0; i<numAssets; ++i)
+    {
+        auto& events = assetEvents[i];
+        events.reserve(numSamples);
+
+        for(int s = 0; s<numSamples; ++s)
+        {
+            const int gridPoint = sampledGridPoints[static_cast<size_t>(i)*numSamples + s];
+
+            // Cycle through the events if there are more samples than events
+            const int eventIndex = s % eventCount;
+
+            if(eventType == "timeHistory")
+            {
+                const auto& available = gridEvents.at(gridPoint);
+
+                if(eventIndex >= available.size())
+                {
+                    err = "The grid point file " + gridPointFiles.at(gridPoint) + " has fewer events than the first grid point";
+                    assetEvents.clear();
+                    return -1;
+                }
+
+                events.push_back(available.at(eventIndex));
+            }
+            else
+            {
+                Event event;
+                event.name = gridPointFiles.at(gridPoint) + "x" + QString::number(eventIndex);
+                events.push_back(event);
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+int NearestNeighbourEventMapper::getNumMapped(void) const
+{
+    return numMapped;
+}
+
+
+void NearestNeighbourEventMapper::cancel(void)
+{
+    cancelled = true;
+}
+
+
+const QVector<QVector<NearestNeighbourEventMapper::Event>>& NearestNeighbourEventMapper::getAssetEvents(void) const
+{
+    return assetEvents;
+}
+
+
+QString NearestNeighbourEventMapper::getEventType(void) const
+{
+    return eventType;
+}
+
+
+int NearestNeighbourEventMapper::writeAssetEventsTable(const QVector<Asset>& assets, const QString& pathToTable, QString& err) const
+{
+    if(assets.size() != assetEvents.size())
+    {
+        err = "The assets do not match the assets that were mapped";
+        return -1;
+    }
+
+    QSaveFile outFile(pathToTable);
+    if(!outFile.open(QFile::WriteOnly | QFile::Text))
+    {
+        err = "Could not open the file " + pathToTable;
+        return -1;
+    }
+
+    QTextStream out(&outFile);
+    out << "AssetID,Sample,Event,ScaleFactor\n";
+
+    for(int i = 0; i<assets.size(); ++i)
+    {
+        const auto& events = assetEvents.at(i);
+
+        for(int s = 0; s<events.size(); ++s)
+            out << assets.at(i).id << ',' << s << ',' << events.at(s).name << ',' << events.at(s).scaleFactor << '\n';
+    }
+
+    out.flush();
+
+    if(out.status() != QTextStream::Ok || !outFile.commit())
+    {
+        err = "Could not write the events to the file " + pathToTable;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#ifndef NEARESTNEIGHBOUREVENTMAPPER_H
+#define NEARESTNEIGHBOUREVENTMAPPER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// In-process version of the NearestNeighborEvents regional mapping application
+// The grid points of an EventGrid.csv are put into a 2-d tree over their longitude and latitude, every asset then takes the events of a number of samples from its nearest grid points, where a neighbour is picked with a probability proportional to its inverse squared distance
+// The workflow still runs the application to write the events into the asset files, this version previews the assignment on the assets that are loaded in R2D
+// The samples of an asset depend only on the seed and the position of the asset in the list, so that a seed always gives the same assignment no matter how many threads are used
+
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+class NearestNeighbourEventMapper
+{
+public:
+
+    struct Asset
+    {
+        QString id;
+        double longitude = 0.0;
+        double latitude = 0.0;
+    };
+
+    // An event and its scaling factor, i.e., a ground motion record or a row of intensity measures at a grid point
+    struct Event
+    {
+        QString name;
+        double scaleFactor = 1.0;
+    };
+
+    NearestNeighbourEventMapper();
+
+    // Reads the grid points (GP_file, Longitude, Latitude) of an EventGrid.csv and builds the tree over their locations
+    // Returns 0 on success and -1 on failure with the message in err
+    int loadEventGrid(const QString& pathToEventGrid, QString& err);
+
+    int numGridPoints(void) const;
+
+    // The k grid points that are closest to a location, closest first, ties go to the grid point that comes first in the file
+    void nearestGridPoints(const double longitude, const double latitude, const int k, QVector<int>& indices, QVector<double>& distances) const;
+
+    // Samples the events of every asset in parallel, the result has one list of numSamples events per asset
+    int mapAssets(const QVector<Asset>& assets, const int numNeighbours, const int numSamples, const int seed, QString& err);
+
+    // The number of assets that mapAssets has sampled so far, can be called from another thread while it runs
+    int getNumMapped(void) const;
+
+    // Makes mapAssets stop and return -1, the one that is running or the next one if it has not started yet, can be called from another thread
+    void cancel(void);
+
+    const QVector<QVector<Event>>& getAssetEvents(void) const;
+
+    // "timeHistory" if the grid points list ground motion records, or "intensityMeasure"
+    QString getEventType(void) const;
+
+    // Writes the events of every asset into a CSV table with one row per sample (AssetID, Sample, Event, ScaleFactor)
+    int writeAssetEventsTable(const QVector<Asset>& assets, const QString& pathToTable, QString& err) const;
+
+private:
+
+    struct GridPoint
+    {
+        double x;
+        double y;
+        int index;
+    };
+
+    void buildTree(const int begin, const int end, const int depth);
+
+    // Reads the ground motion records and their scaling factors listed in the file of a grid point
+    int readGridPointEvents(const int gridPoint, QVector<Event>& events, QString& err) const;
+
+    QString eventDir;
+
+    QStringList gridPointFiles;
+
+    // The grid points in the order of an implicit tree: the middle of a range is the node that splits it, on x at even depths and on y at odd depths
+    QVector<GridPoint> tree;
+
+    QString eventType;
+
+    // Number of events at every grid point, taken from the first grid point
+    int eventCount = 0;
+
+    QVector<QVector<Event>> assetEvents;
+
+    std::atomic<int> numMapped{0};
+    std::atomic<bool> cancelled{false};
+};
+
+#endif // NEARESTNEIGHBOUREVENTMAPPER_H
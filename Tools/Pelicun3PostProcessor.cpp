@@ -42,6 +42,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "MainWindowWorkflowApp.h"
 #include "Pelicun3PostProcessor.h"
 #include "REmpiricalProbabilityDistribution.h"
+#include "ResultsColumnCache.h"
+#include "ResultsTableModel.h"
 #include "TablePrinter.h"
 #include "TableNumberItem.h"
 #include "VisualizationWidget.h"
@@ -70,6 +72,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStackedBarSeries>
 #include <QStringList>
 #include <QTabWidget>
+#include <QTableView>
 #include <QTableWidget>
 #include <QTextCursor>
 #include <QTextTable>
@@ -80,6 +83,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <qgsattributes.h>
 #include <qgsmapcanvas.h>
 
+#include <limits>
+
 // Test to remove start
 // #include <chrono>
 // using namespace std::chrono;
@@ -270,31 +275,28 @@ int Pelicun3PostProcessor::processResults(QString &outputFile, QString &dirName,
     for (int type_i=0; type_i<typesInAssetType.count(); type_i++){
         QString type = typesInAssetType.at(type_i);
         QString pathGeojson = dirName + QDir::separator() +  type + QString(".geojson");
-        QFile jsonFile(pathGeojson);
-        QJsonArray features;
-        if (jsonFile.exists() && jsonFile.open(QFile::ReadOnly)){
-            QJsonDocument exDoc = QJsonDocument::fromJson(jsonFile.readAll());
-            QJsonObject jsonObject = exDoc.object();
-            features = jsonObject["features"].toArray();
+        if (!QFileInfo::exists(pathGeojson)) {
+            continue;
         }
 
-        QStringList extractAttributes = {"AIM_id"};
+        // The results are read from the binary cache next to the geojson, which is built the first time the results are opened
+        auto resultsCache = std::make_shared<ResultsColumnCache>();
+        QString cacheErr;
+        if (resultsCache->open(pathGeojson, cacheErr) != 0) {
+            this->errorMessage(cacheErr);
+            continue;
+        }
+
+        QVector<int> extractColumns = {-1};
         QStringList comboBoxHeadings = {"AIM_id"};
         bool hasR2DresToShow = false;
-        for (int i = 0; i < features.size(); i++){
-            QJsonObject ft = features.at(i).toObject();
-            QJsonObject properties = ft["properties"].toObject();
-            QStringList keys = properties.keys();
-            foreach (const QString &key, keys) {
-                if (key.startsWith("R2Dres_")){
-                    QString resultName = key.section('_', 1);
-                    if (!resultName.startsWith("MostLikelyDamageState") &&
-                        !extractAttributes.contains(key)){
-                        extractAttributes.append(key);
-                        comboBoxHeadings.append(key.section('_', 1));
-                        hasR2DresToShow = true;
-                    }
-                }
+        const QStringList& resultColumns = resultsCache->getColumnNames();
+        for (int col = 0; col < resultColumns.size(); ++col) {
+            QString resultName = resultColumns.at(col).section('_', 1);
+            if (!resultName.startsWith("MostLikelyDamageState")){
+                extractColumns.append(col);
+                comboBoxHeadings.append(resultName);
+                hasR2DresToShow = true;
             }
         }
         if (!hasR2DresToShow) {
@@ -314,7 +316,9 @@ int Pelicun3PostProcessor::processResults(QString &outputFile, QString &dirName,
 
         QVBoxLayout* typetableWidgetLayout = new QVBoxLayout(typetableWidget);
 
-        QTableWidget* typeResultsTableWidget = new QTableWidget(typeDockWidget);
+        QTableView* typeResultsTableWidget = new QTableView(typeDockWidget);
+        ResultsTableModel* typeResultsTableModel = new ResultsTableModel(typeResultsTableWidget);
+        typeResultsTableWidget->setModel(typeResultsTableModel);
         typeResultsTableWidget->verticalHeader()->setVisible(false);
         typeResultsTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
@@ -349,7 +353,8 @@ int Pelicun3PostProcessor::processResults(QString &outputFile, QString &dirName,
         typetableWidgetLayout->addStretch(0);
 
 //        QStringList extractAttributes = {"AIM_id","mean repair_cost-","mean repair_time-parallel","mean repair_time-sequential", "highest_DMG"};
-        extractDataAddToTable(features, extractAttributes,typeResultsTableWidget, comboBoxHeadings);
+        extractDataAddToTable(*resultsCache, extractColumns, typeResultsTableModel, comboBoxHeadings);
+        resultsCacheList.append(resultsCache);
         dockList->append(typeDockWidget);
 
         typeDockWidget->setWidget(typetableWidget);
@@ -421,42 +426,25 @@ int Pelicun3PostProcessor::processResults(QString &outputFile, QString &dirName,
 
 }
 
-int Pelicun3PostProcessor::extractDataAddToTable(QJsonArray& features, QStringList& attributes, QTableWidget* table, QStringList headings){
-    QVector<QVector<double>> result(features.count(), QVector<double> (attributes.count(), 0.0));
-    table->setColumnCount(headings.size());
-    table->setHorizontalHeaderLabels(headings);
-    table->setRowCount(features.count());
-    for (int m = 0; m < features.count(); m++){
-        QJsonObject ft = features.at(m).toObject();
-        QJsonObject properties = ft["properties"].toObject();
-        for (int n = 0; n < attributes.count(); n++){
-            QString attri = attributes.at(n);
-            if (!properties.contains(attri)){
-                if (!properties.contains("type")) {
-//                    this->errorMessage(attri + QString("dose not exist in R2D_results.geojson"));
-                    return -1;
-                } else {
-//                    this->errorMessage(attri + QString("for") + properties["type"].toString() + QString(" ") + ft["id"].toString() + QString(" dose not exist in R2D_results.geojson"));
-                    if (attri.compare("AIM_id")==0){
-                        auto item = new TableNumberItem(QString::number(m));
-                        table->setItem(m, n, item);
-                    } else {
-                        auto item = new TableNumberItem("");
-                        table->setItem(m, n, item);
-                    }
-                }
-            }
-            else{
-                if (attri.compare("AIM_id")==0){
-                    auto item = new TableNumberItem(properties[attri].toString());
-                    table->setItem(m, n, item);
-                } else {
-                    result[m][n] = properties[attri].toDouble();
-                    auto item = new TableNumberItem(QString::number(result[m][n]));
-                    table->setItem(m, n, item);
-                }
+int Pelicun3PostProcessor::extractDataAddToTable(const ResultsColumnCache& resultsCache, const QVector<int>& columns, ResultsTableModel* table, QStringList headings){
+    const int numRows = resultsCache.numRows();
+    // The table reads straight from the columns of the cache, nothing is copied per cell
+    table->setNumberOfRows(numRows);
+    for (int n = 0; n < columns.count(); n++){
+        // Column -1 is the asset id
+        if (columns.at(n) == -1){
+            QVector<double> idValues(numRows);
+            for (int m = 0; m < numRows; m++){
+                bool OK;
+                idValues[m] = resultsCache.assetID(m).toDouble(&OK);
+                if (!OK)
+                    idValues[m] = std::numeric_limits<double>::quiet_NaN();
             }
+            const ResultsColumnCache* cache = &resultsCache;
+            table->addTextColumn(headings.at(n), [cache](int row){ return cache->assetID(row); }, idValues);
+            continue;
         }
+        table->addColumn(headings.at(n), resultsCache.column(columns.at(n)));
     }
     return 0;
 }
@@ -658,10 +646,12 @@ void Pelicun3PostProcessor::clear(void)
 {
 
     for (int i = 0; i < tableList.count(); i++){
-        QTableWidget* parentWidget = tableList.at(i);
-        parentWidget->clear();
+        auto tableModel = qobject_cast<ResultsTableModel*>(tableList.at(i)->model());
+        if (tableModel)
+            tableModel->clear();
     }
     tableList.clear();
+    resultsCacheList.clear();
     for (int i = 0; i < dockList->count(); i++){
         QDockWidget* parentWidget = dockList->at(i);
         qDeleteAll(parentWidget->findChildren<QWidget*>("", Qt::FindDirectChildrenOnly));
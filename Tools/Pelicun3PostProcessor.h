@@ -47,13 +47,15 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QJsonArray>
 
 #include <memory>
-#include <set>
 
 class REmpiricalProbabilityDistribution;
+class ResultsColumnCache;
 class VisualizationWidget;
 
 class QDockWidget;
 class QTableWidget;
+class QTableView;
+class ResultsTableModel;
 class QGridLayout;
 class QLabel;
 class QComboBox;
@@ -113,7 +115,7 @@ public:
         return val;
     }
 
-    void processResultsSubset(const std::set<int>& selectedComponentIDs);
+    void processResultsSubset(const ComponentIDSet& selectedComponentIDs);
 
     void setCurrentlyViewable(bool status);
 
@@ -157,14 +159,17 @@ private:
     QVBoxLayout* layout;
 
 //    QList<QDockWidget*> dockList;
-    QList<QTableWidget*> tableList;
+    QList<QTableView*> tableList;
 
     QComboBox* sortComboBox;
 
     QGraphicsView* mapViewMainWidget;
 
 
-    int extractDataAddToTable(QJsonArray& features, QStringList& attributes, QTableWidget* table, QStringList headings);
+    int extractDataAddToTable(const ResultsColumnCache& resultsCache, const QVector<int>& columns, ResultsTableModel* table, QStringList headings);
+
+    // The results cache of each asset type that has a table, kept open while the tables are shown
+    QList<std::shared_ptr<ResultsColumnCache>> resultsCacheList;
 
 //    QByteArray uiState;
 
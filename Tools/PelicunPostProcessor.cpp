@@ -44,6 +44,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "REmpiricalProbabilityDistribution.h"
 #include "TablePrinter.h"
 #include "TableNumberItem.h"
+#include "ResultsTableModel.h"
 #include "VisualizationWidget.h"
 #include "WorkflowAppR2D.h"
 #include "Utils/ProgramOutputDialog.h"
@@ -70,9 +71,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStackedBarSeries>
 #include <QStringList>
 #include <QTabWidget>
+#include <QTableView>
 #include <QTableWidget>
 #include <QTextCursor>
 #include <QTextTable>
+#include <QTimer>
 #include <QValueAxis>
 
 #include "QGISVisualizationWidget.h"
@@ -80,6 +83,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <qgsattributes.h>
 #include <qgsmapcanvas.h>
 
+#include <limits>
+#include <numeric>
+
 // Test to remove start
 // #include <chrono>
 // using namespace std::chrono;
@@ -94,6 +100,16 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
     Losseschart = nullptr;
     viewMenu = nullptr;
 
+    // Coalesces the updates of the charts and of the table while a selection is being made on the map
+    subsetUpdateTimer = new QTimer(this);
+    subsetUpdateTimer->setSingleShot(true);
+    subsetUpdateTimer->setInterval(50);
+    connect(subsetUpdateTimer, &QTimer::timeout, this, [this]()
+    {
+        if(!pendingSubsetRows.isEmpty())
+            this->updateDVSummary(pendingSubsetRows);
+    });
+
     // Create a view menu for the dockable windows
     auto menuBar = WorkflowAppR2D::getInstance()->getTheMainWindow()->menuBar();
 
@@ -183,7 +199,9 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
 
     auto tableWidgetLayout = new QVBoxLayout(tableWidget);
 
-    pelicunResultsTableWidget = new QTableWidget(this);
+    pelicunResultsTableWidget = new QTableView(this);
+    pelicunResultsTableModel = new ResultsTableModel(pelicunResultsTableWidget);
+    pelicunResultsTableWidget->setModel(pelicunResultsTableModel);
     pelicunResultsTableWidget->verticalHeader()->setVisible(false);
     pelicunResultsTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
@@ -306,7 +324,8 @@ void PelicunPostProcessor::importResults(const QString& pathToResults)
     if(!errMsg.isEmpty())
         throw errMsg;
 
-    DVdata = csvTool.parseCSVFile(pathToBuildings + QDir::separator() + DVResultsSheet,errMsg);
+    // Only the typed DV columns are kept after the import, see processDVResults
+    auto DVdata = csvTool.parseCSVFile(pathToBuildings + QDir::separator() + DVResultsSheet,errMsg);
      if(!errMsg.isEmpty())
         throw errMsg;
 
@@ -416,40 +435,6 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
     //    auto indexFloodRCagg = headerStrings.indexOf("Repair Cost-Flood-aggregate");
     //    auto indexFloodRC1_1 = headerStrings.indexOf("Repair Cost-Flood-1_1-mean");
 
-    QStringList tableHeadings = {"Asset ID","Repair\nCost","Repair\nTime","Replacement\nProbability","Fatalities","Loss\nRatio"};
-
-    pelicunResultsTableWidget->setColumnCount(tableHeadings.size());
-    pelicunResultsTableWidget->setHorizontalHeaderLabels(tableHeadings);
-    pelicunResultsTableWidget->setRowCount(DVResults.size()-numHeaderRows);
-
-    auto cumulativeSagg = 0.0;
-    auto cumulativeNSagg = 0.0;
-
-    auto cumulativeStructDS1 = 0.0;
-    auto cumulativeStructDS2 = 0.0;
-    auto cumulativeStructDS3 = 0.0;
-    auto cumulativeStructDS4 = 0.0;
-
-    auto cumulativeNSAccDS1 = 0.0;
-    auto cumulativeNSAccDS2 = 0.0;
-    auto cumulativeNSAccDS3 = 0.0;
-    auto cumulativeNSAccDS4 = 0.0;
-
-    auto cumulativeNSDriftDS1 = 0.0;
-    auto cumulativeNSDriftDS2 = 0.0;
-    auto cumulativeNSDriftDS3 = 0.0;
-    auto cumulativeNSDriftDS4 = 0.0;
-
-    auto cumulativeinjSevLvl1 = 0.0;
-    auto cumulativeinjSevLvl2 = 0.0;
-    auto cumulativeinjSevLvl3 = 0.0;
-    auto cumulativeinjSevLvl4 = 0.0;
-
-    auto cumulativeRepairTime = 0.0;
-    auto cumulativeRepairCost = 0.0;
-
-    REmpiricalProbabilityDistribution theProbDist;
-
     // Get the buildings database
     auto theBuildingDB = ComponentDatabaseManager::getInstance()->getAssetDb("Buildings");
 
@@ -468,118 +453,88 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
     auto selFeatLayer = theBuildingDB->getSelectedLayer();
     mapViewSubWidget->setCurrentLayer(selFeatLayer);
 
+    // The results are kept as typed columns with an index from the asset ID to the row, selections on the map are then a gather over the rows
+    const int numRows = DVResults.size()-numHeaderRows;
+    DVcolumns.resize(numRows);
+    DVrowOfID.clear();
+    DVrowOfID.reserve(numRows);
+
     // Vector to hold the attributes
-    QVector< QgsAttributes > fieldAttributes(DVResults.size()-numHeaderRows, QgsAttributes(numHeaderColumns));
+    QVector< QgsAttributes > fieldAttributes(numRows, QgsAttributes(numHeaderColumns));
+
+    // The IDs that are in more than one row of the results
+    QStringList repeatedIDs;
 
     // 4 rows of headers in the results file
     for(int i = numHeaderRows, count = 0; i<DVResults.size(); ++i, ++count)
     {
-        auto inputRow = DVResults.at(i);
+        const auto& inputRow = DVResults.at(i);
 
         auto buildingID = objectToInt(inputRow.at(0));
 
+        // A repeated asset ID keeps its first row, like the lookup by ID did before the index
+        if(!DVrowOfID.contains(buildingID))
+            DVrowOfID.insert(buildingID, count);
+        else
+            repeatedIDs.append(QString::number(buildingID));
+
         // Defaults to 1.0 if no replacement cost is given, i.e., it assumes the repair cost is the loss ratio
         auto replacementCostVar = theBuildingDB->getAttributeValue(buildingID,"ReplacementCost",QVariant(1.0));
 
         auto replacementCost = replacementCostVar.toDouble();
 
         // This assumes that the output from pelicun will not change
-        auto IDStr = inputRow.at(0);                                // ID
-        auto totalRepairCost = inputRow.at(indexRCagg);             // Aggregate repair cost (mean)
-        auto replaceMentProb = inputRow.at(indexRepairImpracProb);  // Replacement probability, i.e., repair impractical probability
+        DVcolumns.assetIDs[count] = inputRow.at(0);
 
-        auto repairTime = 0.0;
+        // Aggregate repair cost (mean)
+        auto repairCost = objectToDouble(inputRow.at(indexRCagg));
+        DVcolumns.repairCost[count] = repairCost;
+        DVcolumns.lossRatio[count] = repairCost/replacementCost;
 
-        auto injSevLvl1 = 0.0;
-        auto injSevLvl2 = 0.0;
-        auto injSevLvl3 = 0.0;
-        auto fatalities = 0.0; // injSevLvl4
+        // Replacement probability, i.e., repair impractical probability
+        bool replacementProbOK;
+        auto replacementProbValue = inputRow.at(indexRepairImpracProb).toDouble(&replacementProbOK);
+        DVcolumns.replacementProb[count] = replacementProbOK ? replacementProbValue : std::numeric_limits<double>::quiet_NaN();
 
         // Aggregate repair time (mean)
         if(indexRepairTime != -1)
-            repairTime = objectToDouble(inputRow.at(indexRepairTime));
-
-        cumulativeRepairTime += repairTime;
+            DVcolumns.repairTime[count] = objectToDouble(inputRow.at(indexRepairTime));
 
+        // Structural losses damage states 1 to 4 (mean), damage state 4 includes 4_2
         if(indexSRC1_1 != -1)
         {
-            auto StructDS1 = objectToDouble(inputRow.at(indexSRC1_1));    // Structural losses damage state 1 (mean)
-            auto StructDS2 = objectToDouble(inputRow.at(indexSRC1_1+1));  // Structural losses damage state 2 (mean)
-            auto StructDS3 = objectToDouble(inputRow.at(indexSRC1_1+2));  // Structural losses damage state 3 (mean)
-            auto StructDS4 = objectToDouble(inputRow.at(indexSRC1_1+3));  // Structural losses damage state 4 (mean)
-            StructDS4 += objectToDouble(inputRow.at(indexSRC1_1+4));      // Structural losses damage state 4_2 (mean)
-
-            cumulativeStructDS1 += StructDS1;
-            cumulativeStructDS2 += StructDS2;
-            cumulativeStructDS3 += StructDS3;
-            cumulativeStructDS4 += StructDS4;
+            for(int ds = 0; ds<4; ++ds)
+                DVcolumns.structLoss[ds][count] = objectToDouble(inputRow.at(indexSRC1_1+ds));
+
+            DVcolumns.structLoss[3][count] += objectToDouble(inputRow.at(indexSRC1_1+4));
         }
 
+        // Non-structural acceleration sensitive losses damage states 1 to 4 (mean)
         if(indexNSARC1_1 != -1)
         {
-            auto NSAccDS1 = objectToDouble(inputRow.at(indexNSARC1_1));    // Non-structural acceleration sensitive losses damage state 1 (mean)
-            auto NSAccDS2 = objectToDouble(inputRow.at(indexNSARC1_1+1));  // Non-structural acceleration sensitive losses damage state 2 (mean)
-            auto NSAccDS3 = objectToDouble(inputRow.at(indexNSARC1_1+2));  // Non-structural acceleration sensitive losses damage state 3 (mean)
-            auto NSAccDS4 = objectToDouble(inputRow.at(indexNSARC1_1+3));  // Non-structural acceleration sensitive losses damage state 4 (mean)
-
-            cumulativeNSAccDS1 += NSAccDS1;
-            cumulativeNSAccDS2 += NSAccDS2;
-            cumulativeNSAccDS3 += NSAccDS3;
-            cumulativeNSAccDS4 += NSAccDS4;
+            for(int ds = 0; ds<4; ++ds)
+                DVcolumns.NSAccLoss[ds][count] = objectToDouble(inputRow.at(indexNSARC1_1+ds));
         }
 
+        // Non-structural drift sensitive losses damage states 1 to 4 (mean)
         if(indexNSDRC1_1 != -1)
         {
-            auto NSDriftDS1 = objectToDouble(inputRow.at(24));  // Non-structural drift sensitive losses damage state 1 (mean)
-            auto NSDriftDS2 = objectToDouble(inputRow.at(25));  // Non-structural drift sensitive losses damage state 2 (mean)
-            auto NSDriftDS3 = objectToDouble(inputRow.at(26));  // Non-structural drift sensitive losses damage state 3 (mean)
-            auto NSDriftDS4 = objectToDouble(inputRow.at(27));  // Non-structural drift sensitive losses damage state 4 (mean)
-
-            cumulativeNSDriftDS1 += NSDriftDS1;
-            cumulativeNSDriftDS2 += NSDriftDS2;
-            cumulativeNSDriftDS3 += NSDriftDS3;
-            cumulativeNSDriftDS4 += NSDriftDS4;
+            for(int ds = 0; ds<4; ++ds)
+                DVcolumns.NSDriftLoss[ds][count] = objectToDouble(inputRow.at(24+ds));
         }
 
+        // Injuries severity levels 1 to 4 (mean), level 4 are the fatalities
         if(indexInjuriesSev1 != -1)
         {
-            injSevLvl1 = objectToDouble(inputRow.at(indexInjuriesSev1));    // Injuries severity level 1 (mean)
-            injSevLvl2 = objectToDouble(inputRow.at(indexInjuriesSev1+1));  // Injuries severity level 2 (mean)
-            injSevLvl3 = objectToDouble(inputRow.at(indexInjuriesSev1+2));  // Injuries severity level 3 (mean)
-            fatalities = objectToDouble(inputRow.at(indexInjuriesSev1+3));  // Injuries severity level 4 (mean)
-
-            cumulativeinjSevLvl1 += injSevLvl1;
-            cumulativeinjSevLvl2 += injSevLvl2;
-            cumulativeinjSevLvl3 += injSevLvl3;
-            cumulativeinjSevLvl4 += fatalities;
+            for(int lvl = 0; lvl<4; ++lvl)
+                DVcolumns.injuries[lvl][count] = objectToDouble(inputRow.at(indexInjuriesSev1+lvl));
         }
 
         if(indexSRCagg != -1)
-            cumulativeSagg += objectToDouble(inputRow.at(indexSRCagg));
+            DVcolumns.structAgg[count] = objectToDouble(inputRow.at(indexSRCagg));
 
         if(indexNSRCagg != -1)
-            cumulativeNSagg += objectToDouble(inputRow.at(indexNSRCagg));
-
-        auto repairCost = objectToDouble(totalRepairCost);
-        auto lossRatio = repairCost/replacementCost;
-
-        cumulativeRepairCost += repairCost;
-
-        theProbDist.addSample(repairCost);
-
-        auto IDItem = new TableNumberItem(IDStr);
-        auto RepCostItem = new TableNumberItem(totalRepairCost);
-        auto RepProbItem = new TableNumberItem(replaceMentProb);
-        auto RepairTimeItem = new TableNumberItem(QString::number(repairTime));
-        auto fatalitiesItem = new TableNumberItem(QString::number(fatalities));
-        auto lossRatioItem = new TableNumberItem(QString::number(lossRatio));
-
-        pelicunResultsTableWidget->setItem(count,0, IDItem);
-        pelicunResultsTableWidget->setItem(count,1, RepCostItem);
-        pelicunResultsTableWidget->setItem(count,2, RepairTimeItem);
-        pelicunResultsTableWidget->setItem(count,3, RepProbItem);
-        pelicunResultsTableWidget->setItem(count,4, fatalitiesItem);
-        pelicunResultsTableWidget->setItem(count,5, lossRatioItem);
+            DVcolumns.NSAgg[count] = objectToDouble(inputRow.at(indexNSRCagg));
 
         auto& rowData = fieldAttributes[count];
 
@@ -592,9 +547,12 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
             rowData[k] = QVariant(value.toDouble());
         }
 
-        rowData.push_back(lossRatio);
+        rowData.push_back(DVcolumns.lossRatio[count]);
     }
 
+    if(!repeatedIDs.isEmpty())
+        ProgramOutputDialog::getInstance()->appendText("Warning: the asset IDs " + repeatedIDs.join(", ") + " are repeated in the DV results, the first row of each is used for the selections");
+
     // Test to remove start
     // auto start = high_resolution_clock::now();
     // Test to remove end
@@ -625,10 +583,98 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
     // Change the name to say loss ratio
     theBuildingDB->getSelectedLayer()->setName("Loss Ratio");
 
+    // The summary of all of the assets
+    QVector<int> allRows(numRows);
+    std::iota(allRows.begin(), allRows.end(), 0);
+
+    return this->updateDVSummary(allRows);
+}
+
+
+void PelicunPostProcessor::DVResultColumns::resize(const int numRows)
+{
+    assetIDs = QVector<QString>(numRows);
+    repairCost = QVector<double>(numRows, 0.0);
+    repairTime = QVector<double>(numRows, 0.0);
+    replacementProb = QVector<double>(numRows, 0.0);
+    lossRatio = QVector<double>(numRows, 0.0);
+    structAgg = QVector<double>(numRows, 0.0);
+    NSAgg = QVector<double>(numRows, 0.0);
+
+    for(int i = 0; i<4; ++i)
+    {
+        structLoss[i] = QVector<double>(numRows, 0.0);
+        NSAccLoss[i] = QVector<double>(numRows, 0.0);
+        NSDriftLoss[i] = QVector<double>(numRows, 0.0);
+        injuries[i] = QVector<double>(numRows, 0.0);
+    }
+}
+
+
+// Gathers the values of a column at the given rows
+static QVector<double> gatherRows(const QVector<double>& column, const QVector<int>& rows)
+{
+    QVector<double> values(rows.size());
+
+    auto out = values.data();
+    const auto in = column.constData();
+    for(auto&& row : rows)
+        *out++ = in[row];
+
+    return values;
+}
+
+
+// Sum of a column over the given rows, with four partial sums so that the additions do not wait on each other
+static double sumRows(const QVector<double>& column, const QVector<int>& rows)
+{
+    const auto in = column.constData();
+    const auto idx = rows.constData();
+    const int n = rows.size();
+
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+
+    int i = 0;
+    for(; i+4<=n; i+=4)
+    {
+        s0 += in[idx[i]];
+        s1 += in[idx[i+1]];
+        s2 += in[idx[i+2]];
+        s3 += in[idx[i+3]];
+    }
+
+    for(; i<n; ++i)
+        s0 += in[idx[i]];
+
+    return (s0+s1)+(s2+s3);
+}
+
+
+int PelicunPostProcessor::updateDVSummary(const QVector<int>& rows)
+{
+    QStringList tableHeadings = {"Asset ID","Repair\nCost","Repair\nTime","Replacement\nProbability","Fatalities","Loss\nRatio"};
+
+    // The table columns are gathered here and handed to the model in one go
+    QStringList assetIDColumn;
+    assetIDColumn.reserve(rows.size());
+    for(auto&& row : rows)
+        assetIDColumn.append(DVcolumns.assetIDs.at(row));
+
+    auto repairCostColumn = gatherRows(DVcolumns.repairCost, rows);
+
+    pelicunResultsTableModel->setNumberOfRows(rows.size());
+    pelicunResultsTableModel->addTextColumn(tableHeadings.at(0), assetIDColumn);
+    pelicunResultsTableModel->addColumn(tableHeadings.at(1), repairCostColumn);
+    pelicunResultsTableModel->addColumn(tableHeadings.at(2), gatherRows(DVcolumns.repairTime, rows));
+    pelicunResultsTableModel->addColumn(tableHeadings.at(3), gatherRows(DVcolumns.replacementProb, rows));
+    pelicunResultsTableModel->addColumn(tableHeadings.at(4), gatherRows(DVcolumns.injuries[3], rows));
+    pelicunResultsTableModel->addColumn(tableHeadings.at(5), gatherRows(DVcolumns.lossRatio, rows));
+
     //  CASUALTIES
     QBarSet *casualtiesSet = new QBarSet("Casualties");
 
-    *casualtiesSet << cumulativeinjSevLvl1 << cumulativeinjSevLvl2 << cumulativeinjSevLvl3 << cumulativeinjSevLvl4;
+    for(int lvl = 0; lvl<4; ++lvl)
+        *casualtiesSet << sumRows(DVcolumns.injuries[lvl], rows);
 
     this->createCasualtiesChart(casualtiesSet);
 
@@ -640,19 +686,27 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
     QBarSet *NSAccLossSet = new QBarSet("Non-structural Acc.");
     QBarSet *NSDriftLossSet = new QBarSet("Non-structural Drift");
 
-    *structLossSet << cumulativeStructDS1 << cumulativeStructDS2 << cumulativeStructDS3 << cumulativeStructDS4 ;
-    *NSAccLossSet << cumulativeNSAccDS1 << cumulativeNSAccDS2 << cumulativeNSAccDS3 << cumulativeNSAccDS4 ;
-    *NSDriftLossSet << cumulativeNSDriftDS1 << cumulativeNSDriftDS2 << cumulativeNSDriftDS3 << cumulativeNSDriftDS4;
+    for(int ds = 0; ds<4; ++ds)
+    {
+        *structLossSet << sumRows(DVcolumns.structLoss[ds], rows);
+        *NSAccLossSet << sumRows(DVcolumns.NSAccLoss[ds], rows);
+        *NSDriftLossSet << sumRows(DVcolumns.NSDriftLoss[ds], rows);
+    }
 
     this->createLossesChart(structLossSet, NSAccLossSet, NSDriftLossSet);
 
-    totalLossValueLabel->setText(QString::number(cumulativeRepairCost,'g',3));
+    totalLossValueLabel->setText(QString::number(sumRows(DVcolumns.repairCost, rows),'g',3));
 
-    structLossValueLabel->setText(QString::number(cumulativeSagg,'g',3));
-    nonStructLossValueLabel->setText(QString::number(cumulativeNSagg,'g',3));
+    structLossValueLabel->setText(QString::number(sumRows(DVcolumns.structAgg, rows),'g',3));
+    nonStructLossValueLabel->setText(QString::number(sumRows(DVcolumns.NSAgg, rows),'g',3));
 
     // Repair time
-    totalRepairTimeValueLabel->setText(QString::number(cumulativeRepairTime,'g',3));
+    totalRepairTimeValueLabel->setText(QString::number(sumRows(DVcolumns.repairTime, rows),'g',3));
+
+    REmpiricalProbabilityDistribution theProbDist;
+
+    for(auto&& repairCost : repairCostColumn)
+        theProbDist.addSample(repairCost);
 
     this->createHistogramChart(&theProbDist);
 
@@ -728,13 +782,13 @@ int PelicunPostProcessor::createHistogramChart(REmpiricalProbabilityDistribution
     QVector<double> yValues;
 
     // Handle the special case where there is only one sample
-    if(probDist->getNumberSamples() < 2)
+    if(probDist->getNumberSamples() == 1)
     {
-        xValues = probDist->getValues();
+        xValues.push_back(probDist->getMin());
         yValues.push_back(1.0);
 
     }
-    else
+    else if(probDist->getNumberSamples() > 1)
     {
         xValues = probDist->getHistogramTicks();
         yValues = probDist->getRelativeFrequencyDiagram();
@@ -781,6 +835,12 @@ int PelicunPostProcessor::createHistogramChart(REmpiricalProbabilityDistribution
 
     series->attachAxis(axisX);
 
+    // The 10th, 50th and 90th percentiles of the repair costs
+    if(probDist->getNumberSamples() > 0)
+        RFDiagChart->setTitle(QString("P10 = %1, P50 = %2, P90 = %3").arg(probDist->quantile(0.1),0,'g',3).arg(probDist->quantile(0.5),0,'g',3).arg(probDist->quantile(0.9),0,'g',3));
+    else
+        RFDiagChart->setTitle(QString());
+
     return 0;
 }
 
@@ -848,62 +908,46 @@ int PelicunPostProcessor::printToPDF(const QString& outputPath)
 }
 
 
-void PelicunPostProcessor::processResultsSubset(const std::set<int>& selectedComponentIDs)
+void PelicunPostProcessor::processResultsSubset(const ComponentIDSet& selectedComponentIDs)
 {
 
-    if(selectedComponentIDs.empty())
+    if(selectedComponentIDs.isEmpty())
         return;
 
-    if(DVdata.size() < numHeaderRows)
+    if(DVrowOfID.isEmpty())
     {
         QString msg = "No results to import!";
         throw msg;
     }
 
-    if(DVdata.at(numHeaderRows).isEmpty() || DVdata.last().isEmpty())
-    {
-        QString msg = "No values in the cells";
-        throw msg;
-    }
-
-    auto firstID = objectToInt(DVdata.at(numHeaderRows).at(0));
-
-    auto lastID = objectToInt(DVdata.last().at(0));
-
-    QVector<QStringList> DVsubset(&DVdata[0],&DVdata[numHeaderRows]);
+    // Gather the rows of the selected assets from the index, in the ascending order of the IDs
+    QVector<int> rows;
+    rows.reserve(selectedComponentIDs.size());
 
-    for(auto&& id : selectedComponentIDs)
+    for(auto&& range : selectedComponentIDs.ranges())
     {
-        // Check that the ID falls within the bounds of the data
-        if(id<firstID || id>lastID)
+        for(int id = range.first; ; ++id)
         {
-            QString msg = "ID " + QString::number(id) + " is out of bounds of the results";
-            throw msg;
-        }
-
-        auto found = false;
-        for(int i = numHeaderRows; i<DVdata.size(); ++i)
-        {
-            auto inputRow = DVdata.at(i);
+            auto it = DVrowOfID.constFind(id);
 
-            auto buildingID = objectToInt(inputRow.at(0));
-
-            if(id == buildingID)
+            if(it == DVrowOfID.constEnd())
             {
-                DVsubset << inputRow;
-                found = true;
-                break;
+                QString msg = "ID " + QString::number(id) + " cannot be found in the results";
+                throw msg;
             }
-        }
 
-        if(!found)
-        {
-            QString msg = "ID " + QString::number(id) + " cannot be found in the results";
-            throw msg;
+            rows.append(it.value());
+
+            if(id == range.last)
+                break;
         }
     }
 
-    this->processDVResults(DVsubset);
+    // The charts are redrawn at most once per interval, while the selection is being dragged only the latest selection is drawn
+    pendingSubsetRows = rows;
+
+    if(!subsetUpdateTimer->isActive())
+        subsetUpdateTimer->start();
 }
 
 
@@ -1350,7 +1394,10 @@ int PelicunPostProcessor::processIMResults(const QVector<QStringList>& IMResults
 void PelicunPostProcessor::clear(void)
 {
     DMdata.clear();
-    DVdata.clear();
+    DVcolumns.resize(0);
+    DVrowOfID.clear();
+    subsetUpdateTimer->stop();
+    pendingSubsetRows.clear();
     EDPdata.clear();
     if(!IMdata.isEmpty() && IMdata.size()>numHeaderRows)
         siteResponseTableWidget->clear();
@@ -1365,7 +1412,7 @@ void PelicunPostProcessor::clear(void)
     structLossValueLabel->clear();
     nonStructLossValueLabel->clear();
 
-    pelicunResultsTableWidget->clear();
+    pelicunResultsTableModel->clear();
 
     sortComboBox->setCurrentIndex(0);
 
@@ -42,22 +42,25 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "SimCenterMapcanvasWidget.h"
 
+#include <QHash>
 #include <QString>
 #include <QMainWindow>
 
 #include <memory>
-#include <set>
 
 class REmpiricalProbabilityDistribution;
 class VisualizationWidget;
 
 class QDockWidget;
 class QTableWidget;
+class QTableView;
+class ResultsTableModel;
 class QGridLayout;
 class QLabel;
 class QComboBox;
 class QGraphicsView;
 class QVBoxLayout;
+class QTimer;
 
 namespace QtCharts
 {
@@ -113,7 +116,7 @@ public:
         return val;
     }
 
-    void processResultsSubset(const std::set<int>& selectedComponentIDs);
+    void processResultsSubset(const ComponentIDSet& selectedComponentIDs);
 
     void setCurrentlyViewable(bool status);
 
@@ -135,10 +138,42 @@ protected:
 
 private:
 
+    // Loads the DV results into typed columns indexed by the asset ID, adds them to the buildings layer and shows the summary of all assets
     int processDVResults(const QVector<QStringList>& DVResults);
 
+    // Updates the table, the charts and the totals for a set of rows of the DV columns
+    int updateDVSummary(const QVector<int>& rows);
+
+    // The DV results, one value per asset in the order of the results file
+    struct DVResultColumns
+    {
+        void resize(const int numRows);
+
+        QVector<QString> assetIDs;
+        QVector<double> repairCost;
+        QVector<double> repairTime;
+        QVector<double> replacementProb;
+        QVector<double> lossRatio;
+        QVector<double> structAgg;
+        QVector<double> NSAgg;
+
+        // Damage states 1 to 4 and injury severity levels 1 to 4, level 4 are the fatalities
+        QVector<double> structLoss[4];
+        QVector<double> NSAccLoss[4];
+        QVector<double> NSDriftLoss[4];
+        QVector<double> injuries[4];
+    };
+
+    DVResultColumns DVcolumns;
+
+    // Row in the DV columns of each asset ID
+    QHash<int, int> DVrowOfID;
+
+    // The latest selection that is waiting to be shown, and the timer that limits how often the charts are redrawn
+    QVector<int> pendingSubsetRows;
+    QTimer* subsetUpdateTimer;
+
     QVector<QStringList> DMdata;
-    QVector<QStringList> DVdata;
     QVector<QStringList> EDPdata;
     QVector<QStringList> IMdata;
 
@@ -161,7 +196,8 @@ private:
 
     QWidget *tableWidget;
 
-    QTableWidget* pelicunResultsTableWidget;
+    QTableView* pelicunResultsTableWidget;
+    ResultsTableModel* pelicunResultsTableModel;
 
     QDockWidget* chartsDock1;
     QDockWidget* chartsDock2;
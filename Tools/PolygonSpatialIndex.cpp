@@ -0,0 +1,324 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "PolygonSpatialIndex.h"
+
+#include <qgsgeometryengine.h>
+#include <qgspoint.h>
+
+#include <QHash>
+#include <QThread>
+#include <QVarLengthArray>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+
+namespace
+{
+
+// Number of entries packed into one node of the tree
+const int nodeCapacity = 16;
+
+// Prepared engines of the polygons that a worker thread has tested so far
+typedef QHash<int, std::shared_ptr<QgsGeometryEngine>> EngineCache;
+
+}
+
+
+PolygonSpatialIndex::PolygonSpatialIndex()
+{
+
+}
+
+
+void PolygonSpatialIndex::build(const QVector<QgsGeometry>& polygons)
+{
+    this->clear();
+
+    polygonGeoms = polygons;
+
+    const int numPolygons = polygonGeoms.size();
+
+    if(numPolygons == 0)
+        return;
+
+    polygonEnvelopes.resize(numPolygons);
+
+    for(int i = 0; i<numPolygons; ++i)
+    {
+        const auto& geom = polygonGeoms.at(i);
+
+        // An empty envelope that never contains a point
+        if(geom.isNull() || geom.isEmpty())
+        {
+            const double inf = std::numeric_limits<double>::infinity();
+            polygonEnvelopes[i] = Envelope{inf, inf, -inf, -inf};
+            continue;
+        }
+
+        auto bb = geom.boundingBox();
+        polygonEnvelopes[i] = Envelope{bb.xMinimum(), bb.yMinimum(), bb.xMaximum(), bb.yMaximum()};
+    }
+
+    nodes.reserve(numPolygons/nodeCapacity*2 + 2);
+    children.reserve(numPolygons*2);
+
+    // Pack the polygons into leaves and then the nodes of every level into their parents, until only the root is left
+    QVector<int> entries(numPolygons);
+    std::iota(entries.begin(), entries.end(), 0);
+
+    QVector<Envelope> entryEnvelopes = polygonEnvelopes;
+
+    bool leafLevel = true;
+
+    do
+    {
+        QVector<int> parents;
+        QVector<Envelope> parentEnvelopes;
+
+        this->packLevel(entries, entryEnvelopes, leafLevel, parents, parentEnvelopes);
+
+        entries.swap(parents);
+        entryEnvelopes.swap(parentEnvelopes);
+
+        leafLevel = false;
+
+    } while(entries.size() > 1);
+
+    rootNode = entries.first();
+}
+
+
+void PolygonSpatialIndex::packLevel(QVector<int>& entries, const QVector<Envelope>& entryEnvelopes, const bool leafLevel, QVector<int>& parents, QVector<Envelope>& parentEnvelopes)
+{
+    const int numEntries = entries.size();
+
+    const int numParents = (numEntries + nodeCapacity - 1)/nodeCapacity;
+    const int numSlices = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numParents))));
+    const int sliceSize = numSlices*nodeCapacity;
+
+    auto centerX = [&](const int pos) { const auto& env = entryEnvelopes.at(pos); return 0.5*(env.xMin + env.xMax); };
+    auto centerY = [&](const int pos) { const auto& env = entryEnvelopes.at(pos); return 0.5*(env.yMin + env.yMax); };
+
+    // Positions into the entries, sorted into vertical slices by x and then into runs of nodeCapacity by y within each slice
+    QVector<int> order(numEntries);
+    std::iota(order.begin(), order.end(), 0);
+
+    std::sort(order.begin(), order.end(), [&](const int a, const int b)
+    {
+        const double xa = centerX(a), xb = centerX(b);
+        return xa < xb || (xa == xb && a < b);
+    });
+
+    for(int sliceStart = 0; sliceStart < numEntries; sliceStart += sliceSize)
+    {
+        const int sliceEnd = std::min(sliceStart + sliceSize, numEntries);
+
+        std::sort(order.begin() + sliceStart, order.begin() + sliceEnd, [&](const int a, const int b)
+        {
+            const double ya = centerY(a), yb = centerY(b);
+            return ya < yb || (ya == yb && a < b);
+        });
+    }
+
+    parents.reserve(numParents);
+    parentEnvelopes.reserve(numParents);
+
+    for(int sliceStart = 0; sliceStart < numEntries; sliceStart += sliceSize)
+    {
+        const int sliceEnd = std::min(sliceStart + sliceSize, numEntries);
+
+        for(int groupStart = sliceStart; groupStart < sliceEnd; groupStart += nodeCapacity)
+        {
+            const int groupEnd = std::min(groupStart + nodeCapacity, sliceEnd);
+
+            const double inf = std::numeric_limits<double>::infinity();
+            Node node{Envelope{inf, inf, -inf, -inf}, children.size(), 0, leafLevel};
+
+            for(int i = groupStart; i<groupEnd; ++i)
+            {
+                const int pos = order.at(i);
+                const auto& env = entryEnvelopes.at(pos);
+
+                node.envelope.xMin = std::min(node.envelope.xMin, env.xMin);
+                node.envelope.yMin = std::min(node.envelope.yMin, env.yMin);
+                node.envelope.xMax = std::max(node.envelope.xMax, env.xMax);
+                node.envelope.yMax = std::max(node.envelope.yMax, env.yMax);
+
+                children.push_back(entries.at(pos));
+            }
+
+            node.childEnd = children.size();
+
+            parents.push_back(nodes.size());
+            parentEnvelopes.push_back(node.envelope);
+
+            nodes.push_back(node);
+        }
+    }
+}
+
+
+void PolygonSpatialIndex::clear(void)
+{
+    polygonGeoms.clear();
+    polygonEnvelopes.clear();
+    nodes.clear();
+    children.clear();
+    rootNode = -1;
+}
+
+
+int PolygonSpatialIndex::size(void) const
+{
+    return polygonGeoms.size();
+}
+
+
+void PolygonSpatialIndex::envelopeCandidates(const QgsPointXY& point, QVector<int>& candidates) const
+{
+    candidates.clear();
+
+    if(rootNode == -1)
+        return;
+
+    const double x = point.x();
+    const double y = point.y();
+
+    QVarLengthArray<int, 64> stack;
+    stack.push_back(rootNode);
+
+    while(!stack.isEmpty())
+    {
+        const auto& node = nodes.at(stack.last());
+        stack.removeLast();
+
+        if(!node.envelope.contains(x,y))
+            continue;
+
+        for(int i = node.childBegin; i<node.childEnd; ++i)
+        {
+            const int child = children.at(i);
+
+            if(node.isLeaf)
+            {
+                if(polygonEnvelopes.at(child).contains(x,y))
+                    candidates.push_back(child);
+            }
+            else
+            {
+                stack.push_back(child);
+            }
+        }
+    }
+
+    // So that a point on a shared boundary always goes to the same polygon
+    std::sort(candidates.begin(), candidates.end());
+}
+
+
+static int locateWithEngines(const PolygonSpatialIndex& index, const QVector<QgsGeometry>& polygons, const QgsPointXY& point, QVector<int>& candidates, EngineCache& engines)
+{
+    index.envelopeCandidates(point, candidates);
+
+    if(candidates.isEmpty())
+        return -1;
+
+    QgsPoint pointGeom(point.x(), point.y());
+
+    for(auto&& candidate : candidates)
+    {
+        auto engine = engines.value(candidate);
+
+        if(engine == nullptr)
+        {
+            engine.reset(QgsGeometry::createGeometryEngine(polygons.at(candidate).constGet()));
+            engine->prepareGeometry();
+            engines.insert(candidate, engine);
+        }
+
+        if(engine->intersects(&pointGeom))
+            return candidate;
+    }
+
+    return -1;
+}
+
+
+int PolygonSpatialIndex::locate(const QgsPointXY& point) const
+{
+    QVector<int> candidates;
+    EngineCache engines;
+
+    return locateWithEngines(*this, polygonGeoms, point, candidates, engines);
+}
+
+
+QVector<int> PolygonSpatialIndex::locateAll(const QVector<QgsPointXY>& points) const
+{
+    const int numPoints = points.size();
+
+    QVector<int> polygonIndices(numPoints, -1);
+
+    if(numPoints == 0 || rootNode == -1)
+        return polygonIndices;
+
+    // Contiguous runs of points, since neighbouring features tend to fall into the same polygons and can then reuse the engines prepared by their thread
+    const int numPartitions = std::max(1, std::min(numPoints, 4*QThread::idealThreadCount()));
+
+    QVector<int> partitions(numPartitions);
+    std::iota(partitions.begin(), partitions.end(), 0);
+
+    int* out = polygonIndices.data();
+
+    QtConcurrent::blockingMap(partitions, [&](const int partition)
+    {
+        const int begin = static_cast<int>(static_cast<qint64>(numPoints)*partition/numPartitions);
+        const int end = static_cast<int>(static_cast<qint64>(numPoints)*(partition+1)/numPartitions);
+
+        QVector<int> candidates;
+        EngineCache engines;
+
+        for(int i = begin; i<end; ++i)
+            out[i] = locateWithEngines(*this, polygonGeoms, points.at(i), candidates, engines);
+    });
+
+    return polygonIndices;
+}
@@ -0,0 +1,100 @@
+#ifndef POLYGONSPATIALINDEX_H
+#define POLYGONSPATIALINDEX_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Point-in-polygon lookup over a set of polygon features, e.g., parcels, census blocks, or counties
+// The polygon envelopes are bulk loaded once into a sort-tile-recursive (STR) packed R-tree, the tree is read-only after that so it can be queried from many threads at once
+// The envelope hits are confirmed with prepared geometry tests, each worker thread prepares its own engines because a prepared geometry is not safe to share between threads
+
+#include <qgsgeometry.h>
+#include <qgspointxy.h>
+
+#include <QVector>
+
+class PolygonSpatialIndex
+{
+public:
+    PolygonSpatialIndex();
+
+    // Bulk loads the envelopes of the polygons, the polygons must be in the same crs as the points that are located later on
+    void build(const QVector<QgsGeometry>& polygons);
+
+    void clear(void);
+
+    int size(void) const;
+
+    // Indices of the polygons whose envelope contains the point, in ascending order
+    void envelopeCandidates(const QgsPointXY& point, QVector<int>& candidates) const;
+
+    // Index of the first polygon that contains the point, or -1 if no polygon contains it
+    int locate(const QgsPointXY& point) const;
+
+    // Locates all of the points in parallel, the result has one polygon index (or -1) per point
+    QVector<int> locateAll(const QVector<QgsPointXY>& points) const;
+
+private:
+
+    struct Envelope
+    {
+        double xMin;
+        double yMin;
+        double xMax;
+        double yMax;
+
+        bool contains(const double x, const double y) const { return x >= xMin && x <= xMax && y >= yMin && y <= yMax; }
+    };
+
+    // A node covers the range [childBegin, childEnd) of the children vector, which holds polygon indices for a leaf and node indices otherwise
+    struct Node
+    {
+        Envelope envelope;
+        int childBegin;
+        int childEnd;
+        bool isLeaf;
+    };
+
+    void packLevel(QVector<int>& entries, const QVector<Envelope>& entryEnvelopes, const bool leafLevel, QVector<int>& parents, QVector<Envelope>& parentEnvelopes);
+
+    QVector<QgsGeometry> polygonGeoms;
+    QVector<Envelope> polygonEnvelopes;
+
+    QVector<Node> nodes;
+    QVector<int> children;
+    int rootNode = -1;
+};
+
+#endif // POLYGONSPATIALINDEX_H
@@ -37,7 +37,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "QGISHurricanePreprocessor.h"
-#include "CSVReaderWriter.h"
 #include "QGISVisualizationWidget.h"
 
 #include <qgsfield.h>
@@ -51,6 +50,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QProgressBar>
 #include <QList>
 
+#include <cmath>
+
 QGISHurricanePreprocessor::QGISHurricanePreprocessor(QProgressBar* pBar, QGISVisualizationWidget* visWidget, QObject* parent) : theProgressBar(pBar), theVisualizationWidget(visWidget), theParent(parent)
 {
     allHurricanesLayer = nullptr;
@@ -63,111 +64,24 @@ QGISHurricanePreprocessor::QGISHurricanePreprocessor(QProgressBar* pBar, QGISVis
 
 QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QString &eventFile, QString &err)
 {
-    CSVReaderWriter csvTool;
-
-    QVector<QStringList> data = csvTool.parseCSVFile(eventFile, err);
-
-    if(!err.isEmpty())
-    {
-        return nullptr;
-    }
-
-    if(data.empty())
-    {
-        err = "Hurricane data is empty";
-        return nullptr;
-    }
-
-    // Get the header information to populate the fields
-    auto headerData = data.at(0);
-
-    auto numCol = headerData.size();
-
-    // Pop off the first two rows that contain the header and units information
-    data.pop_front();
-    data.pop_front();
-
-
-    // Split the hurricanes up as they come in one long list
-    QVectorIterator<QStringList> i(data);
-    QString SID;
-
-    HurricaneObject hurricane;
-    hurricane.parameterLabels = headerData;
-
-    auto indexLandfall = headerData.indexOf("DIST2LAND");
-    auto indexSID = headerData.indexOf("SID");
-
-    if(indexLandfall == -1 || indexSID == -1)
-    {
-        err = "Could not find the required column indexes in the data file";
-        return nullptr;
-    }
-
-    // While iterating through the hurricane points, save the data at first landfall
-    bool landfallFound = false;
-    while (i.hasNext())
-    {
-        auto row = i.next();
-
-        if(row.size() != numCol)
-        {
-            err = "Error, inconsistency in the data in the row and number of columns";
-            return nullptr;
-        }
-
-        // Not all hurricanes will make landfall
-        if(!landfallFound)
-        {
-            auto distToLand = row.at(indexLandfall);
-
-            // If the distance to land is 0, then this is the first landfall
-            if(distToLand.compare("0") == 0)
-            {
-                landfallFound = true;
-                hurricane.landfallData = row;
-                hurricane.indexLandfall = hurricane.size();
-            }
-        }
-
-        auto currSID = row.at(indexSID);
-
-        if(SID.compare(currSID) != 0)
-        {
-            if(!hurricane.empty())
-            {
-                hurricanes.push_back(hurricane);
-                hurricane.clear();
-                landfallFound = false;
-            }
-
-            SID = currSID;
-        }
-
-        hurricane.push_back(row);
-    }
-
-    // Push back the last hurricane
-    if(!hurricane.empty())
-        hurricanes.push_back(hurricane);
-
-    auto numHurricanes = hurricanes.size();
+    this->clear();
 
     theProgressBar->setMinimum(0);
-    theProgressBar->setMaximum(numHurricanes);
+    theProgressBar->setMaximum(100);
     theProgressBar->reset();
     QApplication::processEvents();
 
-    // Name and storm ID
-    auto indexName = headerData.indexOf("NAME");
-    auto indexSeason = headerData.indexOf("SEASON");
-
-    // Check that the indexes are found
-    if(indexName == -1 || indexSID == -1 || indexSeason == -1)
+    // The database is only parsed the first time it is loaded, later the index is mapped
+    auto progress = [this](int percent)
     {
-        err = "Error adding a vector layer";
+        theProgressBar->setValue(percent);
+        QApplication::processEvents();
+    };
+
+    if(trackIndex.open(eventFile, err, progress) != 0)
         return nullptr;
-    }
+
+    auto numHurricanes = trackIndex.numStorms();
 
     // Create the hurricane track fields
     QList<QgsField> attrib;
@@ -187,19 +101,9 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
 
     for(int i = 0; i<numHurricanes; ++i)
     {
-        theProgressBar->setValue(i);
-        QApplication::processEvents();
-
-        // Get the hurricane
-        HurricaneObject& hurricane = hurricanes[i];
-
-        auto name = hurricane.front().at(indexName);
-        auto SID = hurricane.front().at(indexSID);
-        auto season = hurricane.front().at(indexSeason);
-
-        hurricane.name = name;
-        hurricane.SID = SID;
-        hurricane.season = season;
+        auto name = trackIndex.getName(i);
+        auto SID = trackIndex.getSID(i);
+        auto season = QString::number(trackIndex.getSeason(i));
         auto nameID = name+"-"+season;
 
         // Create a unique ID for this track
@@ -215,7 +119,7 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
 
         QgsFeature feature;
 
-        auto polyline = this->getTrackGeometry(&hurricane, err);
+        auto polyline = this->getTrackGeometry(i, err);
 
         if(polyline.isEmpty() || polyline.isNull())
             return nullptr;
@@ -227,6 +131,8 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
         featList.push_back(feature);
     }
 
+    theProgressBar->setValue(100);
+
     // Create the buildings group layer that will hold the sublayers
     allHurricanesLayer = theVisualizationWidget->addVectorLayer("linestring","All Hurricanes");
 
@@ -267,6 +173,7 @@ QgsVectorLayer* QGISHurricanePreprocessor::loadHurricaneDatabaseData(const QStri
 void QGISHurricanePreprocessor::clear(void)
 {
     hurricanes.clear();
+    trackIndex.close();
     allHurricanesLayer = nullptr;
 }
 
@@ -516,15 +423,28 @@ QgsVectorLayer* QGISHurricanePreprocessor::createLandfallVisualization(const dou
 }
 
 
-HurricaneObject* QGISHurricanePreprocessor::getHurricane(const QString& SID)
+HurricaneObject* QGISHurricanePreprocessor::getHurricane(const QString& SID, QString& err)
 {
-    for(auto&& it : hurricanes)
+    auto storm = trackIndex.findStorm(SID);
+
+    if(storm == -1)
     {
-        if(SID.compare(it.SID) == 0)
-            return &it;
+        err = "Could not find the hurricane with the SID " + SID;
+        return nullptr;
     }
 
-    return nullptr;
+    auto it = hurricanes.find(storm);
+
+    if(it != hurricanes.end())
+        return &it.value();
+
+    // Only the rows of this storm are parsed from the database
+    HurricaneObject hurricane;
+
+    if(trackIndex.readStorm(storm, hurricane, err) != 0)
+        return nullptr;
+
+    return &hurricanes.insert(storm, hurricane).value();
 }
 
 
@@ -534,6 +454,12 @@ QgsVectorLayer *QGISHurricanePreprocessor::getAllHurricanesLayer() const
 }
 
 
+const HurricaneTrackIndex& QGISHurricanePreprocessor::getTrackIndex() const
+{
+    return trackIndex;
+}
+
+
 
 QgsGeometry QGISHurricanePreprocessor::getTrackGeometry(HurricaneObject* hurricane, QString& err)
 {
@@ -595,3 +521,34 @@ QgsGeometry QGISHurricanePreprocessor::getTrackGeometry(HurricaneObject* hurrica
 
     return geom;
 }
+
+
+QgsGeometry QGISHurricanePreprocessor::getTrackGeometry(int storm, QString& err)
+{
+    auto firstPoint = trackIndex.getFirstPoint(storm);
+    auto numPoints = trackIndex.getNumPoints(storm);
+
+    auto latitudes = trackIndex.getLatitudes() + firstPoint;
+    auto longitudes = trackIndex.getLongitudes() + firstPoint;
+
+    // Each row is a point on the hurricane track
+    QgsPolylineXY polyLine;
+    polyLine.reserve(numPoints);
+
+    for(int j = 0; j<numPoints; ++j)
+    {
+        auto latitude = latitudes[j];
+        auto longitude = longitudes[j];
+
+        // The index has NaN where the database has no number
+        if(std::isnan(latitude) || std::isnan(longitude) || latitude == 0.0 || longitude == 0.0)
+        {
+            err = "Could not find the lat/lon from hurricane track points";
+            return QgsGeometry();
+        }
+
+        polyLine.push_back(QgsPointXY(longitude,latitude));
+    }
+
+    return QgsGeometry::fromPolylineXY(polyLine);
+}
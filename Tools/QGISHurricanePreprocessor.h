@@ -39,6 +39,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "HurricaneObject.h"
+#include "HurricaneTrackIndex.h"
 
 class QGISVisualizationWidget;
 
@@ -46,6 +47,7 @@ class QGISVisualizationWidget;
 
 class QgsVectorLayer;
 
+#include <QMap>
 #include <QString>
 #include <QStringList>
 #include <QVector>
@@ -64,10 +66,14 @@ public:
     void clear(void);
 
     // Gets the hurricane of the given storm id
-    HurricaneObject* getHurricane(const QString& SID);
+    // Returns nullptr on failure with the message in err
+    HurricaneObject* getHurricane(const QString& SID, QString& err);
 
     QgsVectorLayer *getAllHurricanesLayer() const;
 
+    // The index of the loaded database, e.g., to find the storms of a season or a region
+    const HurricaneTrackIndex& getTrackIndex() const;
+
    // Creates a hurricane visualization of the track and track points if desired
     QgsVectorLayer* createTrackVisualization(HurricaneObject* hurricane, QString& err);
 
@@ -81,11 +87,17 @@ public:
 private:
 
     QgsGeometry getTrackGeometry(HurricaneObject* hurricane, QString& err);
+
+    // Builds the track from the point columns of the index without reading the database
+    QgsGeometry getTrackGeometry(int storm, QString& err);
     QgsVectorLayer* allHurricanesLayer;
     QProgressBar* theProgressBar;
     QGISVisualizationWidget* theVisualizationWidget;
     QObject* theParent;
-    QVector<HurricaneObject> hurricanes;
+    HurricaneTrackIndex trackIndex;
+
+    // The storms that were opened so far, by their index in the database
+    QMap<int, HurricaneObject> hurricanes;
 };
 
 #endif // QGISHurricanePreprocessor_H
@@ -59,6 +59,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "QDebug"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 REmpiricalProbabilityDistribution::REmpiricalProbabilityDistribution(QString objectName) : name(objectName)
 {
     numBins = 60;
@@ -69,8 +73,8 @@ REmpiricalProbabilityDistribution::REmpiricalProbabilityDistribution(QString obj
     histPlotHeight = 0.0;
     histogramArea = 0.0;
     binSize = 0.0;
-    parameterSum = 0.0;
-    parameterSquaredSum = 0.0;
+    runningMean = 0.0;
+    sumSquaredDeviations = 0.0;
     max = 0.0;
     min = 0.0;
 }
@@ -79,23 +83,25 @@ REmpiricalProbabilityDistribution::REmpiricalProbabilityDistribution(QString obj
 void REmpiricalProbabilityDistribution::addSample(const double& val)
 {
     values.push_back(val);
-    parameterSum += val;
-    parameterSquaredSum += val*val;
+
     ++n;
 
-    if(val > max)
+    // Welford's update, which does not lose the variance to cancellation like the sum of the squares does
+    auto delta = val - runningMean;
+    runningMean += delta/static_cast<double>(n);
+    sumSquaredDeviations += delta*(val - runningMean);
+
+    if(n == 1 || val > max)
         max = val;
 
-    if(val < min)
+    if(n == 1 || val < min)
         min = val;
 }
 
 
 double REmpiricalProbabilityDistribution::mean(void)
 {
-    auto num = static_cast<double>(n);
-
-    return  parameterSum/num;
+    return runningMean;
 }
 
 
@@ -105,11 +111,9 @@ double REmpiricalProbabilityDistribution::stdDev(void)
     if(n<=1)
         return 0.0;
 
-    double meanVal = this->mean();
-
     auto num = static_cast<double>(n);
 
-    return sqrt(1.0/(num-1.0) * (parameterSquaredSum - num * meanVal * meanVal));
+    return sqrt(sumSquaredDeviations/(num-1.0));
 }
 
 
@@ -122,6 +126,30 @@ double  REmpiricalProbabilityDistribution::CV(void)
 }
 
 
+double REmpiricalProbabilityDistribution::quantile(const double p)
+{
+    if(n == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    QVector<double> sorted = values;
+
+    // Only the two closest ranks have to be in place, not all of the samples sorted
+    const double rank = std::min(std::max(p, 0.0), 1.0)*(n - 1);
+    const int lower = static_cast<int>(std::floor(rank));
+    const double frac = rank - lower;
+
+    std::nth_element(sorted.begin(), sorted.begin() + lower, sorted.end());
+    const double lowerValue = sorted[lower];
+
+    if(frac == 0.0 || lower + 1 >= n)
+        return lowerValue;
+
+    const double upperValue = *std::min_element(sorted.begin() + lower + 1, sorted.end());
+
+    return lowerValue + frac*(upperValue - lowerValue);
+}
+
+
 QVector<double>  REmpiricalProbabilityDistribution::getRelativeFrequencyDiagram(void)
 {
     theFrequencyDiagram.clear();
@@ -151,22 +179,24 @@ QVector<double>  REmpiricalProbabilityDistribution::getRelativeFrequencyDiagram(
 }
 
 
+void REmpiricalProbabilityDistribution::updateHistogramRange(void)
+{
+    // Get size of histogram
+//    histogramMin = meanVal - 5.0 * stdv;
+    histogramMin = 0.0;
+    histogramMax = this->mean() + 5.0 * this->stdDev();
+    binSize = (histogramMax - histogramMin) / numBins;
+}
+
+
 QVector<double>  REmpiricalProbabilityDistribution::getHistogramTicks(void)
 {
 
     QVector<double> theHistogramTicks;
 
-    auto meanVal = this->mean();
-
     theHistogramTicks.resize(numBins);
 
-    auto stdv = this->stdDev();
-
-    // Get size of histogram
-//    histogramMin = meanVal - 5.0 * stdv;
-    histogramMin = 0.0;
-    histogramMax = meanVal + 5.0 * stdv;
-    binSize = (histogramMax - histogramMin) / numBins;
+    this->updateHistogramRange();
 
     theHistogramTicks[0] = histogramMin;
 
@@ -251,35 +281,46 @@ QVector<double>  REmpiricalProbabilityDistribution::updateHistogram()
         return theHistogram;
     }
 
-    auto stdv = this->stdDev();
-
-    auto meanVal = this->mean();
+    this->updateHistogramRange();
 
-    // Get size of histogram
-//    histogramMin = meanVal - 5.0 * stdv;
-
-    histogramMin = 0.0;
-
-    histogramMax = meanVal + 5.0 * stdv;
-    binSize = (histogramMax - histogramMin) / numBins;
+    // Bin k, for k = 1 to numBins-1, holds the samples below histogramMin + k*binSize that are not in a lower bin; the larger samples are left out
+    if(binSize > 0.0 && std::isfinite(binSize))
+    {
+        for (auto&& val : values)
+        {
+            if(std::isnan(val))
+                continue;
 
-    // Create histogram
-    for (int j=0; j<values.size(); ++j) {
+            // The bin from the index arithmetic, then nudged so that the rounding cannot put a sample on the wrong side of a bin edge
+            auto binPos = std::floor((val - histogramMin) / binSize) + 1.0;
+            int k = binPos < 1.0 ? 1 : (binPos > numBins ? numBins : static_cast<int>(binPos));
 
-        for (int k=1; k<numBins; ++k) {
+            while (k > 1 && val < histogramMin + static_cast<double>(k-1) * binSize)
+                --k;
 
-            if (values.at(j) < histogramMin + static_cast<double>(k) * binSize) {
+            while (k < numBins && !(val < histogramMin + static_cast<double>(k) * binSize))
+                ++k;
 
+            if (k < numBins)
                 theHistogram[k] += 1.0;
+        }
+    }
+    else
+    {
+        for (auto&& val : values) {
 
-                if (theHistogram[k] > histogramHeight) {
-                    histogramHeight += 1.0;
+            for (int k=1; k<numBins; ++k) {
+
+                if (val < histogramMin + static_cast<double>(k) * binSize) {
+                    theHistogram[k] += 1.0;
+                    break;
                 }
-                break;
             }
         }
     }
 
+    histogramHeight = std::max(histogramHeight, *std::max_element(theHistogram.begin(), theHistogram.end()));
+
     histogramArea = static_cast<double>(n)*binSize;
 
     if (histogramHeight/histogramArea > histPlotHeight) {
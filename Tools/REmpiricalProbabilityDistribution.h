@@ -57,8 +57,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 *************************************************************************** */
 
+// Empirical distribution of samples with the running mean and standard deviation (Welford) and a histogram for plotting
+
 #include <math.h>
 #include <vector>
+#include <QString>
 #include <QVector>
 
 class REmpiricalProbabilityDistribution
@@ -74,6 +77,9 @@ public:
 
     double CV(void);
 
+    // The value at the probability p in [0, 1], interpolated between the two closest samples
+    double quantile(const double p);
+
     QVector<double>  updateHistogram();
 
     // For plotting
@@ -102,6 +108,9 @@ public:
 
 private:
 
+    // Sets the range and the bin size of the histogram from the mean and the standard deviation
+    void updateHistogramRange(void);
+
     QString name;
 
     QVector<double> values;
@@ -117,8 +126,10 @@ private:
 
     double max;
     double min;
-    double parameterSum;
-    double parameterSquaredSum;
+
+    // Running mean and sum of the squared deviations from the mean
+    double runningMean;
+    double sumSquaredDeviations;
     int n;
 };
 
@@ -0,0 +1,281 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "RasterBlockSampler.h"
+
+#include <qgsrasterblock.h>
+#include <qgsrasterdataprovider.h>
+#include <qgsrectangle.h>
+
+#include <QPair>
+#include <QString>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+RasterBlockSampler::RasterBlockSampler(QgsRasterDataProvider* provider, const int tileSize, const int maxCachedTiles) : dataProvider(provider), tileSize(std::max(1, tileSize)), maxCachedTiles(std::max(1, maxCachedTiles))
+{
+
+}
+
+
+void RasterBlockSampler::clearCache(void)
+{
+    tileOrder.clear();
+    tileCache.clear();
+}
+
+
+std::shared_ptr<const RasterBlockSampler::Tile> RasterBlockSampler::getTile(const int band, const int tileRow, const int tileCol, QString& err)
+{
+    const quint64 key = (static_cast<quint64>(band) << 48) | (static_cast<quint64>(tileRow) << 24) | static_cast<quint64>(tileCol);
+
+    auto cached = tileCache.value(key);
+    if(cached != nullptr)
+    {
+        tileOrder.removeOne(key);
+        tileOrder.append(key);
+        return cached;
+    }
+
+    const int xSize = dataProvider->xSize();
+    const int ySize = dataProvider->ySize();
+
+    auto tile = std::make_shared<Tile>();
+    tile->firstCol = tileCol*tileSize;
+    tile->firstRow = tileRow*tileSize;
+
+    // One pixel more than the tile in each direction, for the bilinear lookups on the last row and column of the tile
+    tile->width = std::min(tileSize + 1, xSize - tile->firstCol);
+    tile->height = std::min(tileSize + 1, ySize - tile->firstRow);
+
+    const auto extent = dataProvider->extent();
+    const double pixelWidth = extent.width()/xSize;
+    const double pixelHeight = extent.height()/ySize;
+
+    const double xMin = extent.xMinimum() + tile->firstCol*pixelWidth;
+    const double yMax = extent.yMaximum() - tile->firstRow*pixelHeight;
+
+    QgsRectangle tileExtent(xMin, yMax - tile->height*pixelHeight, xMin + tile->width*pixelWidth, yMax);
+
+    std::unique_ptr<QgsRasterBlock> block(dataProvider->block(band, tileExtent, tile->width, tile->height));
+
+    if(block == nullptr || !block->isValid())
+    {
+        err = "Error reading the block of the raster at row " + QString::number(tile->firstRow) + " and column " + QString::number(tile->firstCol) + " in band " + QString::number(band);
+        return nullptr;
+    }
+
+    tile->pixels.resize(tile->width*tile->height);
+
+    double* pixels = tile->pixels.data();
+
+    for(int row = 0; row < tile->height; ++row)
+    {
+        for(int col = 0; col < tile->width; ++col)
+            pixels[row*tile->width + col] = block->isNoData(row, col) ? std::numeric_limits<double>::quiet_NaN() : block->value(row, col);
+    }
+
+    if(tileOrder.size() >= maxCachedTiles)
+        tileCache.remove(tileOrder.takeFirst());
+
+    tileOrder.append(key);
+    tileCache.insert(key, tile);
+
+    return tile;
+}
+
+
+int RasterBlockSampler::sample(const QVector<double>& x, const QVector<double>& y, const QVector<int>& bands, const Interpolation interpolation, QVector<double>& values, QBitArray& missed, QString& err)
+{
+    if(dataProvider == nullptr)
+    {
+        err = "Error, attempting to sample a raster layer that has not been loaded";
+        return -1;
+    }
+
+    if(x.size() != y.size())
+    {
+        err = "Error, the number of x and y coordinates to sample the raster at are not the same";
+        return -1;
+    }
+
+    const int numBands = dataProvider->bandCount();
+
+    for(auto&& band : bands)
+    {
+        if(band < 1 || band > numBands)
+        {
+            err = "Error, the band number given "+QString::number(band)+" is not in the raster, the raster has "+QString::number(numBands)+" bands";
+            return -1;
+        }
+    }
+
+    const int numPoints = x.size();
+    const int numSampledBands = bands.size();
+
+    values.fill(std::numeric_limits<double>::quiet_NaN(), numPoints*numSampledBands);
+    missed.fill(false, numPoints);
+
+    const int xSize = dataProvider->xSize();
+    const int ySize = dataProvider->ySize();
+
+    if(numPoints == 0 || numSampledBands == 0 || xSize == 0 || ySize == 0)
+        return 0;
+
+    const auto extent = dataProvider->extent();
+    const double pixelWidth = extent.width()/xSize;
+    const double pixelHeight = extent.height()/ySize;
+
+    const int numTileCols = (xSize + tileSize - 1)/tileSize;
+
+    // The pixel that anchors the lookup of every point, i.e., the pixel itself for the nearest lookup and the top left of the four pixels for the bilinear one
+    QVector<int> anchorCols(numPoints);
+    QVector<int> anchorRows(numPoints);
+    QVector<double> weightsX(numPoints, 0.0);
+    QVector<double> weightsY(numPoints, 0.0);
+
+    // Pairs of (tile, point) so that the points can be visited tile by tile
+    QVector<QPair<qint64,int>> tilePoints;
+    tilePoints.reserve(numPoints);
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        const double col = (x.at(i) - extent.xMinimum())/pixelWidth;
+        const double row = (extent.yMaximum() - y.at(i))/pixelHeight;
+
+        // Also catches NaN coordinates
+        if(!(col >= 0.0 && col < xSize && row >= 0.0 && row < ySize))
+        {
+            missed.setBit(i);
+            continue;
+        }
+
+        if(interpolation == Interpolation::Nearest)
+        {
+            anchorCols[i] = static_cast<int>(col);
+            anchorRows[i] = static_cast<int>(row);
+        }
+        else
+        {
+            // Bilinear between the centres of the pixels, clamped to the edge pixels
+            const double centreCol = col - 0.5;
+            const double centreRow = row - 0.5;
+
+            anchorCols[i] = std::max(0, std::min(static_cast<int>(std::floor(centreCol)), xSize - 2));
+            anchorRows[i] = std::max(0, std::min(static_cast<int>(std::floor(centreRow)), ySize - 2));
+
+            weightsX[i] = xSize == 1 ? 0.0 : std::max(0.0, std::min(1.0, centreCol - anchorCols.at(i)));
+            weightsY[i] = ySize == 1 ? 0.0 : std::max(0.0, std::min(1.0, centreRow - anchorRows.at(i)));
+        }
+
+        const qint64 tile = static_cast<qint64>(anchorRows.at(i)/tileSize)*numTileCols + anchorCols.at(i)/tileSize;
+        tilePoints.push_back(qMakePair(tile, i));
+    }
+
+    std::sort(tilePoints.begin(), tilePoints.end());
+
+    const int* cols = anchorCols.constData();
+    const int* rows = anchorRows.constData();
+    const double* wx = weightsX.constData();
+    const double* wy = weightsY.constData();
+    double* out = values.data();
+
+    for(int b = 0; b<numSampledBands; ++b)
+    {
+        int groupStart = 0;
+        while(groupStart < tilePoints.size())
+        {
+            const qint64 tileIndex = tilePoints.at(groupStart).first;
+
+            int groupEnd = groupStart;
+            while(groupEnd < tilePoints.size() && tilePoints.at(groupEnd).first == tileIndex)
+                ++groupEnd;
+
+            auto tile = this->getTile(bands.at(b), static_cast<int>(tileIndex/numTileCols), static_cast<int>(tileIndex%numTileCols), err);
+
+            if(tile == nullptr)
+                return -1;
+
+            const double* pixels = tile->pixels.constData();
+            const int stride = tile->width;
+
+            for(int k = groupStart; k<groupEnd; ++k)
+            {
+                const int i = tilePoints.at(k).second;
+
+                const int localCol = cols[i] - tile->firstCol;
+                const int localRow = rows[i] - tile->firstRow;
+
+                const double* p = pixels + localRow*stride + localCol;
+
+                double val = p[0];
+
+                if(interpolation == Interpolation::Bilinear)
+                {
+                    const int right = localCol + 1 < tile->width ? 1 : 0;
+                    const int down = localRow + 1 < tile->height ? stride : 0;
+
+                    const double top = p[0] + wx[i]*(p[right] - p[0]);
+                    const double bottom = p[down] + wx[i]*(p[down + right] - p[down]);
+                    const double bilinear = top + wy[i]*(bottom - top);
+
+                    // Next to a no data pixel fall back to the pixel that contains the point
+                    if(!std::isnan(bilinear))
+                    {
+                        val = bilinear;
+                    }
+                    else
+                    {
+                        const int nearCol = wx[i] < 0.5 ? 0 : right;
+                        const int nearRow = wy[i] < 0.5 ? 0 : down;
+                        val = p[nearRow + nearCol];
+                    }
+                }
+
+                if(std::isnan(val))
+                    missed.setBit(i);
+                else
+                    out[static_cast<qint64>(i)*numSampledBands + b] = val;
+            }
+
+            groupStart = groupEnd;
+        }
+    }
+
+    return 0;
+}
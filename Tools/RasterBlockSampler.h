@@ -0,0 +1,94 @@
+#ifndef RASTERBLOCKSAMPLER_H
+#define RASTERBLOCKSAMPLER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Samples a raster at many points at once
+// The points are grouped by the tile of the raster that they fall into, and each tile is read once as a block from the data provider instead of sampling the provider once per point
+// The tiles overlap their neighbours by one pixel so that the four pixels of a bilinear lookup are always in the same tile
+// A few decoded tiles are kept between calls, e.g., when the assets of several types are sampled one after the other
+
+#include <QBitArray>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include <memory>
+
+class QgsRasterDataProvider;
+class QString;
+
+class RasterBlockSampler
+{
+public:
+
+    enum class Interpolation { Nearest, Bilinear };
+
+    explicit RasterBlockSampler(QgsRasterDataProvider* provider, const int tileSize = 256, const int maxCachedTiles = 16);
+
+    // Samples the bands at the points, the coordinates have to be in the crs of the raster
+    // values holds numBands values per point, i.e., values[i*bands.size() + b], and a point that is outside of the raster or on a no data pixel is NaN with its bit set in missed
+    // Note that band numbers start from 1 and not 0!
+    // Returns 0 on success and -1 on failure with the message in err
+    int sample(const QVector<double>& x, const QVector<double>& y, const QVector<int>& bands, const Interpolation interpolation, QVector<double>& values, QBitArray& missed, QString& err);
+
+    void clearCache(void);
+
+private:
+
+    // The pixels of a tile as doubles, row by row, with no data as NaN
+    struct Tile
+    {
+        int firstCol = 0;
+        int firstRow = 0;
+        int width = 0;
+        int height = 0;
+        QVector<double> pixels;
+    };
+
+    std::shared_ptr<const Tile> getTile(const int band, const int tileRow, const int tileCol, QString& err);
+
+    QgsRasterDataProvider* dataProvider = nullptr;
+
+    int tileSize;
+    int maxCachedTiles;
+
+    // Least recently used tiles are at the front
+    QList<quint64> tileOrder;
+    QHash<quint64, std::shared_ptr<const Tile>> tileCache;
+};
+
+#endif // RASTERBLOCKSAMPLER_H
@@ -0,0 +1,488 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+
+#include "ResultsColumnCache.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QVector>
+
+#include <cstring>
+#include <limits>
+
+namespace {
+
+struct CacheHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 numColumns;
+    qint64 numRows;
+    qint64 sourceSize;
+    qint64 sourceModified;
+    qint64 namesSize;
+    qint64 idBytesSize;
+};
+
+const char cacheMagic[8] = {'R','2','D','R','E','S','C','C'};
+const quint32 cacheVersion = 3;
+
+inline qint64 alignTo8(const qint64 offset)
+{
+    return (offset + 7) & ~qint64(7);
+}
+
+struct CacheLayout
+{
+    qint64 idOffsetsOffset;
+    qint64 idBytesOffset;
+    qint64 valuesOffset;
+    qint64 totalSize;
+};
+
+CacheLayout computeLayout(const CacheHeader& header)
+{
+    CacheLayout layout;
+    layout.idOffsetsOffset = alignTo8(static_cast<qint64>(sizeof(CacheHeader)) + header.namesSize);
+    layout.idBytesOffset = layout.idOffsetsOffset + (header.numRows + 1)*static_cast<qint64>(sizeof(qint64));
+    layout.valuesOffset = alignTo8(layout.idBytesOffset + header.idBytesSize);
+    layout.totalSize = layout.valuesOffset + static_cast<qint64>(header.numColumns)*header.numRows*static_cast<qint64>(sizeof(double));
+
+    return layout;
+}
+
+bool writePadding(QSaveFile& file)
+{
+    const char zeros[8] = {0,0,0,0,0,0,0,0};
+
+    const auto padding = alignTo8(file.pos()) - file.pos();
+
+    return padding == 0 || file.write(zeros, padding) == padding;
+}
+
+}
+
+
+ResultsColumnCache::ResultsColumnCache()
+{
+
+}
+
+
+ResultsColumnCache::~ResultsColumnCache()
+{
+    this->close();
+}
+
+
+QString ResultsColumnCache::getCachePath(const QString& pathToGeoJSON)
+{
+    return pathToGeoJSON + ".r2dcache";
+}
+
+
+int ResultsColumnCache::open(const QString& pathToGeoJSON, QString& err)
+{
+    this->close();
+
+    qint64 sourceSize = 0;
+    qint64 sourceModified = 0;
+
+    if(fingerprint(pathToGeoJSON, sourceSize, sourceModified, err) != 0)
+        return -1;
+
+    auto pathToCache = getCachePath(pathToGeoJSON);
+
+    // Use the existing cache if it was made from the same GeoJSON file
+    QString loadErr;
+    if(QFileInfo::exists(pathToCache) && this->load(pathToCache, sourceSize, sourceModified, loadErr) == 0)
+        return 0;
+
+    this->close();
+
+    if(this->build(pathToGeoJSON, pathToCache, sourceSize, sourceModified, err) != 0)
+        return -1;
+
+    if(this->load(pathToCache, sourceSize, sourceModified, err) != 0)
+    {
+        this->close();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void ResultsColumnCache::close(void)
+{
+    if(cacheFile != nullptr)
+    {
+        if(mappedData != nullptr)
+            cacheFile->unmap(mappedData);
+
+        cacheFile->close();
+
+        delete cacheFile;
+    }
+
+    cacheFile = nullptr;
+    mappedData = nullptr;
+    cacheData.clear();
+    cacheBytes = nullptr;
+
+    rowCount = 0;
+    columnNames.clear();
+
+    idOffsets = nullptr;
+    idBytes = nullptr;
+    values = nullptr;
+}
+
+
+int ResultsColumnCache::numRows(void) const
+{
+    return static_cast<int>(rowCount);
+}
+
+
+int ResultsColumnCache::numColumns(void) const
+{
+    return columnNames.size();
+}
+
+
+const QStringList& ResultsColumnCache::getColumnNames(void) const
+{
+    return columnNames;
+}
+
+
+int ResultsColumnCache::getColumnIndex(const QString& name) const
+{
+    return columnNames.indexOf(name);
+}
+
+
+const double* ResultsColumnCache::column(const int col) const
+{
+    if(col < 0 || col >= columnNames.size())
+        return nullptr;
+
+    return values + static_cast<qint64>(col)*rowCount;
+}
+
+
+double ResultsColumnCache::value(const int row, const int col) const
+{
+    if(row < 0 || row >= rowCount || col < 0 || col >= columnNames.size())
+        return std::numeric_limits<double>::quiet_NaN();
+
+    return values[static_cast<qint64>(col)*rowCount + row];
+}
+
+
+QString ResultsColumnCache::assetID(const int row) const
+{
+    if(row < 0 || row >= rowCount)
+        return QString();
+
+    return QString::fromUtf8(idBytes + idOffsets[row], static_cast<int>(idOffsets[row + 1] - idOffsets[row]));
+}
+
+
+int ResultsColumnCache::fingerprint(const QString& pathToGeoJSON, qint64& size, qint64& modified, QString& err)
+{
+    QFileInfo fileInfo(pathToGeoJSON);
+
+    if(!fileInfo.isFile())
+    {
+        err = "Cannot open the file: " + pathToGeoJSON;
+        return -1;
+    }
+
+    size = fileInfo.size();
+    modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    return 0;
+}
+
+
+int ResultsColumnCache::build(const QString& pathToGeoJSON, const QString& pathToCache, const qint64 sourceSize, const qint64 sourceModified, QString& err)
+{
+    QFile jsonFile(pathToGeoJSON);
+
+    if(!jsonFile.open(QFile::ReadOnly))
+    {
+        err = "Cannot open the file: " + pathToGeoJSON;
+        return -1;
+    }
+
+    QJsonParseError parseError;
+    const auto features = QJsonDocument::fromJson(jsonFile.readAll(), &parseError).object().value("features").toArray();
+
+    jsonFile.close();
+
+    if(parseError.error != QJsonParseError::NoError)
+    {
+        err = "Error parsing JSON: " + parseError.errorString() + "\n File: " + pathToGeoJSON;
+        return -1;
+    }
+
+    const int numFeatures = features.size();
+
+    // Gather the columns in a single pass over the features
+    QStringList names;
+    QHash<QString, int> nameToColumn;
+    QVector<QVector<double>> columns;
+
+    QVector<qint64> offsets;
+    offsets.reserve(numFeatures + 1);
+    offsets.append(0);
+
+    QByteArray ids;
+
+    for(int row = 0; row < numFeatures; ++row)
+    {
+        const auto properties = features.at(row).toObject().value("properties").toObject();
+
+        for(auto it = properties.constBegin(); it != properties.constEnd(); ++it)
+        {
+            const auto& key = it.key();
+
+            if(!key.startsWith("R2Dres_"))
+                continue;
+
+            auto col = nameToColumn.value(key, -1);
+
+            if(col == -1)
+            {
+                col = names.size();
+                names.append(key);
+                nameToColumn.insert(key, col);
+                columns.append(QVector<double>(numFeatures, std::numeric_limits<double>::quiet_NaN()));
+            }
+
+            columns[col][row] = it.value().toDouble();
+        }
+
+        auto id = properties.value("AIM_id");
+
+        if(id.isUndefined())
+            ids.append(QString::number(row).toUtf8());
+        else
+            ids.append(id.toVariant().toString().toUtf8());
+
+        offsets.append(ids.size());
+    }
+
+    QByteArray namesBlock;
+    for(auto&& name : names)
+    {
+        const auto utf8 = name.toUtf8();
+        const quint32 length = static_cast<quint32>(utf8.size());
+
+        namesBlock.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        namesBlock.append(utf8);
+    }
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.numColumns = static_cast<quint32>(names.size());
+    header.numRows = numFeatures;
+    header.namesSize = namesBlock.size();
+    header.idBytesSize = ids.size();
+    header.sourceSize = sourceSize;
+    header.sourceModified = sourceModified;
+
+    // Written to a temporary file first so that a half-written cache is never picked up
+    QSaveFile cacheFile(pathToCache);
+
+    if(!cacheFile.open(QIODevice::WriteOnly))
+    {
+        err = "Cannot create the results cache: " + pathToCache;
+        return -1;
+    }
+
+    bool ok = cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+    ok = ok && cacheFile.write(namesBlock) == namesBlock.size();
+    ok = ok && writePadding(cacheFile);
+    ok = ok && cacheFile.write(reinterpret_cast<const char*>(offsets.constData()), offsets.size()*sizeof(qint64)) == static_cast<qint64>(offsets.size()*sizeof(qint64));
+    ok = ok && cacheFile.write(ids) == ids.size();
+    ok = ok && writePadding(cacheFile);
+
+    for(auto&& col : columns)
+    {
+        const auto numBytes = static_cast<qint64>(col.size()*sizeof(double));
+        ok = ok && cacheFile.write(reinterpret_cast<const char*>(col.constData()), numBytes) == numBytes;
+    }
+
+    if(!ok || !cacheFile.commit())
+    {
+        cacheFile.cancelWriting();
+        err = "Error writing the results cache: " + pathToCache;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int ResultsColumnCache::load(const QString& pathToCache, const qint64 sourceSize, const qint64 sourceModified, QString& err)
+{
+    cacheFile = new QFile(pathToCache);
+
+    if(!cacheFile->open(QIODevice::ReadOnly))
+    {
+        err = "Cannot open the results cache: " + pathToCache;
+        return -1;
+    }
+
+    const auto fileSize = cacheFile->size();
+
+    if(fileSize < static_cast<qint64>(sizeof(CacheHeader)))
+    {
+        err = "The results cache is corrupt: " + pathToCache;
+        return -1;
+    }
+
+    mappedData = cacheFile->map(0, fileSize);
+
+    if(mappedData != nullptr)
+    {
+        cacheBytes = reinterpret_cast<const char*>(mappedData);
+    }
+    else
+    {
+        // Some file systems do not support mapping, read the file into memory instead
+        cacheData = cacheFile->readAll();
+        cacheBytes = cacheData.constData();
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, cacheBytes, sizeof(header));
+
+    if(std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion)
+    {
+        err = "The results cache has an unknown format: " + pathToCache;
+        return -1;
+    }
+
+    if(header.sourceSize != sourceSize || header.sourceModified != sourceModified)
+    {
+        err = "The results cache is out of date: " + pathToCache;
+        return -1;
+    }
+
+    // Every size in the header has to fit in the file before the layout is computed from them, otherwise the offsets can overflow
+    const auto doubleSize = static_cast<qint64>(sizeof(double));
+
+    if(header.numRows < 0 || header.namesSize < 0 || header.idBytesSize < 0 || header.numRows > std::numeric_limits<int>::max() ||
+            header.namesSize > fileSize || header.idBytesSize > fileSize || header.numRows >= fileSize/doubleSize ||
+            (header.numRows > 0 && static_cast<qint64>(header.numColumns) > fileSize/(header.numRows*doubleSize)))
+    {
+        err = "The results cache is corrupt: " + pathToCache;
+        return -1;
+    }
+
+    const auto layout = computeLayout(header);
+
+    if(layout.totalSize != fileSize)
+    {
+        err = "The results cache is corrupt: " + pathToCache;
+        return -1;
+    }
+
+    // Read the column names
+    const char* names = cacheBytes + sizeof(CacheHeader);
+    const char* namesEnd = names + header.namesSize;
+
+    for(quint32 i = 0; i < header.numColumns; ++i)
+    {
+        quint32 length = 0;
+
+        if(namesEnd - names < static_cast<qint64>(sizeof(length)))
+        {
+            err = "The results cache is corrupt: " + pathToCache;
+            return -1;
+        }
+
+        std::memcpy(&length, names, sizeof(length));
+        names += sizeof(length);
+
+        if(namesEnd - names < static_cast<qint64>(length))
+        {
+            err = "The results cache is corrupt: " + pathToCache;
+            return -1;
+        }
+
+        columnNames.append(QString::fromUtf8(names, static_cast<int>(length)));
+        names += length;
+    }
+
+    const auto offsets = reinterpret_cast<const qint64*>(cacheBytes + layout.idOffsetsOffset);
+
+    if(offsets[0] != 0 || offsets[header.numRows] != header.idBytesSize)
+    {
+        err = "The results cache is corrupt: " + pathToCache;
+        return -1;
+    }
+
+    // The ID offsets are read without checks afterwards, so each one has to lie within the ID bytes and follow the one before it
+    for(qint64 row = 0; row < header.numRows; ++row)
+    {
+        if(offsets[row + 1] < offsets[row] || offsets[row + 1] > header.idBytesSize)
+        {
+            err = "The results cache is corrupt: " + pathToCache;
+            return -1;
+        }
+    }
+
+    rowCount = header.numRows;
+
+    idOffsets = reinterpret_cast<const qint64*>(cacheBytes + layout.idOffsetsOffset);
+    idBytes = cacheBytes + layout.idBytesOffset;
+    values = reinterpret_cast<const double*>(cacheBytes + layout.valuesOffset);
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef RESULTSCOLUMNCACHE_H
+#define RESULTSCOLUMNCACHE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Binary, column-oriented cache of the numeric R2Dres_ results of a per-type results GeoJSON file
+// The cache is written next to the GeoJSON file on the first load and memory-mapped on every load after that, so that the results never have to be parsed again
+// Layout (native byte order, the cache is only ever read on the machine that wrote it):
+//   header | column names | asset id offsets (numRows+1 x qint64) | asset id bytes | padding to 8 bytes | one block of numRows doubles per column
+// A value that is missing from a feature is stored as NaN
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class QFile;
+
+class ResultsColumnCache
+{
+public:
+    ResultsColumnCache();
+    ~ResultsColumnCache();
+
+    // Opens the cache of the GeoJSON file, the cache is (re)built first if it is missing or does not match the GeoJSON file
+    // Returns 0 on success and -1 on failure with the message in err
+    int open(const QString& pathToGeoJSON, QString& err);
+
+    void close(void);
+
+    // The path of the cache that belongs to a GeoJSON file
+    static QString getCachePath(const QString& pathToGeoJSON);
+
+    int numRows(void) const;
+    int numColumns(void) const;
+
+    // The property names of the columns, e.g., R2Dres_MeanRepairCost, in the order they first appear in the features
+    const QStringList& getColumnNames(void) const;
+    int getColumnIndex(const QString& name) const;
+
+    // Pointer to the numRows values of a column, valid until the cache is closed
+    const double* column(const int col) const;
+
+    double value(const int row, const int col) const;
+
+    // The AIM_id of the asset in a row, or the row number if the feature has no AIM_id
+    QString assetID(const int row) const;
+
+private:
+
+    int build(const QString& pathToGeoJSON, const QString& pathToCache, const qint64 sourceSize, const qint64 sourceModified, QString& err);
+    int load(const QString& pathToCache, const qint64 sourceSize, const qint64 sourceModified, QString& err);
+
+    // Fingerprint of the GeoJSON file, its size and modification time, so that a cache hit does not have to read the file
+    // The feature splitter leaves a per-type file untouched when its contents did not change, which keeps the modification time of the file valid
+    static int fingerprint(const QString& pathToGeoJSON, qint64& size, qint64& modified, QString& err);
+
+    QFile* cacheFile = nullptr;
+    uchar* mappedData = nullptr;
+
+    // Used instead of the mapping if the file system does not support it
+    QByteArray cacheData;
+
+    const char* cacheBytes = nullptr;
+
+    qint64 rowCount = 0;
+    QStringList columnNames;
+
+    const qint64* idOffsets = nullptr;
+    const char* idBytes = nullptr;
+    const double* values = nullptr;
+};
+
+#endif // RESULTSCOLUMNCACHE_H
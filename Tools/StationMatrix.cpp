@@ -0,0 +1,226 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+#include "StationMatrix.h"
+#include "CSVStreamReader.h"
+
+#include <QtNumeric>
+
+#include <algorithm>
+#include <cmath>
+
+int StationMatrix::parseFile(const QString& pathToFile, const int maxTextRows, QString& err)
+{
+    headers.clear();
+    values.clear();
+    numericColumns.clear();
+    textRows.clear();
+    rows = 0;
+    cols = 0;
+
+    CSVStreamReader csvReader;
+
+    QString rowErr;
+
+    auto res = csvReader.parseFile(pathToFile, [&](const CSVRow& row, int rowIndex)
+    {
+        if(rowIndex == 0)
+        {
+            headers = row.toStringList();
+            cols = headers.size();
+            numericColumns.fill(true, cols);
+            return true;
+        }
+
+        if(row.size() != cols)
+        {
+            rowErr = "The number of columns in the row " + QString::number(rowIndex) + " of the file " + pathToFile + " should be " + QString::number(cols);
+            return false;
+        }
+
+        if(maxTextRows == -1 || textRows.size() < maxTextRows)
+            textRows.push_back(row.toStringList());
+
+        for(int j = 0; j<cols; ++j)
+        {
+            bool ok = false;
+            auto val = row[j].toDouble(&ok);
+
+            if(!ok)
+            {
+                val = qQNaN();
+                numericColumns[j] = false;
+            }
+
+            values.push_back(val);
+        }
+
+        ++rows;
+
+        return true;
+    }, err);
+
+    if(res != 0)
+        return -1;
+
+    if(!rowErr.isEmpty())
+    {
+        err = rowErr;
+        return -1;
+    }
+
+    if(rows == 0)
+    {
+        err = "The file " + pathToFile + " is empty";
+        return -1;
+    }
+
+    return 0;
+}
+
+
+const QStringList& StationMatrix::getHeaders(void) const
+{
+    return headers;
+}
+
+
+int StationMatrix::numRows(void) const
+{
+    return rows;
+}
+
+
+int StationMatrix::numColumns(void) const
+{
+    return cols;
+}
+
+
+double StationMatrix::value(const int row, const int col) const
+{
+    return values.at(row*cols + col);
+}
+
+
+bool StationMatrix::isNumericColumn(const int col) const
+{
+    return numericColumns.at(col);
+}
+
+
+const QVector<QStringList>& StationMatrix::getTextRows(void) const
+{
+    return textRows;
+}
+
+
+QVector<double> StationMatrix::columnMeans(void) const
+{
+    QVector<double> sums(cols, 0.0);
+
+    double* sumsData = sums.data();
+    const double* rowData = values.constData();
+
+    // Walk the matrix in memory order, the inner loop over the columns has no dependencies between iterations
+    for(int i = 0; i<rows; ++i, rowData += cols)
+        for(int j = 0; j<cols; ++j)
+            sumsData[j] += rowData[j];
+
+    for(int j = 0; j<cols; ++j)
+        sumsData[j] = numericColumns.at(j) ? sumsData[j]/rows : qQNaN();
+
+    return sums;
+}
+
+
+QVector<double> StationMatrix::columnStdDevs(void) const
+{
+    auto means = this->columnMeans();
+
+    QVector<double> sumSquares(cols, 0.0);
+
+    double* sumSquaresData = sumSquares.data();
+    const double* meansData = means.constData();
+    const double* rowData = values.constData();
+
+    // Two passes rather than the sum of the squares, to not lose the precision when the spread is small relative to the mean
+    for(int i = 0; i<rows; ++i, rowData += cols)
+    {
+        for(int j = 0; j<cols; ++j)
+        {
+            const double diff = rowData[j] - meansData[j];
+            sumSquaresData[j] += diff*diff;
+        }
+    }
+
+    for(int j = 0; j<cols; ++j)
+    {
+        if(!numericColumns.at(j))
+            sumSquaresData[j] = qQNaN();
+        else
+            sumSquaresData[j] = rows > 1 ? std::sqrt(sumSquaresData[j]/(rows - 1)) : 0.0;
+    }
+
+    return sumSquares;
+}
+
+
+double StationMatrix::columnPercentile(const int col, const double p) const
+{
+    if(col < 0 || col >= cols || !numericColumns.at(col))
+        return qQNaN();
+
+    QVector<double> column(rows);
+
+    for(int i = 0; i<rows; ++i)
+        column[i] = values[i*cols + col];
+
+    // Only the two closest ranks have to be in place, not the whole column sorted
+    const double rank = std::min(std::max(p, 0.0), 100.0)/100.0*(rows - 1);
+    const int lower = static_cast<int>(std::floor(rank));
+    const double frac = rank - lower;
+
+    std::nth_element(column.begin(), column.begin() + lower, column.end());
+    const double lowerValue = column[lower];
+
+    if(frac == 0.0 || lower + 1 >= rows)
+        return lowerValue;
+
+    const double upperValue = *std::min_element(column.begin() + lower + 1, column.end());
+
+    return lowerValue + frac*(upperValue - lowerValue);
+}
@@ -0,0 +1,92 @@
+#ifndef STATIONMATRIX_H
+#define STATIONMATRIX_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// The realizations of a station file, e.g., the intensity measures of a ground motion station, parsed once into a contiguous row-major matrix of doubles
+// The fields that are not numbers are stored as NaN and only the text of the first few rows is kept, for the previews in the map
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class StationMatrix
+{
+public:
+
+    // Parses the file, the header is the first row and every row must have as many fields as the header
+    // The text of the first maxTextRows rows is kept, or of all of them if it is -1
+    // Returns 0 on success and -1 on failure with the message in err
+    int parseFile(const QString& pathToFile, const int maxTextRows, QString& err);
+
+    const QStringList& getHeaders(void) const;
+
+    int numRows(void) const;
+    int numColumns(void) const;
+
+    double value(const int row, const int col) const;
+
+    // True if every value in the column is a number
+    bool isNumericColumn(const int col) const;
+
+    // The text of the first maxTextRows rows of the last parse
+    const QVector<QStringList>& getTextRows(void) const;
+
+    // Reductions of all of the columns in a single sweep over the rows, a column that is not numeric gives NaN
+    QVector<double> columnMeans(void) const;
+
+    // Sample standard deviation
+    QVector<double> columnStdDevs(void) const;
+
+    // The p-th percentile (0 <= p <= 100) of a column, interpolated linearly between the closest ranks, NaN if the column is not numeric
+    double columnPercentile(const int col, const double p) const;
+
+private:
+
+    QStringList headers;
+
+    int rows = 0;
+    int cols = 0;
+
+    // Row-major, i.e., values[row*cols + col]
+    QVector<double> values;
+
+    QVector<bool> numericColumns;
+
+    QVector<QStringList> textRows;
+};
+
+#endif // STATIONMATRIX_H
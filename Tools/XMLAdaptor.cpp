@@ -41,207 +41,289 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "QGISVisualizationWidget.h"
 #include <qgsvectorlayer.h>
 
-#include <QtXml>
+#include <QCoreApplication>
 #include <QFile>
+#include <QThread>
+#include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrent>
 
-XMLAdaptor::XMLAdaptor()
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace
 {
 
-}
+// Size of the slice of grid_data that is parsed and added to the layer at a time
+const qint64 gridBatchBytes = 8*1024*1024;
 
+// The grid points parsed by one worker thread
+struct GridPartition
+{
+    const char* begin = nullptr;
+    const char* end = nullptr;
 
-QgsVectorLayer* XMLAdaptor::parseXMLFile(const QString& filePath, QString& errMessage, QGISVisualizationWidget* GISVisWidget)
+    QVector<QgsFeature> features;
+
+    QString err;
+};
+
+
+// Splits a line of the grid into its values, the values are separated by spaces or tabs
+// Returns the number of values found, or -1 if a value is not a number
+int parseGridLine(const char* lineBegin, const char* lineEnd, QByteArray& token, QVector<double>& values)
 {
-    // QDomDocument used to import XML data
-    QDomDocument xmlGMs;
+    values.resize(0);
 
-    // Load xml file
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly ))
+    const char* pos = lineBegin;
+
+    while(pos < lineEnd)
     {
-        // Error while loading file
-        errMessage = "Error while loading file";
-        return nullptr;
-    }
+        while(pos < lineEnd && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+            ++pos;
 
-    // Set raw XML content into the QDomDocument
-    xmlGMs.setContent(&file);
+        if(pos == lineEnd)
+            break;
 
-    // Close the file now that we are done with it
-    file.close();
+        const char* tokenBegin = pos;
 
-    // Extract the root element
-    QDomElement root=xmlGMs.documentElement();
+        while(pos < lineEnd && *pos != ' ' && *pos != '\t' && *pos != '\r')
+            ++pos;
 
-    // Get root names and attributes
-    QString Type = root.tagName();
+        // Reuse the token buffer so that the numbers are converted without an allocation each
+        token.resize(0);
+        token.append(tokenBegin, static_cast<int>(pos - tokenBegin));
 
-    // Check that the XML file is actually a shake map grid
-    if(Type.compare("shakemap_grid") != 0)
-    {
-        errMessage = "Error, XML file is not a ShakeMap grid";
-        return nullptr;
+        bool OK = true;
+        values.push_back(token.toDouble(&OK));
+
+        if(!OK)
+            return -1;
     }
 
-    // Get some information from the file
-    shakemapID = root.attribute("shakemap_id","NULL");
+    return values.size();
+}
 
-    //    QString shakemapVersion = root.attribute("shakemap_version","NULL");
 
-    //    if(shakemapVersion.compare("10") != 0)
-    //    {
-    //        errMessage = "Error: only shakemap version 10 is supported";
-    //        return nullptr;
-    //    }
+void parseGridPartition(GridPartition& partition, const int numFields, const int indexLon, const int indexLat, const QgsFields& featFields)
+{
+    const QVariant assetType("SHAKEMAP_GRID");
+    const QVariant tabName("ShakeMap Grid Point");
 
-    QDomNodeList eventList = root.elementsByTagName("event");
+    QByteArray token;
+    token.reserve(64);
 
-    QDomNodeList GMFieldsList = root.elementsByTagName("grid_field");
+    QVector<double> values;
+    values.reserve(numFields);
 
-    auto numFields = GMFieldsList.size();
+    const char* lineBegin = partition.begin;
 
-    if(numFields == 0 || eventList.size() == 0)
-        return nullptr;
+    while(lineBegin < partition.end)
+    {
+        const char* lineEnd = std::find(lineBegin, partition.end, '\n');
 
-    // Get the event name
-    eventName = eventList.item(0).toElement().attribute("event_description","NULL");
+        const auto numValues = parseGridLine(lineBegin, lineEnd, token, values);
 
-    int indexLon = -1;
-    int indexLat = -1;
+        lineBegin = lineEnd + 1;
 
-    // Get all of the grid fields from the XML file
-    QgsFields featFields;
+        if(numValues == 0)
+            continue;
 
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
+        if(numValues == -1)
+        {
+            partition.err = "Error converting a value in the grid data to double";
+            return;
+        }
 
-    featFields.append(QgsField("AssetType", QVariant::String));
-    featFields.append(QgsField("TabName", QVariant::String));
+        if(numValues != numFields)
+        {
+            partition.err = "Error the number of columns in a point does not equal the number of fields";
+            return;
+        }
 
-    for(int i = 0; i < GMFieldsList.count(); ++i)
-    {
-        auto item = GMFieldsList.item(i).toElement();
+        auto longitude = values.at(indexLon);
+        auto latitude = values.at(indexLat);
 
-        QString fieldName = item.attribute("name","NULL");
-        attribFields.push_back(QgsField(fieldName, QVariant::String));
+        if(longitude == 0.0 || latitude == 0.0)
+        {
+            partition.err = "Error, zero lat lon values";
+            return;
+        }
+
+        // create the feature attributes
+        QgsAttributes featAttributes(numFields + 2);
+
+        featAttributes[0] = assetType;
+        featAttributes[1] = tabName;
+
+        for(int i = 0; i<numFields; ++i)
+            featAttributes[2+i] = values.at(i);
 
-        featFields.append(QgsField(fieldName, QVariant::String));
+        // Create the feature
+        QgsFeature feature(featFields);
+        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
+        feature.setAttributes(featAttributes);
 
-        if(fieldName.compare("LAT") == 0)
-            indexLat = i;
-        if(fieldName.compare("LON") == 0)
-            indexLon = i;
+        partition.features.push_back(feature);
     }
+}
 
-    // Get the grid data from the XML file
-    QDomNodeList gridDataElements = root.elementsByTagName("grid_data");
+}
+
+
+XMLAdaptor::XMLAdaptor()
+{
 
-    if(gridDataElements.size() != 1)
+}
+
+
+QgsVectorLayer* XMLAdaptor::parseXMLFile(const QString& filePath, QString& errMessage, QGISVisualizationWidget* GISVisWidget)
+{
+    // Load xml file
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly ))
     {
-        errMessage = "Error, no grid data in XML file";
+        // Error while loading file
+        errMessage = "Error while loading file";
         return nullptr;
     }
 
-    auto gridData =  gridDataElements.at(0).toElement().text();
+    // Map the file instead of reading it, a high resolution grid can be hundreds of megabytes
+    QByteArray fileData;
+    const char* data = nullptr;
+    const qint64 dataSize = file.size();
 
-    // Each grid point is separated by a newline
-    auto gridPoints = gridData.split("\n",Qt::SkipEmptyParts);
+    if(auto mappedData = file.map(0, dataSize))
+    {
+        data = reinterpret_cast<const char*>(mappedData);
+    }
+    else
+    {
+        // Without the mapping the file has to fit in a QByteArray
+        if(dataSize > std::numeric_limits<int>::max())
+        {
+            errMessage = "Error, the XML file is too large to be read into memory and could not be mapped";
+            return nullptr;
+        }
 
-    if(gridPoints.size() == 0)
-        return nullptr;
+        fileData = file.readAll();
+        data = fileData.constData();
+    }
 
-    if(indexLat == -1 || indexLon == -1)
-    {
-        errMessage = "Error getting the lat and/or lon indexes in the grid xml file";
-        return nullptr;
-    }   
+    // Find the grid data, everything before it is the header of the grid, which is small
+    // The search runs over the raw pointers with 64-bit offsets, a QByteArray cannot span a grid of more than 2 GB
+    const char* dataEnd = data + dataSize;
 
-//    // Over 50000 points causes arc gis library to crash... even though, too many points makes the visualization too cluttered
-//    int decim = gridPoints.size()/40000;
+    const char gridDataOpen[] = "<grid_data";
+    const char gridDataClose[] = "</grid_data>";
 
-//    if(decim == 0)
-//        decim = 1;
+    const char* gridDataTag = std::search(data, dataEnd, gridDataOpen, gridDataOpen + sizeof(gridDataOpen) - 1);
+    const char* gridDataBegin = gridDataTag == dataEnd ? dataEnd : std::find(gridDataTag, dataEnd, '>');
 
-    // Iterate through the grid points to get the data at each point
-    QgsFeatureList featureList;
+    // The closing tag is at the end of the file, so search for it from the back rather than across the whole grid
+    const char* gridDataClosing = gridDataBegin == dataEnd ? dataEnd : std::find_end(gridDataBegin, dataEnd, gridDataClose, gridDataClose + sizeof(gridDataClose) - 1);
 
-    auto count = 0;
-    for(auto&& gp : gridPoints)
+    if(gridDataClosing == dataEnd)
     {
-        ++count;
+        errMessage = "Error, no grid data in XML file";
+        return nullptr;
+    }
 
-//        if(count%decim != 0)
-//            continue;
+    const qint64 gridDataEnd = gridDataClosing - data;
+    const qint64 headerSize = gridDataTag - data;
 
-        // Change for windows compilation
-        gp.remove("\r");
+    if(headerSize > std::numeric_limits<int>::max())
+    {
+        errMessage = "Error, the header of the XML file is too large";
+        return nullptr;
+    }
 
-        if(gp.isEmpty())
-            continue;
+    // Read the event and the grid fields from the header
+    QXmlStreamReader xmlReader(QByteArray::fromRawData(data, static_cast<int>(headerSize)));
 
-        QStringList pointData;
+    bool isRoot = true;
+    bool foundEvent = false;
 
-        if(gp.contains("\t"))
-            pointData = gp.split("\t");
-        else
-            pointData = gp.split(" ");
+    QStringList fieldNames;
 
-        if(pointData.size() != numFields)
-        {
-            errMessage = "Error the number of columns in a point does not equal the number of fields";
-            return nullptr;
-        }
+    int indexLon = -1;
+    int indexLat = -1;
 
-        // create the feature attributes
-        QgsAttributes featAttributes(attribFields.size());
+    while(!xmlReader.atEnd())
+    {
+        if(xmlReader.readNext() != QXmlStreamReader::StartElement)
+            continue;
 
-        featAttributes[0]= "SHAKEMAP_GRID"; // Asset type
-        featAttributes[1]= "ShakeMap Grid Point"; // Tab Name
+        auto tagName = xmlReader.name();
+        auto attributes = xmlReader.attributes();
 
-        for(int i = 0; i<numFields; ++i)
+        // Check that the XML file is actually a shake map grid
+        if(isRoot)
         {
-            auto attrbVal = pointData[i];
-            featAttributes[2+i] = attrbVal;
-        }
+            if(tagName.compare(QLatin1String("shakemap_grid")) != 0)
+            {
+                errMessage = "Error, XML file is not a ShakeMap grid";
+                return nullptr;
+            }
 
-        bool OK = true;
+            // Get some information from the file
+            shakemapID = attributes.hasAttribute("shakemap_id") ? attributes.value("shakemap_id").toString() : "NULL";
 
-        auto longitude = pointData[indexLon].toDouble(&OK);
-
-        if(!OK)
+            isRoot = false;
+        }
+        else if(tagName.compare(QLatin1String("event")) == 0 && !foundEvent)
         {
-            errMessage = "Error converting longitude to double";
-            return nullptr;
+            foundEvent = true;
+
+            // Get the event name
+            eventName = attributes.hasAttribute("event_description") ? attributes.value("event_description").toString() : "NULL";
         }
+        else if(tagName.compare(QLatin1String("grid_field")) == 0)
+        {
+            QString fieldName = attributes.hasAttribute("name") ? attributes.value("name").toString() : "NULL";
 
-        auto latitude = pointData[indexLat].toDouble(&OK);
+            if(fieldName.compare("LAT") == 0)
+                indexLat = fieldNames.size();
+            if(fieldName.compare("LON") == 0)
+                indexLon = fieldNames.size();
 
-        if(!OK)
-        {
-            errMessage = "Error converting latitude to double";
-            return nullptr;
+            fieldNames.push_back(fieldName);
         }
+    }
 
-        if(longitude == 0.0 || latitude == 0.0)
-        {
-            errMessage = "Error, zero lat lon values";
-            return nullptr;
-        }
+    // The header ends in the middle of the root element, so only a premature end is expected
+    if(xmlReader.hasError() && xmlReader.error() != QXmlStreamReader::PrematureEndOfDocumentError)
+    {
+        errMessage = "Error reading the XML file: " + xmlReader.errorString();
+        return nullptr;
+    }
 
-        // Create the feature
-        QgsFeature feature;
-        feature.setFields(featFields);
-        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
-        feature.setAttributes(featAttributes);
-        featureList.append(feature);
+    auto numFields = fieldNames.size();
 
-        // Create the ground motion station
-        GroundMotionStation station("NULL",latitude,longitude);
-        station.setStationFeature(feature);
-        stationList.push_back(station);
+    if(numFields == 0 || !foundEvent)
+    {
+        errMessage = "Error, the XML file is missing the event or the grid fields";
+        return nullptr;
+    }
+
+    if(indexLat == -1 || indexLon == -1)
+    {
+        errMessage = "Error getting the lat and/or lon indexes in the grid xml file";
+        return nullptr;
     }
 
+    // Get all of the grid fields from the XML file, the values of the grid are numbers
+    QgsFields featFields;
+
+    QList<QgsField> attribFields;
+    attribFields.push_back(QgsField("AssetType", QVariant::String));
+    attribFields.push_back(QgsField("TabName", QVariant::String));
+
+    for(auto&& fieldName : fieldNames)
+        attribFields.push_back(QgsField(fieldName, QVariant::Double));
+
+    for(auto&& field : attribFields)
+        featFields.append(field);
 
     auto vectorLayer = GISVisWidget->addVectorLayer("Point", "ShakeMap Grid");
     if(vectorLayer == nullptr)
@@ -262,7 +344,85 @@ QgsVectorLayer* XMLAdaptor::parseXMLFile(const QString& filePath, QString& errMe
 
     vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
 
-    dProvider->addFeatures(featureList);
+    // Parse the grid points a batch at a time, each batch is split at line breaks between the worker threads and its features are added to the layer before the next batch is parsed
+    const int numPartitions = std::max(1, QThread::idealThreadCount());
+
+    QVector<GridPartition> partitions(numPartitions);
+
+    const char* batchBegin = gridDataBegin + 1;
+    const char* gridEnd = data + gridDataEnd;
+
+    while(batchBegin < gridEnd)
+    {
+        const char* batchEnd = batchBegin + std::min<qint64>(gridBatchBytes, gridEnd - batchBegin);
+        batchEnd = std::find(batchEnd, gridEnd, '\n');
+
+        const qint64 batchSize = batchEnd - batchBegin;
+
+        const char* partitionBegin = batchBegin;
+        for(int i = 0; i<numPartitions; ++i)
+        {
+            const char* partitionEnd = i == numPartitions - 1 ? batchEnd : std::find(batchBegin + batchSize*(i+1)/numPartitions, batchEnd, '\n');
+            partitionEnd = std::max(partitionBegin, partitionEnd);
+
+            auto& partition = partitions[i];
+            partition.begin = partitionBegin;
+            partition.end = partitionEnd;
+            partition.features.clear();
+            partition.err.clear();
+
+            partitionBegin = partitionEnd;
+        }
+
+        QtConcurrent::blockingMap(partitions, [&](GridPartition& partition)
+        {
+            parseGridPartition(partition, numFields, indexLon, indexLat, featFields);
+        });
+
+        for(auto&& partition : partitions)
+        {
+            if(!partition.err.isEmpty())
+            {
+                errMessage = partition.err;
+                stationList.clear();
+                GISVisWidget->removeLayer(vectorLayer);
+                return nullptr;
+            }
+
+            // The features are moved along rather than copied, the stations share the features that the layer holds once their IDs are set
+            QgsFeatureList featureList;
+            featureList.reserve(partition.features.size());
+
+            for(auto&& feature : partition.features)
+                featureList.append(std::move(feature));
+
+            partition.features.clear();
+
+            dProvider->addFeatures(featureList, QgsFeatureSink::FastInsert);
+
+            for(auto&& feature : featureList)
+            {
+                // Create the ground motion station
+                auto point = feature.geometry().asPoint();
+                GroundMotionStation station("NULL",point.y(),point.x());
+                station.setStationFeature(feature);
+                stationList.push_back(std::move(station));
+            }
+        }
+
+        batchBegin = batchEnd;
+
+        // Keep the interface painting while a large grid is loading
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    }
+
+    if(stationList.isEmpty())
+    {
+        errMessage = "Error, no grid points in the XML file";
+        GISVisWidget->removeLayer(vectorLayer);
+        return nullptr;
+    }
+
     vectorLayer->updateExtents();
 
     GISVisWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
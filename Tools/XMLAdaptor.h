@@ -39,6 +39,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 // This class imports a XML ShakeMap grid into a ArcGIS feature collection layer
+// The grid is streamed: the header is read with a QXmlStreamReader and the grid_data is parsed in parallel, one batch of lines at a time
 
 #include "GroundMotionStation.h"
 
@@ -41,9 +41,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "AssetInputWidget.h"
 #include "VisualizationWidget.h"
 #include "CSVReaderWriter.h"
+#include "CSVStreamReader.h"
 #include "ComponentTableView.h"
 #include "ComponentTableModel.h"
 #include "ComponentDatabaseManager.h"
+#include "ConcurrentTasks.h"
 
 // Test to remove
 //#include <chrono>
@@ -62,13 +64,21 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QFileInfo>
 #include <QJsonObject>
 #include <QHeaderView>
+#include <QProgressBar>
+#include <QEventLoop>
+#include <QtConcurrent>
+#include <QThread>
 
 #include "QGISVisualizationWidget.h"
 
+#include <qgsfeature.h>
+#include <qgsvectorlayer.h>
+
 
 // Std library headers
 #include <string>
 #include <algorithm>
+#include <numeric>
 
 AssetInputWidget::AssetInputWidget(QWidget *parent, VisualizationWidget* visWidget, QString assetType, QString appType) : SimCenterAppWidget(parent), appType(appType), assetType(assetType)
 {
@@ -111,6 +121,15 @@ AssetInputWidget::~AssetInputWidget()
 
 bool AssetInputWidget::loadAssetData(bool message)
 {
+    // A load asked for while another one is running replaces it, the running load is cancelled and this one is started once it has unwound
+    if(isLoading)
+    {
+        loadAfterLoading = true;
+        this->handleCancelLoading();
+        this->statusMessage("The assets in " + pathToComponentInputFile + " are loaded once the current load has been cancelled");
+        return true;
+    }
+
     // Ask for the file path if the file path has not yet been set, and return if it is still null
     if(pathToComponentInputFile.compare("NULL") == 0)
         this->chooseComponentInfoFileDialog();
@@ -149,36 +168,124 @@ bool AssetInputWidget::loadAssetData(bool message)
         return false;
     }
 
-    CSVReaderWriter csvTool;
-    
+    this->startLoading();
+
+    auto res = this->loadAssetFile();
+
+    this->finishLoading();
+
+    // A clear that came in while loading is carried out now that the background work is done
+    if(clearAfterLoading)
+    {
+        clearAfterLoading = false;
+
+        // The file of a load that was asked for after the clear is kept
+        auto nextPath = pathToComponentInputFile;
+
+        this->clear();
+
+        if(!loadAfterLoading)
+            return false;
+
+        pathToComponentInputFile = nextPath;
+        componentFileLineEdit->setText(nextPath);
+    }
+    else if(res == false && cancelLoading)
+    {
+        // Throw away whatever was loaded before the cancel
+        if(mainLayer != nullptr)
+            theVisualizationWidget->removeLayer(mainLayer);
+
+        if(selectedFeaturesLayer != nullptr)
+            theVisualizationWidget->removeLayer(selectedFeaturesLayer);
+
+        mainLayer = nullptr;
+        selectedFeaturesLayer = nullptr;
+
+        componentTableWidget->clear();
+        componentTableWidget->hide();
+        tableHorizontalHeadings.clear();
+
+        emit headingValuesChanged(QStringList{"N/A"});
+
+        this->statusMessage("Loading of the assets was cancelled");
+    }
+
+    // Start the load that was queued behind this one
+    if(loadAfterLoading)
+    {
+        loadAfterLoading = false;
+
+        auto filter = filterAfterLoading;
+        filterAfterLoading.clear();
+
+        res = this->loadAssetData(message);
+
+        if(res && !filter.isEmpty())
+            this->setFilterString(filter);
+    }
+
+    return res;
+}
+
+
+bool AssetInputWidget::loadAssetFile(void)
+{
+    // Stream the rows straight into the typed columns of the table, the file is never held in memory as strings
+    CSVStreamReader csvReader;
+
+    QStringList tableHeadings;
+    ComponentTableStore tableStore;
+
+    const auto fileSize = QFileInfo(pathToComponentInputFile).size();
+
+    this->setLoadingProgress("Reading the asset file", 0, 100);
+
     QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(pathToComponentInputFile,err);
-    
-    if(!err.isEmpty())
+    int parseRes = 0;
+
+    // The parsing is done on a worker thread, the table is handed over to the model once it is complete
+    auto completed = this->runInBackground([&]()
+    {
+        parseRes = csvReader.parseFile(pathToComponentInputFile, [&](const CSVRow& row, int rowIndex)
+        {
+            if(rowIndex == 0)
+                tableHeadings = row.toStringList();
+            else
+                tableStore.appendRow(row);
+
+            if(rowIndex % 4096 == 0 && fileSize > 0)
+                this->setLoadingProgress("Reading the asset file", static_cast<int>(100*csvReader.bytesParsed()/fileSize), 100);
+
+            return !cancelLoading;
+        }, err);
+
+        if(parseRes == 0 && !cancelLoading)
+            tableStore.finalize();
+    });
+
+    if(!completed)
+        return false;
+
+    if(parseRes != 0)
     {
         this->errorMessage(err);
         return false;
     }
     
-    if(data.empty())
+    if(tableHeadings.empty())
     {
         this->errorMessage("Input file is empty");
         return false;
     }
     
-    // Get the header file
-    QStringList tableHeadings = data.first();
-    
     tableHorizontalHeadings = tableHeadings;
     
     tableHeadings.push_front("N/A");
     
     emit headingValuesChanged(tableHeadings);
     
-    // Pop off the row that contains the header information
-    data.pop_front();
-    
-    auto numRows = data.size();
+    auto numRows = tableStore.rowCount();
     
     if(numRows == 0)
     {
@@ -187,18 +294,15 @@ bool AssetInputWidget::loadAssetData(bool message)
     }
     else{
         this->statusMessage("Loading visualization for " + QString::number(numRows)+ " assets");
-        QApplication::processEvents();
     }
     
-    auto firstRow = data.first();
-    
-    if(firstRow.empty())
+    if(tableStore.columnCount() == 0)
     {
         this->errorMessage("First row is empty");
         return false;
     }
     
-    componentTableWidget->getTableModel()->populateData(data, tableHorizontalHeadings);
+    componentTableWidget->getTableModel()->populateData(std::move(tableStore), tableHorizontalHeadings);
 
 #ifdef OpenSRA
     label3->show();
@@ -214,10 +318,12 @@ bool AssetInputWidget::loadAssetData(bool message)
     if(selectedFeaturesLayer != nullptr)
         theVisualizationWidget->removeLayer(selectedFeaturesLayer);
 
+    mainLayer = nullptr;
+    selectedFeaturesLayer = nullptr;
 
     auto res = this->loadAssetVisualization();
 
-    if(res != 0)
+    if(res != 0 || cancelLoading)
         return false;
 
     // Get the ID of the first and last component
@@ -242,7 +348,6 @@ bool AssetInputWidget::loadAssetData(bool message)
     //    this->statusMessage("Done ALL "+QString::number(duration.count()));
     
     this->statusMessage("Done loading assets");
-    QApplication::processEvents();
 
     emit doneLoadingComponents();
     
@@ -366,6 +471,9 @@ void AssetInputWidget::createComponentsBox(void)
 
     mainWidgetLayout->addWidget(label3,0,Qt::AlignCenter);
     mainWidgetLayout->addWidget(componentTableWidget,0,Qt::AlignCenter);
+
+    this->createLoadingWidget();
+    mainWidgetLayout->addWidget(loadingWidget);
     
     mainWidgetLayout->addStretch();
 
@@ -457,7 +565,11 @@ void AssetInputWidget::createComponentsBox(void)
     // mainWidgetLayout->addWidget(label3,0,Qt::AlignCenter);
     
     mainWidgetLayout->addWidget(componentTableWidget,3, 0, 1,4);
-    mainWidgetLayout->setRowStretch(4,1);
+
+    this->createLoadingWidget();
+    mainWidgetLayout->addWidget(loadingWidget,4, 0, 1,4);
+
+    mainWidgetLayout->setRowStretch(5,1);
     
     //    mainWidgetLayout->addStretch();
 
@@ -494,6 +606,9 @@ void AssetInputWidget::selectComponents(void)
 
 void AssetInputWidget::handleComponentSelection(void)
 {
+    // The selection works on the table and layers that a running load is still building
+    if(isLoading)
+        return;
 
     auto nRows = componentTableWidget->rowCount();
 
@@ -520,18 +635,17 @@ void AssetInputWidget::handleComponentSelection(void)
         return;
     }
 
-    auto selectedComponentIDs = selectComponentsLineEdit->getSelectedComponentIDs();
+    auto&& selectedComponentIDs = selectComponentsLineEdit->getSelectedComponentIDs();
 
-    // First check that all of the selected IDs are within range
-    for(auto&& it : selectedComponentIDs)
+    // First check that all of the selected IDs are within range, the set is sorted so only its ends need checking
+    if(!selectedComponentIDs.isEmpty() && (selectedComponentIDs.first()<firstID || selectedComponentIDs.last()>lastID))
     {
-        if(it<firstID || it>lastID)
-        {
-            QString msg = "The component ID " + QString::number(it) + " is out of range of the components provided";
-            this->errorMessage(msg);
-            selectComponentsLineEdit->clear();
-            return;
-        }
+        auto outOfRangeID = selectedComponentIDs.first()<firstID ? selectedComponentIDs.first() : selectedComponentIDs.last();
+
+        QString msg = "The component ID " + QString::number(outOfRangeID) + " is out of range of the components provided";
+        this->errorMessage(msg);
+        selectComponentsLineEdit->clear();
+        return;
     }
 
     theComponentDb->startEditing();
@@ -580,6 +694,10 @@ QStringList AssetInputWidget::getTableHorizontalHeadings()
 
 void AssetInputWidget::clearComponentSelection(void)
 {
+    // The selection works on the table and layers that a running load is still building
+    if(isLoading)
+        return;
+
     //    auto nRows = componentTableWidget->rowCount();
 
     // Hide all rows in the table
@@ -762,7 +880,9 @@ bool AssetInputWidget::inputAppDataFromJSON(QJsonObject &jsonObject)
             pathToComponentInputFile = fileName;
             componentFileLineEdit->setText(fileName);
 
-            this->loadAssetData();
+            if(this->loadAssetData() == false)
+                return false;
+
             foundFile = true;
 
         } else {
@@ -777,7 +897,9 @@ bool AssetInputWidget::inputAppDataFromJSON(QJsonObject &jsonObject)
             if (fileInfo.exists(pathToComponentInputFile)) {
                 componentFileLineEdit->setText(pathToComponentInputFile);
                 foundFile = true;
-                this->loadAssetData();
+
+                if(this->loadAssetData() == false)
+                    return false;
 
             } else {
                 // adam .. adam .. adam
@@ -786,7 +908,9 @@ bool AssetInputWidget::inputAppDataFromJSON(QJsonObject &jsonObject)
                 if (fileInfo.exists(pathToComponentInputFile)) {
                     componentFileLineEdit->setText(pathToComponentInputFile);
                     foundFile = true;
-                    this->loadAssetData();
+
+                    if(this->loadAssetData() == false)
+                        return false;
                 }
                 else
                 {
@@ -805,7 +929,13 @@ bool AssetInputWidget::inputAppDataFromJSON(QJsonObject &jsonObject)
         }
 
         if (appData.contains("filter"))
-            this->setFilterString(appData["filter"].toString());
+        {
+            // A load that is queued behind a running one has not filled the table yet, its filter is applied once it is done
+            if(loadAfterLoading)
+                filterAfterLoading = appData["filter"].toString();
+            else
+                this->setFilterString(appData["filter"].toString());
+        }
 
     }
     else
@@ -970,6 +1100,195 @@ bool AssetInputWidget::copyFiles(QString &destName)
 }
 
 
+void AssetInputWidget::createLoadingWidget(void)
+{
+    loadingWidget = new QWidget();
+
+    QHBoxLayout* loadingLayout = new QHBoxLayout(loadingWidget);
+    loadingLayout->setContentsMargins(0,0,0,0);
+
+    loadingLabel = new QLabel();
+
+    loadingProgressBar = new QProgressBar();
+    loadingProgressBar->setRange(0,100);
+
+    QPushButton* cancelButton = new QPushButton(tr("Cancel"));
+    cancelButton->setMaximumWidth(150);
+
+    connect(cancelButton,&QPushButton::clicked,this,&AssetInputWidget::handleCancelLoading);
+
+    loadingLayout->addWidget(loadingLabel);
+    loadingLayout->addWidget(loadingProgressBar,1);
+    loadingLayout->addWidget(cancelButton);
+
+    loadingWidget->hide();
+}
+
+
+void AssetInputWidget::startLoading(void)
+{
+    isLoading = true;
+    cancelLoading = false;
+
+    clearAfterLoading = false;
+
+    // The loading wait keeps the event loop running for the cancel button, so lock out everything that could re-trigger or alter the load
+    this->setLoadingInputsEnabled(false);
+    componentTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    loadingLabel->clear();
+    loadingProgressBar->setValue(0);
+    loadingWidget->show();
+}
+
+
+void AssetInputWidget::finishLoading(void)
+{
+    isLoading = false;
+
+    this->setLoadingInputsEnabled(true);
+    componentTableWidget->setEditTriggers(QAbstractItemView::DoubleClicked);
+
+    loadingWidget->hide();
+}
+
+
+void AssetInputWidget::setLoadingInputsEnabled(const bool enabled)
+{
+    browseFileButton->setEnabled(enabled);
+    componentFileLineEdit->setEnabled(enabled);
+    selectComponentsLineEdit->setEnabled(enabled);
+}
+
+
+void AssetInputWidget::handleCancelLoading(void)
+{
+    if(!isLoading)
+        return;
+
+    cancelLoading = true;
+
+    loadingLabel->setText("Cancelling...");
+}
+
+
+bool AssetInputWidget::isLoadingCancelled(void) const
+{
+    return cancelLoading;
+}
+
+
+void AssetInputWidget::setLoadingProgress(const QString& stage, const int value, const int maximum)
+{
+    // Post the update to the GUI thread so that this can be called from the workers
+    QMetaObject::invokeMethod(this, [this, stage, value, maximum]()
+    {
+        if(loadingWidget == nullptr)
+            return;
+
+        loadingLabel->setText(stage);
+        loadingProgressBar->setRange(0,maximum);
+        loadingProgressBar->setValue(value);
+    }, Qt::QueuedConnection);
+}
+
+
+bool AssetInputWidget::runInBackground(const std::function<void(void)>& function)
+{
+    return this->waitForLoading(QtConcurrent::run(function));
+}
+
+
+bool AssetInputWidget::waitForLoading(const QFuture<void>& future)
+{
+    loadingFuture = future;
+
+    // User input is let through so that the cancel button works, the inputs that could re-enter the load are disabled in startLoading
+    // A load or clear that still comes in, e.g., from opening an example, cancels this load and is carried out once it has unwound
+    ConcurrentTasks::waitFor(loadingFuture, nullptr, QEventLoop::AllEvents);
+
+    return !cancelLoading;
+}
+
+
+int AssetInputWidget::loadFeaturesInChunks(QgsVectorLayer* layer, const FeatureBuilder& buildFeature)
+{
+    auto pr = layer->dataProvider();
+
+    auto numRows = componentTableWidget->rowCount();
+
+    // Each chunk is split into one contiguous block of rows per core
+    const int numPartitions = std::max(1, QThread::idealThreadCount());
+
+    QVector<int> partitions(numPartitions);
+    std::iota(partitions.begin(), partitions.end(), 0);
+
+    QVector<QString> partitionErrors(numPartitions);
+    std::atomic<bool> buildFailed{false};
+
+    for(int chunkStart = 0; chunkStart < numRows; chunkStart += featureChunkSize)
+    {
+        const int chunkEnd = std::min(chunkStart + featureChunkSize, numRows);
+        const int chunkRows = chunkEnd - chunkStart;
+
+        // Every row has its own slot so that the partitions can fill them without locking
+        QVector<QgsFeature> features(chunkRows);
+        QgsFeature* featureData = features.data();
+
+        auto completed = this->waitForLoading(QtConcurrent::map(partitions, [&](const int partition)
+        {
+            const int begin = chunkStart + static_cast<int>(static_cast<qint64>(chunkRows)*partition/numPartitions);
+            const int end = chunkStart + static_cast<int>(static_cast<qint64>(chunkRows)*(partition+1)/numPartitions);
+
+            for(int i = begin; i < end; ++i)
+            {
+                if(cancelLoading || buildFailed)
+                    return;
+
+                if(buildFeature(i, featureData[i-chunkStart], partitionErrors[partition]) != 0)
+                {
+                    buildFailed = true;
+                    return;
+                }
+            }
+        }));
+
+        if(!completed)
+            return -1;
+
+        if(buildFailed)
+        {
+            for(auto&& err : partitionErrors)
+            {
+                if(!err.isEmpty())
+                {
+                    this->errorMessage(err);
+                    break;
+                }
+            }
+
+            return -1;
+        }
+
+        // The chunks are added in order, and in a single batch, so that the feature ids follow the table rows
+        QgsFeatureList featureList = features.toList();
+
+        if(!pr->addFeatures(featureList, QgsFeatureSink::FastInsert))
+        {
+            this->errorMessage("Error adding the features to the layer");
+            return -1;
+        }
+
+        layer->updateExtents();
+        layer->triggerRepaint();
+
+        this->setLoadingProgress("Loading the " + assetType.toLower() + " on the map", chunkEnd, numRows);
+    }
+
+    return 0;
+}
+
+
 void AssetInputWidget::clearTableData(void)
 {
     theComponentDb->clear();
@@ -986,6 +1305,16 @@ void AssetInputWidget::clearTableData(void)
 
 void AssetInputWidget::clear(void)
 {
+    // Do not clear the data out from under a running load, cancel it and clear once it has unwound
+    if(isLoading)
+    {
+        clearAfterLoading = true;
+        loadAfterLoading = false;
+        filterAfterLoading.clear();
+        this->handleCancelLoading();
+        return;
+    }
+
     this->clearTableData();
 
     mainLayer = nullptr;
@@ -1034,6 +1363,10 @@ void AssetInputWidget::clearSelectedAssets(void)
 
 void AssetInputWidget::handleComponentFilter(void)
 {
+    // The selection works on the table and layers that a running load is still building
+    if(isLoading)
+        return;
+
     auto mainAssetLayer = theComponentDb->getMainLayer();
 
     if(mainAssetLayer == nullptr)
@@ -45,9 +45,12 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "ComponentDatabase.h"
 
 #include <set>
+#include <atomic>
+#include <functional>
 
 #include <QString>
 #include <QObject>
+#include <QFuture>
 
 class AssetInputDelegate;
 class AssetFilterDelegate;
@@ -67,6 +70,7 @@ class QVBoxLayout;
 class QPushButton;
 class QHBoxLayout;
 class QGridLayout;
+class QProgressBar;
 
 class AssetInputWidget : public  SimCenterAppWidget, public GISSelectable
 {
@@ -151,9 +155,25 @@ protected slots:
     void chooseComponentInfoFileDialog(void);
     void clearComponentSelection(void);
     void handleComponentFilter(void);
+    void handleCancelLoading(void);
 
 protected:
 
+    // Signature of the function that creates the feature of a table row; it is called from several worker threads at once and must only read from the table
+    using FeatureBuilder = std::function<int(const int row, QgsFeature& feature, QString& err)>;
+
+    // Runs the function on a worker thread and returns once it is done, the event loop keeps running in the meantime so that the GUI stays responsive
+    // Returns false if the loading was cancelled
+    bool runInBackground(const std::function<void(void)>& function);
+
+    // Builds the features of the table rows in chunks, with the rows of each chunk partitioned across the cores, and adds each chunk to the layer in one batch as soon as it is done, so that the map fills in progressively
+    int loadFeaturesInChunks(QgsVectorLayer* layer, const FeatureBuilder& buildFeature);
+
+    // Can be called from the worker threads
+    void setLoadingProgress(const QString& stage, const int value, const int maximum);
+
+    bool isLoadingCancelled(void) const;
+
     QGISVisualizationWidget* theVisualizationWidget = nullptr;
 
     ComponentTableView* componentTableWidget = nullptr;
@@ -205,6 +225,35 @@ protected:
 
     void clearTableData(void);
 
+private:
+
+    bool loadAssetFile(void);
+
+    bool waitForLoading(const QFuture<void>& future);
+
+    void createLoadingWidget(void);
+    void startLoading(void);
+    void finishLoading(void);
+
+    // Enables or disables the inputs that could start another load while one is running
+    void setLoadingInputsEnabled(const bool enabled);
+
+    // The number of table rows in each chunk of features that is added to the map
+    const int featureChunkSize = 10000;
+
+    bool isLoading = false;
+    std::atomic<bool> cancelLoading{false};
+    bool clearAfterLoading = false;
+
+    // A load that was asked for while another one was running, and the filter from the input file to apply once it is done
+    bool loadAfterLoading = false;
+    QString filterAfterLoading;
+    QFuture<void> loadingFuture;
+
+    QWidget* loadingWidget = nullptr;
+    QLabel* loadingLabel = nullptr;
+    QProgressBar* loadingProgressBar = nullptr;
+
 
 };
 
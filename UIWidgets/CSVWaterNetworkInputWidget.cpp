@@ -258,6 +258,8 @@ int CSVWaterNetworkInputWidget::loadPipelinesVisualization()
 
     auto numAtrb = attribFields.size();
 
+    const auto& tableStore = pipelinesTableWidget->getTableModel()->getTableStore();
+
     for(int i = 0; i<nRows; ++i)
     {
 
@@ -265,9 +267,7 @@ int CSVWaterNetworkInputWidget::loadPipelinesVisualization()
         QgsAttributes featureAttributes(numAtrb);
 
         // Create a new pipeline
-        QString pipelineIDStr = pipelinesTableWidget->item(i,0).toString();
-
-        int pipelineID =  pipelineIDStr.toInt();
+        int pipelineID = static_cast<int>(tableStore.toLongLong(i,0));
 
         // Create a unique ID for the pipeline
         //        auto uid = theVisualizationWidget->createUniqueID();
@@ -290,9 +290,9 @@ int CSVWaterNetworkInputWidget::loadPipelinesVisualization()
         QgsFeature feature;
         feature.setFields(featFields);
 
-        auto nodeTag1 = pipelinesTableWidget->item(i,indexNodeTag1).toInt();
+        auto nodeTag1 = static_cast<int>(tableStore.toLongLong(i,indexNodeTag1));
 
-        auto nodeTag2 = pipelinesTableWidget->item(i,indexNodeTag2).toInt();
+        auto nodeTag2 = static_cast<int>(tableStore.toLongLong(i,indexNodeTag2));
 
         // Start and end point of the pipe
         QgsPointXY point1 = nodePointsMap.value(nodeTag1);
@@ -411,16 +411,20 @@ int CSVWaterNetworkInputWidget::getNodeMap()
     }
 
 
+    // Read the coordinates straight from the typed table columns
+    const auto& tableStore = theNodesTableWidget->getTableModel()->getTableStore();
+
+    const auto latitudes = tableStore.columnToDoubles(indexLatitude, 0.0);
+    const auto longitudes = tableStore.columnToDoubles(indexLongitude, 0.0);
+
     for(int i = 0; i<nRows; ++i)
     {
 
         // Create a new node
-        QString nodeIDStr = theNodesTableWidget->item(i,0).toString();
-
-        int nodeID = nodeIDStr.toInt();
+        int nodeID = static_cast<int>(tableStore.toLongLong(i,0));
 
-        auto latitude = theNodesTableWidget->item(i,indexLatitude).toDouble();
-        auto longitude = theNodesTableWidget->item(i,indexLongitude).toDouble();
+        auto latitude = latitudes[i];
+        auto longitude = longitudes[i];
 
         QgsPointXY point(longitude,latitude);
         auto geom = QgsGeometry::fromPointXY(point);
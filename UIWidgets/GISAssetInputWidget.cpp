@@ -330,6 +330,85 @@ bool GISAssetInputWidget::loadAssetData(bool message)
         return false;
     }
 
+    return this->loadMainLayer(message);
+}
+
+
+bool GISAssetInputWidget::loadAssetFeatures(const QString& layerName, const QString& layerType, const QgsFields& fields, QgsFeatureList& features, bool message)
+{
+    if(!this->addMainLayer(layerName, layerType, fields))
+        return false;
+
+    if(!mainLayer->dataProvider()->addFeatures(features, QgsFeatureSink::FastInsert))
+    {
+        this->errorMessage("Error adding features to the layer "+layerName);
+        return false;
+    }
+
+    mainLayer->updateExtents();
+
+    return this->loadMainLayer(message);
+}
+
+
+bool GISAssetInputWidget::loadAssetFeatures(const QString& layerName, const QString& layerType, const QgsFields& fields, const std::function<bool(QgsFeatureList&)>& nextFeatures, bool message)
+{
+    if(!this->addMainLayer(layerName, layerType, fields))
+        return false;
+
+    auto pr = mainLayer->dataProvider();
+
+    QgsFeatureList features;
+    while(nextFeatures(features))
+    {
+        if(!pr->addFeatures(features, QgsFeatureSink::FastInsert))
+        {
+            this->errorMessage("Error adding features to the layer "+layerName);
+            return false;
+        }
+
+        features.clear();
+    }
+
+    mainLayer->updateExtents();
+
+    return this->loadMainLayer(message);
+}
+
+
+bool GISAssetInputWidget::addMainLayer(const QString& layerName, const QString& layerType, const QgsFields& fields)
+{
+    // Clear the old layers if any
+    if(mainLayer != nullptr)
+        theVisualizationWidget->removeLayer(mainLayer);
+
+    if(selectedFeaturesLayer != nullptr)
+        theVisualizationWidget->removeLayer(selectedFeaturesLayer);
+
+    mainLayer = theVisualizationWidget->addVectorLayer(layerType, layerName);
+
+    if(mainLayer == nullptr)
+    {
+        this->errorMessage("Error, failed to add GIS layer");
+        return false;
+    }
+
+    auto pr = mainLayer->dataProvider();
+
+    if(!pr->addAttributes(fields.toList()))
+    {
+        this->errorMessage("Error adding attributes to the layer "+layerName);
+        return false;
+    }
+
+    mainLayer->updateFields(); // tell the vector layer to fetch changes from the provider
+
+    return true;
+}
+
+
+bool GISAssetInputWidget::loadMainLayer(bool message)
+{
     this->setCRS(mainLayer->crs());
 
     auto numFeat = mainLayer->featureCount();
@@ -41,6 +41,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "AssetInputWidget.h"
 #include "qgsvectorfilewriter.h"
 
+#include <functional>
+
 class QgsVectorLayer;
 class CRSSelectionWidget;
 
@@ -80,6 +82,13 @@ public:
     int getOffset(void);
     CRSSelectionWidget* getCRSSelectorWidget(void);
 
+    // Loads the assets from features that are already in memory instead of from a GIS file, layerType is the geometry type of the layer, e.g., point or linestring
+    bool loadAssetFeatures(const QString& layerName, const QString& layerType, const QgsFields& fields, QgsFeatureList& features, bool message = true);
+
+    // Like above, but the features are added block by block so that only one block is buffered at a time, the layer still holds a copy of all of them
+    // nextFeatures fills the list with the next block of features and returns false once there are no more
+    bool loadAssetFeatures(const QString& layerName, const QString& layerType, const QgsFields& fields, const std::function<bool(QgsFeatureList&)>& nextFeatures, bool message = true);
+
 public slots:
     bool loadAssetData(bool message = true);
 
@@ -88,6 +97,12 @@ private slots:
 
 protected:
 
+    // Fills the table, the visualization, and the database from the main layer once it is loaded
+    bool loadMainLayer(bool message);
+
+    // Replaces the main layer with an empty memory layer that has the fields
+    bool addMainLayer(const QString& layerName, const QString& layerType, const QgsFields& fields);
+
     CRSSelectionWidget* crsSelectorWidget = nullptr;
 
 };
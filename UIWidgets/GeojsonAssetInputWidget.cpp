@@ -40,11 +40,15 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "QGISVisualizationWidget.h"
 #include "GISAssetInputWidget.h"
 #include "MultiComponentR2D.h"
-#include "SimCenterPreferences.h"
 
 #include <qgslinesymbol.h>
 #include <qgsmarkersymbol.h>
 #include <qgsjsonutils.h>
+#include <qgsfeatureiterator.h>
+#include <qgsfeaturerequest.h>
+#include <qgsgeometry.h>
+#include <qgsvectorlayer.h>
+#include <qgswkbtypes.h>
 
 #include <QLineEdit>
 #include <QLabel>
@@ -53,8 +57,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QSplitter>
 #include <QGroupBox>
 #include <QVBoxLayout>
-#include <QJsonArray>
-#include <QTemporaryFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QHash>
+
+#include <algorithm>
 
 GeojsonAssetInputWidget::GeojsonAssetInputWidget(QWidget *parent, VisualizationWidget* visWidget, QString componentType, QString appType)
     : SimCenterAppWidget(parent), componentType(componentType), appType(appType)
@@ -401,158 +408,182 @@ void GeojsonAssetInputWidget::chooseAssetFileDialog(void)
 
 
 
+namespace {
+
+// The features of one asset type in the GeoJSON file, e.g., Bridge or Tunnel
+struct GeojsonAssetFeatures
+{
+    QgsWkbTypes::Type wkbType = QgsWkbTypes::Unknown;
+
+    // Whether a field of the file is set for any of the features of this type
+    QVector<bool> usedFields;
+
+    // The ids of the features in the file, in the order of the file
+    QVector<QgsFeatureId> featureIds;
+};
+
+// The number of features that are read from the file and added to a layer at a time
+const int featureBlockSize = 10000;
+
+}
+
+
 bool GeojsonAssetInputWidget::loadAssetData(void)
 {
     QString pathGeojson = componentFileLineEdit->text();
-      QFile jsonFile(pathGeojson);
 
-    QMap<QString, QList<QJsonObject>> assetDictionary;
+    if(!QFileInfo::exists(pathGeojson))
+    {
+        this->errorMessage("Failed to open file at location: "+pathGeojson);
+        return false;
+    }
+
+    // The file is opened once through OGR, there is no JSON document of the whole file and no temporary files per asset type
+    // The features of each type are read from it in blocks and copied into the memory layer of the type, so the loading buffer holds one block but the layers hold all of the features
+    QgsVectorLayer sourceLayer(pathGeojson, QFileInfo(pathGeojson).fileName(), "ogr");
 
-    QJsonObject crs;
-    if (jsonFile.exists() && jsonFile.open(QFile::ReadOnly)) {
+    if(!sourceLayer.isValid())
+    {
+        this->errorMessage("Failed to open file at location: "+pathGeojson);
+        return false;
+    }
 
-        QString data = jsonFile.readAll();
-        QJsonDocument exDoc = QJsonDocument::fromJson(data.toUtf8());
-        QJsonObject jsonObject = exDoc.object();
+    QgsCoordinateReferenceSystem qgsCRS = sourceLayer.crs();
+    if (!qgsCRS.isValid()){
+        QString msg = "The CRS defined in " + pathGeojson + " is invalid and ignored";
+        errorMessage(msg);
+    }
+    crsSelectorWidget->setCRS(qgsCRS);
 
-        if(jsonObject.contains("crs"))
-            crs = jsonObject["crs"].toObject();
-        QString crsString = crs["properties"].toObject()["name"].toString();
-        QgsCoordinateReferenceSystem qgsCRS = QgsCoordinateReferenceSystem(crsString);
-        if (!qgsCRS.isValid()){
-            qgsCRS.createFromOgcWmsCrs(crsString);
-        }
-        if (!qgsCRS.isValid()){
-            QString msg = "The CRS: " + crsString + " defined in " + pathGeojson + " is invalid and ignored";
-            errorMessage(msg);
-        }
-        crsSelectorWidget->setCRS(qgsCRS);
-        QJsonArray features = jsonObject["features"].toArray();
+    const auto sourceFields = sourceLayer.fields();
+    const auto typeIndex = sourceFields.indexFromName("type");
 
-        for (const QJsonValue& valueIt : features) {
+    if (typeIndex == -1) {
+        this->errorMessage("The features in "+pathGeojson+" are missing the 'type' property that defines the asset type");
+        return false;
+    }
 
-            QJsonObject value = valueIt.toObject();
+    // Sort the features by asset type in a single pass, only their ids are kept and the features are read again per type below
+    QMap<QString, GeojsonAssetFeatures> assetDictionary;
 
-            // Get the type
-            QJsonObject assetProperties = value["properties"].toObject();
+    auto features = sourceLayer.getFeatures();
 
-            if (!jsonObject.contains("type")) {
-                this->errorMessage("The Json object is missing the 'type' key that defines the asset type");
-                return false;
-            }
+    QgsFeature feat;
+    while (features.nextFeature(feat))
+    {
+        auto& asset = assetDictionary[feat.attribute(typeIndex).toString()];
 
-            QString assetType = assetProperties["type"].toString();
+        if(asset.usedFields.isEmpty())
+            asset.usedFields.fill(false, sourceFields.size());
 
-            if (!assetDictionary.contains(assetType))
-            {
-                assetDictionary[assetType] = QList<QJsonObject>({value});
-            }
-            else
-            {
-                QList<QJsonObject>& featList = assetDictionary[assetType];
-                featList.append(value);
-            }
+        const auto attributes = feat.attributes();
+        for(int i = 0; i<attributes.size(); ++i)
+        {
+            if(!attributes.at(i).isNull())
+                asset.usedFields[i] = true;
         }
-    }
-    else{
-        this->errorMessage("Failed to open file at location: "+pathGeojson);
-        return false;
+
+        // Single and multi part geometries of the same kind go into a multi part layer
+        if(feat.hasGeometry())
+        {
+            auto wkbType = feat.geometry().wkbType();
+
+            if(asset.wkbType == QgsWkbTypes::Unknown)
+                asset.wkbType = wkbType;
+            else if(asset.wkbType != wkbType && QgsWkbTypes::multiType(asset.wkbType) == QgsWkbTypes::multiType(wkbType))
+                asset.wkbType = QgsWkbTypes::multiType(wkbType);
+        }
+
+        asset.featureIds.append(feat.id());
     }
 
     for (auto it = assetDictionary.begin(); it != assetDictionary.end(); ++it)
     {
         QString assetType = it.key();
-        QList<QJsonObject> features = it.value();
+        auto& asset = it.value();
 
-        QJsonArray featuresArray;
-        for (const auto& obj : features) {
-            featuresArray.append(obj);
+        // Like a GeoJSON file of only this asset type, the layer only gets the fields that are set for the type
+        QgsFields fields;
+        QgsAttributeList fieldIndices;
+        for(int i = 0; i<sourceFields.size(); ++i)
+        {
+            if(asset.usedFields.at(i))
+            {
+                fields.append(sourceFields.at(i));
+                fieldIndices.append(i);
+            }
         }
 
-        QJsonObject assetDictionary;
-        assetDictionary["type"]="FeatureCollection";
-        assetDictionary["features"]=featuresArray;
+        // The features of the type are read from the file a block at a time and go into the layer in the order of the file
+        int numRead = 0;
 
-        if(!crs.isEmpty())
-            assetDictionary["crs"]=crs;
+        auto nextFeatures = [&](QgsFeatureList& block)
+        {
+            if(numRead == asset.featureIds.size())
+                return false;
 
-        QString workingDir = SimCenterPreferences::getInstance()->getLocalWorkDir();
-        QDir dirWork(workingDir);
-        if (!dirWork.exists()){
-            if (!dirWork.mkpath(workingDir))
-            {
-                QString errorMessage = QString("Could not load the Working Directory: ") + workingDir
-                                       + QString(". Change the Local Jobs Directory location in preferences.");
+            const int blockEnd = std::min(numRead + featureBlockSize, asset.featureIds.size());
 
-                this->errorMessage(errorMessage);
+            QgsFeatureIds blockIds;
+            QHash<QgsFeatureId, int> blockPositions;
 
-                return false;
+            for(int i = numRead; i<blockEnd; ++i)
+            {
+                blockIds.insert(asset.featureIds.at(i));
+                blockPositions.insert(asset.featureIds.at(i), i - numRead);
+                block.append(QgsFeature());
             }
-        }
-        // Store data in a ground motions folder under hazard simulation
-        workingDir += QDir::separator() + QString("temp_files");
-        QDir tempDir(workingDir);
-        if (!tempDir.exists()){
-            if (!tempDir.mkpath(workingDir))
+
+            QgsFeatureRequest request;
+            request.setFilterFids(blockIds);
+            request.setSubsetOfAttributes(fieldIndices);
+
+            auto blockFeatures = sourceLayer.getFeatures(request);
+
+            QgsFeature feature;
+            while (blockFeatures.nextFeature(feature))
             {
-                QString errorMessage = QString("Could not make the temp_files directory in ") + workingDir
-                                       + QString(". Change the Local Jobs Directory location in preferences.");
+                if(fields.size() != sourceFields.size())
+                {
+                    const auto attributes = feature.attributes();
 
-                this->errorMessage(errorMessage);
+                    QgsAttributes typeAttributes(fieldIndices.size());
+                    for(int i = 0; i<fieldIndices.size(); ++i)
+                        typeAttributes[i] = attributes.at(fieldIndices.at(i));
 
-                return false;
+                    feature.setFields(fields);
+                    feature.setAttributes(typeAttributes);
+                }
+
+                block[blockPositions.value(feature.id())] = feature;
             }
-        }
-        QString outputFile = tempDir.absolutePath() + QDir::separator() + assetType + ".geojson";
 
-        QFile file(outputFile);
-        if (!file.open(QFile::WriteOnly | QFile::Text))
-        {
-            this->errorMessage("Error creating the asset output json file in GeojsonAssetInputWidget");
-            return false;
-        }
+            numRead = blockEnd;
 
-        // Write the file to the folder
-        QJsonDocument doc(assetDictionary);
-        file.write(doc.toJson());
-        file.close();
+            return true;
+        };
 
-        this->statusMessage("Loading asset type "+assetType+" with "+ QString::number(features.size())+" features");
+        QString layerType = asset.wkbType == QgsWkbTypes::Unknown ? QString("none") : QgsWkbTypes::displayString(asset.wkbType);
 
-        GISAssetInputWidget *thisAssetWidget = new GISAssetInputWidget(nullptr, theVisualizationWidget, assetType);
+        this->statusMessage("Loading asset type "+assetType+" with "+ QString::number(asset.featureIds.size())+" features");
 
-        // Hide the first label
-        /*
-        thisAssetWidget->getLabel1()->hide();
-        thisAssetWidget->getCRSSelectorWidget()->hide();
-        // Hide the file input widgets in the asset file path layout
-        auto pathLayout = thisAssetWidget->getAssetFilePathLayout();
-        for (int i = 0; i < pathLayout->count(); ++i) {
-            QWidget *widget = pathLayout->itemAt(i)->widget();
-            if (widget) {
-                widget->hide();
-            }
-        }
-        */
+        GISAssetInputWidget *thisAssetWidget = new GISAssetInputWidget(nullptr, theVisualizationWidget, assetType);
 
         thisAssetWidget->hideCRS_Selection();
         thisAssetWidget->hideAssetFilePath();
 
-        thisAssetWidget->setPathToComponentInputFile(outputFile);
-        if (!thisAssetWidget->loadAssetData(false)) {
+        if (!thisAssetWidget->loadAssetFeatures(assetType, layerType, fields, nextFeatures, false)) {
             this->errorMessage("Failed to load asset data for asset type" + assetType);
             return false;
         }
 
+        if (qgsCRS.isValid())
+            thisAssetWidget->setCRS(qgsCRS);
+
         theAssetLayerList.append(thisAssetWidget->getMainLayer());
 
         mainAssetWidget->addComponent(assetType, thisAssetWidget);
 
-//        if (!file.remove()) {
-//            this->errorMessage("Warning, failed to remove the temporary file "+outputFile);
-//        }
-
-
         if (ComponentTypeToAdditionalWidget.contains(assetType)){
             for (QWidget* it:ComponentTypeToAdditionalWidget[assetType]){
                 it->show();
@@ -567,4 +598,3 @@ bool GeojsonAssetInputWidget::loadAssetData(void)
 
 
 }
-
@@ -36,7 +36,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
-#include "CSVReaderWriter.h"
+#include "CSVStreamReader.h"
 #include "GroundMotionStation.h"
 
 #include <QFileInfo>
@@ -47,6 +47,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QFile>
+#include <QMutexLocker>
+#include <QPair>
 
 GroundMotionStation::GroundMotionStation(QString path, double lat, double lon) : stationFilePath(path), latitude(lat), longitude(lon)
 {
@@ -65,76 +67,121 @@ double GroundMotionStation::getLongitude() const
 }
 
 
-void GroundMotionStation::importGroundMotions(void)
+void GroundMotionStation::importGroundMotions(GroundMotionRecordCache* recordCache, const int maxStationDataRows)
 {
-    CSVReaderWriter csvTool;
+    CSVStreamReader csvReader;
 
-    QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(stationFilePath,err);
+    QStringList tableHeadings;
 
-    // Return if there is an error or the data is empty
-    if(!err.isEmpty())
-        throw err;
+    QString baseDir = QFileInfo(stationFilePath).dir().absolutePath();
 
-    if(data.size() < 2)
-        throw "The file " + stationFilePath + " is empty";
+    // Pairs of the ground motion file path and its scaling factor, the time histories are imported once the station file is closed
+    QVector<QPair<QString, double>> gmFiles;
 
-    // Get the header file
-    QStringList tableHeadings = data.first();
+    QString rowErr;
 
-    // Pop off the row that contains the header information
-    data.pop_front();
+    QString err;
+    auto res = csvReader.parseFile(stationFilePath, [&](const CSVRow& row, int rowIndex)
+    {
+        if(rowIndex == 0)
+        {
+            tableHeadings = row.toStringList();
 
-    stationData = data;
+            if(tableHeadings.at(0).compare("GM_file") == 0 && tableHeadings.size() != 2)
+            {
+                rowErr = "The number of columns in the header should be 2";
+                return false;
+            }
 
-    auto numRows = data.size();
-    auto numCols = tableHeadings.size();
+            return true;
+        }
 
-    if(tableHeadings.at(0).compare("GM_file") == 0)
-    {
-        if(numCols != 2)
-            throw "The number of columns in the header should be 2";
+        if(maxStationDataRows == -1 || stationData.size() < maxStationDataRows)
+            stationData.push_back(row.toStringList());
 
-        QFileInfo stationInfo(stationFilePath);
+        if(tableHeadings.at(0).compare("GM_file") != 0)
+            return true;
 
-        auto baseDir = stationInfo.dir().absolutePath();
+        auto i = rowIndex - 1;
 
-        // Get the data
-        for(int i = 0; i<numRows; ++i)
+        if(row.size() != tableHeadings.size())
         {
-            auto rowStringList = data[i];
+            rowErr = "The number of columns in the row " + QString::number(i) + " should be " + QString::number(tableHeadings.size());
+            return false;
+        }
 
-            if(rowStringList.size() != numCols)
-                throw "The number of columns in the row " + QString::number(i) + " should be " + QString::number(numCols);
+        bool ok;
+        auto factor = row[1].toDouble(&ok);
 
-            auto GMFile = rowStringList[0];
+        if(!ok)
+        {
+            rowErr = "Error converting the string " + row[1].toString() + " to a double";
+            return false;
+        }
 
-            bool ok;
-            auto factor = rowStringList[1].toDouble(&ok);
+        gmFiles.push_back(qMakePair(baseDir + QDir::separator() + row[0].toString() + ".json", factor));
 
-            if(!ok)
-                throw "Error converting the string " + rowStringList[1] + " to a double";
+        return true;
+    }, err);
 
-            auto GMFilePath = baseDir + QDir::separator() + GMFile + ".json";
+    // Return if there is an error or the data is empty
+    if(res != 0)
+        throw err;
 
-            this->importGroundMotionTimeHistory(GMFilePath, factor);
-        }
-    }
+    if(!rowErr.isEmpty())
+        throw rowErr;
+
+    if(csvReader.numRowsParsed() < 2)
+        throw "The file " + stationFilePath + " is empty";
 
+    for(auto&& it : gmFiles)
+        this->importGroundMotionTimeHistory(it.first, it.second, recordCache);
 }
 
 
-void GroundMotionStation::importGroundMotionTimeHistory(const QString& filePath,const double scalingFactor)
+void GroundMotionStation::importGroundMotionTimeHistory(const QString& filePath, const double scalingFactor, GroundMotionRecordCache* recordCache)
 {
+    GroundMotionTimeHistory newGM = recordCache != nullptr ? recordCache->getRecord(filePath) : parseGroundMotionTimeHistory(filePath);
+
+    newGM.setScalingFactor(scalingFactor);
+
+    groundMotionTimeHistories.push_back(std::move(newGM));
+}
+
+
+GroundMotionTimeHistory GroundMotionStation::parseGroundMotionTimeHistory(const QString& filePath)
+{
+    // Take the compact binary copy of the record if it is there and not older than the JSON
+    const QFileInfo binaryInfo(GroundMotionTimeHistory::binaryFilePath(filePath));
+
+    if(binaryInfo.exists())
+    {
+        const QFileInfo jsonInfo(filePath);
+
+        // Without the JSON the binary copy is the only source of the record, so its errors are reported
+        if(!jsonInfo.exists())
+            return GroundMotionTimeHistory::readBinary(binaryInfo.filePath());
+
+        if(binaryInfo.lastModified() >= jsonInfo.lastModified())
+        {
+            try
+            {
+                return GroundMotionTimeHistory::readBinary(binaryInfo.filePath());
+            }
+            catch(...)
+            {
+                // A binary copy with another byte order, an older version, or a size that does not match is skipped and the JSON is parsed instead
+            }
+        }
+    }
+
     QFile file(filePath);
     if (!file.open(QFile::ReadOnly | QFile::Text))
         throw "Could not open the file at: "+ filePath;
 
 
-    // place contents of file into json object
-    QString val;
-    val=file.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(val.toUtf8());
+    // place contents of file into json object, without the round trip through a QString
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
     QJsonObject jsonObj = doc.object();
 
     // close file
@@ -144,7 +191,7 @@ void GroundMotionStation::importGroundMotionTimeHistory(const QString& filePath,
     auto gmNameObj = jsonObj.value("name");
 
     if(gmNameObj.isNull())
-        throw "NUll JSON object for field 'name'";
+        throw QString("NUll JSON object for field 'name' in the file ") + filePath;
 
     QString gmName = gmNameObj.toString();
 
@@ -152,7 +199,7 @@ void GroundMotionStation::importGroundMotionTimeHistory(const QString& filePath,
     auto dTObj = jsonObj.value("dT");
 
     if(dTObj.isNull())
-        throw "NUll JSON object for field 'dT'";
+        throw QString("NUll JSON object for field 'dT' in the file ") + filePath;
 
     double dT = dTObj.toDouble();
 
@@ -227,10 +274,48 @@ void GroundMotionStation::importGroundMotionTimeHistory(const QString& filePath,
         newGM.setPeakIntensityMeasureZ(PGA_z);
     }
 
-    newGM.setScalingFactor(scalingFactor);
+    return newGM;
+}
 
-    groundMotionTimeHistories.push_back(std::move(newGM));
 
+GroundMotionTimeHistory GroundMotionRecordCache::getRecord(const QString& filePath)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = records.constFind(filePath);
+    if(it != records.constEnd())
+    {
+        auto record = it.value();
+        locker.unlock();
+
+        return record.get();
+    }
+
+    // Claim the record so that the other threads wait for it instead of parsing it again
+    std::promise<GroundMotionTimeHistory> promise;
+    auto record = promise.get_future().share();
+    records.insert(filePath, record);
+
+    locker.unlock();
+
+    try
+    {
+        promise.set_value(GroundMotionStation::parseGroundMotionTimeHistory(filePath));
+    }
+    catch(...)
+    {
+        // Any failure is handed to the threads that wait for the record, and rethrown here by get
+        promise.set_exception(std::current_exception());
+    }
+
+    return record.get();
+}
+
+
+void GroundMotionRecordCache::clear(void)
+{
+    QMutexLocker locker(&mutex);
+    records.clear();
 }
 
 QgsFeature GroundMotionStation::getStationFeature() const
@@ -42,9 +42,30 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include <qgsfeature.h>
 
+#include <QHash>
 #include <QMap>
+#include <QMutex>
 #include <QVariant>
 
+#include <future>
+
+// Thread-safe cache of the ground motion records, so that a record shared by many stations is parsed only once
+// The records are stored unscaled, each station applies its own scaling factor
+class GroundMotionRecordCache
+{
+public:
+    // Returns the record in the file, a thread asking for a record that another thread is parsing waits for it
+    // Throws a QString if the record cannot be parsed
+    GroundMotionTimeHistory getRecord(const QString& filePath);
+
+    void clear(void);
+
+private:
+    QMutex mutex;
+
+    QHash<QString, std::shared_future<GroundMotionTimeHistory>> records;
+};
+
 class GroundMotionStation
 {
 public:
@@ -55,7 +76,14 @@ public:
     double getLongitude() const;
 
     QString getStationFilePath() const;
-    void importGroundMotions(void);
+
+    // Imports the station file and its ground motion records, the records are taken from the cache if one is given
+    // Only the first maxStationDataRows rows of the station file are kept in the station data, or all of them if it is -1
+    void importGroundMotions(GroundMotionRecordCache* recordCache = nullptr, const int maxStationDataRows = -1);
+
+    // Parses a ground motion record file, throws a QString on error
+    // The binary copy of the record is read instead if it is next to the file and up to date
+    static GroundMotionTimeHistory parseGroundMotionTimeHistory(const QString& filePath);
 
     QVector<GroundMotionTimeHistory> getStationGroundMotions() const;
 
@@ -89,7 +117,7 @@ public:
 
 private:
 
-    void importGroundMotionTimeHistory(const QString& filePath, const double scalingFactor);
+    void importGroundMotionTimeHistory(const QString& filePath, const double scalingFactor, GroundMotionRecordCache* recordCache);
 
     QString stationFilePath;
 
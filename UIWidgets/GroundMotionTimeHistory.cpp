@@ -38,6 +38,47 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "GroundMotionTimeHistory.h"
 
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <cstring>
+
+namespace {
+
+// Increase when the layout of the binary record changes
+const quint32 binaryVersion = 1;
+
+const char binaryMagic[8] = {'R','2','D','G','M','T','H','\0'};
+
+// Written in the native byte order, a record from a machine with a different byte order is read from the JSON instead
+const quint32 byteOrderMark = 0x01020304;
+
+struct BinaryHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byteOrder;
+
+    double dT;
+    double peakIntensityMeasure[3];
+
+    // The number of points of the x, y, and z time histories, 0 if the direction is not in the record
+    quint32 numPoints[3];
+
+    // The size of the UTF-8 name that follows the header, the time histories start on the next 4 byte boundary
+    quint32 nameSize;
+};
+
+static_assert(sizeof(BinaryHeader) == 64, "The binary record header must not be padded");
+
+qint64 alignedSize(qint64 size)
+{
+    return (size + 3) & ~qint64(3);
+}
+
+}
+
 GroundMotionTimeHistory::GroundMotionTimeHistory(QString name) : GMName(name)
 {
     dT = 0.0;
@@ -148,3 +189,137 @@ void GroundMotionTimeHistory::setScalingFactor(double value)
 {
     scalingFactor = value;
 }
+
+
+QString GroundMotionTimeHistory::binaryFilePath(const QString& jsonFilePath)
+{
+    QFileInfo jsonInfo(jsonFilePath);
+
+    return jsonInfo.path() + "/" + jsonInfo.completeBaseName() + ".bth";
+}
+
+
+int GroundMotionTimeHistory::writeBinary(const QString& filePath, QString& err) const
+{
+    const QVector<double>* directions[3] = {&x, &y, &z};
+
+    const auto nameData = GMName.toUtf8();
+
+    BinaryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+    header.version = binaryVersion;
+    header.byteOrder = byteOrderMark;
+    header.dT = dT;
+    header.peakIntensityMeasure[0] = peakIntensityMeasureX;
+    header.peakIntensityMeasure[1] = peakIntensityMeasureY;
+    header.peakIntensityMeasure[2] = peakIntensityMeasureZ;
+    header.nameSize = nameData.size();
+
+    for(int i = 0; i<3; ++i)
+        header.numPoints[i] = directions[i]->size();
+
+    // Write to a temporary file first so that a reader never sees a partial record
+    QSaveFile file(filePath);
+
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        err = "Could not create the file " + filePath + ": " + file.errorString();
+        return -1;
+    }
+
+    static const char zeros[4] = {};
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(nameData.constData(), nameData.size());
+    file.write(zeros, alignedSize(nameData.size()) - nameData.size());
+
+    QVector<float> values;
+    for(auto&& it : directions)
+    {
+        values.resize(it->size());
+
+        for(int i = 0; i<it->size(); ++i)
+            values[i] = static_cast<float>(it->at(i));
+
+        file.write(reinterpret_cast<const char*>(values.constData()), values.size()*sizeof(float));
+    }
+
+    if(!file.commit())
+    {
+        err = "Could not write the file " + filePath + ": " + file.errorString();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+GroundMotionTimeHistory GroundMotionTimeHistory::readBinary(const QString& filePath)
+{
+    QFile file(filePath);
+
+    if(!file.open(QIODevice::ReadOnly))
+        throw "Could not open the file at: " + filePath;
+
+    const auto fileSize = file.size();
+
+    if(fileSize < static_cast<qint64>(sizeof(BinaryHeader)))
+        throw "The file " + filePath + " is not a valid binary ground motion record";
+
+    QByteArray buffer;
+    const char* data = reinterpret_cast<const char*>(file.map(0, fileSize));
+
+    if(data == nullptr)
+    {
+        // Some file systems do not support mapping, read the record into memory instead
+        buffer = file.readAll();
+        data = buffer.constData();
+
+        if(buffer.size() != fileSize)
+            throw "Could not read the file " + filePath;
+    }
+
+    BinaryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if(std::memcmp(header.magic, binaryMagic, sizeof(binaryMagic)) != 0 || header.version != binaryVersion || header.byteOrder != byteOrderMark)
+        throw "The file " + filePath + " is not a valid binary ground motion record";
+
+    qint64 offset = sizeof(header);
+
+    qint64 expectedSize = offset + alignedSize(header.nameSize);
+    for(int i = 0; i<3; ++i)
+        expectedSize += static_cast<qint64>(header.numPoints[i])*sizeof(float);
+
+    if(expectedSize != fileSize)
+        throw "The size of the file " + filePath + " does not match its header";
+
+    GroundMotionTimeHistory record(QString::fromUtf8(data + offset, header.nameSize));
+    offset += alignedSize(header.nameSize);
+
+    record.setDT(header.dT);
+    record.setPeakIntensityMeasureX(header.peakIntensityMeasure[0]);
+    record.setPeakIntensityMeasureY(header.peakIntensityMeasure[1]);
+    record.setPeakIntensityMeasureZ(header.peakIntensityMeasure[2]);
+
+    QVector<double>* directions[3] = {&record.x, &record.y, &record.z};
+
+    for(int i = 0; i<3; ++i)
+    {
+        const auto numPoints = static_cast<int>(header.numPoints[i]);
+
+        // The values start on a 4 byte boundary of the mapping, which is page aligned
+        const float* values = reinterpret_cast<const float*>(data + offset);
+
+        auto& direction = *directions[i];
+        direction.resize(numPoints);
+
+        for(int j = 0; j<numPoints; ++j)
+            direction[j] = values[j];
+
+        offset += static_cast<qint64>(numPoints)*sizeof(float);
+    }
+
+    return record;
+}
@@ -74,6 +74,16 @@ public:
     double getScalingFactor() const;
     void setScalingFactor(double value);
 
+    // Compact binary form of a record: a fixed header with the time step and the peak values, the name, then the x, y, and z time histories as float32
+    // The file is written next to the JSON record with the same name, e.g., RSN123.json and RSN123.bth
+    static QString binaryFilePath(const QString& jsonFilePath);
+
+    // The scaling factor is not stored, it belongs to the station that uses the record
+    int writeBinary(const QString& filePath, QString& err) const;
+
+    // Maps the file and reads the record from it, throws a QString on error
+    static GroundMotionTimeHistory readBinary(const QString& filePath);
+
 private:
 
     QString GMName;
@@ -65,7 +65,7 @@ HazardToAssetWidget::HazardToAssetWidget(QWidget *parent, VisualizationWidget* v
   
 
   // Buildings
-  NearestNeighbourMapping *theNNMapB = new NearestNeighbourMapping();
+  NearestNeighbourMapping *theNNMapB = new NearestNeighbourMapping(nullptr, "Buildings");
   SiteSpecifiedMapping *theSSMapB = new SiteSpecifiedMapping();
   GISBasedMapping *theGISMapB = new GISBasedMapping();
   
@@ -74,7 +74,7 @@ HazardToAssetWidget::HazardToAssetWidget(QWidget *parent, VisualizationWidget* v
   buildingWidget->addComponent(QString("GIS Specified"), QString("GISSpecifiedEvents"), theGISMapB);
   
   // Gas pipelines
-  NearestNeighbourMapping *theNNMapG = new NearestNeighbourMapping();
+  NearestNeighbourMapping *theNNMapG = new NearestNeighbourMapping(nullptr, "Gas Pipelines");
   SiteSpecifiedMapping *theSSMapG = new SiteSpecifiedMapping();
   GISBasedMapping *theGISMapG = new GISBasedMapping();
   
@@ -83,7 +83,7 @@ HazardToAssetWidget::HazardToAssetWidget(QWidget *parent, VisualizationWidget* v
   gasWidget->addComponent(QString("GIS Specified"), QString("GISSpecifiedEvents"), theGISMapG);      
   
   // Water Distribution Network
-  NearestNeighbourMapping *theNNMapWDN = new NearestNeighbourMapping();
+  NearestNeighbourMapping *theNNMapWDN = new NearestNeighbourMapping(nullptr, "Water Networks");
   SiteSpecifiedMapping *theSSMapWDN = new SiteSpecifiedMapping();
   GISBasedMapping *theGISMapWDN = new GISBasedMapping();
   
@@ -92,7 +92,7 @@ HazardToAssetWidget::HazardToAssetWidget(QWidget *parent, VisualizationWidget* v
   wdnWidget->addComponent(QString("GIS Specified"), QString("GISSpecifiedEvents"), theGISMapWDN);
   
   // Power Network
-  NearestNeighbourMapping *theNNMapPN = new NearestNeighbourMapping();
+  NearestNeighbourMapping *theNNMapPN = new NearestNeighbourMapping(nullptr, "Power Network");
   SiteSpecifiedMapping *theSSMapPN = new SiteSpecifiedMapping();
   GISBasedMapping *theGISMapPN = new GISBasedMapping();
 
@@ -101,7 +101,7 @@ HazardToAssetWidget::HazardToAssetWidget(QWidget *parent, VisualizationWidget* v
   pnWidget->addComponent(QString("GIS Specified"), QString("GISSpecifiedEvents"), theGISMapPN);
   
   // Transportation
-  NearestNeighbourMapping *theNNMapTransport = new NearestNeighbourMapping();
+  NearestNeighbourMapping *theNNMapTransport = new NearestNeighbourMapping(nullptr, "Transportation Network");
   SiteSpecifiedMapping *theSSMapTransport = new SiteSpecifiedMapping();
   GISBasedMapping *theGISMapTransport = new GISBasedMapping();
 
@@ -46,6 +46,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <Utils/ProgramOutputDialog.h>
 #include "NetworkDownloadManager.h"
 #include "ZipUtils.h"
+#include "PolygonSpatialIndex.h"
 
 #include <QDir>
 #include <QApplication>
@@ -67,6 +68,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <qgsmarkersymbol.h>
 #include <qgslinesymbol.h>
 #include <qgsgeometryengine.h>
+#include <qgsvectordataprovider.h>
+#include <qgsvectorlayer.h>
 #include <qgsproject.h>
 #include <qgsmapcanvas.h>
 
@@ -74,6 +77,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <chrono>
 #include <thread>
 #include <future>
+#include <limits>
 using namespace std::chrono;
 // Test to remove end
 
@@ -236,106 +240,48 @@ std::set<QString> HousingUnitAllocationWidget::getCountiesFromBuildingInventory(
     }
 
 
-    // Create a cache to store the counties, since many buildings can be in multiple counties
-    QVector<QgsFeature> countyVecCache;
-
-
-    // Iterate through the building features
-    auto features = assetLayer->getFeatures();
+    auto start = high_resolution_clock::now();
 
-    auto testInPolygon = [](const QgsGeometry& countyGeom, const QgsPointXY& buildCentroid, QgsGeometryEngine* polygonGeometryEngine) -> bool
-    {
+    // Index the county polygons once and then look up the centroid of every building in it
+    QVector<QgsGeometry> countyGeoms;
+    countyGeoms.reserve(countyFeatVec.size());
 
-        // Do initial bounding box check which is very fast to exclude points that are far away
-        auto bb = countyGeom.boundingBox();
+    for(auto&& county : countyFeatVec)
+        countyGeoms.push_back(county.geometry());
 
-        if(bb.contains(buildCentroid))
-        {
-            if(polygonGeometryEngine->intersects(countyGeom.constGet()))
-            {
-                return true;
-            }
-        }
+    PolygonSpatialIndex countyIndex;
+    countyIndex.build(countyGeoms);
 
-        return false;
-    };
+    QVector<QgsFeatureId> buildingIds;
+    QVector<QgsPointXY> buildingCentroids;
+    this->getAssetCentroids(buildingIds, buildingCentroids);
 
+    auto countyIndices = countyIndex.locateAll(buildingCentroids);
 
-    QgsFeature feat;
-    while (features.nextFeature(feat))
+    for(int i = 0; i<countyIndices.size(); ++i)
     {
+        const auto countyIdx = countyIndices.at(i);
 
-        auto buildGeom = feat.geometry();
-
-        auto buildCentroid = buildGeom.centroid().asPoint();
-
-        std::unique_ptr< QgsGeometryEngine > polygonGeometryEngine(QgsGeometry::createGeometryEngine(buildGeom.constGet()));
-
-        polygonGeometryEngine->prepareGeometry();
-
-        //        if(!polygonGeometryEngine->isValid())
-        //        {
-        //            emit emitStatusMsg("Error: the geometry engine is not valid for feature "+QString::number(feat.id()));
-        //            return std::set<QString>{};
-        //        }
-
-        bool found = false;
-
-        // First check the cache
-        auto countyIt = countyVecCache.constBegin();
-        while(countyIt != countyVecCache.constEnd())
+        // If not found then error
+        if(countyIdx == -1)
         {
-            auto countyGeom = countyIt->geometry();
+            emit emitErrorMsg("Error, could not find a US county for the feature" + QString::number(buildingIds.at(i)));
 
-            if(testInPolygon(countyGeom,buildCentroid,polygonGeometryEngine.get()) == true)
-            {
-
-                auto countyIDidx = countyIt->fieldNameIndex("GEOID");
-                auto countyId = countyIt->attribute(countyIDidx).toString();
-
-                res.insert(countyId);
-
-                found = true;
-                break;
-            }
-
-            countyIt++;
-        }
-
-        // Try to find it in the full county vector
-        if(!found)
-        {
-            auto countyIt = countyFeatVec.constBegin();
-            while(countyIt != countyFeatVec.constEnd())
-            {
-                auto countyGeom = countyIt->geometry();
-
-                if(testInPolygon(countyGeom,buildCentroid,polygonGeometryEngine.get()) == true)
-                {
-
-                    auto countyIDidx = countyIt->fieldNameIndex("GEOID");
-                    auto countyId = countyIt->attribute(countyIDidx).toString();
-
-                    res.insert(countyId);
-
-                    found = true;
-                    break;
-                }
-
-                countyIt++;
-            }
+            return std::set<QString>{};
         }
 
-        // If still not found then error
-        if(!found)
-        {
-            emit emitErrorMsg("Error, could not find a US county for the feature" + QString::number(feat.id()));
+        const auto& county = countyFeatVec.at(countyIdx);
 
-            return std::set<QString>{};
-        }
+        auto countyIDidx = county.fieldNameIndex("GEOID");
+        auto countyId = county.attribute(countyIDidx).toString();
 
+        res.insert(countyId);
     }
 
+    auto stop = high_resolution_clock::now();
+    auto duration = duration_cast<milliseconds>(stop - start);
+    emit emitStatusMsg("Duration finding the counties of the assets: " + QString::number(duration.count()/1000.0) + " seconds");
+
     emit emitStatusMsg("Done getting counties for the asset inventory.");
 
     return res;
@@ -798,14 +744,7 @@ int HousingUnitAllocationWidget::getParcelFeatures(void)
 
 int HousingUnitAllocationWidget::linkBuildingsAndParcels(void)
 {
-
-    // Test to remove start
     auto start = high_resolution_clock::now();
-    // Test to remove end
-
-
-    //auto buildingsMapCpy = buildingsMap;
-    //auto pacrcelsMapCpy = buildingsMap;
 
     emit emitStatusMsg("Linking buildings to parcels.");
 
@@ -815,72 +754,61 @@ int HousingUnitAllocationWidget::linkBuildingsAndParcels(void)
         return -1;
     }
 
-    auto countFound = 0;
-    auto countNotFound = 0;
-
-    //    QMapIterator<QgsFeatureId,std::shared_ptr<Building>> buildingIt(buildingsMap);
-    //    while (buildingIt.hasNext())
+    // Index the parcels once instead of testing every building against every parcel
+    QVector<std::shared_ptr<Parcel>> parcelVec;
+    QVector<QgsGeometry> parcelGeoms;
+    parcelVec.reserve(parcelsMap.size());
+    parcelGeoms.reserve(parcelsMap.size());
 
-    for(auto&& buildObj : buildingsMap)
+    for(auto&& parcel : parcelsMap)
     {
-        //        if(count == 1000)
-        //            break;
-
-        // buildingIt.next();
-        //        std::shared_ptr<Building> buildObj = buildingIt.value();
-
-        auto buildCentroidXY = buildObj->buildingCentroidXY;
-
-        // auto buildGeom = buildObj->buildingFeat.geometry();
-        //        std::unique_ptr< QgsGeometryEngine > polygonGeometryEngine(QgsGeometry::createGeometryEngine(buildGeom.constGet()));
+        parcelVec.push_back(parcel);
+        parcelGeoms.push_back(parcel->parcelFeat.geometry());
+    }
 
-        //        polygonGeometryEngine->prepareGeometry();
+    PolygonSpatialIndex parcelIndex;
+    parcelIndex.build(parcelGeoms);
 
-        //        if(!polygonGeometryEngine->isValid())
-        //        {
-        //            emit emitStatusMsg("Error: the geometry engine is not valid for feature "+QString::number(buildingIt.key()));
-        //            return -1;
-        //        }
+    QVector<std::shared_ptr<Building>> buildingVec;
+    QVector<QgsPointXY> buildingCentroids;
+    buildingVec.reserve(buildingsMap.size());
+    buildingCentroids.reserve(buildingsMap.size());
 
-        bool found = false;
+    for(auto&& buildObj : buildingsMap)
+    {
+        buildingVec.push_back(buildObj);
+        buildingCentroids.push_back(buildObj->buildingCentroidXY);
+    }
 
-        for(auto&& parcel : parcelsMap)
-        {
-            auto parcelGeom = parcel->parcelFeat.geometry();
+    // The lookups run in parallel, the links are made afterwards in building order so that the parcels list their buildings in a fixed order
+    auto parcelIndices = parcelIndex.locateAll(buildingCentroids);
 
-            // Do initial bounding box check which is very fast to exclude points that are far away
-            auto bb = parcelGeom.boundingBox();
+    auto countFound = 0;
+    auto countNotFound = 0;
 
-            if(bb.contains(buildCentroidXY))
-            {
-                //                if(polygonGeometryEngine->intersects(parcelGeom.constGet()))
-                //                {
-                // Associate the parcel with the building and vice versa
-                parcel->associatedBuildings.push_back(buildObj);
-                buildObj->associatedParcel = parcel;
-                found = true;
-                ++countFound;
-                break;
-                //                }
-            }
-        }
+    for(int i = 0; i<buildingVec.size(); ++i)
+    {
+        auto&& buildObj = buildingVec.at(i);
 
-        if(!found)
+        if(parcelIndices.at(i) == -1)
         {
             emit emitInfoMsg("Warning: could not find a parcel for building "+QString::number(buildObj->buildingFeat.id()));
             ++countNotFound;
-            // return -1;
+            continue;
         }
+
+        // Associate the parcel with the building and vice versa
+        auto&& parcel = parcelVec.at(parcelIndices.at(i));
+        parcel->associatedBuildings.push_back(buildObj);
+        buildObj->associatedParcel = parcel;
+        ++countFound;
     }
 
-    emit emitStatusMsg("Done linking buildings to parcels.");
+    emit emitStatusMsg("Done linking buildings to parcels, "+QString::number(countFound)+" linked and "+QString::number(countNotFound)+" without a parcel.");
 
-    // Test to remove start
     auto stop = high_resolution_clock::now();
     auto duration = duration_cast<milliseconds>(stop - start);
     emit emitStatusMsg("Duration linking buildings to parcels: " + QString::number(duration.count()/1000.0) + " seconds");
-    // Test to remove end
-
 
     return 0;
 }
@@ -901,7 +829,7 @@ int HousingUnitAllocationWidget::extractCensusData(void)
 
     QString errMsg;
 
-    auto res = theVisualizationWidget->joinLayers(censusBlockLayer,assetLayer,"CENSUSLAYER_",errMsg);
+    auto res = this->joinPolygonLayer(censusBlockLayer,"CENSUSLAYER_",errMsg);
     if(res != 0)
         emit emitErrorMsg(errMsg);
 
@@ -926,7 +854,7 @@ int HousingUnitAllocationWidget::extractACSData(void)
 
     QString errMsg;
 
-    auto res = theVisualizationWidget->joinLayers(ACSBlockGroupLayer,assetLayer,"ACSLAYER_",errMsg);
+    auto res = this->joinPolygonLayer(ACSBlockGroupLayer,"ACSLAYER_",errMsg);
     if(res != 0)
         emit emitErrorMsg(errMsg);
 
@@ -936,6 +864,144 @@ int HousingUnitAllocationWidget::extractACSData(void)
 }
 
 
+void HousingUnitAllocationWidget::getAssetCentroids(QVector<QgsFeatureId>& ids, QVector<QgsPointXY>& centroids)
+{
+    ids.clear();
+    centroids.clear();
+
+    ids.reserve(assetLayer->featureCount());
+    centroids.reserve(assetLayer->featureCount());
+
+    auto features = assetLayer->getFeatures(QgsFeatureRequest().setNoAttributes());
+
+    QgsFeature feat;
+    while (features.nextFeature(feat))
+    {
+        ids.push_back(feat.id());
+
+        // An asset without a geometry gets a point that is not inside of any polygon
+        auto geom = feat.geometry();
+        if(geom.isNull())
+            centroids.push_back(QgsPointXY(std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()));
+        else
+            centroids.push_back(geom.centroid().asPoint());
+    }
+}
+
+
+int HousingUnitAllocationWidget::joinPolygonLayer(QgsVectorLayer* joinLayer, const QString& prefix, QString& err)
+{
+    auto start = high_resolution_clock::now();
+
+    // Get the polygons in the crs of the assets
+    QVector<QgsFeature> joinFeatVec;
+    QVector<QgsGeometry> joinGeoms;
+
+    joinFeatVec.reserve(joinLayer->featureCount());
+    joinGeoms.reserve(joinLayer->featureCount());
+
+    const bool needsTransform = joinLayer->crs() != assetLayer->crs();
+    QgsCoordinateTransform coordTrans(joinLayer->crs(), assetLayer->crs(), QgsProject::instance());
+
+    auto joinFeatures = joinLayer->getFeatures();
+
+    QgsFeature joinFeat;
+    while (joinFeatures.nextFeature(joinFeat))
+    {
+        auto geom = joinFeat.geometry();
+
+        if(needsTransform && !geom.isNull())
+        {
+            if(geom.transform(coordTrans) != 0)
+            {
+                err = "Error transforming the geometry of feature "+QString::number(joinFeat.id())+" in the layer "+joinLayer->name();
+                return -1;
+            }
+        }
+
+        joinFeatVec.push_back(joinFeat);
+        joinGeoms.push_back(geom);
+    }
+
+    PolygonSpatialIndex joinIndex;
+    joinIndex.build(joinGeoms);
+
+    QVector<QgsFeatureId> assetIds;
+    QVector<QgsPointXY> assetCentroids;
+    this->getAssetCentroids(assetIds, assetCentroids);
+
+    auto joinIndices = joinIndex.locateAll(assetCentroids);
+
+    // Add the fields of the joined layer to the assets, reusing the fields left over from an earlier join
+    auto joinFields = joinLayer->fields();
+
+    QList<QgsField> newFields;
+    for(int i = 0; i<joinFields.size(); ++i)
+    {
+        QgsField field = joinFields.at(i);
+        field.setName(prefix+field.name());
+
+        if(assetLayer->fields().indexOf(field.name()) == -1)
+            newFields.append(field);
+    }
+
+    auto assetProvider = assetLayer->dataProvider();
+
+    if(!newFields.isEmpty())
+    {
+        if(!assetProvider->addAttributes(newFields))
+        {
+            err = "Error adding the fields of the layer "+joinLayer->name()+" to the assets";
+            return -1;
+        }
+
+        assetLayer->updateFields();
+    }
+
+    QVector<int> assetFieldIndices(joinFields.size());
+    for(int i = 0; i<joinFields.size(); ++i)
+        assetFieldIndices[i] = assetLayer->fields().indexOf(prefix+joinFields.at(i).name());
+
+    QgsChangedAttributesMap changedAttributes;
+
+    auto countNotFound = 0;
+
+    for(int i = 0; i<assetIds.size(); ++i)
+    {
+        const auto joinIdx = joinIndices.at(i);
+
+        if(joinIdx == -1)
+        {
+            ++countNotFound;
+            continue;
+        }
+
+        const auto& joinedFeat = joinFeatVec.at(joinIdx);
+
+        QgsAttributeMap attributes;
+        for(int j = 0; j<assetFieldIndices.size(); ++j)
+            attributes.insert(assetFieldIndices.at(j), joinedFeat.attribute(j));
+
+        changedAttributes.insert(assetIds.at(i), attributes);
+    }
+
+    if(!assetProvider->changeAttributeValues(changedAttributes))
+    {
+        err = "Error setting the values joined from the layer "+joinLayer->name();
+        return -1;
+    }
+
+    if(countNotFound != 0)
+        emit emitInfoMsg("Warning: "+QString::number(countNotFound)+" assets are not inside of a feature in the layer "+joinLayer->name());
+
+    auto stop = high_resolution_clock::now();
+    auto duration = duration_cast<milliseconds>(stop - start);
+    emit emitStatusMsg("Duration joining the layer "+joinLayer->name()+" to the assets: " + QString::number(duration.count()/1000.0) + " seconds");
+
+    return 0;
+}
+
+
 void HousingUnitAllocationWidget::clear()
 {
     Layermap.clear();
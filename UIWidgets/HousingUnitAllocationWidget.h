@@ -253,6 +253,12 @@ private:
     int extractCensusData(void);
     int extractACSData(void);
 
+    // Spatial join that copies the attributes of the polygon containing each asset into the asset layer, with the field names prefixed
+    int joinPolygonLayer(QgsVectorLayer* joinLayer, const QString& prefix, QString& err);
+
+    // Ids and centroids of the assets, in the crs of the asset layer
+    void getAssetCentroids(QVector<QgsFeatureId>& ids, QVector<QgsPointXY>& centroids);
+
     QProcess* process = nullptr;
 
     QgsProjectionSelectionWidget* mCensusCrsSelector = nullptr;
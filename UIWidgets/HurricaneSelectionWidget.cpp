@@ -43,10 +43,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "HurricaneParameterWidget.h"
 #include "SimCenterPreferences.h"
 #include "SiteConfig.h"
-#include "GridNode.h"
 #include "NodeHandle.h"
 #include "LayerTreeItem.h"
 #include "CSVReaderWriter.h"
+#include "ConcurrentTasks.h"
 #include "Utils/ProgramOutputDialog.h"
 
 //Test
@@ -72,6 +72,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStackedWidget>
 #include <QVBoxLayout>
 #include <QDir>
+#include <QSet>
 
 #include "SimCenterMapcanvasWidget.h"
 #include "RectangleGrid.h"
@@ -1014,12 +1015,11 @@ int HurricaneSelectionWidget::loadResults(const QString& outputDir)
 
     auto numRows = data.size();
 
-    QgsFeatureList featList;
-    featList.reserve(numRows);
-    // Get the data
+    // Resolve the stations first, the map cannot be touched from the worker threads
+    QVector<WindFieldStation*> stations(numRows, nullptr);
+    QSet<QString> stationNames;
     for(int i = 0; i<numRows; ++i)
     {
-
         auto vecValues = data.at(i);
 
         if(vecValues.size() != 3)
@@ -1035,73 +1035,94 @@ int HurricaneSelectionWidget::loadResults(const QString& outputDir)
         // Find the station in the map
         auto station = stationMap.find(stationName);
 
-        if(station->isNull())
+        if(station == stationMap.end() || station->isNull())
         {
-            this->errorMessage("Error, could not find the station in the map");
+            this->errorMessage("Error, could not find the station " + stationName + " in the map");
             return -1;
         }
 
-        station->setStationFilePath(stationPath);
-
-        try {
-            station->importWindFieldStation();
-        } catch (const QString& err) {
-            this->errorMessage(err);
+        // Every station is decoded by a single worker
+        if(stationNames.contains(stationName))
+        {
+            this->errorMessage("Error, the station " + stationName + " is listed more than once in the file " + resultsPath);
             return -1;
         }
 
-        auto pws = station->getStationData();
+        stationNames.insert(stationName);
 
-        if(pws.empty())
-        {
-            this->errorMessage("Error getting the peak wind speeds from the results");
-            return -1;
-        }
+        station->setStationFilePath(stationPath);
 
-        auto headings =  station->getStationDataHeaders();
+        stations[i] = &station.value();
+    }
 
-        auto idxPWS = headings.indexOf("PWS");
+    // Decode the station files in parallel, every station only writes to its own slot
+    WindFieldStation** stationsData = stations.data();
 
-        if(idxPWS == -1)
-        {
-            this->errorMessage("Error, PWS index not found in headers");
-            return -1;
-        }
+    auto importStation = [stationsData](const int i, QString& err)
+    {
+        auto station = stationsData[i];
 
-        QString pwsStr;
+        station->importWindFieldStation();
 
-        for(int i = 0; i<pws.size()-1; ++i)
-        {
-            pwsStr += pws[i].at(idxPWS) + ", ";
-        }
+        if(station->getPeakWindSpeeds().isEmpty())
+            err = "Error, PWS index not found in headers of the file " + station->getStationFilePath();
+    };
+
+    if(progressBar != nullptr)
+    {
+        progressBar->setRange(0, numRows);
+        progressBar->setValue(0);
+    }
+
+    std::function<void(int)> showProgress;
+    if(progressBar != nullptr)
+        showProgress = [this](int value) { progressBar->setValue(value); };
+
+    // Report the first error in the order of the grid file
+    auto importErr = ConcurrentTasks::map(numRows, importStation, showProgress);
 
-        pwsStr += pws.back().at(idxPWS);
+    if(!importErr.isEmpty())
+    {
+        this->errorMessage(importErr);
+        return -1;
+    }
 
-        QString attribute = "Peak Wind Speeds";
+    QgsFeatureList featList;
+    featList.reserve(numRows);
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        auto station = stations.at(i);
 
         auto feat = station->getStationFeature();
 
         if(!feat.isValid())
         {
             this->errorMessage("Feature is not valid");
+            return -1;
         }
 
-        auto atrb = feat.attribute(attribute);
+        auto idxPWS = station->getStationDataHeaders().indexOf("PWS");
 
-        if(!atrb.isValid())
-        {
-            this->errorMessage("Could not find attribute in feature");
-        }
+        auto res = feat.setAttribute("Peak Wind Speeds", station->getColumnStrings().at(idxPWS));
+        res = res && feat.setAttribute("Max Peak Wind Speed", station->getMaxPeakWindSpeed());
+        res = res && feat.setAttribute("Mean Peak Wind Speed", station->getMeanPeakWindSpeed());
 
-        auto res = feat.setAttribute(attribute,pwsStr);
         if(res == false)
         {
             this->errorMessage("Failed to update feature");
+            return -1;
         }
+
         featList.push_back(feat);
     }
 
-    this->updateGridLayerFeatures(featList);
+    // Replace the grid in a single batch
+    if(this->updateGridLayerFeatures(featList) != 0)
+    {
+        this->errorMessage("Failed to update the features of the grid layer");
+        return -1;
+    }
 
     emit outputDirectoryPathChanged(outputDir, resultsPath);
 
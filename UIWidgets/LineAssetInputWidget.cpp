@@ -112,71 +112,63 @@ int LineAssetInputWidget::loadAssetVisualization(void)
 
     filterDelegateWidget  = new AssetFilterDelegate(mainLayer);
 
-    // Get the number of rows
-    auto nRows = componentTableWidget->rowCount();
-
     auto numAtrb = attribFields.size();
 
-    for(int i = 0; i<nRows; ++i)
-    {
+    // Read the coordinates straight from the typed table columns
+    const auto& tableStore = componentTableWidget->getTableModel()->getTableStore();
+
+    const auto latitudesStart = tableStore.columnToDoubles(indexLatStart, 0.0);
+    const auto longitudesStart = tableStore.columnToDoubles(indexLonStart, 0.0);
+    const auto latitudesEnd = tableStore.columnToDoubles(indexLatEnd, 0.0);
+    const auto longitudesEnd = tableStore.columnToDoubles(indexLonEnd, 0.0);
+
+    const auto numCols = tableStore.columnCount();
+
+    const auto assetTypeAttrib = QString(assetType).remove(" ");
 
+    // The features are built on the worker threads in chunks, the builder only reads from the table
+    auto featureRes = this->loadFeaturesInChunks(mainLayer, [&](const int i, QgsFeature& feature, QString& err)
+    {
         // create the feature attributes
         QgsAttributes featureAttributes(numAtrb);
 
         // Create a new pipeline
-        QString pipelineIDStr = componentTableWidget->item(i,0).toString();
-
-        int pipelineID =  pipelineIDStr.toInt();
-
-        // Create a unique ID for the building
-//        auto uid = theVisualizationWidget->createUniqueID();
+        int pipelineID = static_cast<int>(tableStore.toLongLong(i,0));
 
         // "ID"
         // "AssetType"
         // "Tabname"
 
         featureAttributes[0] = QVariant(pipelineID);
-        featureAttributes[1] = QVariant(QString(assetType).remove(" "));
+        featureAttributes[1] = QVariant(assetTypeAttrib);
         featureAttributes[2] = QVariant("ID: "+QString::number(pipelineID));
 
-        // The feature attributes are the columns from the table
-        for(int j = 1; j<componentTableWidget->columnCount(); ++j)
-        {
-            auto attrbVal = componentTableWidget->item(i,j);
-            featureAttributes[2+j] = attrbVal;
-        }
+        // The feature attributes are the columns from the table, read directly from the store to skip the model lookups
+        for(int j = 1; j<numCols; ++j)
+            featureAttributes[2+j] = tableStore.text(i,j);
 
-        QgsFeature feature;
         feature.setFields(featFields);
 
-        auto latitudeStart = componentTableWidget->item(i,indexLatStart).toDouble();
-        auto longitudeStart = componentTableWidget->item(i,indexLonStart).toDouble();
-
-        auto latitudeEnd = componentTableWidget->item(i,indexLatEnd).toDouble();
-        auto longitudeEnd = componentTableWidget->item(i,indexLonEnd).toDouble();
-
         // Start and end point of the pipe
-        QgsPointXY point1(longitudeStart,latitudeStart);
-        QgsPointXY point2(longitudeEnd,latitudeEnd);
-
         QgsPolylineXY pipeSegment(2);
-        pipeSegment[0]=point1;
-        pipeSegment[1]=point2;
+        pipeSegment[0] = QgsPointXY(longitudesStart[i],latitudesStart[i]);
+        pipeSegment[1] = QgsPointXY(longitudesEnd[i],latitudesEnd[i]);
 
         feature.setGeometry(QgsGeometry::fromPolylineXY(pipeSegment));
 
         feature.setAttributes(featureAttributes);
 
         if(!feature.isValid())
-            return -1;
-
-        auto res = pr->addFeature(feature, QgsFeatureSink::FastInsert);
-        if(!res)
         {
-            this->errorMessage("Error adding the feature to the layer");
+            err = "Error creating the feature of the pipeline " + QString::number(pipelineID);
             return -1;
         }
-    }
+
+        return 0;
+    });
+
+    if(featureRes != 0)
+        return -1;
 
     mainLayer->commitChanges(true);
     mainLayer->updateExtents();
@@ -38,18 +38,30 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "NearestNeighbourMapping.h"
 #include "SimCenterPreferences.h"
+#include "ComponentDatabaseManager.h"
 
 #include <QComboBox>
 #include <QDebug>
 #include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QIntValidator>
 #include <QJsonObject>
 #include <QLabel>
 #include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrent>
 
-NearestNeighbourMapping::NearestNeighbourMapping(QWidget *parent) : SimCenterAppWidget(parent)
+#include <qgscoordinatetransform.h>
+#include <qgsexception.h>
+#include <qgsgeometry.h>
+#include <qgsproject.h>
+
+NearestNeighbourMapping::NearestNeighbourMapping(QWidget *parent, const QString& assetType) : SimCenterAppWidget(parent), assetType(assetType)
 {
     QGridLayout* regionalMapLayout = new QGridLayout(this);
 
@@ -82,14 +94,44 @@ NearestNeighbourMapping::NearestNeighbourMapping(QWidget *parent) : SimCenterApp
     regionalMapLayout->addWidget(new QLabel("Seed"), 2, 0);
     regionalMapLayout->addWidget(randomSeed, 2, 1);
 
-    regionalMapLayout->setRowStretch(3,1);
+    // The mapping normally runs in the workflow, the preview runs it here on the assets that are loaded
+    if(!assetType.isEmpty())
+    {
+        previewButton = new QPushButton("Preview Mapping");
+        previewButton->setToolTip("Map the events of an event grid onto the loaded assets with the settings above and save the sampled events to a CSV file");
+        connect(previewButton,&QPushButton::clicked,this,&NearestNeighbourMapping::handlePreviewMapping);
+
+        previewProgressBar = new QProgressBar();
+        previewProgressBar->hide();
+
+        cancelPreviewButton = new QPushButton(tr("Cancel"));
+        cancelPreviewButton->hide();
+        connect(cancelPreviewButton,&QPushButton::clicked,this,&NearestNeighbourMapping::handleCancelPreview);
+
+        previewProgressTimer = new QTimer(this);
+        previewProgressTimer->setInterval(100);
+        connect(previewProgressTimer,&QTimer::timeout,this,&NearestNeighbourMapping::updatePreviewProgress);
+
+        connect(&previewWatcher,&QFutureWatcher<QString>::finished,this,&NearestNeighbourMapping::handlePreviewFinished);
+
+        regionalMapLayout->addWidget(previewButton, 3, 0, 1, 2);
+        regionalMapLayout->addWidget(previewProgressBar, 4, 0);
+        regionalMapLayout->addWidget(cancelPreviewButton, 4, 1);
+    }
+
+    regionalMapLayout->setRowStretch(5,1);
     
 }
 
 
 NearestNeighbourMapping::~NearestNeighbourMapping()
 {
-
+    // The preview uses the mapper until it returns
+    if(previewMapper != nullptr)
+    {
+        previewMapper->cancel();
+        previewWatcher.waitForFinished();
+    }
 }
 
 
@@ -149,3 +191,155 @@ bool NearestNeighbourMapping::copyFiles(QString &destName)
   return true;
 }
 
+
+int NearestNeighbourMapping::getAssetLocations(QVector<NearestNeighbourEventMapper::Asset>& assets, QString& err) const
+{
+    auto theAssetDb = ComponentDatabaseManager::getInstance()->getAssetDb(assetType);
+
+    if(theAssetDb == nullptr || theAssetDb->getMainLayer() == nullptr)
+    {
+        err = "Load the " + assetType + " assets before previewing the mapping";
+        return -1;
+    }
+
+    auto assetLayer = theAssetDb->getSelectedLayer();
+
+    if(assetLayer == nullptr || assetLayer->featureCount() == 0)
+        assetLayer = theAssetDb->getMainLayer();
+
+    const auto indexID = assetLayer->fields().lookupField("ID");
+
+    // The grid points are at their longitude and latitude
+    QgsCoordinateTransform transform(assetLayer->crs(), QgsCoordinateReferenceSystem("EPSG:4326"), QgsProject::instance());
+
+    assets.clear();
+    assets.reserve(static_cast<int>(assetLayer->featureCount()));
+
+    QgsFeature feature;
+    auto featIt = assetLayer->getFeatures();
+    while(featIt.nextFeature(feature))
+    {
+        // Line and polygon assets are mapped at their centroid
+        auto point = feature.geometry().centroid().asPoint();
+
+        try
+        {
+            point = transform.transform(point);
+        }
+        catch(QgsCsException& e)
+        {
+            err = "Could not transform the location of the asset " + QString::number(feature.id()) + " to longitude and latitude: " + e.what();
+            return -1;
+        }
+
+        NearestNeighbourEventMapper::Asset asset;
+        asset.id = indexID == -1 ? QString::number(feature.id()) : feature.attribute(indexID).toString();
+        asset.longitude = point.x();
+        asset.latitude = point.y();
+
+        assets.push_back(asset);
+    }
+
+    if(assets.isEmpty())
+    {
+        err = "There are no " + assetType + " assets to map";
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void NearestNeighbourMapping::handlePreviewMapping(void)
+{
+    if(previewMapper != nullptr)
+        return;
+
+    QString err;
+
+    QVector<NearestNeighbourEventMapper::Asset> assets;
+    if(this->getAssetLocations(assets, err) != 0)
+    {
+        this->errorMessage(err);
+        return;
+    }
+
+    auto pathToEventGrid = QFileDialog::getOpenFileName(this, tr("Event Grid File"), QString(), tr("Event grid (EventGrid.csv);;CSV files (*.csv)"));
+    if(pathToEventGrid.isEmpty())
+        return;
+
+    auto pathToTable = QFileDialog::getSaveFileName(this, tr("Save the Mapped Events"), QFileInfo(pathToEventGrid).absolutePath() + QDir::separator() + "MappedEvents.csv", tr("CSV files (*.csv)"));
+    if(pathToTable.isEmpty())
+        return;
+
+    const auto numSamples = samplesLineEdit->text().toInt();
+    const auto numNeighbours = neighborsLineEdit->text().toInt();
+    const auto seed = randomSeed->text().toInt();
+
+    numPreviewAssets = assets.size();
+    previewTable = pathToTable;
+    previewMapper = std::make_shared<NearestNeighbourEventMapper>();
+
+    this->statusMessage("Mapping the events onto " + QString::number(numPreviewAssets) + " assets");
+
+    previewButton->setEnabled(false);
+    previewProgressBar->setRange(0, numPreviewAssets);
+    previewProgressBar->setValue(0);
+    previewProgressBar->show();
+    cancelPreviewButton->setEnabled(true);
+    cancelPreviewButton->show();
+    previewProgressTimer->start();
+
+    auto mapper = previewMapper;
+
+    previewWatcher.setFuture(QtConcurrent::run([mapper, assets, pathToEventGrid, pathToTable, numNeighbours, numSamples, seed]()
+    {
+        QString err;
+
+        if(mapper->loadEventGrid(pathToEventGrid, err) != 0)
+            return err;
+
+        if(mapper->mapAssets(assets, numNeighbours, numSamples, seed, err) != 0)
+            return err;
+
+        if(mapper->writeAssetEventsTable(assets, pathToTable, err) != 0)
+            return err;
+
+        return QString();
+    }));
+}
+
+
+void NearestNeighbourMapping::handleCancelPreview(void)
+{
+    if(previewMapper == nullptr)
+        return;
+
+    previewMapper->cancel();
+    cancelPreviewButton->setEnabled(false);
+}
+
+
+void NearestNeighbourMapping::updatePreviewProgress(void)
+{
+    if(previewMapper != nullptr)
+        previewProgressBar->setValue(previewMapper->getNumMapped());
+}
+
+
+void NearestNeighbourMapping::handlePreviewFinished(void)
+{
+    previewProgressTimer->stop();
+    previewProgressBar->hide();
+    cancelPreviewButton->hide();
+    previewButton->setEnabled(true);
+
+    auto err = previewWatcher.result();
+
+    if(err.isEmpty())
+        this->statusMessage("Mapped " + QString::number(previewMapper->numGridPoints()) + " grid points onto " + QString::number(numPreviewAssets) + " assets, the events are in " + previewTable);
+    else
+        this->errorMessage(err);
+
+    previewMapper.reset();
+}
@@ -40,14 +40,24 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include <SimCenterAppWidget.h>
 
+#include "NearestNeighbourEventMapper.h"
+
+#include <QFutureWatcher>
+
+#include <memory>
+
 class QLineEdit;
+class QProgressBar;
+class QPushButton;
+class QTimer;
 
 class NearestNeighbourMapping : public SimCenterAppWidget
 {
     Q_OBJECT
 
 public:
-    explicit NearestNeighbourMapping(QWidget *parent = nullptr);
+    // The asset type is the name of the component database whose assets the mapping can be previewed on, e.g., "Buildings"
+    explicit NearestNeighbourMapping(QWidget *parent = nullptr, const QString& assetType = QString());
     ~NearestNeighbourMapping();
 
     bool outputAppDataToJSON(QJsonObject &jsonObject);
@@ -58,7 +68,33 @@ public:
 
 signals:
 
+private slots:
+
+    // Previews the mapping on the loaded assets, the event grid and the output table are chosen by the user
+    // The mapping runs on the thread pool, the widget shows its progress and can cancel it
+    void handlePreviewMapping(void);
+    void handleCancelPreview(void);
+    void handlePreviewFinished(void);
+    void updatePreviewProgress(void);
+
 private:
+
+    // The selected assets of the asset type, or all of them if none are selected, at their longitude and latitude
+    int getAssetLocations(QVector<NearestNeighbourEventMapper::Asset>& assets, QString& err) const;
+
+    QString assetType;
+
+    QPushButton* previewButton = nullptr;
+    QPushButton* cancelPreviewButton = nullptr;
+    QProgressBar* previewProgressBar = nullptr;
+    QTimer* previewProgressTimer = nullptr;
+
+    // The mapping of a running preview, the future gives the error message or an empty string
+    std::shared_ptr<NearestNeighbourEventMapper> previewMapper;
+    QFutureWatcher<QString> previewWatcher;
+    QString previewTable;
+    int numPreviewAssets = 0;
+
     QLineEdit *samplesLineEdit;
     QLineEdit *neighborsLineEdit;
     QLineEdit *randomSeed;
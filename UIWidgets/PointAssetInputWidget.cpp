@@ -39,6 +39,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "PointAssetInputWidget.h"
 #include "QGISVisualizationWidget.h"
 #include "ComponentTableView.h"
+#include "ComponentTableModel.h"
 #include "AssetFilterDelegate.h"
 
 #include <QDir>
@@ -88,9 +89,6 @@ int PointAssetInputWidget::loadAssetVisualization()
         return -1;
     }
 
-    // Get the number of rows
-    auto nRows = componentTableWidget->rowCount();
-
     QString layerType;
 
     if(indexFootprint != -1)
@@ -124,18 +122,22 @@ int PointAssetInputWidget::loadAssetVisualization()
 
     auto numAtrb = attribFields.size();
 
-    for(int i = 0; i<nRows; ++i)
+    // Read the coordinates straight from the typed table columns
+    const auto& tableStore = componentTableWidget->getTableModel()->getTableStore();
+
+    const auto latitudes = tableStore.columnToDoubles(indexLatitude, 0.0);
+    const auto longitudes = tableStore.columnToDoubles(indexLongitude, 0.0);
+
+    const auto numCols = tableStore.columnCount();
+
+    // The features are built on the worker threads in chunks, the builder only reads from the table
+    auto featureRes = this->loadFeaturesInChunks(mainLayer, [&](const int i, QgsFeature& feature, QString& err)
     {
         // create the feature attributes
         QgsAttributes featureAttributes(numAtrb);
 
         // Create a new asset
-        QString assetIDStr = componentTableWidget->item(i,0).toString();
-
-        int assetID = assetIDStr.toInt();
-
-        // Create a unique ID for the asset
-//        auto uid = theVisualizationWidget->createUniqueID();
+        int assetID = static_cast<int>(tableStore.toLongLong(i,0));
 
         //  "ID"
         //  "AssetType"
@@ -145,23 +147,19 @@ int PointAssetInputWidget::loadAssetVisualization()
         featureAttributes[1] = QVariant(assetType);
         featureAttributes[2] = QVariant(assetID);
 
-        // The feature attributes are the columns from the table
-        for(int j = 1; j<componentTableWidget->columnCount(); ++j)
-        {
-            auto attrbVal = componentTableWidget->item(i,j);
-            featureAttributes[2+j] = attrbVal;
-        }
+        // The feature attributes are the columns from the table, read directly from the store to skip the model lookups
+        for(int j = 1; j<numCols; ++j)
+            featureAttributes[2+j] = tableStore.text(i,j);
 
-        auto latitude = componentTableWidget->item(i,indexLatitude).toDouble();
-        auto longitude = componentTableWidget->item(i,indexLongitude).toDouble();
+        auto latitude = latitudes[i];
+        auto longitude = longitudes[i];
 
-        QgsFeature feature;
         feature.setFields(featFields);
 
         // If a footprint is given use that
         if(indexFootprint != -1)
         {
-            QString footprint = componentTableWidget->item(i,indexFootprint).toString();
+            QString footprint = tableStore.text(i,indexFootprint);
 
             if(footprint.compare("NA") == 0)
             {
@@ -172,7 +170,7 @@ int PointAssetInputWidget::loadAssetVisualization()
                 auto geom = theVisualizationWidget->getPolygonGeometryFromJson(footprint);
                 if(geom.isEmpty())
                 {
-                    this->errorMessage("Error getting the asset footprint geometry");
+                    err = "Error getting the asset footprint geometry";
                     return -1;
                 }
 
@@ -181,11 +179,10 @@ int PointAssetInputWidget::loadAssetVisualization()
         }
         else
         {
-            QgsPointXY(longitude,latitude);
             auto geom = QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude));
             if(geom.isEmpty())
             {
-                this->errorMessage("Error getting the asset footprint geometry");
+                err = "Error getting the asset footprint geometry";
                 return -1;
             }
 
@@ -195,20 +192,16 @@ int PointAssetInputWidget::loadAssetVisualization()
         feature.setAttributes(featureAttributes);
 
         if(!feature.isValid())
-            return -1;
-
-
-        auto res = pr->addFeature(feature, QgsFeatureSink::FastInsert);
-        if(!res)
         {
-            this->errorMessage("Error adding the feature to the layer");
+            err = "Error creating the feature of the asset " + QString::number(assetID);
             return -1;
         }
 
-        //        auto id = feature.id();
+        return 0;
+    });
 
-        //        qDebug()<<id;
-    }
+    if(featureRes != 0)
+        return -1;
 
     mainLayer->commitChanges(true);
     mainLayer->updateExtents();
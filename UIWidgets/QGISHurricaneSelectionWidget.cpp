@@ -42,7 +42,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "HurricaneParameterWidget.h"
 
 #include "NodeHandle.h"
-#include "GridNode.h"
 #include "RectangleGrid.h"
 
 #include <QPushButton>
@@ -151,12 +150,12 @@ void QGISHurricaneSelectionWidget::handleHurricaneSelect(void)
 
 
     // Get the selected hurricane from the preprocessor
-    auto importedHurricane = hurricaneImportTool->getHurricane(hurricaneSID);
+    QString err;
+    auto importedHurricane = hurricaneImportTool->getHurricane(hurricaneSID, err);
 
     if(importedHurricane == nullptr)
     {
-        QString err = "Could not find the hurricane with the SID " + hurricaneSID;
-        qDebug()<<err;
+        this->errorMessage(err);
         return;
     }
 
@@ -281,9 +280,9 @@ void QGISHurricaneSelectionWidget::handleGridSelected(void)
         return;
 
     // Get the vector of grid nodes
-    auto gridNodeVec = userGrid->getGridNodeVec();
+    auto gridPoints = userGrid->getGridPoints();
 
-    if(gridNodeVec.isEmpty())
+    if(gridPoints.isEmpty())
         return;
 
     auto mapCanvas = mapViewSubWidget->mapCanvas();
@@ -296,6 +295,8 @@ void QGISHurricaneSelectionWidget::handleGridSelected(void)
     featFields.append(QgsField("Latitude", QVariant::Double));
     featFields.append(QgsField("Longitude", QVariant::Double));
     featFields.append(QgsField("Peak Wind Speeds", QVariant::String));
+    featFields.append(QgsField("Max Peak Wind Speed", QVariant::Double));
+    featFields.append(QgsField("Mean Peak Wind Speed", QVariant::Double));
 
     QList<QgsField> attribFields;
     for(int i = 0; i<featFields.size(); ++i)
@@ -306,14 +307,12 @@ void QGISHurricaneSelectionWidget::handleGridSelected(void)
     QStringList headerRow = {"GP_file", "Latitude", "Longitude"};
     gridData.push_back(headerRow);
 
-    for(int i = 0; i<gridNodeVec.size(); ++i)
+    for(int i = 0; i<gridPoints.size(); ++i)
     {
-        auto gridNode = gridNodeVec.at(i);
-
         // The station id
         auto stationName = QString::number(i+1);
 
-        auto screenPoint = gridNode->getPoint();
+        auto screenPoint = gridPoints.at(i);
 
         // The latitude and longitude
         auto longitude = theVisualizationWidget->getLongFromScreenPoint(screenPoint,mapCanvas);
@@ -330,6 +329,8 @@ void QGISHurricaneSelectionWidget::handleGridSelected(void)
         featAttributes[3] = latitude; // Latitude
         featAttributes[4] = longitude; // Longitude
         featAttributes[5] = "N/A"; // Peak Wind Speeds
+        featAttributes[6] = QVariant(QVariant::Double); // Max Peak Wind Speed, set when the results are loaded
+        featAttributes[7] = QVariant(QVariant::Double); // Mean Peak Wind Speed
 
         // Create the point and add it to the feature table
         // Create the point and add it to the feature table
@@ -570,7 +571,7 @@ int QGISHurricaneSelectionWidget::updateGridLayerFeatures(QgsFeatureList& featLi
     if(!res)
         return -1;
 
-    res = gridLayer->dataProvider()->addFeatures(featList);
+    res = gridLayer->dataProvider()->addFeatures(featList, QgsFeatureSink::FastInsert);
 
     if(!res)
         return -1;
@@ -322,6 +322,8 @@ void RasterHazardInputWidget::clear(void)
 
     //unitsWidget->clear();
     theIMs->clear();    
+
+    rasterSampler.reset();
 }
 
 
@@ -360,6 +362,30 @@ double RasterHazardInputWidget::sampleRaster(const double& x, const double& y, c
 }
 
 
+int RasterHazardInputWidget::sampleRaster(const QVector<double>& x, const QVector<double>& y, const QVector<int>& bands, QVector<double>& values, QBitArray& missed, const RasterBlockSampler::Interpolation interpolation)
+{
+    if(rasterSampler == nullptr)
+    {
+        this->errorMessage("Error, attempting to sample a raster layer that has not been loaded");
+        return -1;
+    }
+
+    QString err;
+    if(rasterSampler->sample(x, y, bands, interpolation, values, missed, err) != 0)
+    {
+        this->errorMessage(err);
+        return -1;
+    }
+
+    // One warning for the whole batch instead of one per point
+    auto numMissed = missed.count(true);
+    if(numMissed != 0)
+        this->infoMessage("Warning, "+QString::number(numMissed)+" of "+QString::number(x.size())+" points could not be sampled from the raster, they may be out of bounds or on a no data pixel");
+
+    return 0;
+}
+
+
 int RasterHazardInputWidget::loadRaster(void)
 {
     this->statusMessage("Loading Raster Hazard Layer");
@@ -415,17 +441,24 @@ int RasterHazardInputWidget::loadRaster(void)
 
     dataProvider = rasterlayer->dataProvider();
 
+    rasterSampler = std::make_unique<RasterBlockSampler>(dataProvider);
+
     theVisualizationWidget->zoomToLayer(rasterlayer);
 
     //    // Test to remove start
     //    auto start = high_resolution_clock::now();
     //    // Test to remove end
 
+    //    QVector<double> xs(1000000), ys(1000000);
     //    for(int i = 0; i<1000000; ++i)
     //    {
     //        auto rnd = static_cast<double>(std::rand()/((RAND_MAX + 1u)/0.1));
-    //        this->sampleRaster(-94.87183+rnd,29.24216+rnd,1);
+    //        xs[i] = -94.87183+rnd;
+    //        ys[i] = 29.24216+rnd;
     //    }
+    //    QVector<double> vals;
+    //    QBitArray missed;
+    //    this->sampleRaster(xs,ys,{1},vals,missed);
 
     //    // Test to remove start
     //    auto stop = high_resolution_clock::now();
@@ -39,6 +39,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic
 
 #include "SimCenterAppWidget.h"
+#include "RasterBlockSampler.h"
 
 #include <qgscoordinatereferencesystem.h>
 
@@ -80,6 +81,12 @@ public:
     // Note that band numbers start from 1 and not 0!
     double sampleRaster(const double& x, const double& y, const int& bandNumber);
 
+    // Samples the bands of the raster at many points at once, the coordinates have to be in the crs of the raster
+    // values holds bands.size() values per point, and a point that is out of bounds or on a no data pixel is NaN with its bit set in missed
+    // Returns 0 on success and -1 on failure
+    int sampleRaster(const QVector<double>& x, const QVector<double>& y, const QVector<int>& bands, QVector<double>& values, QBitArray& missed,
+                     const RasterBlockSampler::Interpolation interpolation = RasterBlockSampler::Interpolation::Nearest);
+
 private slots:
     void chooseEventFileDialog(void);
     void handleLayerCrsChanged(const QgsCoordinateReferenceSystem & val);
@@ -101,6 +108,7 @@ private:
     QWidget* fileInputWidget = nullptr;
 
     QgsRasterDataProvider* dataProvider = nullptr;
+    std::unique_ptr<RasterBlockSampler> rasterSampler;
     QgsRasterLayer* rasterlayer = nullptr;
 
     SimCenterIMWidget* theIMs = nullptr;  
@@ -43,6 +43,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "GeneralInformationWidget.h"
 #include "PelicunPostProcessor.h"
 #include "CBCitiesPostProcessor.h"
+#include "GeoJSONFeatureSplitter.h"
 #include "ResultsWidget.h"
 #include "SimCenterPreferences.h"
 #include <WorkflowAppR2D.h>
@@ -270,49 +271,24 @@ int ResultsWidget::processResults(QString resultsDirectory)
     //    2. creating small geojson for each type    
     //
 
-    // 1. first divide features into types
+    // 1. first divide features into types, the features are streamed straight to a file per type
     QString pathGeojson = resultsDirectory + QDir::separator() +  QString("R2D_results.geojson");
     QFile jsonFile(pathGeojson);
-    QMap<QString, QList<QJsonObject>> assetDictionary;
+    GeoJSONFeatureSplitter featureSplitter;
     QMap<QString, QList<QString>> assetTypeToType;
-    QJsonObject crs;
-    if (jsonFile.exists() && jsonFile.open(QFile::ReadOnly)) {
-        QString resultData = jsonFile.readAll();
+    if (jsonFile.exists()) {
 
-        // FMK - placing Nan inside quotes to validate
-        if (resultData.contains(" NaN"))
-            resultData.replace("NaN", "\"NaN\"");
-
-        // Sina - Placing Infinity to "INF" (inside qoutes)
-        if (resultData.contains(" Infinity"))
-            resultData.replace("Infinity", "\"inf\"");
-
-
-        /* ******************************************
-        QFile fileNan(QString(pathGeojson + ".Nan"));
-        if(!fileNan.open(QIODevice::WriteOnly)){
-        fileNan.close();
-        } else {
-        QTextStream out(&fileNan); out << resultData;
-        fileNan.close();
-        }
-        ********************************************/
-        
-        QJsonParseError parseError;
-        QJsonDocument exDoc = QJsonDocument::fromJson(resultData.toUtf8(), &parseError);
-
-        // Sina - Added to handle when there is a parsling error gracefully. 
-        if (parseError.error != QJsonParseError::NoError) {
-            QString msg = "Error parsing JSON: " + parseError.errorString() + "\n File: " + pathGeojson;
-            qDebug() << "Error parsing JSON: " <<parseError.errorString() << "\n File: " << "OFSET" << parseError.offset;
-            errorMessage(msg);
+        QString err;
+        if (featureSplitter.splitFile(pathGeojson, resultsDirectory, err) != 0) {
+            qDebug() << err;
+            errorMessage(err);
         }
         else {
 
-            QJsonObject jsonObject = exDoc.object();
+            assetTypeToType = featureSplitter.getAssetTypeToType();
 
-            if(jsonObject.contains("crs")) {
-                crs = jsonObject["crs"].toObject();
+            QJsonObject crs = featureSplitter.getCRS();
+            if(!crs.isEmpty()) {
                 QString crsString = crs["properties"].toObject()["name"].toString();
 
                 QgsCoordinateReferenceSystem qgsCRS = QgsCoordinateReferenceSystem(crsString);
@@ -328,85 +304,16 @@ int ResultsWidget::processResults(QString resultsDirectory)
                 QString msg = "No CRS info provided in " + pathGeojson;
                 errorMessage(msg);
             }
-        
-            QJsonArray features = jsonObject["features"].toArray();
-            for (const QJsonValue& valueIt : features) {
-                QJsonObject value = valueIt.toObject();
-                // Get the type
-                QJsonObject assetProperties = value["properties"].toObject();
-                if (!jsonObject.contains("type")) {
-                    this->errorMessage("The Json object is missing the 'type' key that defines the asset type");
-                    return false;
-                }
-                // type is Bridge/Tunnel/Road
-                QString type = assetProperties["type"].toString();
-                if (type.compare("")==0){
-                    type = "Building";
-                }
-                if (!assetDictionary.contains(type))
-                {
-                    assetDictionary[type] = QList<QJsonObject>({value});
-                }
-                else
-                {
-                    QList<QJsonObject>& featList = assetDictionary[type];
-                    featList.append(value);
-                }
-                // assetType is Transportation Network
-                QString assetType = assetProperties["assetType"].toString();
-                if (!assetTypeToType.contains(assetType))
-                {
-                    assetTypeToType[assetType] = QList<QString>({type});
-                }
-                else
-                {
-                    QList<QString>& typesList = assetTypeToType[assetType];
-                    bool typeExists = false;
-                    for (QString it : typesList){
-                        if (it.compare(type)==0){
-                            typeExists = true;
-                        }
-                    }
-                    if (!typeExists){
-                        typesList.append(type);
-                    }
-                }
-            }
         }
     }
 
-    // 2. creating small geojson for each type
+    // 2. creating layers from the small geojson of each type
     if (jsonFile.exists()){
       QVector<QgsMapLayer*> mapLayers;
       QVector<QgsMapLayer*> DMGLayers;
-      for (auto it = assetDictionary.begin(); it != assetDictionary.end(); ++it) {
-        QString assetType = it.key();
-        QList<QJsonObject> features = it.value();
-	
-        QJsonArray featuresArray;
-        for (const auto& obj : features) {
-	  featuresArray.append(obj);
-        }
-
-        QJsonObject assetDictionary;
-        assetDictionary["type"]="FeatureCollection";
-        assetDictionary["features"]=featuresArray;
-
-        if(!crs.isEmpty())
-	  assetDictionary["crs"]=crs;
-	
-        QString outputFile = resultsDirectory + QDir::separator() + assetType + ".geojson";
-
-        QFile file(outputFile);
-        if (!file.open(QFile::WriteOnly | QFile::Text)) {
-            this->errorMessage("Error creating the asset output json file in GeojsonAssetInputWidget");
-            return false;
-        }
+      for (const QString& assetType : featureSplitter.getFeatureTypes()) {
 
-        // Write the file to the folder
-        QJsonDocument doc(assetDictionary);
-        file.write(doc.toJson());
-        file.close();
+        QString outputFile = featureSplitter.getOutputFile(assetType);
 
 	//
 	// create layers in main VIZ
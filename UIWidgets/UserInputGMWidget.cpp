@@ -37,6 +37,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic, Frank McKenna
 
 #include "CSVReaderWriter.h"
+#include "ConcurrentTasks.h"
+#include "CSVStreamReader.h"
 #include "LayerTreeView.h"
 #include "UserInputGMWidget.h"
 #include "VisualizationWidget.h"
@@ -336,28 +338,35 @@ void UserInputGMWidget::chooseEventFileDialog(void)
     //    set motionDir if file in dir that contains all the motions
     //    invoke loadUserGMData
 
-    CSVReaderWriter csvTool;
+    // Only the station names in the first column are needed here
+    CSVStreamReader csvReader;
+
+    QStringList stationNames;
 
     QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(newEventFile, err);
+    auto res = csvReader.parseFile(newEventFile, [&](const CSVRow& row, int rowIndex)
+    {
+        // Skip the row that contains the header information
+        if(rowIndex != 0)
+            stationNames.append(row[0].toString());
 
-    if(!err.isEmpty())
+        return true;
+    }, err);
+
+    if(res != 0)
     {
         this->errorMessage(err);
         return;
     }
 
-    if(data.empty())
+    if(csvReader.numRowsParsed() == 0)
         return;
 
     eventFile = newEventFile;
     eventFileLineEdit->setText(eventFile);
 
     // check if file in dir with all motions, if so set motionDir
-    // Pop off the row that contains the header information
-    data.pop_front();
-    auto numRows = data.size();
-    int count = 0;
+    auto numRows = stationNames.size();
     QFileInfo eventFileInfo(eventFile);
     QDir fileDir(eventFileInfo.absolutePath());
     QStringList filesInDir = fileDir.entryList(QStringList() << "*", QDir::Files);
@@ -365,8 +374,7 @@ void UserInputGMWidget::chooseEventFileDialog(void)
     // check all files are there
     bool allThere = true;
     for(int i = 0; i<numRows; ++i) {
-        auto rowStr = data.at(i);
-        auto stationName = rowStr[0];
+        auto stationName = stationNames.at(i);
         if (!filesInDir.contains(stationName)) {
             allThere = false;
             i=numRows;
@@ -383,8 +391,7 @@ void UserInputGMWidget::chooseEventFileDialog(void)
             QStringList filesInDir = motionDirDir.entryList(QStringList() << "*", QDir::Files);
             bool allThere = true;
             for(int i = 0; i<numRows; ++i) {
-                auto rowStr = data.at(i);
-                auto stationName = rowStr[0];
+                auto stationName = stationNames.at(i);
                 if (!filesInDir.contains(stationName)) {
                     allThere = false;
                     i=numRows;
@@ -486,25 +493,33 @@ void UserInputGMWidget::loadUserGMData(void)
     // Path to station files, e.g., site0.csv
     auto stationFilePath = motionDir + QDir::separator() + stationName;
 
+    // Only the header and the first row of data are needed from the sample station, stop reading after that
+    CSVStreamReader csvReader;
+
+    QStringList stationDataHeadings;
+
     QString err2;
-    QVector<QStringList> sampleStationData = csvTool.parseCSVFile(stationFilePath,err);
+    auto res = csvReader.parseFile(stationFilePath, [&](const CSVRow& row, int rowIndex)
+    {
+        if(rowIndex == 0)
+            stationDataHeadings = row.toStringList();
+
+        return rowIndex == 0;
+    }, err2);
 
     // Return if there is an error or the station data is empty
-    if(!err2.isEmpty())
+    if(res != 0)
     {
         this->errorMessage("Could not parse the first station with the following error: "+err2);
         return;
     }
 
-    if(sampleStationData.size() < 2)
+    if(csvReader.numRowsParsed() < 2)
     {
         this->errorMessage("The file " + stationFilePath + " is empty");
         return;
     }
 
-    // Get the header file
-    auto stationDataHeadings = sampleStationData.first();
-
     // Create the fields
     QList<QgsField> attribFields;
     attribFields.push_back(QgsField("AssetType", QVariant::String));
@@ -527,9 +542,10 @@ void UserInputGMWidget::loadUserGMData(void)
 
     auto numRows = data.size();
 
-    int count = 0;
+    progressBar->setRange(0, numRows);
 
-    auto maxToDisp = 20;
+    // Number of values of each parameter shown in the attribute preview
+    const int maxToDisp = 20;
 
     int latIndex = theVisualizationWidget->getIndexOfVal(eventColHeaders, "latitude");
     int lonIndex = theVisualizationWidget->getIndexOfVal(eventColHeaders, "longitude");
@@ -546,19 +562,18 @@ void UserInputGMWidget::loadUserGMData(void)
         lonIndex = 1;
     }
 
-    QgsFeatureList featureList;
-    // Get the data
+    // Get the station locations first, they are quick to check
+    QVector<double> latitudes(numRows);
+    QVector<double> longitudes(numRows);
+
     for(int i = 0; i<numRows; ++i)
     {
-        auto rowStr = data.at(i);
+        const auto& rowStr = data.at(i);
 
         auto stationName = rowStr[0];
 
-        // Path to station files, e.g., site0.csv
-        auto stationPath = motionDir + QDir::separator() + stationName;
-
         bool ok;
-        auto lon = rowStr[lonIndex].toDouble(&ok);
+        longitudes[i] = rowStr[lonIndex].toDouble(&ok);
 
         if(!ok)
         {
@@ -570,7 +585,7 @@ void UserInputGMWidget::loadUserGMData(void)
             return;
         }
 
-        auto lat = rowStr[latIndex].toDouble(&ok);
+        latitudes[i] = rowStr[latIndex].toDouble(&ok);
 
         if(!ok)
         {
@@ -581,20 +596,38 @@ void UserInputGMWidget::loadUserGMData(void)
 
             return;
         }
+    }
 
-        GroundMotionStation GMStation(stationPath,lat,lon);
+    // Import the stations in parallel, the records that are shared between stations are parsed once
+    GroundMotionRecordCache recordCache;
+
+    QVector<QgsFeature> stationFeatures(numRows);
+
+    // Each station writes only to its own slot
+    QgsFeature* stationFeaturesData = stationFeatures.data();
+
+    auto importStation = [&](const int i, QString& stationErr)
+    {
+        auto stationName = data.at(i)[0];
+
+        // Path to station files, e.g., site0.csv
+        auto stationPath = motionDir + QDir::separator() + stationName;
+
+        GroundMotionStation GMStation(stationPath,latitudes.at(i),longitudes.at(i));
 
         try
         {
-            GMStation.importGroundMotions();
+            // One row more than is shown, to know if the preview is cut off
+            GMStation.importGroundMotions(&recordCache, maxToDisp + 1);
         }
         catch(QString msg)
         {
-            auto errorMessage = "Error importing ground motion file: " + stationName+"\n"+msg;
-            this->errorMessage(errorMessage);
-
-            this->hideProgressBar();
-
+            stationErr = "Error importing ground motion file: " + stationName+"\n"+msg;
+            return;
+        }
+        catch(...)
+        {
+            stationErr = "Error importing ground motion file: " + stationName;
             return;
         }
 
@@ -613,28 +646,21 @@ void UserInputGMWidget::loadUserGMData(void)
         featAttributes[4] = longitude;                   // "Longitude"
 
         // The number of headings in the file
-        auto numParams = stationData.front().size();
-
-        maxToDisp = (maxToDisp<stationData.size() ? maxToDisp : stationData.size());
+        auto numParams = std::min(stationData.front().size(), attribFields.size() - 5);
 
-        QVector<QString> dataStrs(numParams);
+        auto numToDisp = std::min(maxToDisp, stationData.size());
 
-        for(int i = 0; i<maxToDisp-1; ++i)
+        for(int j = 0; j<numParams; ++j)
         {
-            auto stationParams = stationData[i];
+            QStringList values;
+            values.reserve(numToDisp);
 
-            for(int j = 0; j<numParams; ++j)
-            {
-                dataStrs[j] += stationParams[j] + ", ";
-            }
-        }
+            for(int k = 0; k<numToDisp; ++k)
+                values.append(stationData.at(k).value(j));
 
-        for(int j = 0; j<numParams; ++j)
-        {
-            auto str = dataStrs[j] ;
-            str += stationData[maxToDisp-1][j];
+            auto str = values.join(", ");
 
-            if(maxToDisp<stationData.size())
+            if(numToDisp<stationData.size())
                 str += "...";
 
             featAttributes[5+j] = str;
@@ -644,15 +670,33 @@ void UserInputGMWidget::loadUserGMData(void)
         QgsFeature feature;
         feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
         feature.setAttributes(featAttributes);
-        featureList.append(feature);
+        stationFeaturesData[i] = feature;
+    };
+
+    progressLabel->clear();
+
+    // Report the first station that failed, in the order of the event file
+    auto importErr = ConcurrentTasks::map(numRows, importStation, [this](int value) { progressBar->setValue(value); });
 
-        ++count;
-        progressLabel->clear();
-        progressBar->setValue(count);
+    if(!importErr.isEmpty())
+    {
+        this->errorMessage(importErr);
+
+        this->hideProgressBar();
 
-        QApplication::processEvents();
+        return;
     }
 
+    // The records are not needed once the stations are checked
+    recordCache.clear();
+
+    QgsFeatureList featureList;
+    featureList.reserve(numRows);
+
+    for(auto&& feature : stationFeatures)
+        featureList.append(feature);
+
+    stationFeatures.clear();
 
     auto vectorLayer = qgisVizWidget->addVectorLayer("Point", "Ground Motion Grid");
 
@@ -676,7 +720,7 @@ void UserInputGMWidget::loadUserGMData(void)
 
     vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
 
-    dProvider->addFeatures(featureList);
+    dProvider->addFeatures(featureList, QgsFeatureSink::FastInsert);
     vectorLayer->updateExtents();
 
     qgisVizWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
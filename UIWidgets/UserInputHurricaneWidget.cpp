@@ -38,6 +38,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 
 #include "CSVReaderWriter.h"
+#include "ConcurrentTasks.h"
 #include "LayerTreeView.h"
 #include "UserInputHurricaneWidget.h"
 #include "QGISVisualizationWidget.h"
@@ -67,6 +68,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QVBoxLayout>
 #include <QDir>
 
+#include <vector>
+
 UserInputHurricaneWidget::UserInputHurricaneWidget(QGISVisualizationWidget* visWidget, QWidget *parent) : SimCenterAppWidget(parent), theVisualizationWidget(visWidget)
 {
     progressBar = nullptr;
@@ -502,56 +505,15 @@ void UserInputHurricaneWidget::loadUserWFData(void)
     if(data.empty())
         return;
 
-    this->showProgressBar();
-
-    QApplication::processEvents();
-
-    //progressBar->setRange(0,inputFiles.size());
-    progressBar->setRange(0, data.count());
-
-    progressBar->setValue(0);
-
-    // Get the headers in the first station file - assume that the rest will be the same
-    auto rowStr = data.at(1);
-    auto stationName = rowStr[0];
-
-    // Path to station files, e.g., site0.csv
-    auto stationFilePath = eventDir + QDir::separator() + stationName;
-
-    QString err2;
-    QVector<QStringList> sampleStationData = csvTool.parseCSVFile(stationFilePath,err);
-
-    // Return if there is an error or the station data is empty
-    if(!err2.isEmpty())
-    {
-        this->errorMessage("Could not parse the first station with the following error: "+err2);
-        return;
-    }
-
-    if(sampleStationData.size() < 2)
+    if(data.size() < 2)
     {
-        this->errorMessage("The file " + stationFilePath + " is empty");
+        this->errorMessage("The file " + eventFile + " is empty");
         return;
     }
 
-    // Get the header file
-    auto stationDataHeadings = sampleStationData.first();
-
-
-    // Create the fields
-    QList<QgsField> attribFields;
-    attribFields.push_back(QgsField("AssetType", QVariant::String));
-    attribFields.push_back(QgsField("TabName", QVariant::String));
-    attribFields.push_back(QgsField("Station Name", QVariant::String));
-    attribFields.push_back(QgsField("Latitude", QVariant::Double));
-    attribFields.push_back(QgsField("Longitude", QVariant::Double));
-
-    for(auto&& it : stationDataHeadings)
-    {
-        attribFields.push_back(QgsField(it, QVariant::String));
-        unitsWidget->addNewUnitItem(it);
-    }
+    this->showProgressBar();
 
+    QApplication::processEvents();
 
     auto headerInfo = data.front();
 
@@ -570,10 +532,9 @@ void UserInputHurricaneWidget::loadUserWFData(void)
 
     auto numRows = data.size();
 
-    int count = 0;
+    std::vector<WindFieldStation> stations;
+    stations.reserve(numRows);
 
-    QgsFeatureList featureList;
-    // Get the data
     for(int i = 0; i<numRows; ++i)
     {
         auto rowStr = data.at(i);
@@ -612,68 +573,105 @@ void UserInputHurricaneWidget::loadUserWFData(void)
 
         WFStation.setStationFilePath(stationPath);
 
+        stations.push_back(std::move(WFStation));
+    }
+
+    // Decode the station files in parallel, every station only writes to its own slot
+    WindFieldStation* stationsData = stations.data();
+
+    auto importStation = [stationsData](const int i, QString& err)
+    {
         try
         {
-            WFStation.importWindFieldStation();
+            stationsData[i].importWindFieldStation(" ");
         }
-        catch(QString msg)
+        catch(const QString& msg)
         {
-            auto errorMessage = "Error importing wind field file: " + stationName+"\n"+msg;
+            err = "Error importing wind field file: " + stationsData[i].getName() + "\n" + msg;
+        }
+    };
 
-            this->errorMessage(errorMessage);
+    progressLabel->clear();
+    progressBar->setRange(0, numRows);
+    progressBar->setValue(0);
 
-            this->hideProgressBar();
+    // Report the first error in the order of the grid file
+    auto importErr = ConcurrentTasks::map(numRows, importStation, [this](int value) { progressBar->setValue(value); });
 
-            return;
-        }
+    if(!importErr.isEmpty())
+    {
+        this->errorMessage(importErr);
+        this->hideProgressBar();
+        return;
+    }
+
+    // Get the headers in the first station file - assume that the rest will be the same
+    auto stationDataHeadings = stations.front().getStationDataHeaders();
 
-        auto stationData = WFStation.getStationData();
+    // Create the fields
+    QList<QgsField> attribFields;
+    attribFields.push_back(QgsField("AssetType", QVariant::String));
+    attribFields.push_back(QgsField("TabName", QVariant::String));
+    attribFields.push_back(QgsField("Station Name", QVariant::String));
+    attribFields.push_back(QgsField("Latitude", QVariant::Double));
+    attribFields.push_back(QgsField("Longitude", QVariant::Double));
+
+    for(auto&& it : stationDataHeadings)
+    {
+        attribFields.push_back(QgsField(it, QVariant::String));
+        unitsWidget->addNewUnitItem(it);
+    }
+
+    // The summary of the peak wind speeds that were computed while decoding
+    const bool hasPWS = stationDataHeadings.contains("PWS");
+    if(hasPWS)
+    {
+        attribFields.push_back(QgsField("Max Peak Wind Speed", QVariant::Double));
+        attribFields.push_back(QgsField("Mean Peak Wind Speed", QVariant::Double));
+    }
+
+    const int numHeadings = stationDataHeadings.size();
+
+    QgsFeatureList featureList;
+    featureList.reserve(numRows);
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        auto& WFStation = stations[i];
 
         // create the feature attributes
         QgsAttributes featAttributes(attribFields.size());
 
         featAttributes[0] = "HurricaneGridPoint"; // AssetType
         featAttributes[1] = "Hurricane Grid Point"; // TabName
-        featAttributes[2] = stationName; // Station Name
-        featAttributes[3] = latitude; // Latitude
-        featAttributes[4] = longitude; // Longitude
+        featAttributes[2] = WFStation.getName(); // Station Name
+        featAttributes[3] = WFStation.getLatitude(); // Latitude
+        featAttributes[4] = WFStation.getLongitude(); // Longitude
 
-        // The number of headings in the file
-        auto numParams =stationData.front().size();
+        // The number of headings in the file, the fields were created from the headings of the first station
+        const auto& dataStrs = WFStation.getColumnStrings();
+        auto numParams = std::min(numHeadings, int(dataStrs.size()));
 
-        QVector<QString> dataStrs(numParams);
-
-        for(int i = 0; i<stationData.size(); ++i)
+        for(int j = 0; j<numParams; ++j)
         {
-            auto stationParams = stationData[i];
-
-            for(int j = 0; j<numParams; ++j)
-            {
-                dataStrs[j] += stationParams[j] + " ";
-            }
+            featAttributes[5+j] = dataStrs[j];
         }
 
-        for(int i = 0; i<numParams; ++i)
+        if(hasPWS && !WFStation.getPeakWindSpeeds().isEmpty())
         {
-            featAttributes[5+i] = dataStrs[i];
+            featAttributes[5+numHeadings] = WFStation.getMaxPeakWindSpeed();
+            featAttributes[6+numHeadings] = WFStation.getMeanPeakWindSpeed();
         }
 
         // Create the point and add it to the feature table
         QgsFeature feature;
-        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(longitude,latitude)));
+        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(WFStation.getLongitude(),WFStation.getLatitude())));
         feature.setAttributes(featAttributes);
         featureList.append(feature);
 
         WFStation.setStationFeature(feature);
-
-        ++count;
-        progressLabel->clear();
-        progressBar->setValue(count);
-
-        QApplication::processEvents();
     }
 
-
     auto vectorLayer = QGsVisWidget->addVectorLayer("Point", "Hurricane Grid");
 
     if(vectorLayer == nullptr)
@@ -697,7 +695,8 @@ void UserInputHurricaneWidget::loadUserWFData(void)
 
     vectorLayer->updateFields(); // tell the vector layer to fetch changes from the provider
 
-    dProvider->addFeatures(featureList);
+    // Add all of the features in a single batch
+    dProvider->addFeatures(featureList, QgsFeatureSink::FastInsert);
     vectorLayer->updateExtents();
 
     QGsVisWidget->createSymbolRenderer(Qgis::MarkerShape::Cross,Qt::black,2.0,vectorLayer);
@@ -36,7 +36,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
-#include "CSVReaderWriter.h"
+#include "CSVStreamReader.h"
 #include "WindFieldStation.h"
 
 #include <QFileInfo>
@@ -53,6 +53,12 @@ WindFieldStation::WindFieldStation(QString name, double lat, double lon) : stati
 }
 
 
+QString WindFieldStation::getName() const
+{
+    return stationName;
+}
+
+
 double WindFieldStation::getLatitude() const
 {
     return latitude;
@@ -65,27 +71,99 @@ double WindFieldStation::getLongitude() const
 }
 
 
-void WindFieldStation::importWindFieldStation(void)
+void WindFieldStation::importWindFieldStation(const QString& separator)
 {
-    CSVReaderWriter csvTool;
+    CSVStreamReader csvReader;
+
+    tableHeadings.clear();
+    columnStrings.clear();
+    peakWindSpeeds.clear();
+    numRows = 0;
+    maxPeakWindSpeed = 0.0;
+    meanPeakWindSpeed = 0.0;
+
+    // The previews are built as bytes and converted once at the end
+    QVector<QByteArray> columnData;
+    const auto separatorData = separator.toUtf8();
+
+    int idxPWS = -1;
+    double sumPWS = 0.0;
+
+    QString rowErr;
 
     QString err;
-    QVector<QStringList> data = csvTool.parseCSVFile(stationFilePath,err);
+    auto res = csvReader.parseFile(stationFilePath, [&](const CSVRow& row, int rowIndex)
+    {
+        // Get the header file
+        if(rowIndex == 0)
+        {
+            tableHeadings = row.toStringList();
+            columnData.resize(tableHeadings.size());
+            idxPWS = tableHeadings.indexOf("PWS");
+            return true;
+        }
+
+        if(row.size() != tableHeadings.size())
+        {
+            rowErr = "The number of columns in the row " + QString::number(rowIndex) + " of the file " + stationFilePath + " should be " + QString::number(tableHeadings.size());
+            return false;
+        }
+
+        for(int j = 0; j<row.size(); ++j)
+        {
+            auto& column = columnData[j];
+
+            if(numRows != 0)
+                column.append(separatorData);
+
+            column.append(row[j].data(), row[j].size());
+        }
+
+        if(idxPWS != -1)
+        {
+            // Assume a zero value if the field is empty
+            double pws = 0.0;
+
+            if(!row[idxPWS].isEmpty())
+            {
+                bool ok = false;
+                pws = row[idxPWS].toDouble(&ok);
+
+                if(!ok)
+                {
+                    rowErr = "Could not convert the peak wind speed " + row[idxPWS].toString() + " in the file " + stationFilePath + " to a double";
+                    return false;
+                }
+            }
+
+            if(peakWindSpeeds.isEmpty() || pws > maxPeakWindSpeed)
+                maxPeakWindSpeed = pws;
+
+            sumPWS += pws;
+            peakWindSpeeds.push_back(pws);
+        }
+
+        ++numRows;
+
+        return true;
+    }, err);
 
     // Return if there is an error or the data is empty
-    if(!err.isEmpty())
+    if(res != 0)
         throw err;
 
-    if(data.size() < 2)
-        throw "The file " + stationFilePath + " is empty";
+    if(!rowErr.isEmpty())
+        throw rowErr;
 
-    // Get the header file
-    tableHeadings = data.first();
+    if(numRows == 0)
+        throw "The file " + stationFilePath + " is empty";
 
-    // Pop off the row that contains the header information
-    data.pop_front();
+    if(!peakWindSpeeds.isEmpty())
+        meanPeakWindSpeed = sumPWS/peakWindSpeeds.size();
 
-    stationData = data;
+    columnStrings.reserve(columnData.size());
+    for(auto&& it : columnData)
+        columnStrings.append(QString::fromUtf8(it));
 }
 
 
@@ -118,13 +196,38 @@ int WindFieldStation::updateFeatureAttribute(const QString& attribute, const QVa
     return 0;
 }
 
-QVector<QStringList> WindFieldStation::getStationData() const
+QStringList WindFieldStation::getStationDataHeaders() const
 {
-    return stationData;
+    return tableHeadings;
 }
 
-QStringList WindFieldStation::getStationDataHeaders() const
+
+const QStringList& WindFieldStation::getColumnStrings() const
 {
-    return tableHeadings;
+    return columnStrings;
+}
+
+
+int WindFieldStation::getNumRows() const
+{
+    return numRows;
+}
+
+
+const QVector<double>& WindFieldStation::getPeakWindSpeeds() const
+{
+    return peakWindSpeeds;
+}
+
+
+double WindFieldStation::getMaxPeakWindSpeed() const
+{
+    return maxPeakWindSpeed;
+}
+
+
+double WindFieldStation::getMeanPeakWindSpeed() const
+{
+    return meanPeakWindSpeed;
 }
 
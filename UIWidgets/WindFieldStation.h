@@ -50,6 +50,8 @@ public:
 
     bool isNull(){return stationName.isEmpty();}
 
+    QString getName() const;
+
     double getLatitude() const;
 
     double getLongitude() const;
@@ -57,7 +59,10 @@ public:
     QString getStationFilePath() const;
     void setStationFilePath(const QString &value);
 
-    void importWindFieldStation(void);
+    // Reads the station file in a single pass, throws a QString with the message if the file cannot be read
+    // The values of each column are joined with the separator into one string for the previews in the map
+    // The peak wind speeds (PWS) are decoded into numbers and their maximum and mean are computed in the same pass
+    void importWindFieldStation(const QString& separator = ", ");
 
     // Function to convert a QString and QVariant to double
     // Throws an error exception if conversion fails
@@ -82,10 +87,19 @@ public:
 
     int updateFeatureAttribute(const QString& attribute, const QVariant& value);
 
-    QVector<QStringList> getStationData() const;
-
     QStringList getStationDataHeaders() const;
 
+    // The values of each column joined with the separator, in the order of the headers
+    const QStringList& getColumnStrings() const;
+
+    int getNumRows() const;
+
+    // Empty if the station file does not have a PWS column
+    const QVector<double>& getPeakWindSpeeds() const;
+
+    double getMaxPeakWindSpeed() const;
+    double getMeanPeakWindSpeed() const;
+
 private:
 
     QString stationFilePath;
@@ -96,10 +110,17 @@ private:
 
     double longitude;
 
-    QVector<QStringList> stationData;
-
     QStringList tableHeadings;
 
+    QStringList columnStrings;
+
+    int numRows = 0;
+
+    QVector<double> peakWindSpeeds;
+
+    double maxPeakWindSpeed = 0.0;
+    double meanPeakWindSpeed = 0.0;
+
     QgsFeature stationFeature;
 
 
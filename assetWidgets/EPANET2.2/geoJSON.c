@@ -13,94 +13,71 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <epanet2.h>
 #include <epanet2_2.h>
 #include <types.h>
 #include <funcs.h>
+#include "geoJSON.h"
 
-void  writeConsole(char *s)
-{
-    fprintf(stdout, "\r%s", s);
-    fflush(stdout);
-}
-
-static Project __defaultProject;
-static Project *_defaultProject = &__defaultProject;
+int outputNetworkJSON(Project *, const char *, InpFeatureCallback, void *);
+int visitNetworkFeatures(Project *, InpFeatureCallback, void *);
 
-int outputJSON(Project *, const char *);
+int readInpNetwork(const char *inpFile, const char *rptFile, const char *jsonFile, InpFeatureCallback callback, void *userData, char *errmsg, int maxLen) {
 
-// Functions for creating and removing default temporary files
-static void createtmpfiles()
-{
-    getTmpName(_defaultProject->TmpHydFname);
-    getTmpName(_defaultProject->TmpOutFname);
-    getTmpName(_defaultProject->TmpStatFname);
-}
-
-static void removetmpfiles()
-{
-    remove(_defaultProject->TmpHydFname);
-    remove(_defaultProject->TmpOutFname);
-    remove(_defaultProject->TmpStatFname);
-}
-
-
-
-int createJSON(const char *f1, const char *f2, const char *f3, const char *f4) {
-  
 /*--------------------------------------------------------------
- **  Input:   argc    = number of command line arguments
- **           *argv[] = array of command line arguments
- **  Output:  none
- **  Purpose: main program stub for command line EPANET
- **
- **  Command line for stand-alone operation is:
- **    progname f1  f2  f3
- **  where progname = name of executable this code was compiled to,
- **  f1 = name of input file,
- **  f2 = name of report file
- **  f3 = name of binary output file (optional).
+ **  Input:   inpFile  = name of input file
+ **           rptFile  = name of report file
+ **           jsonFile = name of the GeoJSON file to write (optional)
+ **           callback = function called with every feature of the network
+ **  Output:  errmsg   = error message
+ **  Purpose: reads the network of an .inp file into its own project,
+ **           so that it does not share any state with other projects,
+ **           and visits every feature of the network once
  **--------------------------------------------------------------
  */
 
-  char errmsg[256] = "";
   int  errcode = 0;
-  int  warncode = 0;    
-  int  version;
-  int  major;
-  int  minor;
-  int  patch;
-  
-  // Get version number and display in Major.Minor.Patch format
-  ENgetversion(&version);
-  major = version/10000;
-  minor = (version%10000)/100;
-  patch = version%100;
-  printf("\n... Running EPANET Version %d.%d.%d\n", major, minor, patch);
-  
-  Project *theProjectPtr = _defaultProject;
-  
-  // Run the project and record any warning
-  createtmpfiles();
-  ERRCODE(EN_open(theProjectPtr, f1, f2, f3));        
+  int  warncode = 0;
+  int  res = 0;
+  EN_Project theProjectPtr = 0;
+
+  if (errmsg != 0 && maxLen > 0)
+    memset(errmsg, 0, maxLen);
+
+  if (EN_createproject(&theProjectPtr) != 0) {
+    if (errmsg != 0 && maxLen > 0)
+      snprintf(errmsg, maxLen, "Failed to allocate the EPANET project");
+    return 101;
+  }
+
+  // Read the network, no binary output file is needed to only read the network
+  ERRCODE(EN_open(theProjectPtr, inpFile, rptFile, ""));
   if (errcode < 100) warncode = errcode;
-  removetmpfiles();
-  
-  if (warncode) errcode = MAX(errcode, warncode);
-  
-  // Check for errors/warnings and report accordingly
-  if (errcode != 0) {
-    if (errcode < 100) {
-      printf("\n... EPANET ran with warnings - check the Status Report.\n");
-      return errcode;
-    } else {
-      ENgeterror(errcode, errmsg, 255);
-      printf("\n... EPANET failed with %s.\n", errmsg);
-      return 100;
-    }
+
+  if (errcode >= 100) {
+    if (errmsg != 0 && maxLen > 0)
+      EN_geterror(errcode, errmsg, maxLen - 1);
+    EN_deleteproject(theProjectPtr);
+    return errcode;
   }
-  
-  if (f4 != 0) {
-    outputJSON(theProjectPtr, f4);
+
+  if (jsonFile != 0)
+    res = outputNetworkJSON(theProjectPtr, jsonFile, callback, userData);
+  else
+    res = visitNetworkFeatures(theProjectPtr, callback, userData);
+
+  EN_deleteproject(theProjectPtr);
+
+  if (res == -1) {
+    if (errmsg != 0 && maxLen > 0)
+      snprintf(errmsg, maxLen, "Could not open file: %s", jsonFile);
+    return 100;
+  } else if (res != 0) {
+    if (errmsg != 0 && maxLen > 0)
+      snprintf(errmsg, maxLen, "Reading the network was stopped");
+    return 100;
   }
+
+  return warncode;
 }
@@ -1 +1,44 @@
-int  createJSON(const char *f1, const char *f2, const char *f3, const char *f4);
+#ifndef GEOJSON_H
+#define GEOJSON_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define INP_MAX_FIELDS 20
+
+typedef enum { INP_DOUBLE, INP_INT, INP_STRING } InpFieldType;
+
+// One property of a network feature, num holds the value of double and int fields, str the value of string fields
+typedef struct {
+  const char *name;
+  InpFieldType type;
+  double num;
+  const char *str;
+} InpField;
+
+// One junction, pump, pipe, reservoir or tank of the network, every feature of a type has the same fields in the same order
+// The strings are owned by the project and are only valid for the duration of the callback
+typedef struct {
+  const char *type;
+  int id;
+  int numPoints;   // 1 for nodes, 2 for links
+  double x[2];
+  double y[2];
+  int numFields;
+  InpField fields[INP_MAX_FIELDS];
+} InpFeature;
+
+// Called once for every feature, a non-zero return stops the traversal and is returned to the caller
+typedef int (*InpFeatureCallback)(void *userData, const InpFeature *feature);
+
+// Reads the .inp file once into a new project and passes every feature of the network to the callback
+// If jsonFile is not null the features are also written to it as a single GeoJSON FeatureCollection in the same pass
+// Returns 0 on success, an EPANET warning code (< 100) if the network was read with warnings, or an error code with the message in errmsg
+int readInpNetwork(const char *inpFile, const char *rptFile, const char *jsonFile, InpFeatureCallback callback, void *userData, char *errmsg, int maxLen);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // GEOJSON_H
@@ -288,6 +288,18 @@ typedef enum {
   EN_PDA         = 1    //!< Pressure driven analysis
 } EN_DemandModel;
 
+/// Linear equation solvers
+/**
+These are the solvers of the sparse linear system of heads in each trial of the
+hydraulic solution, selected with the @ref EN_LINEARSOLVER option. Both use the
+same node re-ordering and symbolic factorization. The solver can only be changed
+while the hydraulic solver is closed.
+*/
+typedef enum {
+  EN_CHOLESKY    = 0,   //!< Column-by-column sparse Cholesky factorization (default)
+  EN_SUPERNODAL  = 1    //!< Supernodal Cholesky factorization with dense kernels
+} EN_LinearSolverType;
+
 /// Simulation options
 /**
 These constants identify the hydraulic and water quality simulation options
@@ -317,7 +329,8 @@ typedef enum {
   EN_BULKORDER      = 19, //!< Bulk water reaction order for pipes
   EN_WALLORDER      = 20, //!< Wall reaction order for pipes (either 0 or 1)
   EN_TANKORDER      = 21, //!< Bulk water reaction order for tanks
-  EN_CONCENLIMIT    = 22  //!< Limiting concentration for growth reactions
+  EN_CONCENLIMIT    = 22, //!< Limiting concentration for growth reactions
+  EN_LINEARSOLVER   = 23  //!< Solver of the linear equations in each hydraulic trial (see @ref EN_LinearSolverType)
 } EN_Option;
 
 /// Simple control types
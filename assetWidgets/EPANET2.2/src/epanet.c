@@ -1187,6 +1187,9 @@ int DLLEXPORT EN_getoption(EN_Project p, int option, double *value)
     case EN_CONCENLIMIT:
         v = qual->Climit * p->Ucf[QUALITY];
         break;
+    case EN_LINEARSOLVER:
+        v = hyd->LinSolver;
+        break;
 
     default:
         return 251;
@@ -1344,6 +1347,14 @@ int DLLEXPORT EN_setoption(EN_Project p, int option, double value)
         qual->Climit = value / p->Ucf[QUALITY];
         break;
 
+    case EN_LINEARSOLVER:
+        // Can't change if hydraulic solver is open
+        if (p->hydraul.OpenHflag) return 262;
+        i = ROUND(value);
+        if (i < CHOLESKY || i > SUPERNODAL) return 213;
+        hyd->LinSolver = i;
+        break;
+
     default:
         return 251;
     }
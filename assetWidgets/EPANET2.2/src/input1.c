@@ -112,6 +112,7 @@ void setdefaults(Project *pr)
     hyd->Preq = MINPDIFF;       // Required demand pressure (ft)
     hyd->Pexp = 0.5;            // Pressure function exponent
     hyd->MaxIter = MAXITER;     // Default max. hydraulic trials
+    hyd->LinSolver = CHOLESKY;  // Column-by-column linear solver
     hyd->ExtraIter = -1;        // Stop if network unbalanced
     hyd->Viscos = MISSING;      // Temporary viscosity
     hyd->SpGrav = SPGRAV;       // Default specific gravity
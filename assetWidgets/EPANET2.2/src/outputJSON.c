@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "types.h"
+#include "../geoJSON.h"
 //#include "enumstxt.h"
 
 static inline const char *getStatusType(int f)
@@ -25,71 +26,90 @@ static inline const char *getPumpType(int f)
   return strings[f];
 }
 
-int outputJSON(Project *theProjectPtr, const char *fileName) {
+static void addDouble(InpFeature *f, const char *name, double value)
+{
+  InpField *field = &f->fields[f->numFields++];
+  field->name = name;
+  field->type = INP_DOUBLE;
+  field->num = value;
+  field->str = 0;
+}
 
-  //
-  // open file, error message and return -1 if error
-  //
-  
-  FILE* jsonFile = fopen(fileName, "w"); 
-  if (jsonFile == 0) {
-    printf("ERROR: Coul not open file: %s\n",fileName);
-    return -1;
-  }
+static void addInt(InpFeature *f, const char *name, int value)
+{
+  InpField *field = &f->fields[f->numFields++];
+  field->name = name;
+  field->type = INP_INT;
+  field->num = value;
+  field->str = 0;
+}
 
-  //
-  // start of GeoJSON
-  //
-  
-  fprintf(jsonFile, "\n{\n \"type\":\"FeatureCollection\", \"features\":[");
+static void addString(InpFeature *f, const char *name, const char *value)
+{
+  InpField *field = &f->fields[f->numFields++];
+  field->name = name;
+  field->type = INP_STRING;
+  field->num = 0;
+  field->str = value;
+}
+
+static void startFeature(InpFeature *f, const char *type, int id)
+{
+  f->type = type;
+  f->id = id;
+  f->numFields = 0;
+  addString(f, "type", type);
+}
+
+static void setPoint(InpFeature *f, Snode *theNode)
+{
+  f->numPoints = 1;
+  f->x[0] = theNode->X;
+  f->y[0] = theNode->Y;
+}
+
+static void setLine(InpFeature *f, Snode *startNode, Snode *endNode)
+{
+  f->numPoints = 2;
+  f->x[0] = startNode->X;
+  f->y[0] = startNode->Y;
+  f->x[1] = endNode->X;
+  f->y[1] = endNode->Y;
+}
+
+//
+// visit the junctions, pumps, pipes, reservoirs and tanks of the network in that order
+//
+
+int visitNetworkFeatures(Project *theProjectPtr, InpFeatureCallback callback, void *userData) {
 
   int numNodes = theProjectPtr->network.Nnodes;
   int numTanks = theProjectPtr->network.Ntanks;
-  int numJuncs = theProjectPtr->network.Njuncs;
   int numLinks = theProjectPtr->network.Nlinks;
-  int numPipes = theProjectPtr->network.Npipes;
-  int numPumps = theProjectPtr->network.Npumps; 
-  int numValves = theProjectPtr->network.Nvalves;
-
-
-  printf("\n\t numNodes %d, numTanks %d, numJuncs %d, numLinks %d, numPipes %d, numPumps %d numValves: %d.\n",
-	 numNodes,
-	 numTanks,
-	 numJuncs,
-	 numLinks,
-	 numPipes,
-	 numPumps,
-	 numValves);  
-  
+  int numPumps = theProjectPtr->network.Npumps;
+
+  InpFeature f;
+  int res = 0;
+
   //
-  // output Junctions
+  // Junctions
   //
-  
+
   for (int i=1; i<=numNodes; i++) { // not standard C indexing
     Snode *theNode = &theProjectPtr->network.Node[i];
     if (theNode->Type == JUNCTION) {
-      if (i == 1) // the == 1 is needed to for no initial comma
-	fprintf(jsonFile,"\n {\"type\":\"Feature\",\"geometry\":{ \"type\":\"Point\", \"coordinates\":[%f,%f]},\"id\":\"1\", \"properties\":{\"type\":\"Junction\",\"InpID\":\"%s\", \"El\":%f, \"C0\":%f, \"Ke\":%f}}",
-		theNode->X,
-		theNode->Y,
-		theNode->ID,
-		theNode->El,	       
-		theNode->C0,
-		theNode->Ke);
-      else
-	fprintf(jsonFile,",\n {\"type\":\"Feature\",\"geometry\":{ \"type\":\"Point\", \"coordinates\":[%f,%f]}, \"id\":\"%d\", \"properties\":{\"type\":\"Junction\",\"InpID\":\"%s\", \"El\":%f, \"C0\":%f, \"Ke\":%f}}",
-		theNode->X,
-		theNode->Y,
-		i,
-		theNode->ID,
-		theNode->El,	       
-		theNode->C0,
-		theNode->Ke);	    
+      startFeature(&f, "Junction", i);
+      setPoint(&f, theNode);
+      addString(&f, "InpID", theNode->ID);
+      addDouble(&f, "El", theNode->El);
+      addDouble(&f, "C0", theNode->C0);
+      addDouble(&f, "Ke", theNode->Ke);
+      if ((res = callback(userData, &f)) != 0) return res;
     }
   }
 
   //
-  // output Pumps
+  // Pumps
   //
 
   for (int i=1; i<=numPumps; i++) { // not standard C indexing
@@ -97,122 +117,159 @@ int outputJSON(Project *theProjectPtr, const char *fileName) {
     Slink *theLink = &theProjectPtr->network.Link[thePump->Link];
     Snode *startNode= &theProjectPtr->network.Node[theLink->N1];
     Snode *endNode = &theProjectPtr->network.Node[theLink->N2];
-    fprintf(jsonFile,",\n {\"type\":\"Feature\",\"geometry\":{ \"type\":\"LineString\", \"coordinates\":[[%f,%f],[%f,%f]]},\"id\":\"%d\", \"properties\":{\"type\":\"Pump\",\"InpID\":\"%s\", \"Ptype\":\"%s\", \"Q0\":%f, \"Qmax\":%f, \"Hmax\": %f, \"H0\":%f, \"R\":%f, \"N\":%f, \"Hcurve\":%d, \"Ecurve\":%d, \"Upat\":%d,\"Epat\":%d, \"Ecost\":%f,\"startNode\":\"%s\", \"endNode\":\"%s\"}}",
-	    startNode->X,
-	    startNode->Y,
-	    endNode->X,
-	    endNode->Y,
-	    i,
-	    theLink->ID,
-	    getPumpType(thePump->Ptype),
-	    thePump->Q0,
-	    thePump->Qmax,
-	    thePump->Hmax,
-	    thePump->H0,
-	    thePump->R,
-	    thePump->N,
-	    thePump->Hcurve,
-	    thePump->Ecurve,
-	    thePump->Upat,
-	    thePump->Epat,	     
-	    thePump->Ecost,
-	    startNode->ID,
-	    endNode->ID);	   
-
+    startFeature(&f, "Pump", i);
+    setLine(&f, startNode, endNode);
+    addString(&f, "InpID", theLink->ID);
+    addString(&f, "Ptype", getPumpType(thePump->Ptype));
+    addDouble(&f, "Q0", thePump->Q0);
+    addDouble(&f, "Qmax", thePump->Qmax);
+    addDouble(&f, "Hmax", thePump->Hmax);
+    addDouble(&f, "H0", thePump->H0);
+    addDouble(&f, "R", thePump->R);
+    addDouble(&f, "N", thePump->N);
+    addInt(&f, "Hcurve", thePump->Hcurve);
+    addInt(&f, "Ecurve", thePump->Ecurve);
+    addInt(&f, "Upat", thePump->Upat);
+    addInt(&f, "Epat", thePump->Epat);
+    addDouble(&f, "Ecost", thePump->Ecost);
+    addString(&f, "startNode", startNode->ID);
+    addString(&f, "endNode", endNode->ID);
+    if ((res = callback(userData, &f)) != 0) return res;
   }
 
   //
-  // output Pipes
+  // Pipes, check valve pipes and valves are not output
   //
-  
+
   for (int i=1; i<=numLinks; i++) { // not standard C indexing
     Slink *theLink = &theProjectPtr->network.Link[i];
-    int type = theLink->Type;
-    char *ID = theLink->ID;
-    Snode *startNode = &theProjectPtr->network.Node[theLink->N1];
-    Snode *endNode = &theProjectPtr->network.Node[theLink->N2];
     if (theLink->Type == PIPE) {
-      fprintf(jsonFile,",\n {\"type\":\"Feature\",\"geometry\":{ \"type\":\"LineString\", \"coordinates\":[[%f,%f],[%f,%f]]},\"id\": \"%d\", \"properties\":{\"type\":\"Pipe\",\"InpID\":\"%s\", \"Diam\":%f, \"Kc\":%f, \"Len\":%f, \"Status\":\"%s\", \"Km\":%f, \"Kb\":%f, \"Kw\":%f, \"R\":%f,\"Rc\":%f,\"startNode\":\"%s\", \"endNode\":\"%s\"}}",
-	      startNode->X,
-	      startNode->Y,
-	      endNode->X,
-	      endNode->Y,
-	      i,
-	      theLink->ID,
-	      theLink->Diam,
-	      theLink->Kc,
-	      theLink->Len,
-	      getStatusType(theLink->Status),
-	      theLink->Km,
-	      theLink->Kb,
-	      theLink->Kw,
-	      theLink->R,
-	      theLink->Rc,
-	      startNode->ID,
-	      endNode->ID);
-      
-      
-    } else if (theLink->Type == CVPIPE) {
-      
-    } else if (theLink->Type == PUMP) {
-      ; // pumps already output
-    } else {  //some type valve
-      
+      Snode *startNode = &theProjectPtr->network.Node[theLink->N1];
+      Snode *endNode = &theProjectPtr->network.Node[theLink->N2];
+      startFeature(&f, "Pipe", i);
+      setLine(&f, startNode, endNode);
+      addString(&f, "InpID", theLink->ID);
+      addDouble(&f, "Diam", theLink->Diam);
+      addDouble(&f, "Kc", theLink->Kc);
+      addDouble(&f, "Len", theLink->Len);
+      addString(&f, "Status", getStatusType(theLink->Status));
+      addDouble(&f, "Km", theLink->Km);
+      addDouble(&f, "Kb", theLink->Kb);
+      addDouble(&f, "Kw", theLink->Kw);
+      addDouble(&f, "R", theLink->R);
+      addDouble(&f, "Rc", theLink->Rc);
+      addString(&f, "startNode", startNode->ID);
+      addString(&f, "endNode", endNode->ID);
+      if ((res = callback(userData, &f)) != 0) return res;
     }
   }
 
   //
-  // output Reservoirs and Tanks
+  // Reservoirs and Tanks
   //
 
   for (int i=1; i<=numTanks; i++) { // not standard C indexing
-    Stank *theTank = &theProjectPtr->network.Tank[i];      
-    int nodeID = theTank->Node;
-    double A = theTank->A;
-    Snode *theNode = &theProjectPtr->network.Node[nodeID];      
-    if (A == 0) {   // keeping tanks and resrvoirs seperate for now .. might not want all the stuff in the structure depending on type
-      fprintf(jsonFile,",\n {\"type\":\"Feature\",\"geometry\":{ \"type\":\"Point\", \"coordinates\":[%f,%f]},\"id\":\"%d\", \"properties\":{\"type\":\"Reservoir\",\"InpID\":\"%s\", \"H0\":%f, \"Vmin\":%f, \"Vmax\":%f, \"V0\": %f, \"Kb\":%f, \"V\":%f, \"C\":%f, \"Pat\":%d, \"Vcurve\":%d, \"MixModel\":\"%s\", \"V1Max\":%f, \"CanOverflow\":%d}}",
-	      theNode->X,
-	      theNode->Y,
-	      i,
-	      theNode->ID,
-	      theTank->H0,
-	      theTank->Vmin,
-	      theTank->Vmax,
-	      theTank->V0,
-	      theTank->Kb,
-	      theTank->V,
-	      theTank->C,
-	      theTank->Pat,
-	      theTank->Vcurve,
-	      getMixType(theTank->MixModel),	       
-	      theTank->V1max,
-	      theTank->CanOverflow);		    
-    } else {
-      fprintf(jsonFile,",\n {\"type\":\"Feature\",\"geometry\":{ \"type\":\"Point\", \"coordinates\":[%f,%f]}, \"id\":\"%d\", \"properties\":{\"type\":\"Tank\",\"InpID\":\"%s\", \"H0\":%f, \"Vmin\":%f, \"Vmax\":%f, \"V0\": %f, \"Kb\":%f, \"V\":%f, \"C\":%f, \"Pat\":%d, \"Vcurve\":%d, \"MixModel\":\"%s\", \"V1Max\":%f, \"CanOverflow\":%d}}",
-	      theNode->X,
-	      theNode->Y,
-	      i,
-	      theNode->ID,
-	      theTank->H0,
-	      theTank->Vmin,
-	      theTank->Vmax,
-	      theTank->V0,
-	      theTank->Kb,
-	      theTank->V,
-	      theTank->C,
-	      theTank->Pat,
-	      theTank->Vcurve,
-	      getMixType(theTank->MixModel),	       
-	      theTank->V1max,
-	      theTank->CanOverflow);		          
-    }
+    Stank *theTank = &theProjectPtr->network.Tank[i];
+    Snode *theNode = &theProjectPtr->network.Node[theTank->Node];
+    // keeping tanks and resrvoirs seperate for now .. might not want all the stuff in the structure depending on type
+    startFeature(&f, (theTank->A == 0) ? "Reservoir" : "Tank", i);
+    setPoint(&f, theNode);
+    addString(&f, "InpID", theNode->ID);
+    addDouble(&f, "H0", theTank->H0);
+    addDouble(&f, "Vmin", theTank->Vmin);
+    addDouble(&f, "Vmax", theTank->Vmax);
+    addDouble(&f, "V0", theTank->V0);
+    addDouble(&f, "Kb", theTank->Kb);
+    addDouble(&f, "V", theTank->V);
+    addDouble(&f, "C", theTank->C);
+    addInt(&f, "Pat", theTank->Pat);
+    addInt(&f, "Vcurve", theTank->Vcurve);
+    addString(&f, "MixModel", getMixType(theTank->MixModel));
+    addDouble(&f, "V1Max", theTank->V1max);
+    addInt(&f, "CanOverflow", theTank->CanOverflow);
+    if ((res = callback(userData, &f)) != 0) return res;
   }
 
+  return 0;
+}
+
+typedef struct {
+  FILE *jsonFile;
+  int numWritten;
+  InpFeatureCallback callback;
+  void *userData;
+} JSONWriter;
+
+static int writeFeature(void *userData, const InpFeature *f)
+{
+  JSONWriter *writer = (JSONWriter *)userData;
+  FILE *jsonFile = writer->jsonFile;
+
+  // the comma is needed before every feature except the first
+  fprintf(jsonFile, "%s\n {\"type\":\"Feature\",\"geometry\":{ ", writer->numWritten == 0 ? "" : ",");
+
+  if (f->numPoints == 1)
+    fprintf(jsonFile, "\"type\":\"Point\", \"coordinates\":[%f,%f]}", f->x[0], f->y[0]);
+  else
+    fprintf(jsonFile, "\"type\":\"LineString\", \"coordinates\":[[%f,%f],[%f,%f]]}", f->x[0], f->y[0], f->x[1], f->y[1]);
+
+  fprintf(jsonFile, ", \"id\":\"%d\", \"properties\":{", f->id);
+
+  for (int j=0; j<f->numFields; j++) {
+    const InpField *field = &f->fields[j];
+    const char *sep = (j == 0) ? "" : ", ";
+    if (field->type == INP_STRING)
+      fprintf(jsonFile, "%s\"%s\":\"%s\"", sep, field->name, field->str);
+    else if (field->type == INP_INT)
+      fprintf(jsonFile, "%s\"%s\":%d", sep, field->name, (int)field->num);
+    else
+      fprintf(jsonFile, "%s\"%s\":%f", sep, field->name, field->num);
+  }
+
+  fprintf(jsonFile, "}}");
+
+  writer->numWritten++;
+
+  if (writer->callback != 0)
+    return writer->callback(writer->userData, f);
+
+  return 0;
+}
+
+//
+// write the network to a GeoJSON file, if a callback is given every feature is also passed to it in the same pass
+//
+
+int outputNetworkJSON(Project *theProjectPtr, const char *fileName, InpFeatureCallback callback, void *userData) {
+
+  //
+  // open file, error message and return -1 if error
+  //
+  
+  FILE* jsonFile = fopen(fileName, "w"); 
+  if (jsonFile == 0) {
+    printf("ERROR: Coul not open file: %s\n",fileName);
+    return -1;
+  }
+
+  //
+  // start of GeoJSON
+  //
+  
+  fprintf(jsonFile, "\n{\n \"type\":\"FeatureCollection\", \"features\":[");
+
+  JSONWriter writer = {jsonFile, 0, callback, userData};
+
+  int res = visitNetworkFeatures(theProjectPtr, writeFeature, &writer);
+
   // finish the JSON file
   fprintf(jsonFile, "\n]}\n");
 
   fclose(jsonFile);
 
-  return 0;
+  return res;
+}
+
+int outputJSON(Project *theProjectPtr, const char *fileName) {
+  return outputNetworkJSON(theProjectPtr, fileName, 0, 0);
 }
@@ -16,6 +16,11 @@
    createsparse() -- called from openhyd() in HYDRAUL.C
    freesparse()   -- called from closehyd() in HYDRAUL.C
    linsolve()     -- called from netsolve() in HYDRAUL.C
+
+ linsolve() uses either the column-by-column Cholesky factorization of
+ George and Liu or, when the EN_LINEARSOLVER option is EN_SUPERNODAL,
+ a supernodal version of it. Both share the node re-ordering and the
+ symbolic factorization done in createsparse().
 */
 
 #include <stdlib.h>
@@ -43,6 +48,8 @@ int  linsolve(Smatrix *, int);
 // Local functions
 static int     allocsmatrix(Smatrix *, int, int);
 static int     alloclinsolve(Smatrix *, int);
+static int     allocsupernodes(Smatrix *, int);
+static int     snlinsolve(Smatrix *);
 static int     localadjlists(Network *, Smatrix *);
 static int     paralink(Network *, Smatrix *, int, int, int k);
 static void    xparalinks(Network *);
@@ -121,6 +128,13 @@ int  createsparse(Project *pr)
     // Allocate memory used by linear eqn. solver
     ERRCODE(alloclinsolve(sm, net->Nnodes));
 
+    // Partition the factorized matrix into supernodes
+    // if the supernodal solver is used
+    if (pr->hydraul.LinSolver == SUPERNODAL)
+    {
+        ERRCODE(allocsupernodes(sm, net->Njuncs));
+    }
+
     // Re-build adjacency lists for future use
     ERRCODE(buildadjlists(net));
     return errcode;
@@ -146,6 +160,19 @@ int  allocsmatrix(Smatrix *sm, int Nnodes, int Nlinks)
     sm->link  = NULL;
     sm->first = NULL;
 
+    // Memory for supernodal solver allocated in allocsupernodes().
+    sm->Nsuper = 0;
+    sm->Snode  = NULL;
+    sm->XSUP   = NULL;
+    sm->XSROW  = NULL;
+    sm->SROW   = NULL;
+    sm->Relind = NULL;
+    sm->Sfirst = NULL;
+    sm->Slink  = NULL;
+    sm->XSL    = NULL;
+    sm->SL     = NULL;
+    sm->Swork  = NULL;
+
     // Memory for representing sparse matrix data structure
     sm->Order  = (int *) calloc(Nnodes+1,  sizeof(int));
     sm->Row    = (int *) calloc(Nnodes+1,  sizeof(int));
@@ -185,6 +212,111 @@ int  alloclinsolve(Smatrix *sm, int n)
 }
 
 
+int  allocsupernodes(Smatrix *sm, int n)
+/*
+**--------------------------------------------------------------
+** Input:   n = number of rows in solution matrix
+** Output:  returns error code
+** Purpose: partitions the columns of the factorized matrix into
+**          supernodes and allocates memory used by the
+**          supernodal linear eqn. solver
+**
+** NOTE:   A supernode is a set of consecutive columns whose
+**         non-zeros form a dense lower triangular block on the
+**         diagonal and share the same rows below it. Its coeffs.
+**         are stored as a dense column-major block (rows of the
+**         supernode x columns of the supernode) in SL so that
+**         the factorization can use dense kernels. Requires the
+**         row indexes in NZSUB to be sorted (see sortsparse()).
+**--------------------------------------------------------------
+*/
+{
+    int *XLNZ  = sm->XLNZ;
+    int *NZSUB = sm->NZSUB;
+
+    int    i, j, k, s, nsuper, ncols, nrows, maxrows, maxcols;
+    size_t nvals;
+    int    errcode = 0;
+
+    sm->Snode  = (int *) calloc(n+2, sizeof(int));
+    sm->XSUP   = (int *) calloc(n+2, sizeof(int));
+    sm->Relind = (int *) calloc(n+1, sizeof(int));
+    ERRCODE(MEMCHECK(sm->Snode));
+    ERRCODE(MEMCHECK(sm->XSUP));
+    ERRCODE(MEMCHECK(sm->Relind));
+    if (errcode) return errcode;
+
+    // Column j joins the supernode of column j-1 if j is the first
+    // off-diagonal row of column j-1 and column j-1 has one more
+    // non-zero than column j (the rows of column j are then the
+    // remaining rows of column j-1)
+    nsuper = 0;
+    for (j = 1; j <= n; j++)
+    {
+        if (j > 1 && XLNZ[j] > XLNZ[j-1] && NZSUB[XLNZ[j-1]] == j &&
+            XLNZ[j] - XLNZ[j-1] == XLNZ[j+1] - XLNZ[j] + 1)
+        {
+            sm->Snode[j] = nsuper;
+        }
+        else
+        {
+            nsuper++;
+            sm->Snode[j] = nsuper;
+            sm->XSUP[nsuper] = j;
+        }
+    }
+    sm->XSUP[nsuper+1] = n + 1;
+    sm->Nsuper = nsuper;
+
+    // Count the rows and coeffs. of each supernode
+    sm->XSROW = (int *) calloc(nsuper+2, sizeof(int));
+    sm->XSL   = (size_t *) calloc(nsuper+2, sizeof(size_t));
+    sm->Sfirst = (int *) calloc(nsuper+1, sizeof(int));
+    sm->Slink  = (int *) calloc(nsuper+1, sizeof(int));
+    ERRCODE(MEMCHECK(sm->XSROW));
+    ERRCODE(MEMCHECK(sm->XSL));
+    ERRCODE(MEMCHECK(sm->Sfirst));
+    ERRCODE(MEMCHECK(sm->Slink));
+    if (errcode) return errcode;
+
+    maxrows = 0;
+    maxcols = 0;
+    nvals = 0;
+    sm->XSROW[1] = 0;
+    for (s = 1; s <= nsuper; s++)
+    {
+        ncols = sm->XSUP[s+1] - sm->XSUP[s];
+        j = sm->XSUP[s+1] - 1;
+        nrows = ncols + XLNZ[j+1] - XLNZ[j];
+        sm->XSROW[s+1] = sm->XSROW[s] + nrows;
+        sm->XSL[s] = nvals;
+        nvals += (size_t)nrows * ncols;
+        if (nrows > maxrows) maxrows = nrows;
+        if (ncols > maxcols) maxcols = ncols;
+    }
+    sm->XSL[nsuper+1] = nvals;
+
+    // Store the row indexes of each supernode, the columns of
+    // its diagonal block followed by the rows of its last column
+    sm->SROW  = (int *) calloc(sm->XSROW[nsuper+1] + 1, sizeof(int));
+    sm->SL    = (double *) calloc(nvals + 1, sizeof(double));
+    sm->Swork = (double *) calloc((size_t)maxrows * maxcols + 1, sizeof(double));
+    ERRCODE(MEMCHECK(sm->SROW));
+    ERRCODE(MEMCHECK(sm->SL));
+    ERRCODE(MEMCHECK(sm->Swork));
+    if (errcode) return errcode;
+
+    for (s = 1; s <= nsuper; s++)
+    {
+        i = sm->XSROW[s];
+        for (j = sm->XSUP[s]; j < sm->XSUP[s+1]; j++) sm->SROW[i++] = j;
+        j = sm->XSUP[s+1] - 1;
+        for (k = XLNZ[j]; k < XLNZ[j+1]; k++) sm->SROW[i++] = NZSUB[k];
+    }
+    return errcode;
+}
+
+
 void  freesparse(Project *pr)
 /*
 **----------------------------------------------------------------
@@ -214,6 +346,18 @@ void  freesparse(Project *pr)
     FREE(sm->temp);
     FREE(sm->link);
     FREE(sm->first);
+
+    FREE(sm->Snode);
+    FREE(sm->XSUP);
+    FREE(sm->XSROW);
+    FREE(sm->SROW);
+    FREE(sm->Relind);
+    FREE(sm->Sfirst);
+    FREE(sm->Slink);
+    FREE(sm->XSL);
+    FREE(sm->SL);
+    FREE(sm->Swork);
+    sm->Nsuper = 0;
 }
 
 
@@ -765,6 +909,8 @@ int  linsolve(Smatrix *sm, int n)
     int    i, istop, istrt, isub, j, k, kfirst, newk;
     double bj, diagj, ljk;
 
+    if (sm->Nsuper > 0) return snlinsolve(sm);
+
     memset(temp,  0, (n + 1) * sizeof(double));
     memset(link,  0, (n + 1) * sizeof(int));
     memset(first, 0, (n + 1) * sizeof(int));
@@ -869,3 +1015,198 @@ int  linsolve(Smatrix *sm, int n)
    }
    return 0;
 }
+
+
+int  snlinsolve(Smatrix *sm)
+/*
+**--------------------------------------------------------------
+** Input:   sm   = sparse matrix struct (the number of equations
+**                 is taken from the supernode partition)
+** Output:  sm->F = solution values
+**          returns 0 if solution found, or index of
+**          equation causing system to be ill-conditioned
+** Purpose: solves sparse symmetric system of linear
+**          equations using a supernodal Cholesky factorization
+**
+** NOTE:   This is the left-looking factorization of linsolve()
+**         applied to the supernodes built in allocsupernodes().
+**         Each supernode first gathers the outer product updates
+**         of the supernodes that affect it into the dense work
+**         array Swork and scatters them into its dense block,
+**         then factorizes the block in place. The inner loops run
+**         over contiguous columns so that the compiler can
+**         vectorize them. The factor is kept in SL, the Aii and
+**         Aij arrays are left unchanged.
+**--------------------------------------------------------------
+*/
+{
+    double *Aii   = sm->Aii;
+    double *Aij   = sm->Aij;
+    double *B     = sm->F;
+    double *W     = sm->Swork;
+    int *LNZ      = sm->LNZ;
+    int *XLNZ     = sm->XLNZ;
+    int *NZSUB    = sm->NZSUB;
+    int *XSUP     = sm->XSUP;
+    int *XSROW    = sm->XSROW;
+    int *Snode    = sm->Snode;
+    int *Relind   = sm->Relind;
+    int *link     = sm->Slink;
+    int *first    = sm->Sfirst;
+    int nsuper    = sm->Nsuper;
+
+    int    c, cc, i, j, k, s, t, newt, p1, p2, m, q;
+    int    fcol, ncols, nrows, tncols, tnrows;
+    int    *rows, *trows;
+    double bj, diagj, ljk;
+    double *L, *Lc, *Lt, *Ltc, *Wc;
+
+    memset(link,  0, (nsuper + 1) * sizeof(int));
+    memset(first, 0, (nsuper + 1) * sizeof(int));
+
+    // Begin numerical factorization of matrix A into L
+    //   Compute supernode L(*,s) for s = 1,...nsuper
+    for (s = 1; s <= nsuper; s++)
+    {
+        fcol  = XSUP[s];
+        ncols = XSUP[s+1] - fcol;
+        rows  = sm->SROW + XSROW[s];
+        nrows = XSROW[s+1] - XSROW[s];
+        L     = sm->SL + sm->XSL[s];
+
+        // Position of each row of the supernode in its block
+        for (i = 0; i < nrows; i++) Relind[rows[i]] = i;
+
+        // Load the columns of A into the block
+        memset(L, 0, (size_t)nrows * ncols * sizeof(double));
+        for (c = 0; c < ncols; c++)
+        {
+            j = fcol + c;
+            Lc = L + (size_t)c * nrows;
+            Lc[c] = Aii[j];
+            for (k = XLNZ[j]; k < XLNZ[j+1]; k++)
+            {
+                Lc[Relind[NZSUB[k]]] = Aij[LNZ[k]];
+            }
+        }
+
+        // For each supernode L(*,t) that affects L(*,s):
+        newt = link[s];
+        t = newt;
+        while (t != 0)
+        {
+            newt   = link[t];
+            tncols = XSUP[t+1] - XSUP[t];
+            trows  = sm->SROW + XSROW[t];
+            tnrows = XSROW[t+1] - XSROW[t];
+            Lt     = sm->SL + sm->XSL[t];
+
+            // Rows p1 to p2-1 of L(*,t) are columns of L(*,s)
+            p1 = first[t];
+            p2 = p1;
+            while (p2 < tnrows && trows[p2] < fcol + ncols) p2++;
+            m = tnrows - p1;
+            q = p2 - p1;
+
+            // Outer product of rows p1,... of L(*,t) with its
+            // rows p1 to p2-1, accumulated in W
+            memset(W, 0, (size_t)m * q * sizeof(double));
+            for (c = 0; c < tncols; c++)
+            {
+                Ltc = Lt + (size_t)c * tnrows + p1;
+                for (cc = 0; cc < q; cc++)
+                {
+                    ljk = Ltc[cc];
+                    Wc = W + (size_t)cc * m;
+                    for (i = cc; i < m; i++) Wc[i] += Ltc[i] * ljk;
+                }
+            }
+
+            // Scatter the modification into the block of L(*,s)
+            for (cc = 0; cc < q; cc++)
+            {
+                Lc = L + (size_t)(trows[p1+cc] - fcol) * nrows;
+                Wc = W + (size_t)cc * m;
+                for (i = cc; i < m; i++) Lc[Relind[trows[p1+i]]] -= Wc[i];
+            }
+
+            // Move L(*,t) to the list of the supernode
+            // of its next row for future modification steps
+            if (p2 < tnrows)
+            {
+                first[t] = p2;
+                k = Snode[trows[p2]];
+                link[t] = link[k];
+                link[k] = t;
+            }
+            t = newt;
+        }
+
+        // Factorize the dense block of L(*,s)
+        for (c = 0; c < ncols; c++)
+        {
+            Lc = L + (size_t)c * nrows;
+            diagj = Lc[c];
+            if (diagj <= 0.0)        // Check for ill-conditioning
+            {
+                return fcol + c;
+            }
+            diagj = sqrt(diagj);
+            Lc[c] = diagj;
+            for (i = c + 1; i < nrows; i++) Lc[i] /= diagj;
+
+            // Modify the remaining columns of the supernode
+            for (cc = c + 1; cc < ncols; cc++)
+            {
+                ljk = Lc[cc];
+                Wc = L + (size_t)cc * nrows;
+                for (i = cc; i < nrows; i++) Wc[i] -= Lc[i] * ljk;
+            }
+        }
+
+        // Add L(*,s) to the list of the supernode of its
+        // first row below the diagonal block
+        if (nrows > ncols)
+        {
+            first[s] = ncols;
+            k = Snode[rows[ncols]];
+            link[s] = link[k];
+            link[k] = s;
+        }
+    }      // next s
+
+    // Foward substitution
+    for (s = 1; s <= nsuper; s++)
+    {
+        fcol  = XSUP[s];
+        ncols = XSUP[s+1] - fcol;
+        rows  = sm->SROW + XSROW[s];
+        nrows = XSROW[s+1] - XSROW[s];
+        L     = sm->SL + sm->XSL[s];
+        for (c = 0; c < ncols; c++)
+        {
+            Lc = L + (size_t)c * nrows;
+            bj = B[fcol+c] / Lc[c];
+            B[fcol+c] = bj;
+            for (i = c + 1; i < nrows; i++) B[rows[i]] -= Lc[i] * bj;
+        }
+    }
+
+    // Backward substitution
+    for (s = nsuper; s >= 1; s--)
+    {
+        fcol  = XSUP[s];
+        ncols = XSUP[s+1] - fcol;
+        rows  = sm->SROW + XSROW[s];
+        nrows = XSROW[s+1] - XSROW[s];
+        L     = sm->SL + sm->XSL[s];
+        for (c = ncols - 1; c >= 0; c--)
+        {
+            Lc = L + (size_t)c * nrows;
+            bj = B[fcol+c];
+            for (i = c + 1; i < nrows; i++) bj -= Lc[i] * B[rows[i]];
+            B[fcol+c] = bj / Lc[c];
+        }
+    }
+    return 0;
+}
@@ -308,6 +308,11 @@ typedef enum {
   PDA            // pressure driven analysis
 } DemandModelType;
 
+typedef enum {
+  CHOLESKY,      // column-by-column Cholesky factorization
+  SUPERNODAL     // supernodal Cholesky factorization
+} LinSolverType;
+
 /*
 ------------------------------------------------------
    Fundamental Data Structures
@@ -692,6 +697,25 @@ typedef struct {
     *link,       // Array used by linear eqn. solver
     *first;      // Array used by linear eqn. solver
 
+  // Supernodal storage of the factorized matrix, only
+  // allocated when the supernodal solver is used
+  int
+    Nsuper,      // Number of supernodes
+    *Snode,      // Supernode of each column
+    *XSUP,       // First column of each supernode
+    *XSROW,      // Start position of each supernode in SROW
+    *SROW,       // Row index of each row of each supernode
+    *Relind,     // Array used by supernodal solver
+    *Sfirst,     // Array used by supernodal solver
+    *Slink;      // Array used by supernodal solver
+
+  size_t
+    *XSL;        // Start position of each supernode in SL
+
+  double
+    *SL,         // Dense column-major coeffs. of each supernode
+    *Swork;      // Array used by supernodal solver
+
 } Smatrix;
 
 // Hydraulics Solver Wrapper
@@ -737,6 +761,7 @@ typedef struct {
     Epat,                  // Energy cost time pattern
     DemandModel,           // Fixed or pressure dependent
     Formflag,              // Head loss formula flag
+    LinSolver,             // Linear equation solver
     Iterations,            // Number of hydraulic trials taken
     MaxIter,               // Max. hydraulic trials allowed
     ExtraIter,             // Extra hydraulic trials
@@ -40,10 +40,12 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "QGISVisualizationWidget.h"
 #include "GISAssetInputWidget.h"
 #include "MultiComponentR2D.h"
+#include "EPANET2.2/geoJSON.h"
 
 #include <qgslinesymbol.h>
 #include <qgsmarkersymbol.h>
 #include <qgsjsonutils.h>
+#include <qgsgeometry.h>
 
 #include <QLineEdit>
 #include <QLabel>
@@ -56,7 +58,6 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QApplication>
 #include <QStandardPaths>
 #include <QJsonObject>
-#include <QTemporaryFile>
 #include <QJsonDocument>
 
 InpFileWaterInputWidget::InpFileWaterInputWidget(QWidget *parent, VisualizationWidget* visWidget, QString componentType, QString appType) : SimCenterAppWidget(parent), componentType(componentType), appType(appType)
@@ -447,7 +448,74 @@ void InpFileWaterInputWidget::chooseAssetFileDialog(void)
     return;
 }
 
-extern "C" int createJSON(const char *, const char *, const char *, const char *);
+namespace {
+
+// The features of one asset type of the network, e.g., Junction or Pipe
+struct InpAssetFeatures
+{
+    QString layerType;
+    QgsFields fields;
+    QgsFeatureList features;
+};
+
+// Collects the features that EPANET visits into one feature list per asset type
+int collectInpFeature(void *userData, const InpFeature *f)
+{
+    auto assetDictionary = static_cast<QMap<QString, InpAssetFeatures>*>(userData);
+
+    auto& asset = (*assetDictionary)[QString::fromUtf8(f->type)];
+
+    // All features of a type have the same fields, so the fields are set up from the first one
+    if(asset.fields.isEmpty())
+    {
+        asset.layerType = (f->numPoints == 1) ? "point" : "linestring";
+
+        asset.fields.append(QgsField("id", QVariant::Int));
+
+        for(int i = 0; i < f->numFields; ++i)
+        {
+            auto&& field = f->fields[i];
+
+            auto type = QVariant::Double;
+            if(field.type == INP_INT)
+                type = QVariant::Int;
+            else if(field.type == INP_STRING)
+                type = QVariant::String;
+
+            asset.fields.append(QgsField(QString::fromUtf8(field.name), type));
+        }
+    }
+
+    QgsAttributes attributes(f->numFields + 1);
+    attributes[0] = f->id;
+
+    for(int i = 0; i < f->numFields; ++i)
+    {
+        auto&& field = f->fields[i];
+
+        if(field.type == INP_STRING)
+            attributes[i + 1] = QString::fromUtf8(field.str);
+        else if(field.type == INP_INT)
+            attributes[i + 1] = static_cast<int>(field.num);
+        else
+            attributes[i + 1] = field.num;
+    }
+
+    QgsFeature feature(asset.fields);
+    feature.setAttributes(attributes);
+
+    if(f->numPoints == 1)
+        feature.setGeometry(QgsGeometry::fromPointXY(QgsPointXY(f->x[0], f->y[0])));
+    else
+        feature.setGeometry(QgsGeometry::fromPolylineXY({QgsPointXY(f->x[0], f->y[0]), QgsPointXY(f->x[1], f->y[1])}));
+
+    asset.features.append(feature);
+
+    return 0;
+}
+
+}
+
 
 bool InpFileWaterInputWidget::loadAssetData()
 {
@@ -457,157 +525,73 @@ bool InpFileWaterInputWidget::loadAssetData()
     // fmk - create a tmp geoJSON file and then use that file subequently in Steves code
     //
 
-    //    QFile inpFile(pathInpFileWater);
-    
     QString writableLocation = QStandardPaths::writableLocation(QStandardPaths::StandardLocation::AppLocalDataLocation);
     QDir writableDir(writableLocation);
     if(!writableDir.exists())
         writableDir.mkpath(".");
     
     geoJsonFileName = writableDir.filePath("sc_inpFileGeoJSON.json");
-    QString tmp1 = writableDir.filePath("SimCenter.thing1");
-    QString tmp2 = writableDir.filePath("SimCenter.thing2");
-       
-    createJSON(pathInpFileWater.toStdString().c_str(),
-	       tmp1.toStdString().c_str(),
-	       tmp2.toStdString().c_str(),
-	       geoJsonFileName.toStdString().c_str());
-	
-    QFile jsonFile(geoJsonFileName);
-    // back to Stevan    
-
-    QMap<QString, QList<QJsonObject>> assetDictionary;
-
-    QJsonObject crs;
-    if (jsonFile.exists() && jsonFile.open(QFile::ReadOnly)) {
-      
-      QJsonDocument exDoc = QJsonDocument::fromJson(jsonFile.readAll());
-      QJsonObject jsonObject = exDoc.object();
-      
-      //if(jsonObject.contains("crs"))
-        //crs = jsonObject["crs"].toObject();
-      //QString crsString = crs["properties"].toObject()["name"].toString();
-      //QgsCoordinateReferenceSystem qgsCRS = QgsCoordinateReferenceSystem(inputCRS);
-      QgsCoordinateReferenceSystem qgsCRS = QgsCoordinateReferenceSystem(defaultCRS);
-
-      if (!qgsCRS.isValid()){
-	        qgsCRS.createFromOgcWmsCrs(defaultCRS);
-       }
-        
-      if (!qgsCRS.isValid()){
-	        QString msg = "Default CRS is not valid. Choose an existing CRS.";
-	        //QString msg = "The CRS: " + crsString + " defined in " + geoJsonFileName + " is invalid and ignored.";
-	        errorMessage(msg);
-        }
-
-        crsSelectorWidget->setCRS(qgsCRS);
-        QJsonArray features = jsonObject["features"].toArray();
-
-        for (const QJsonValue& valueIt : features) {
+    QString reportFileName = writableDir.filePath("SimCenter.thing1");
 
-            QJsonObject value = valueIt.toObject();
+    // The network is read once, the GeoJSON file for the backend is written and the features for the layers are collected in the same pass
+    QMap<QString, InpAssetFeatures> assetDictionary;
 
-            // Get the type
-            QJsonObject assetProperties = value["properties"].toObject();
+    char errMsg[256];
+    auto res = readInpNetwork(pathInpFileWater.toStdString().c_str(),
+                              reportFileName.toStdString().c_str(),
+                              geoJsonFileName.toStdString().c_str(),
+                              collectInpFeature, &assetDictionary,
+                              errMsg, sizeof(errMsg));
 
-            if (!jsonObject.contains("type")) {
-                this->errorMessage("The Json object is missing the 'type' key that defines the asset type");
-                return false;
-            }
-
-            QString assetType = assetProperties["type"].toString();
-
-            if (!assetDictionary.contains(assetType))
-            {
-                assetDictionary[assetType] = QList<QJsonObject>({value});
-            }
-            else
-            {
-                QList<QJsonObject>& featList = assetDictionary[assetType];
-                featList.append(value);
-            }
-        }
-    }
-    else{
-        this->errorMessage("Failed to open file at location: "+ geoJsonFileName);
+    if(res >= 100)
+    {
+        this->errorMessage("Failed to read the network in "+ pathInpFileWater + ": " + QString::fromUtf8(errMsg));
         return false;
     }
-
-    for (auto it = assetDictionary.begin(); it != assetDictionary.end(); ++it)
+    else if(res > 0)
     {
-        QString assetType = it.key();
-        QList<QJsonObject> features = it.value();
-
-        QJsonArray featuresArray;
-        for (const auto& obj : features) {
-            featuresArray.append(obj);
-        }
-
-        QJsonObject assetDictionary;
-        assetDictionary["type"]="FeatureCollection";
-        assetDictionary["features"]=featuresArray;
-
-        if(!crs.isEmpty())
-            assetDictionary["crs"]=crs;
+        this->infoMessage("EPANET read the network with warnings, see the report file "+ reportFileName);
+    }
 
-        //QDir tempDir(QDir::tempPath());
-		QTemporaryFile tempFile;
-		
-		tempFile.setFileTemplate(tempFile.fileTemplate() + "_" + assetType + ".geojson");
-        //QString outputFile = tempDir.absolutePath() + QDir::separator() + assetType + ".geojson";
+    QgsCoordinateReferenceSystem qgsCRS = QgsCoordinateReferenceSystem(defaultCRS);
 
-		if (tempFile.open())
-        {
+    if (!qgsCRS.isValid()){
+        qgsCRS.createFromOgcWmsCrs(defaultCRS);
+    }
 
-            QString outputFile = tempFile.fileName();
+    if (!qgsCRS.isValid()){
+        QString msg = "Default CRS is not valid. Choose an existing CRS.";
+        errorMessage(msg);
+    }
 
-            // Write the file to the folderd
-            QJsonDocument doc(assetDictionary);
-            tempFile.write(doc.toJson());
+    crsSelectorWidget->setCRS(qgsCRS);
 
-			// Close the file
-            tempFile.close();
+    for (auto it = assetDictionary.begin(); it != assetDictionary.end(); ++it)
+    {
+        QString assetType = it.key();
+        auto& asset = it.value();
 
-            this->statusMessage("Loading asset type "+assetType+" with "+ QString::number(features.size())+" features");
+        this->statusMessage("Loading asset type "+assetType+" with "+ QString::number(asset.features.size())+" features");
 
-            GISAssetInputWidget *thisAssetWidget = new GISAssetInputWidget(nullptr, theVisualizationWidget, assetType);
+        GISAssetInputWidget *thisAssetWidget = new GISAssetInputWidget(nullptr, theVisualizationWidget, assetType);
 
-            // Hide the first label
-            /*
-        thisAssetWidget->getLabel1()->hide();
-        thisAssetWidget->getCRSSelectorWidget()->hide();
+        thisAssetWidget->hideCRS_Selection();
+        thisAssetWidget->hideAssetFilePath();
 
-        // Hide the file input widgets in the asset file path layout
-        auto pathLayout = thisAssetWidget->getAssetFilePathLayout();
-        for (int i = 0; i < pathLayout->count(); ++i) {
-            QWidget *widget = pathLayout->itemAt(i)->widget();
-            if (widget) {
-                widget->hide();
-            }
+        if (!thisAssetWidget->loadAssetFeatures(assetType, asset.layerType, asset.fields, asset.features, false)) {
+            this->errorMessage("Failed to load asset data for asset type" + assetType);
+            return false;
         }
-        */
-
-            thisAssetWidget->hideCRS_Selection();
-            thisAssetWidget->hideAssetFilePath();
-
-            thisAssetWidget->setPathToComponentInputFile(outputFile);
-            if (!thisAssetWidget->loadAssetData(false)) {
-                this->errorMessage("Failed to load asset data for asset type" + assetType);
-                return false;
-            }
-
-            theAssetLayerList.append(thisAssetWidget->getMainLayer());
 
-            mainAssetWidget->addComponent(assetType, thisAssetWidget);
+        // The features are no longer needed once they are in the layer
+        asset.features.clear();
 
+        if (qgsCRS.isValid())
+            thisAssetWidget->setCRS(qgsCRS);
 
-            // Automatically delete the temporary file when it goes out of scope or when the application exits
-            tempFile.setAutoRemove(true);
-        }
-        else {
-            this->errorMessage("Failed to create temporary file for " + assetType);
-        }
+        theAssetLayerList.append(thisAssetWidget->getMainLayer());
 
+        mainAssetWidget->addComponent(assetType, thisAssetWidget);
 
         if (ComponentTypeToAdditionalWidget.contains(assetType)){
             for (QWidget* it:ComponentTypeToAdditionalWidget[assetType]){
@@ -47,6 +47,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QJsonObject>
 #include <QDoubleValidator>
 #include <QList>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QComboBox>
 
 #include <SC_QRadioButton.h>
 #include <SC_DoubleLineEdit.h>
@@ -57,10 +61,12 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <SC_TableEdit.h>
 //#include <SC_intLineEdit.h>
 #include <RewetResults.h>
+#include <HydraulicScreening.h>
+#include <epanet2_enums.h>
 
 
 RewetRecovery::RewetRecovery(QWidget *parent)
-  : SimCenterAppWidget(parent), resultWidget(0)
+  : SimCenterAppWidget(parent), theScreening(0), resultWidget(0)
 {
     int windowWidth = 800;
 
@@ -385,12 +391,70 @@ RewetRecovery::RewetRecovery(QWidget *parent)
     pumpDiscoveryLayout->addWidget(new QWidget(), 1, 3, 1, 1);
     pumpDiscoveryLayout->setColumnStretch(3,1);
 
+    //
+    // screening widget
+    //
+
+    // (4) quick steady state check of the damage realizations before running the full recovery simulation
+    QWidget *screeningWidget = new QWidget();
+    QGridLayout *screeningLayout = new QGridLayout();
+    screeningWidget->setLayout(screeningLayout);
+
+    screeningInpFile = new SC_FileEdit("screening_inp_file");
+    screeningResultsFile = new SC_FileEdit("screening_results_file");
+    screeningLeakEmitterLineEdit = new SC_DoubleLineEdit("screening_leak_emitter_coefficient", 0.1, 0, 1000000, 0.0001);
+    screeningRunButton = new QPushButton("Run Screening");
+    screeningCancelButton = new QPushButton("Cancel");
+    screeningCancelButton->setEnabled(false);
+
+    // The supernodal factorization works on dense blocks of the network matrix, it gives the same heads and can be faster on large networks
+    screeningSolverCombo = new QComboBox();
+    screeningSolverCombo->addItem("Sparse Cholesky", EN_CHOLESKY);
+    screeningSolverCombo->addItem("Supernodal Cholesky", EN_SUPERNODAL);
+
+    QStringList screeningColumns = {"Realization", "Status", "Demand Satisfied %", "Junctions Below Required Pressure %", "Min Pressure"};
+    screeningTable = new QTableWidget(0, screeningColumns.size());
+    screeningTable->setHorizontalHeaderLabels(screeningColumns);
+    screeningTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    screeningTable->verticalHeader()->setVisible(false);
+    screeningTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    QLabel *screeningNoteLabel = new QLabel("The most likely damage of the pipes in the results of the workflow (R2D_results.geojson) is solved once as a steady state pressure driven analysis with the pressures of the Hydraulics tab. Pipes in damage state 1 leak and pipes in a higher damage state are broken. The broken pipes are closed and the leaks are modelled as emitters at the two end nodes of the pipe.");
+    screeningNoteLabel->setWordWrap(true);
+
+    numRow = 0;
+    screeningLayout->addWidget(screeningNoteLabel, numRow++, 0, 1, 3);
+    screeningLayout->addWidget(new QLabel("Network (.inp) File"), numRow, 0);
+    screeningLayout->addWidget(screeningInpFile, numRow++, 1, 1, 2);
+    screeningLayout->addWidget(new QLabel("Damage Results (.geojson) File"), numRow, 0);
+    screeningLayout->addWidget(screeningResultsFile, numRow++, 1, 1, 2);
+    screeningLayout->addWidget(new QLabel("Leak Emitter Coefficient"), numRow, 0);
+    screeningLayout->addWidget(screeningLeakEmitterLineEdit, numRow, 1);
+    screeningLayout->addWidget(new QLabel("flow units of the .inp file"), numRow++, 2);
+    screeningLayout->addWidget(new QLabel("Linear Solver"), numRow, 0);
+    screeningLayout->addWidget(screeningSolverCombo, numRow++, 1, 1, 2);
+    screeningLayout->addWidget(screeningRunButton, numRow, 0);
+    screeningLayout->addWidget(screeningCancelButton, numRow++, 1);
+    screeningLayout->addWidget(screeningTable, numRow, 0, 1, 3);
+    screeningLayout->setRowStretch(numRow, 1);
+
+    connect(screeningRunButton, &QPushButton::clicked, this, [this]() {
+        this->runHydraulicScreening();
+    });
+
+    // The realizations that are being solved are finished, the rest are skipped
+    connect(screeningCancelButton, &QPushButton::clicked, this, [this]() {
+        if(theScreening != nullptr)
+            theScreening->cancel();
+    });
+
     // stuff below for scrolling .. if no scrolling this->setLayout(mainLayout);
 
     // making the main tabs
     theTabWidget->addTab(simulationWidget, "Simulation");
     theTabWidget->addTab(hydraulicsWidget, "Hydraulics");
     theTabWidget->addTab(restorationWidget, "Restoration");
+    theTabWidget->addTab(screeningWidget, "Screening");
     
     QWidget     *mainGroup = new QWidget();
     mainGroup->setLayout(mainLayout);
@@ -421,6 +485,124 @@ void RewetRecovery::clear(void)
 }
 
 
+void RewetRecovery::runHydraulicScreening(void)
+{
+    QString pathToInpFile = screeningInpFile->getFilename();
+    QString pathToResults = screeningResultsFile->getFilename();
+
+    if(pathToInpFile.isEmpty() || pathToResults.isEmpty())
+    {
+        this->errorMessage("Select the network (.inp) file and the damage results file to run the screening");
+        return;
+    }
+
+    QString err;
+    QVector<HydraulicScenario> scenarios;
+    if(HydraulicScreening::readScenarios(pathToResults, screeningLeakEmitterLineEdit->text().toDouble(), scenarios, err) != 0)
+    {
+        this->errorMessage(err);
+        return;
+    }
+
+    screeningTable->setRowCount(scenarios.size());
+    for(int i = 0; i < scenarios.size(); ++i)
+    {
+        screeningTable->setItem(i, 0, new QTableWidgetItem(scenarios.at(i).name));
+        screeningTable->setItem(i, 1, new QTableWidgetItem("Queued"));
+        for(int j = 2; j < screeningTable->columnCount(); ++j)
+            screeningTable->setItem(i, j, new QTableWidgetItem());
+    }
+
+    // Owned by the widget, so that a running analysis is stopped before the widget goes away
+    theScreening = new HydraulicScreening(this);
+
+    // The rows are filled in as the realizations finish, the signal is queued to the GUI thread
+    connect(theScreening, &HydraulicScreening::scenarioFinished, this, [this](int index) {
+
+        if(theScreening == nullptr)
+            return;
+
+        const auto& res = theScreening->getResults().at(index);
+
+        if(res.errorCode >= 100)
+        {
+            screeningTable->item(index, 1)->setText("Failed (EPANET error " + QString::number(res.errorCode) + ")");
+            return;
+        }
+
+        QString status = res.errorCode > 0 ? "Solved with warnings" : "Solved";
+        if(res.numUnknownIds > 0)
+            status += ", " + QString::number(res.numUnknownIds) + " unknown ids";
+
+        screeningTable->item(index, 1)->setText(status);
+        screeningTable->item(index, 2)->setText(QString::number(100.0*res.demandSatisfaction, 'f', 1));
+        screeningTable->item(index, 3)->setText(QString::number(100.0*res.fractionBelowRequired, 'f', 1));
+        screeningTable->item(index, 4)->setText(QString::number(res.minimumPressure, 'f', 2));
+    });
+
+    connect(theScreening, &HydraulicScreening::finished, this, &RewetRecovery::handleScreeningFinished);
+
+    theScreening->setLinearSolver(screeningSolverCombo->currentData().toInt());
+
+    if(theScreening->run(pathToInpFile, scenarios, solverPDAMin->text().toDouble(), solverPDARequired->text().toDouble(), err) != 0)
+    {
+        theScreening->deleteLater();
+        theScreening = nullptr;
+
+        this->errorMessage(err);
+        return;
+    }
+
+    screeningRunButton->setEnabled(false);
+    screeningSolverCombo->setEnabled(false);
+    screeningCancelButton->setEnabled(true);
+
+    this->statusMessage("Screening " + QString::number(scenarios.size()) + " damage realizations of the network in " + pathToInpFile);
+}
+
+
+void RewetRecovery::handleScreeningFinished(void)
+{
+    if(theScreening == nullptr)
+        return;
+
+    const bool cancelled = theScreening->isCancelled();
+
+    if(cancelled)
+    {
+        const auto& results = theScreening->getResults();
+        for(int i = 0; i < results.size(); ++i)
+        {
+            if(results.at(i).errorCode == -1)
+                screeningTable->item(i, 1)->setText("Cancelled");
+        }
+    }
+
+    auto err = theScreening->getError();
+
+    theScreening->deleteLater();
+    theScreening = nullptr;
+
+    screeningRunButton->setEnabled(true);
+    screeningSolverCombo->setEnabled(true);
+    screeningCancelButton->setEnabled(false);
+
+    if(!err.isEmpty())
+    {
+        this->errorMessage(err);
+        return;
+    }
+
+    if(cancelled)
+    {
+        this->statusMessage("Cancelled the screening of the damage realizations");
+        return;
+    }
+
+    this->statusMessage("Screened the damage realizations");
+}
+
+
 bool RewetRecovery::inputFromJSON(QJsonObject &jsonObject)
 {
   this->clear();
@@ -46,12 +46,16 @@ class SC_FileEdit;
 class SC_DoubleLineEdit;
 class SC_IntLineEdit;
 class SC_ComboBox;
+class QComboBox;
 class SC_CheckBox;
 class RewetResults;
 
 //class SC_IntLineEdit;
 class SC_TableEdit;
 class SC_QRadioButton;
+class HydraulicScreening;
+class QPushButton;
+class QTableWidget;
 
 
 class RewetRecovery : public SimCenterAppWidget
@@ -113,6 +117,20 @@ private:
   SC_TableEdit *pumpTimeBasedDiscoveryTable;
   void copyFilesInPolicyDefinition(QString &file_name, QString &destDir);
 
+  // screening
+  SC_FileEdit *screeningInpFile;
+  SC_FileEdit *screeningResultsFile;
+  SC_DoubleLineEdit *screeningLeakEmitterLineEdit;
+  QPushButton *screeningRunButton;
+  QPushButton *screeningCancelButton;
+  QComboBox *screeningSolverCombo;
+  QTableWidget *screeningTable;
+  HydraulicScreening *theScreening;
+
+  // Starts solving the damage of the results file once with the network in the .inp file, the serviceability of the network is listed when it finishes
+  void runHydraulicScreening(void);
+  void handleScreeningFinished(void);
+
   RewetResults *resultWidget;
 };
 